@@ -34,23 +34,27 @@ BufferPoolManager::~BufferPoolManager() {
 }
 
 Page *BufferPoolManager::FetchPage(page_id_t page_id) {
-  std::lock_guard<std::mutex> guardo(latch_);
-  if (page_table_.find(page_id) != page_table_.end()) {
-    auto frame_id = page_table_[page_id];
-    pages_[frame_id].pin_count_++;
-    replacer_->Pin(frame_id);
-    return &pages_[frame_id];
-  }
-
-  if (!free_list_.empty() || replacer_->Size() != 0) {
-    frame_id_t frame_id = FindFrameId();
-    page_table_[page_id] = frame_id;
-    InitNewPage(frame_id, page_id);
-    disk_manager_->ReadPage(page_id, pages_[frame_id].GetData());
-    return &pages_[frame_id];
+  std::unique_lock<std::mutex> lock(latch_);
+  if (page_table_.find(page_id) == page_table_.end()) {
+    frame_id_t frame_id = FindFrameId(&lock);
+    if (frame_id == -1) {
+      return nullptr;
+    }
+    if (page_table_.find(page_id) == page_table_.end()) {
+      page_table_[page_id] = frame_id;
+      InitNewPage(frame_id, page_id);
+      disk_manager_->ReadPage(page_id, pages_[frame_id].GetData());
+      return &pages_[frame_id];
+    }
+    // Another thread fetched the page while latch_ was released for the log.
+    pages_[frame_id].page_id_ = INVALID_PAGE_ID;
+    pages_[frame_id].is_dirty_ = false;
+    free_list_.push_back(frame_id);
   }
-
-  return nullptr;
+  auto frame_id = page_table_[page_id];
+  pages_[frame_id].pin_count_++;
+  replacer_->Pin(frame_id);
+  return &pages_[frame_id];
 
   // 1.     Search the page table for the requested page (P).
   // 1.1    If P exists, pin it and return it immediately.
@@ -83,13 +87,16 @@ bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
 }
 
 bool BufferPoolManager::FlushPage(page_id_t page_id) {
-  std::lock_guard<std::mutex> guardo(latch_);
+  std::unique_lock<std::mutex> lock(latch_);
   if (page_table_.find(page_id) == page_table_.end()) {
     return false;
   }
   auto frame_id = page_table_[page_id];
   auto page = pages_ + frame_id;
-  disk_manager_->WritePage(page_id, page->GetData());
+  if (!IsLogged(page)) {
+    WaitForLog(frame_id, &lock);
+  }
+  disk_manager_->WritePage(page->GetPageId(), page->GetData());
   page->is_dirty_ = false;
   return true;
 }
@@ -100,13 +107,13 @@ Page *BufferPoolManager::NewPage(page_id_t *page_id) {
   // 2.   Pick a victim page P from either the free list or the replacer. Always pick from the free list first.
   // 3.   Update P's metadata, zero out memory and add P to the page table.
   // 4.   Set the page ID output parameter. Return a pointer to P.
-  std::lock_guard<std::mutex> guardo(latch_);
+  std::unique_lock<std::mutex> lock(latch_);
   auto new_page_id = disk_manager_->AllocatePage();
-  if (free_list_.empty() && replacer_->Size() == 0) {
+  frame_id_t frame_id = FindFrameId(&lock);
+  if (frame_id == -1) {
     printf("All pinned\n");
     return nullptr;
   }
-  frame_id_t frame_id = FindFrameId();
   page_table_[new_page_id] = frame_id;
   InitNewPage(frame_id, new_page_id);
   pages_[frame_id].ResetMemory();
@@ -131,9 +138,11 @@ bool BufferPoolManager::DeletePage(page_id_t page_id) {
   if (page->pin_count_ > 0) {
     return false;
   }
-  replacer_->Unpin(frame_id);
+  // The frame moves from the replacer to the free list; it must not be handed out by both.
+  replacer_->Pin(frame_id);
   page_table_.erase(page_id);
   page->page_id_ = INVALID_PAGE_ID;
+  page->is_dirty_ = false;
   free_list_.push_back(frame_id);
   return true;
 }
@@ -145,4 +154,55 @@ void BufferPoolManager::FlushAllPages() {
   }
 }
 
+frame_id_t BufferPoolManager::FindFrameId(std::unique_lock<std::mutex> *lock) {
+  while (free_list_.empty()) {
+    frame_id_t frame_id;
+    if (!replacer_->Victim(&frame_id)) {
+      return -1;
+    }
+    Page *page = &pages_[frame_id];
+    if (page->is_dirty_ && !IsLogged(page)) {
+      lsn_t lsn = page->GetLSN();
+      WaitForLog(frame_id, lock);
+      if (page->pin_count_ > 0 || page->GetLSN() != lsn) {
+        // The page was fetched meanwhile, and is no longer a victim.
+        continue;
+      }
+      replacer_->Pin(frame_id);
+    }
+    page_table_.erase(page->page_id_);
+    if (page->is_dirty_) {
+      disk_manager_->WritePage(page->GetPageId(), page->GetData());
+    }
+    return frame_id;
+  }
+  frame_id_t frame_id = free_list_.front();
+  free_list_.pop_front();
+  return frame_id;
+}
+
+void BufferPoolManager::WaitForLog(frame_id_t frame_id, std::unique_lock<std::mutex> *lock) {
+  Page *page = &pages_[frame_id];
+  lsn_t lsn = page->GetLSN();
+  page->pin_count_++;
+  replacer_->Pin(frame_id);
+  lock->unlock();
+  log_manager_->Flush(lsn);
+  lock->lock();
+  page->pin_count_--;
+  if (page->pin_count_ == 0) {
+    replacer_->Unpin(frame_id);
+  }
+}
+
+void BufferPoolManager::GetDirtyPageIds(std::vector<page_id_t> *page_ids) {
+  std::lock_guard<std::mutex> guardo(latch_);
+  page_ids->clear();
+  for (size_t i = 0; i < pool_size_; i++) {
+    if (pages_[i].page_id_ != INVALID_PAGE_ID && (pages_[i].is_dirty_ || pages_[i].pin_count_ > 0)) {
+      page_ids->push_back(pages_[i].page_id_);
+    }
+  }
+}
+
 }  // namespace bustub
@@ -0,0 +1,100 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// thread_pool.cpp
+//
+// Identification: src/common/thread_pool.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/thread_pool.h"
+
+#include <exception>
+#include <utility>
+
+namespace bustub {
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    shutdown_ = true;
+  }
+  cv_.notify_all();
+  for (auto &thread : threads_) {
+    thread.join();
+  }
+}
+
+void ThreadPool::Submit(std::function<void()> &&task) {
+  std::lock_guard<std::mutex> guard(latch_);
+  tasks_.push_back(std::move(task));
+  // Every queued task needs a worker of its own, since the workers that are busy may be waiting for it.
+  if (idle_count_ < tasks_.size()) {
+    threads_.emplace_back(&ThreadPool::WorkerLoop, this);
+  } else {
+    cv_.notify_one();
+  }
+}
+
+void ThreadPool::Run(size_t task_count, const std::function<void(size_t)> &task) {
+  if (task_count == 0) {
+    return;
+  }
+  std::mutex done_latch;
+  std::condition_variable done_cv;
+  size_t remaining = task_count;
+  std::exception_ptr error;
+  auto run = [&](size_t task_idx) {
+    std::exception_ptr task_error;
+    try {
+      task(task_idx);
+    } catch (...) {
+      task_error = std::current_exception();
+    }
+    std::lock_guard<std::mutex> guard(done_latch);
+    if (error == nullptr) {
+      error = task_error;
+    }
+    if (--remaining == 0) {
+      done_cv.notify_all();
+    }
+  };
+  for (size_t task_idx = 1; task_idx < task_count; task_idx++) {
+    Submit([&run, task_idx] { run(task_idx); });
+  }
+  run(0);
+  std::unique_lock<std::mutex> lock(done_latch);
+  done_cv.wait(lock, [&] { return remaining == 0; });
+  if (error != nullptr) {
+    std::rethrow_exception(error);
+  }
+}
+
+size_t ThreadPool::GetThreadCount() {
+  std::lock_guard<std::mutex> guard(latch_);
+  return threads_.size();
+}
+
+void ThreadPool::WorkerLoop() {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (true) {
+    while (tasks_.empty() && !shutdown_) {
+      idle_count_++;
+      cv_.wait(lock);
+      idle_count_--;
+    }
+    if (tasks_.empty()) {
+      return;
+    }
+    std::function<void()> task = std::move(tasks_.front());
+    tasks_.pop_front();
+    lock.unlock();
+    task();
+    lock.lock();
+  }
+}
+
+}  // namespace bustub
@@ -12,50 +12,697 @@
 
 #include "concurrency/lock_manager.h"
 
+#include <algorithm>
+#include <functional>
+#include <list>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
 namespace bustub {
 
 bool LockManager::LockShared(Transaction *txn, const RID &rid) {
+  if (IsAborted(txn)) {
+    return false;
+  }
+  CheckLockable(txn, LockMode::SHARED);
+  if (txn->IsSharedLocked(rid) || txn->IsExclusiveLocked(rid)) {
+    return true;
+  }
+  Acquire(txn, RowKey(rid), LockMode::SHARED);
   txn->GetSharedLockSet()->emplace(rid);
   return true;
 }
 
 bool LockManager::LockExclusive(Transaction *txn, const RID &rid) {
+  if (IsAborted(txn)) {
+    return false;
+  }
+  CheckLockable(txn, LockMode::EXCLUSIVE);
+  if (txn->IsExclusiveLocked(rid)) {
+    return true;
+  }
+  Acquire(txn, RowKey(rid), LockMode::EXCLUSIVE);
   txn->GetExclusiveLockSet()->emplace(rid);
   return true;
 }
 
 bool LockManager::LockUpgrade(Transaction *txn, const RID &rid) {
-  txn->GetSharedLockSet()->erase(rid);
+  if (IsAborted(txn)) {
+    return false;
+  }
+  CheckLockable(txn, LockMode::EXCLUSIVE);
+  if (txn->IsExclusiveLocked(rid)) {
+    return true;
+  }
+  if (!Convert(txn, RowKey(rid), LockMode::EXCLUSIVE)) {
+    return false;
+  }
   txn->GetExclusiveLockSet()->emplace(rid);
   return true;
 }
 
 bool LockManager::Unlock(Transaction *txn, const RID &rid) {
-  txn->GetSharedLockSet()->erase(rid);
-  txn->GetExclusiveLockSet()->erase(rid);
+  bool shared = txn->GetSharedLockSet()->erase(rid) != 0;
+  bool exclusive = txn->GetExclusiveLockSet()->erase(rid) != 0;
+  if (!shared && !exclusive) {
+    return false;
+  }
+  Shrink(txn, shared);
+  auto page = txn->GetPageLockSet()->find(rid.GetPageId());
+  if (page != txn->GetPageLockSet()->end()) {
+    auto count = txn->GetRowLockCounts()->find(page->second.first);
+    if (count != txn->GetRowLockCounts()->end() && count->second > 0) {
+      count->second--;
+    }
+  }
+  Release(txn, RowKey(rid));
+  return true;
+}
+
+bool LockManager::LockTable(Transaction *txn, table_oid_t table_oid, LockMode lock_mode) {
+  if (IsAborted(txn)) {
+    return false;
+  }
+  CheckLockable(txn, lock_mode);
+  auto table_locks = txn->GetTableLockSet();
+  auto held = table_locks->find(table_oid);
+  if (held == table_locks->end()) {
+    Acquire(txn, TableKey(table_oid), lock_mode);
+    table_locks->emplace(table_oid, lock_mode);
+    return true;
+  }
+  if (Covers(held->second, lock_mode)) {
+    return true;
+  }
+  LockMode mode = Combine(held->second, lock_mode);
+  if (!Convert(txn, TableKey(table_oid), mode)) {
+    return false;
+  }
+  (*table_locks)[table_oid] = mode;
+  return true;
+}
+
+bool LockManager::LockPage(Transaction *txn, table_oid_t table_oid, page_id_t page_id, LockMode lock_mode) {
+  if (IsAborted(txn)) {
+    return false;
+  }
+  CheckLockable(txn, lock_mode);
+  LockMode intention = Covers(LockMode::SHARED, lock_mode) ? LockMode::INTENTION_SHARED : LockMode::INTENTION_EXCLUSIVE;
+  if (!LockTable(txn, table_oid, intention)) {
+    return false;
+  }
+  LockMode implicit_mode;
+  if (GetImplicitMode(txn->GetTableLockSet()->at(table_oid), &implicit_mode) && Covers(implicit_mode, lock_mode)) {
+    return true;
+  }
+
+  auto page_locks = txn->GetPageLockSet();
+  auto held = page_locks->find(page_id);
+  if (held == page_locks->end()) {
+    Acquire(txn, PageKey(page_id), lock_mode);
+    page_locks->emplace(page_id, std::make_pair(table_oid, lock_mode));
+    return true;
+  }
+  if (Covers(held->second.second, lock_mode)) {
+    return true;
+  }
+  LockMode mode = Combine(held->second.second, lock_mode);
+  if (!Convert(txn, PageKey(page_id), mode)) {
+    return false;
+  }
+  (*page_locks)[page_id] = std::make_pair(table_oid, mode);
   return true;
 }
 
-void LockManager::AddEdge(txn_id_t t1, txn_id_t t2) {}
+bool LockManager::LockRow(Transaction *txn, table_oid_t table_oid, const RID &rid, LockMode lock_mode) {
+  BUSTUB_ASSERT(lock_mode == LockMode::SHARED || lock_mode == LockMode::EXCLUSIVE, "Rows are locked S or X.");
+  if (IsAborted(txn)) {
+    return false;
+  }
+  CheckLockable(txn, lock_mode);
+  if (txn->IsExclusiveLocked(rid) || (lock_mode == LockMode::SHARED && txn->IsSharedLocked(rid))) {
+    return true;
+  }
 
-void LockManager::RemoveEdge(txn_id_t t1, txn_id_t t2) {}
+  LockMode intention = lock_mode == LockMode::SHARED ? LockMode::INTENTION_SHARED : LockMode::INTENTION_EXCLUSIVE;
+  if (!LockTable(txn, table_oid, intention)) {
+    return false;
+  }
+  LockMode implicit_mode;
+  if (GetImplicitMode(txn->GetTableLockSet()->at(table_oid), &implicit_mode) && Covers(implicit_mode, lock_mode)) {
+    return true;
+  }
+  if (!LockPage(txn, table_oid, rid.GetPageId(), intention)) {
+    return false;
+  }
+  auto page = txn->GetPageLockSet()->find(rid.GetPageId());
+  if (page != txn->GetPageLockSet()->end() && GetImplicitMode(page->second.second, &implicit_mode) &&
+      Covers(implicit_mode, lock_mode)) {
+    return true;
+  }
 
-bool LockManager::HasCycle(txn_id_t *txn_id) { return false; }
+  if (lock_mode == LockMode::EXCLUSIVE && txn->IsSharedLocked(rid)) {
+    return LockUpgrade(txn, rid);
+  }
+  bool locked = lock_mode == LockMode::SHARED ? LockShared(txn, rid) : LockExclusive(txn, rid);
+  if (!locked) {
+    return false;
+  }
+  // An escalation that cannot be granted at once is retried every escalation_threshold_ row locks.
+  size_t count = ++(*txn->GetRowLockCounts())[table_oid];
+  size_t period = std::max<size_t>(escalation_threshold_, 1);
+  if (count > escalation_threshold_ && (count - escalation_threshold_ - 1) % period == 0) {
+    Escalate(txn, table_oid);
+  }
+  return true;
+}
 
-std::vector<std::pair<txn_id_t, txn_id_t>> LockManager::GetEdgeList() { return {}; }
+bool LockManager::UnlockTable(Transaction *txn, table_oid_t table_oid) {
+  auto table_locks = txn->GetTableLockSet();
+  auto held = table_locks->find(table_oid);
+  if (held == table_locks->end()) {
+    return false;
+  }
+  Shrink(txn, Covers(LockMode::SHARED, held->second));
+  table_locks->erase(held);
+  txn->GetRowLockCounts()->erase(table_oid);
+  Release(txn, TableKey(table_oid));
+  return true;
+}
+
+bool LockManager::UnlockPage(Transaction *txn, page_id_t page_id) {
+  auto page_locks = txn->GetPageLockSet();
+  auto held = page_locks->find(page_id);
+  if (held == page_locks->end()) {
+    return false;
+  }
+  Shrink(txn, Covers(LockMode::SHARED, held->second.second));
+  page_locks->erase(held);
+  Release(txn, PageKey(page_id));
+  return true;
+}
+
+size_t LockManager::GetLockTableSize() {
+  size_t size = 0;
+  for (auto &shard : shards_) {
+    std::lock_guard<std::mutex> guard(shard.latch_);
+    size += shard.lock_table_.size();
+  }
+  return size;
+}
+
+LockManager::LockTableShard *LockManager::GetShard(const LockKey &key) {
+  return &shards_[(LockKeyHash()(key) >> 60) & (LOCK_TABLE_SHARDS - 1)];
+}
+
+bool LockManager::AreCompatible(LockMode a, LockMode b) {
+  // Indexed by LockMode: SHARED, EXCLUSIVE, INTENTION_SHARED, INTENTION_EXCLUSIVE, SHARED_INTENTION_EXCLUSIVE.
+  static constexpr bool COMPATIBLE[5][5] = {
+      {true, false, true, false, false},   // SHARED
+      {false, false, false, false, false},  // EXCLUSIVE
+      {true, false, true, true, true},     // INTENTION_SHARED
+      {false, false, true, true, false},   // INTENTION_EXCLUSIVE
+      {false, false, true, false, false},  // SHARED_INTENTION_EXCLUSIVE
+  };
+  return COMPATIBLE[static_cast<int>(a)][static_cast<int>(b)];
+}
+
+bool LockManager::Covers(LockMode held, LockMode requested) {
+  switch (held) {
+    case LockMode::EXCLUSIVE:
+      return true;
+    case LockMode::SHARED_INTENTION_EXCLUSIVE:
+      return requested != LockMode::EXCLUSIVE;
+    case LockMode::SHARED:
+    case LockMode::INTENTION_EXCLUSIVE:
+      return requested == held || requested == LockMode::INTENTION_SHARED;
+    case LockMode::INTENTION_SHARED:
+      return requested == LockMode::INTENTION_SHARED;
+  }
+  return false;
+}
+
+LockMode LockManager::Combine(LockMode a, LockMode b) {
+  if (Covers(a, b)) {
+    return a;
+  }
+  if (Covers(b, a)) {
+    return b;
+  }
+  // SHARED and INTENTION_EXCLUSIVE are the only modes that do not cover one another.
+  return LockMode::SHARED_INTENTION_EXCLUSIVE;
+}
+
+bool LockManager::GetImplicitMode(LockMode mode, LockMode *implicit_mode) {
+  switch (mode) {
+    case LockMode::SHARED:
+    case LockMode::SHARED_INTENTION_EXCLUSIVE:
+      *implicit_mode = LockMode::SHARED;
+      return true;
+    case LockMode::EXCLUSIVE:
+      *implicit_mode = LockMode::EXCLUSIVE;
+      return true;
+    default:
+      return false;
+  }
+}
+
+void LockManager::CheckLockable(Transaction *txn, LockMode lock_mode) {
+  if (txn->GetIsolationLevel() == IsolationLevel::READ_UNCOMMITTED && lock_mode != LockMode::EXCLUSIVE &&
+      lock_mode != LockMode::INTENTION_EXCLUSIVE) {
+    AbortTransaction(txn, AbortReason::LOCKSHARED_ON_READ_UNCOMMITTED);
+  }
+  if (txn->GetState() == TransactionState::SHRINKING) {
+    AbortTransaction(txn, AbortReason::LOCK_ON_SHRINKING);
+  }
+}
+
+void LockManager::Acquire(Transaction *txn, const LockKey &key, LockMode lock_mode) {
+  LockTableShard *shard = GetShard(key);
+  std::unique_lock<std::mutex> lock(shard->latch_);
+  auto &queue = shard->lock_table_[key];
+  auto request = queue.request_queue_.emplace(queue.request_queue_.end(), txn->GetTransactionId(), lock_mode, txn);
+  WaitForGrant(shard, &lock, txn, key, request);
+}
+
+bool LockManager::Convert(Transaction *txn, const LockKey &key, LockMode lock_mode) {
+  LockTableShard *shard = GetShard(key);
+  std::unique_lock<std::mutex> lock(shard->latch_);
+  auto entry = shard->lock_table_.find(key);
+  if (entry == shard->lock_table_.end()) {
+    return false;
+  }
+  auto &queue = entry->second;
+  auto held = std::find_if(queue.request_queue_.begin(), queue.request_queue_.end(), [txn](const LockRequest &r) {
+    return r.txn_id_ == txn->GetTransactionId();
+  });
+  if (held == queue.request_queue_.end() || !held->granted_) {
+    return false;
+  }
+  if (queue.upgrading_) {
+    AbortTransaction(txn, AbortReason::UPGRADE_CONFLICT);
+  }
+
+  // The upgrade goes ahead of every waiting request, and is granted once the conflicting locks are released. Until
+  // then the transaction holds no lock on the item.
+  queue.request_queue_.erase(held);
+  auto first_waiting = std::find_if(queue.request_queue_.begin(), queue.request_queue_.end(),
+                                    [](const LockRequest &r) { return !r.granted_; });
+  auto request = queue.request_queue_.emplace(first_waiting, txn->GetTransactionId(), lock_mode, txn);
+  switch (key.granularity_) {
+    case LockGranularity::TABLE:
+      txn->GetTableLockSet()->erase(static_cast<table_oid_t>(key.id_));
+      break;
+    case LockGranularity::PAGE:
+      txn->GetPageLockSet()->erase(static_cast<page_id_t>(key.id_));
+      break;
+    case LockGranularity::ROW:
+      txn->GetSharedLockSet()->erase(RID(key.id_));
+      break;
+  }
+  queue.upgrading_ = true;
+  WaitForGrant(shard, &lock, txn, key, request, true);
+  queue.upgrading_ = false;
+  return true;
+}
+
+bool LockManager::TryConvert(Transaction *txn, const LockKey &key, LockMode lock_mode) {
+  LockTableShard *shard = GetShard(key);
+  std::lock_guard<std::mutex> guard(shard->latch_);
+  auto entry = shard->lock_table_.find(key);
+  if (entry == shard->lock_table_.end() || entry->second.upgrading_) {
+    return false;
+  }
+  auto &requests = entry->second.request_queue_;
+  auto held = std::find_if(requests.begin(), requests.end(),
+                           [txn](const LockRequest &r) { return r.txn_id_ == txn->GetTransactionId(); });
+  if (held == requests.end() || !held->granted_) {
+    return false;
+  }
+  // The request keeps its place, so it must not conflict with a granted request or a request ahead of it.
+  bool ahead = true;
+  for (auto it = requests.begin(); it != requests.end(); ++it) {
+    if (it == held) {
+      ahead = false;
+    } else if ((it->granted_ || ahead) && !AreCompatible(it->lock_mode_, lock_mode)) {
+      return false;
+    }
+  }
+  held->lock_mode_ = lock_mode;
+  return true;
+}
+
+void LockManager::Release(Transaction *txn, const LockKey &key) {
+  LockTableShard *shard = GetShard(key);
+  std::lock_guard<std::mutex> guard(shard->latch_);
+  auto entry = shard->lock_table_.find(key);
+  BUSTUB_ASSERT(entry != shard->lock_table_.end(), "A held lock must have a queue.");
+  auto &requests = entry->second.request_queue_;
+  auto request = std::find_if(requests.begin(), requests.end(),
+                              [txn](const LockRequest &r) { return r.txn_id_ == txn->GetTransactionId(); });
+  BUSTUB_ASSERT(request != requests.end(), "A held lock must have a request.");
+  RemoveRequest(shard, key, request);
+}
+
+void LockManager::Shrink(Transaction *txn, bool read_lock) {
+  // Under READ_COMMITTED, shared locks are released as soon as the read is done, which does not end the growing phase.
+  if (txn->GetState() == TransactionState::GROWING &&
+      !(read_lock && txn->GetIsolationLevel() == IsolationLevel::READ_COMMITTED)) {
+    txn->SetState(TransactionState::SHRINKING);
+  }
+}
+
+void LockManager::Escalate(Transaction *txn, table_oid_t table_oid) {
+  // Exclusive row locks come with an exclusive intention on the table, which the table lock has to cover.
+  LockMode held = txn->GetTableLockSet()->at(table_oid);
+  LockMode mode = Combine(held, Covers(LockMode::SHARED, held) ? LockMode::SHARED : LockMode::EXCLUSIVE);
+  if (!TryConvert(txn, TableKey(table_oid), mode)) {
+    return;
+  }
+  (*txn->GetTableLockSet())[table_oid] = mode;
+
+  // The table lock now covers the row and page locks on the table, which are released without shrinking.
+  auto page_locks = txn->GetPageLockSet();
+  std::unordered_set<page_id_t> page_ids;
+  for (auto it = page_locks->begin(); it != page_locks->end();) {
+    if (it->second.first == table_oid) {
+      page_ids.insert(it->first);
+      it = page_locks->erase(it);
+    } else {
+      ++it;
+    }
+  }
+  for (const auto &lock_set : {txn->GetSharedLockSet(), txn->GetExclusiveLockSet()}) {
+    for (auto it = lock_set->begin(); it != lock_set->end();) {
+      if (page_ids.count(it->GetPageId()) != 0) {
+        Release(txn, RowKey(*it));
+        it = lock_set->erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+  for (page_id_t page_id : page_ids) {
+    Release(txn, PageKey(page_id));
+  }
+  txn->GetRowLockCounts()->erase(table_oid);
+}
+
+bool LockManager::IsAborted(Transaction *txn) {
+  if (txn->IsWounded()) {
+    txn->SetState(TransactionState::ABORTED);
+  }
+  return txn->GetState() == TransactionState::ABORTED;
+}
+
+void LockManager::AbortTransaction(Transaction *txn, AbortReason reason) {
+  txn->SetState(TransactionState::ABORTED);
+  throw TransactionAbortException(txn->GetTransactionId(), reason);
+}
+
+bool LockManager::IsGrantable(const LockRequestQueue &queue, std::list<LockRequest>::iterator request) {
+  bool ahead = true;
+  for (auto it = queue.request_queue_.begin(); it != queue.request_queue_.end(); ++it) {
+    if (it == std::list<LockRequest>::const_iterator(request)) {
+      ahead = false;
+    } else if ((it->granted_ || ahead) && it->txn_id_ != request->txn_id_ &&
+               !AreCompatible(it->lock_mode_, request->lock_mode_)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void LockManager::WaitForGrant(LockTableShard *shard, std::unique_lock<std::mutex> *lock, Transaction *txn,
+                               const LockKey &key, std::list<LockRequest>::iterator request, bool upgrade) {
+  auto &queue = shard->lock_table_.at(key);
+  bool waited = false;
+  while (!IsGrantable(queue, request) && !IsAborted(txn)) {
+    if (deadlock_mode_ == DeadlockMode::DETECTION) {
+      UpdateWaitsFor(txn, key, &queue, request);
+    } else {
+      std::vector<LockKey> wake_up;
+      if (!PreventDeadlock(&queue, txn, request, &wake_up)) {
+        txn->SetState(TransactionState::ABORTED);
+        break;
+      }
+      if (!wake_up.empty()) {
+        // Other shards are latched only after this one is released; the request stays in the queue meanwhile.
+        lock->unlock();
+        WakeUp(wake_up);
+        lock->lock();
+        continue;
+      }
+      if (!RegisterWaiter(txn, key)) {
+        break;
+      }
+    }
+    waited = true;
+    queue.cv_.wait(*lock);
+  }
+  if (waited) {
+    // Once the edges are gone the detector cannot pick this transaction, so the state read below is final.
+    ClearWaitsFor(txn->GetTransactionId());
+  }
+  if (IsAborted(txn)) {
+    if (upgrade) {
+      queue.upgrading_ = false;
+    }
+    RemoveRequest(shard, key, request);
+    throw TransactionAbortException(txn->GetTransactionId(), AbortReason::DEADLOCK);
+  }
+  request->granted_ = true;
+}
+
+void LockManager::RemoveRequest(LockTableShard *shard, const LockKey &key,
+                                std::list<LockRequest>::iterator request) {
+  auto entry = shard->lock_table_.find(key);
+  auto &queue = entry->second;
+  queue.request_queue_.erase(request);
+  if (queue.request_queue_.empty()) {
+    shard->lock_table_.erase(entry);
+  } else {
+    queue.cv_.notify_all();
+  }
+}
+
+std::vector<LockManager::LockRequest *> LockManager::GetBlockers(LockRequestQueue *queue,
+                                                                 std::list<LockRequest>::iterator request) {
+  std::vector<LockRequest *> blockers;
+  bool ahead = true;
+  for (auto it = queue->request_queue_.begin(); it != queue->request_queue_.end(); ++it) {
+    if (it == request) {
+      ahead = false;
+    } else if ((it->granted_ || ahead) && it->txn_id_ != request->txn_id_ &&
+               !AreCompatible(it->lock_mode_, request->lock_mode_)) {
+      blockers.push_back(&*it);
+    }
+  }
+  return blockers;
+}
+
+bool LockManager::PreventDeadlock(LockRequestQueue *queue, Transaction *txn, std::list<LockRequest>::iterator request,
+                                  std::vector<LockKey> *wake_up) {
+  std::vector<LockRequest *> blockers = GetBlockers(queue, request);
+  if (deadlock_mode_ == DeadlockMode::WAIT_DIE) {
+    // An older transaction is in the way.
+    return std::none_of(blockers.begin(), blockers.end(),
+                        [txn](const LockRequest *blocker) { return blocker->txn_id_ < txn->GetTransactionId(); });
+  }
+  std::lock_guard<std::mutex> guard(latch_);
+  bool wounded_here = false;
+  for (LockRequest *blocker : blockers) {
+    if (blocker->txn_id_ < txn->GetTransactionId() || blocker->txn_->IsWounded()) {
+      continue;
+    }
+    // A younger transaction is in the way. It keeps a lock that it holds until it notices the wound and aborts, which
+    // it does at once if it waits, here or elsewhere.
+    blocker->txn_->Wound();
+    auto waiter = waiters_.find(blocker->txn_id_);
+    if (!blocker->granted_) {
+      wounded_here = true;
+    } else if (waiter != waiters_.end()) {
+      wake_up->push_back(waiter->second.key_);
+    }
+  }
+  if (wounded_here) {
+    queue->cv_.notify_all();
+  }
+  return true;
+}
+
+bool LockManager::RegisterWaiter(Transaction *txn, const LockKey &key) {
+  std::lock_guard<std::mutex> guard(latch_);
+  if (IsAborted(txn)) {
+    return false;
+  }
+  waiters_[txn->GetTransactionId()] = {txn, key};
+  return true;
+}
+
+void LockManager::WakeUp(const std::vector<LockKey> &keys) {
+  for (const LockKey &key : keys) {
+    LockTableShard *shard = GetShard(key);
+    std::lock_guard<std::mutex> guard(shard->latch_);
+    auto entry = shard->lock_table_.find(key);
+    if (entry != shard->lock_table_.end()) {
+      entry->second.cv_.notify_all();
+    }
+  }
+}
+
+void LockManager::UpdateWaitsFor(Transaction *txn, const LockKey &key, LockRequestQueue *queue,
+                                 std::list<LockRequest>::iterator request) {
+  txn_id_t txn_id = txn->GetTransactionId();
+  std::vector<txn_id_t> blockers;
+  for (LockRequest *blocker : GetBlockers(queue, request)) {
+    blockers.push_back(blocker->txn_id_);
+  }
+  std::sort(blockers.begin(), blockers.end());
+  blockers.erase(std::unique(blockers.begin(), blockers.end()), blockers.end());
+
+  std::lock_guard<std::mutex> guard(latch_);
+  waiters_[txn_id] = {txn, key};
+  auto &edges = waits_for_[txn_id];
+  bool gained = !std::includes(edges.begin(), edges.end(), blockers.begin(), blockers.end());
+  edges = std::move(blockers);
+  if (gained) {
+    pending_checks_.push_back({txn_id, std::chrono::steady_clock::now()});
+    detection_cv_.notify_one();
+  }
+}
+
+void LockManager::ClearWaitsFor(txn_id_t txn_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  waits_for_.erase(txn_id);
+  waiters_.erase(txn_id);
+}
+
+bool LockManager::FindCycle(txn_id_t txn_id, std::vector<txn_id_t> *cycle) {
+  cycle->clear();
+  std::unordered_set<txn_id_t> visited{txn_id};
+  // The path from txn_id to the current transaction, with the index of the next edge to follow from each.
+  std::vector<std::pair<txn_id_t, size_t>> path{{txn_id, 0}};
+  while (!path.empty()) {
+    auto edges = waits_for_.find(path.back().first);
+    if (edges == waits_for_.end() || path.back().second == edges->second.size()) {
+      path.pop_back();
+      continue;
+    }
+    txn_id_t next = edges->second[path.back().second++];
+    if (next == txn_id) {
+      for (const auto &step : path) {
+        cycle->push_back(step.first);
+      }
+      return true;
+    }
+    if (visited.insert(next).second) {
+      path.emplace_back(next, 0);
+    }
+  }
+  return false;
+}
+
+void LockManager::AddEdge(txn_id_t t1, txn_id_t t2) {
+  std::lock_guard<std::mutex> guard(latch_);
+  auto &edges = waits_for_[t1];
+  auto it = std::lower_bound(edges.begin(), edges.end(), t2);
+  if (it == edges.end() || *it != t2) {
+    edges.insert(it, t2);
+  }
+}
+
+void LockManager::RemoveEdge(txn_id_t t1, txn_id_t t2) {
+  std::lock_guard<std::mutex> guard(latch_);
+  auto edges = waits_for_.find(t1);
+  if (edges == waits_for_.end()) {
+    return;
+  }
+  auto it = std::lower_bound(edges->second.begin(), edges->second.end(), t2);
+  if (it != edges->second.end() && *it == t2) {
+    edges->second.erase(it);
+  }
+  if (edges->second.empty()) {
+    waits_for_.erase(edges);
+  }
+}
+
+bool LockManager::HasCycle(txn_id_t *txn_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  std::vector<txn_id_t> nodes;
+  for (const auto &[node, edges] : waits_for_) {
+    nodes.push_back(node);
+  }
+  std::sort(nodes.begin(), nodes.end());
+  std::vector<txn_id_t> cycle;
+  for (txn_id_t node : nodes) {
+    if (FindCycle(node, &cycle)) {
+      *txn_id = *std::max_element(cycle.begin(), cycle.end());
+      return true;
+    }
+  }
+  return false;
+}
+
+std::vector<std::pair<txn_id_t, txn_id_t>> LockManager::GetEdgeList() {
+  std::lock_guard<std::mutex> guard(latch_);
+  std::vector<std::pair<txn_id_t, txn_id_t>> edge_list;
+  for (const auto &[t1, edges] : waits_for_) {
+    for (txn_id_t t2 : edges) {
+      edge_list.emplace_back(t1, t2);
+    }
+  }
+  return edge_list;
+}
 
 void LockManager::RunCycleDetection() {
+  std::unique_lock<std::mutex> lock(latch_);
   while (enable_cycle_detection_) {
-    std::this_thread::sleep_for(cycle_detection_interval);
-    {
-      std::unique_lock<std::mutex> l(latch_);
-      // TODO(student): remove the continue and add your cycle detection and abort code here
+    detection_cv_.wait_for(lock, cycle_detection_interval,
+                           [this] { return !pending_checks_.empty() || !enable_cycle_detection_; });
+    if (pending_checks_.empty()) {
       continue;
     }
+    auto start = std::chrono::steady_clock::now();
+    // Every cycle contains the edge that closed it, so only the waiters that gained edges need to be checked.
+    std::vector<LockKey> victims;
+    std::vector<txn_id_t> cycle;
+    for (const auto &check : pending_checks_) {
+      if (waits_for_.count(check.txn_id_) != 0) {
+        stats_.checks_++;
+      }
+      while (waits_for_.count(check.txn_id_) != 0 && FindCycle(check.txn_id_, &cycle)) {
+        txn_id_t victim = *std::max_element(cycle.begin(), cycle.end());
+        // Dropping the edges of the victim breaks the cycle; it drops its waiter entry once it wakes up.
+        waits_for_.erase(victim);
+        auto waiter = waiters_.find(victim);
+        if (waiter == waiters_.end()) {
+          continue;
+        }
+        waiter->second.txn_->Wound();
+        victims.push_back(waiter->second.key_);
+        auto latency = std::chrono::steady_clock::now() - check.added_;
+        stats_.deadlocks_++;
+        stats_.total_detection_latency_ += latency;
+        stats_.max_detection_latency_ = std::max<std::chrono::nanoseconds>(stats_.max_detection_latency_, latency);
+      }
+    }
+    pending_checks_.clear();
+    auto pause = std::chrono::steady_clock::now() - start;
+    stats_.total_pause_ += pause;
+    stats_.max_pause_ = std::max<std::chrono::nanoseconds>(stats_.max_pause_, pause);
+
+    // Wake up the victims. Shard latches are taken before latch_, so latch_ is released first.
+    lock.unlock();
+    WakeUp(victims);
+    lock.lock();
   }
 }
 
+LockManager::DetectionStats LockManager::GetDetectionStats() {
+  std::lock_guard<std::mutex> guard(latch_);
+  return stats_;
+}
+
 }  // namespace bustub
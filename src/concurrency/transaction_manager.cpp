@@ -20,25 +20,67 @@
 
 namespace bustub {
 
-std::unordered_map<txn_id_t, Transaction *> TransactionManager::txn_map = {};
-
 Transaction *TransactionManager::Begin(Transaction *txn, IsolationLevel isolation_level) {
-  // Acquire the global transaction latch in shared mode.
-  global_txn_latch_.RLock();
-
   if (txn == nullptr) {
     txn = new Transaction(next_txn_id_++, isolation_level);
   }
+  if (txn->GetIsolationLevel() == IsolationLevel::SNAPSHOT_ISOLATION) {
+    std::lock_guard<std::mutex> guard(snapshot_latch_);
+    txn->SetReadTs(last_commit_ts_);
+    snapshots_[txn->GetReadTs()]++;
+  } else {
+    txn->SetReadTs(last_commit_ts_);
+  }
+  AppendLogRecord(txn, LogRecordType::BEGIN);
 
-  txn_map[txn->GetTransactionId()] = txn;
+  RegistryShard &shard = RegistryShardOf(txn->GetTransactionId());
+  std::lock_guard<std::mutex> guard(shard.latch_);
+  shard.txns_[txn->GetTransactionId()] = txn;
   return txn;
 }
 
 void TransactionManager::Commit(Transaction *txn) {
+  if (txn->IsWounded()) {
+    // An older transaction is waiting for the locks of this one.
+    Abort(txn);
+    throw TransactionAbortException(txn->GetTransactionId(), AbortReason::DEADLOCK);
+  }
   txn->SetState(TransactionState::COMMITTED);
 
-  // Perform all deletes before we commit.
   auto write_set = txn->GetWriteSet();
+  lsn_t commit_lsn = AppendLogRecord(txn, LogRecordType::COMMIT);
+  if (commit_lsn != INVALID_LSN && !write_set->empty()) {
+    // Wait for the commit to be durable, together with the commits that come in meanwhile.
+    log_manager_->Flush(commit_lsn);
+  }
+
+  if (write_set->empty()) {
+    // A transaction that wrote nothing has no versions to stamp, so it takes none of the commit latches.
+    txn->SetCommitTs(last_commit_ts_);
+    EndTransaction(txn);
+  } else {
+    {
+      // New snapshots see the commit only once all its versions are stamped.
+      std::lock_guard<std::mutex> guard(commit_latch_);
+      timestamp_t commit_ts = last_commit_ts_ + 1;
+      txn->SetCommitTs(commit_ts);
+      for (const auto &item : *write_set) {
+        item.table_->GetVersionStore()->CommitWrite(item.rid_, txn, commit_ts);
+      }
+      last_commit_ts_ = commit_ts;
+    }
+    EndTransaction(txn);
+    timestamp_t watermark = GetWatermark();
+    TableHeap *collected_table = nullptr;
+    for (const auto &item : *write_set) {
+      if (item.table_ != collected_table) {
+        collected_table = item.table_;
+        collected_table->GetVersionStore()->GarbageCollect(watermark);
+      }
+    }
+  }
+
+  // Perform all deletes before we commit. The versions that older snapshots read are in the version stores.
   while (!write_set->empty()) {
     auto &item = write_set->back();
     auto table = item.table_;
@@ -52,8 +94,6 @@ void TransactionManager::Commit(Transaction *txn) {
 
   // Release all the locks.
   ReleaseLocks(txn);
-  // Release the global transaction latch.
-  global_txn_latch_.RUnlock();
 }
 
 void TransactionManager::Abort(Transaction *txn) {
@@ -67,9 +107,9 @@ void TransactionManager::Abort(Transaction *txn) {
       table->RollbackDelete(item.rid_, txn);
     } else if (item.wtype_ == WType::INSERT) {
       // Note that this also releases the lock when holding the page latch.
-      table->ApplyDelete(item.rid_, txn);
+      table->RollbackInsert(item.rid_, txn);
     } else if (item.wtype_ == WType::UPDATE) {
-      table->UpdateTuple(item.tuple_, item.rid_, txn);
+      table->RollbackUpdate(item.tuple_, item.rid_, txn);
     }
     table_write_set->pop_back();
   }
@@ -99,15 +139,64 @@ void TransactionManager::Abort(Transaction *txn) {
   }
   table_write_set->clear();
   index_write_set->clear();
+  AppendLogRecord(txn, LogRecordType::ABORT);
+  EndTransaction(txn);
 
   // Release all the locks.
   ReleaseLocks(txn);
-  // Release the global transaction latch.
-  global_txn_latch_.RUnlock();
 }
 
-void TransactionManager::BlockAllTransactions() { global_txn_latch_.WLock(); }
+Transaction *TransactionManager::GetTransaction(txn_id_t txn_id) {
+  RegistryShard &shard = RegistryShardOf(txn_id);
+  std::lock_guard<std::mutex> guard(shard.latch_);
+  auto txn = shard.txns_.find(txn_id);
+  BUSTUB_ASSERT(txn != shard.txns_.end() && txn->second != nullptr, "The transaction must be running.");
+  return txn->second;
+}
 
-void TransactionManager::ResumeTransactions() { global_txn_latch_.WUnlock(); }
+void TransactionManager::GetRunningTransactions(std::vector<Transaction *> *txns) {
+  txns->clear();
+  for (auto &shard : registry_) {
+    std::lock_guard<std::mutex> guard(shard.latch_);
+    for (const auto &txn : shard.txns_) {
+      txns->push_back(txn.second);
+    }
+  }
+}
+
+timestamp_t TransactionManager::GetWatermark() {
+  std::lock_guard<std::mutex> guard(snapshot_latch_);
+  return snapshots_.empty() ? last_commit_ts_.load() : snapshots_.begin()->first;
+}
+
+void TransactionManager::EndTransaction(Transaction *txn) {
+  {
+    RegistryShard &shard = RegistryShardOf(txn->GetTransactionId());
+    std::lock_guard<std::mutex> guard(shard.latch_);
+    shard.txns_.erase(txn->GetTransactionId());
+  }
+  EndSnapshot(txn);
+}
+
+lsn_t TransactionManager::AppendLogRecord(Transaction *txn, LogRecordType log_record_type) {
+  if (!enable_logging || log_manager_ == nullptr) {
+    return INVALID_LSN;
+  }
+  LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), log_record_type);
+  lsn_t lsn = log_manager_->AppendLogRecord(&log_record);
+  txn->SetPrevLSN(lsn);
+  return lsn;
+}
+
+void TransactionManager::EndSnapshot(Transaction *txn) {
+  if (txn->GetIsolationLevel() != IsolationLevel::SNAPSHOT_ISOLATION) {
+    return;
+  }
+  std::lock_guard<std::mutex> guard(snapshot_latch_);
+  auto snapshot = snapshots_.find(txn->GetReadTs());
+  if (snapshot != snapshots_.end() && --snapshot->second == 0) {
+    snapshots_.erase(snapshot);
+  }
+}
 
 }  // namespace bustub
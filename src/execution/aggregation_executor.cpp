@@ -1,58 +1,248 @@
-//===----------------------------------------------------------------------===//
-//
-//                         BusTub
-//
-// aggregation_executor.cpp
-//
-// Identification: src/execution/aggregation_executor.cpp
-//
-// Copyright (c) 2015-19, Carnegie Mellon University Database Group
-//
-//===----------------------------------------------------------------------===//
-#include <memory>
-#include <vector>
-
-#include "execution/executors/aggregation_executor.h"
-
-namespace bustub {
-
-AggregationExecutor::AggregationExecutor(ExecutorContext *exec_ctx, const AggregationPlanNode *plan,
-                                         std::unique_ptr<AbstractExecutor> &&child)
-    : AbstractExecutor(exec_ctx),
-      plan_(plan),
-      child_(std::move(child)),
-      aht_(plan->GetAggregates(), plan_->GetAggregateTypes()),
-      aht_iterator_(aht_.Begin()) {}
-
-const AbstractExecutor *AggregationExecutor::GetChildExecutor() const { return child_.get(); }
-
-void AggregationExecutor::Init() {
-  child_->Init();
-  Tuple tuple;
-  RID rid;
-  while (child_->Next(&tuple, &rid)) {
-    aht_.InsertCombine(MakeKey(&tuple), MakeVal(&tuple));
-  }
-  aht_iterator_ = aht_.Begin();
-}
-
-bool AggregationExecutor::Next(Tuple *tuple, RID *rid) {
-  while (aht_iterator_ != aht_.End()) {
-    const auto &aggregate_key = aht_iterator_.Key();
-    const auto &aggregate_val = aht_iterator_.Val();
-    ++aht_iterator_;
-    // order matters!
-    if ((plan_->GetHaving() == nullptr) ||
-        (plan_->GetHaving()->EvaluateAggregate(aggregate_key.group_bys_, aggregate_val.aggregates_).GetAs<bool>())) {
-      std::vector<Value> result;
-      for (auto &column : GetOutputSchema()->GetColumns()) {
-        result.push_back(column.GetExpr()->EvaluateAggregate(aggregate_key.group_bys_, aggregate_val.aggregates_));
-      }
-      *tuple = Tuple(result, GetOutputSchema());
-      return true;
-    }
-  }
-  return false;
-}
-
-}  // namespace bustub
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// aggregation_executor.cpp
+//
+// Identification: src/execution/aggregation_executor.cpp
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "common/config.h"
+#include "common/thread_pool.h"
+#include "common/util/hash_util.h"
+#include "execution/executors/aggregation_executor.h"
+#include "execution/executors/seq_scan_executor.h"
+#include "execution/morsel_dispenser.h"
+
+namespace bustub {
+
+namespace {
+
+/**
+ * Mixes the hash of a group key with the spill level, so that the rows of one partition spread over all partitions
+ * of the next level. The mix is the MurmurHash3 finalizer, since the partition is taken from the low bits.
+ */
+uint64_t SpillHash(hash_t hash, uint32_t level) {
+  uint64_t mixed = static_cast<uint64_t>(hash) + level * 0x9E3779B97F4A7C15ULL;
+  mixed ^= mixed >> 33;
+  mixed *= 0xFF51AFD7ED558CCDULL;
+  mixed ^= mixed >> 33;
+  mixed *= 0xC4CEB9FE1A85EC53ULL;
+  mixed ^= mixed >> 33;
+  return mixed;
+}
+
+}  // namespace
+
+AggregationExecutor::AggregationExecutor(ExecutorContext *exec_ctx, const AggregationPlanNode *plan,
+                                         std::unique_ptr<AbstractExecutor> &&child)
+    : AbstractExecutor(exec_ctx), plan_(plan), child_(std::move(child)) {}
+
+const AbstractExecutor *AggregationExecutor::GetChildExecutor() const { return child_.get(); }
+
+void AggregationExecutor::Init() {
+  DropSpilledPartitions();
+  tables_.clear();
+  table_idx_ = 0;
+  group_idx_ = 0;
+  const AbstractPlanNode *child_plan = plan_->GetChildPlan();
+  if (plan_->GetParallelism() > 1 && plan_->GetMemoryBudget() == 0 && child_plan->GetType() == PlanType::SeqScan &&
+      !enable_logging) {
+    AggregateInParallel(static_cast<const SeqScanPlanNode *>(child_plan), plan_->GetParallelism());
+    return;
+  }
+  child_->Init();
+  tables_.emplace_back(plan_->GetGroupBys(), plan_->GetAggregates(), plan_->GetAggregateTypes(),
+                       plan_->GetMemoryBudget());
+  // Pull the child a batch at a time; children that only implement Next() are adapted by AbstractExecutor.
+  TupleBatch batch(child_->GetOutputSchema());
+  std::vector<SpillPartition> spills;
+  while (child_->NextBatch(&batch)) {
+    Consume(&batch, 0, &spills);
+  }
+  FinishSpilling(&spills);
+}
+
+void AggregationExecutor::Consume(const TupleBatch *batch, uint32_t level, std::vector<SpillPartition> *spills) {
+  misses_.clear();
+  tables_.back().InsertBatch(batch, &misses_);
+  if (misses_.empty()) {
+    return;
+  }
+  if (spills->empty()) {
+    // The table has just frozen.
+    spills->resize(SPILL_FANOUT);
+    for (auto &partition : *spills) {
+      partition.level_ = level + 1;
+    }
+  }
+  BufferPoolManager *bpm = exec_ctx_->GetBufferPoolManager();
+  for (uint32_t row_idx : misses_) {
+    hash_t hash = 0;
+    for (const auto *group_by : plan_->GetGroupBys()) {
+      Value value = group_by->EvaluateRow(batch, row_idx);
+      if (!value.IsNull()) {
+        hash = HashUtil::CombineHashes(hash, HashUtil::HashValue(&value));
+      }
+    }
+    SpillPartition &partition = (*spills)[SpillHash(hash, level) % SPILL_FANOUT];
+    Tuple tuple = batch->GetTuple(row_idx);
+    TmpTuple tmp_tuple(INVALID_PAGE_ID, 0);
+    if (partition.page_ == nullptr || !partition.page_->Insert(tuple, &tmp_tuple)) {
+      if (partition.page_ != nullptr) {
+        bpm->UnpinPage(partition.page_ids_.back(), true);
+      }
+      page_id_t page_id;
+      partition.page_ = reinterpret_cast<TmpTuplePage *>(bpm->NewPage(&page_id));
+      BUSTUB_ASSERT(partition.page_ != nullptr, "Couldn't allocate a page to spill to.");
+      partition.page_->Init(page_id, PAGE_SIZE);
+      partition.page_ids_.push_back(page_id);
+      bool inserted __attribute__((unused)) = partition.page_->Insert(tuple, &tmp_tuple);
+      BUSTUB_ASSERT(inserted, "A spilled tuple must fit in an empty page.");
+    }
+  }
+}
+
+void AggregationExecutor::FinishSpilling(std::vector<SpillPartition> *spills) {
+  for (auto &partition : *spills) {
+    if (partition.page_ == nullptr) {
+      continue;
+    }
+    exec_ctx_->GetBufferPoolManager()->UnpinPage(partition.page_ids_.back(), true);
+    partition.page_ = nullptr;
+    pending_partitions_.push_back(std::move(partition));
+  }
+  spills->clear();
+}
+
+void AggregationExecutor::AggregatePartition(const SpillPartition &partition) {
+  tables_.clear();
+  tables_.emplace_back(plan_->GetGroupBys(), plan_->GetAggregates(), plan_->GetAggregateTypes(),
+                       partition.level_ < MAX_SPILL_LEVEL ? plan_->GetMemoryBudget() : 0);
+  BufferPoolManager *bpm = exec_ctx_->GetBufferPoolManager();
+  TupleBatch batch(child_->GetOutputSchema());
+  std::vector<SpillPartition> spills;
+  Tuple tuple;
+  TmpTuple cur(INVALID_PAGE_ID, 0);
+  for (page_id_t page_id : partition.page_ids_) {
+    auto page = reinterpret_cast<TmpTuplePage *>(bpm->FetchPage(page_id));
+    BUSTUB_ASSERT(page != nullptr, "Couldn't fetch a spilled page.");
+    batch.Clear();
+    for (bool found = page->GetFirstTmpTuple(&cur); found; found = page->GetNextTmpTuple(cur, &cur)) {
+      page->Get(cur, &tuple);
+      batch.AppendTuple(tuple, RID());
+    }
+    bpm->UnpinPage(page_id, false);
+    bpm->DeletePage(page_id);
+    Consume(&batch, partition.level_, &spills);
+  }
+  FinishSpilling(&spills);
+}
+
+void AggregationExecutor::DropSpilledPartitions() {
+  for (const auto &partition : pending_partitions_) {
+    for (page_id_t page_id : partition.page_ids_) {
+      exec_ctx_->GetBufferPoolManager()->DeletePage(page_id);
+    }
+  }
+  pending_partitions_.clear();
+}
+
+void AggregationExecutor::AggregateInParallel(const SeqScanPlanNode *scan_plan, uint32_t parallelism) {
+  TableHeap *table_heap = exec_ctx_->GetCatalog()->GetTable(scan_plan->GetTableOid())->table_.get();
+  MorselDispenser dispenser(table_heap, parallelism);
+
+  // Pre-aggregation: every worker pulls its own scan of the morsels it claims into its own table, then buckets its
+  // groups by partition. The partition comes from the high bits of the hash, which the directory does not use.
+  std::vector<std::unique_ptr<SeqScanExecutor>> scans;
+  std::vector<AggregationHashTable> local_tables;
+  local_tables.reserve(parallelism);
+  for (uint32_t w = 0; w < parallelism; w++) {
+    scans.emplace_back(std::make_unique<SeqScanExecutor>(exec_ctx_, scan_plan, &dispenser));
+    local_tables.emplace_back(plan_->GetGroupBys(), plan_->GetAggregates(), plan_->GetAggregateTypes());
+  }
+  std::vector<std::vector<std::vector<size_t>>> partitions(parallelism, std::vector<std::vector<size_t>>(parallelism));
+  ThreadPool fallback_pool;
+  ThreadPool *pool = exec_ctx_->GetThreadPool() != nullptr ? exec_ctx_->GetThreadPool() : &fallback_pool;
+  pool->Run(parallelism, [&](size_t w) {
+    TupleBatch batch(scan_plan->OutputSchema());
+    scans[w]->Init();
+    while (scans[w]->NextBatch(&batch)) {
+      local_tables[w].InsertBatch(&batch);
+    }
+    for (size_t group_idx = 0; group_idx < local_tables[w].GetGroupCount(); group_idx++) {
+      partitions[w][(local_tables[w].GetPartitionHash(group_idx) >> 32) % parallelism].push_back(group_idx);
+    }
+  });
+
+  // Merge: every partition is owned by one thread, so the merged tables need no latching.
+  tables_.reserve(parallelism);
+  for (uint32_t p = 0; p < parallelism; p++) {
+    tables_.emplace_back(plan_->GetGroupBys(), plan_->GetAggregates(), plan_->GetAggregateTypes());
+  }
+  pool->Run(parallelism, [&](size_t p) {
+    for (uint32_t w = 0; w < parallelism; w++) {
+      for (size_t group_idx : partitions[w][p]) {
+        tables_[p].MergeGroup(local_tables[w], group_idx);
+      }
+    }
+  });
+}
+
+bool AggregationExecutor::NextGroup(std::vector<Value> *values) {
+  std::vector<Value> group_bys;
+  std::vector<Value> aggregates;
+  while (table_idx_ < tables_.size() || !pending_partitions_.empty()) {
+    if (table_idx_ == tables_.size()) {
+      // The groups in memory are exhausted; aggregate the next spilled partition.
+      SpillPartition partition = std::move(pending_partitions_.back());
+      pending_partitions_.pop_back();
+      AggregatePartition(partition);
+      table_idx_ = 0;
+      group_idx_ = 0;
+      continue;
+    }
+    if (group_idx_ == tables_[table_idx_].GetGroupCount()) {
+      table_idx_++;
+      group_idx_ = 0;
+      continue;
+    }
+    tables_[table_idx_].GetGroup(group_idx_++, &group_bys, &aggregates);
+    // order matters!
+    if ((plan_->GetHaving() == nullptr) ||
+        (plan_->GetHaving()->EvaluateAggregate(group_bys, aggregates).GetAs<bool>())) {
+      values->clear();
+      for (auto &column : GetOutputSchema()->GetColumns()) {
+        values->push_back(column.GetExpr()->EvaluateAggregate(group_bys, aggregates));
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
+bool AggregationExecutor::Next(Tuple *tuple, RID *rid) {
+  std::vector<Value> values;
+  if (!NextGroup(&values)) {
+    return false;
+  }
+  *tuple = Tuple(values, GetOutputSchema());
+  return true;
+}
+
+bool AggregationExecutor::NextBatch(TupleBatch *batch) {
+  batch->Clear();
+  std::vector<Value> values;
+  while (!batch->IsFull() && NextGroup(&values)) {
+    batch->AppendRow(values, RID());
+  }
+  return !batch->IsEmpty();
+}
+
+}  // namespace bustub
@@ -0,0 +1,474 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// aggregation_hash_table.cpp
+//
+// Identification: src/execution/aggregation_hash_table.cpp
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "common/exception.h"
+#include "common/macros.h"
+#include "execution/aggregation_hash_table.h"
+#include "execution/expressions/column_value_expression.h"
+#include "type/limits.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+/** The initial number of buckets in the directory. */
+constexpr size_t INITIAL_DIRECTORY_SIZE = 256;
+
+int64_t DoubleToWord(double value) {
+  int64_t word;
+  std::memcpy(&word, &value, sizeof(word));
+  return word;
+}
+
+double WordToDouble(int64_t word) {
+  double value;
+  std::memcpy(&value, &word, sizeof(value));
+  return value;
+}
+
+/** @return the index of the integer column of the batch that expr reads, or -1 if expr is anything else */
+int64_t DirectIntegerColumn(const AbstractExpression *expr, const TupleBatch *batch) {
+  auto column_expr = dynamic_cast<const ColumnValueExpression *>(expr);
+  if (column_expr == nullptr || !batch->IsIntegerColumn(column_expr->GetColIdx())) {
+    return -1;
+  }
+  return column_expr->GetColIdx();
+}
+
+/** Throws OUT_OF_RANGE, like Value::Add() does, unless an integer aggregate is a non-NULL value of its type. */
+void CheckIntegerRange(int64_t aggregate, TypeId type) {
+  int64_t min;
+  int64_t max;
+  switch (type) {
+    case TypeId::TINYINT:
+      min = BUSTUB_INT8_MIN;
+      max = BUSTUB_INT8_MAX;
+      break;
+    case TypeId::SMALLINT:
+      min = BUSTUB_INT16_MIN;
+      max = BUSTUB_INT16_MAX;
+      break;
+    case TypeId::INTEGER:
+      min = BUSTUB_INT32_MIN;
+      max = BUSTUB_INT32_MAX;
+      break;
+    default:
+      min = BUSTUB_INT64_MIN;
+      max = BUSTUB_INT64_MAX;
+      break;
+  }
+  if (aggregate < min || aggregate > max) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "Numeric value out of range.");
+  }
+}
+
+}  // namespace
+
+AggregationHashTable::AggregationHashTable(const std::vector<const AbstractExpression *> &group_bys,
+                                           const std::vector<const AbstractExpression *> &agg_exprs,
+                                           const std::vector<AggregationType> &agg_types, size_t memory_budget)
+    : group_bys_(group_bys),
+      agg_exprs_(agg_exprs),
+      agg_types_(agg_types),
+      memory_budget_(memory_budget),
+      directory_(INITIAL_DIRECTORY_SIZE, 0) {
+  for (const auto *expr : group_bys_) {
+    key_types_.push_back(expr->GetReturnType());
+    key_encodings_.push_back(EncodingOf(expr->GetReturnType()));
+    has_varchar_keys_ = has_varchar_keys_ || key_encodings_.back() == Encoding::Varchar;
+  }
+  for (size_t i = 0; i < agg_exprs_.size(); i++) {
+    TypeId type = agg_exprs_[i]->GetReturnType();
+    agg_input_types_.push_back(type);
+    bool is_integer = TupleBatch::IsIntegerType(type);
+    bool is_decimal = type == TypeId::DECIMAL;
+    switch (agg_types_[i]) {
+      case AggregationType::CountAggregate:
+        slot_kinds_.push_back(SlotKind::Count);
+        break;
+      case AggregationType::SumAggregate:
+        BUSTUB_ASSERT(is_integer || is_decimal, "SUM needs a numeric input.");
+        slot_kinds_.push_back(is_integer ? SlotKind::IntegerSum : SlotKind::DecimalSum);
+        break;
+      case AggregationType::MinAggregate:
+        if (is_integer) {
+          slot_kinds_.push_back(SlotKind::IntegerMin);
+        } else {
+          slot_kinds_.push_back(is_decimal ? SlotKind::DecimalMin : SlotKind::ValueMin);
+        }
+        break;
+      case AggregationType::MaxAggregate:
+        if (is_integer) {
+          slot_kinds_.push_back(SlotKind::IntegerMax);
+        } else {
+          slot_kinds_.push_back(is_decimal ? SlotKind::DecimalMax : SlotKind::ValueMax);
+        }
+        break;
+    }
+    if (slot_kinds_.back() == SlotKind::ValueMin || slot_kinds_.back() == SlotKind::ValueMax) {
+      has_value_slots_ = true;
+    }
+  }
+}
+
+AggregationHashTable::Encoding AggregationHashTable::EncodingOf(TypeId type) {
+  switch (type) {
+    case TypeId::TINYINT:
+    case TypeId::SMALLINT:
+    case TypeId::INTEGER:
+    case TypeId::BIGINT:
+      return Encoding::Integer;
+    case TypeId::DECIMAL:
+      return Encoding::Decimal;
+    case TypeId::BOOLEAN:
+      return Encoding::Boolean;
+    case TypeId::TIMESTAMP:
+      return Encoding::Timestamp;
+    case TypeId::VARCHAR:
+      return Encoding::Varchar;
+    default:
+      UNREACHABLE("Unsupported group-by type.");
+  }
+}
+
+uint64_t AggregationHashTable::HashKey(const int64_t *key, size_t key_words) {
+  // Each word is mixed with the MurmurHash3 finalizer so that serial keys spread over the whole directory.
+  uint64_t hash = 0x9E3779B97F4A7C15ULL;
+  for (size_t i = 0; i < key_words; i++) {
+    hash ^= static_cast<uint64_t>(key[i]);
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDULL;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ULL;
+    hash ^= hash >> 33;
+  }
+  return hash;
+}
+
+int64_t AggregationHashTable::Encode(const Value &value, Encoding encoding, bool add_strings) {
+  switch (encoding) {
+    case Encoding::Integer:
+      return TupleBatch::IntegerOf(value);
+    case Encoding::Decimal:
+      return DoubleToWord(value.GetAs<double>());
+    case Encoding::Boolean:
+      return value.GetAs<int8_t>();
+    case Encoding::Timestamp:
+      return static_cast<int64_t>(value.GetAs<uint64_t>());
+    case Encoding::Varchar: {
+      if (value.IsNull()) {
+        return VARCHAR_NULL_ID;
+      }
+      std::string data(value.GetData(), value.GetLength());
+      auto it = string_ids_.find(data);
+      if (it != string_ids_.end()) {
+        return it->second;
+      }
+      if (!add_strings) {
+        return VARCHAR_UNKNOWN_ID;
+      }
+      auto id = static_cast<int64_t>(strings_.size());
+      // The string is held by strings_ and by a node of string_ids_.
+      string_bytes_ += 2 * (sizeof(std::string) + data.capacity()) + sizeof(int64_t);
+      string_ids_.emplace(data, id);
+      strings_.push_back(std::move(data));
+      return id;
+    }
+  }
+  UNREACHABLE("Unsupported encoding.");
+}
+
+Value AggregationHashTable::Decode(int64_t word, TypeId type) const {
+  switch (EncodingOf(type)) {
+    case Encoding::Integer:
+      return Value(type, word);
+    case Encoding::Decimal:
+      return Value(type, WordToDouble(word));
+    case Encoding::Boolean:
+      return Value(type, static_cast<int8_t>(word));
+    case Encoding::Timestamp:
+      return Value(type, static_cast<uint64_t>(word));
+    case Encoding::Varchar: {
+      if (word == VARCHAR_NULL_ID) {
+        return ValueFactory::GetNullValueByType(type);
+      }
+      const std::string &data = strings_[word];
+      return Value(type, data.data(), static_cast<uint32_t>(data.size()), true);
+    }
+  }
+  UNREACHABLE("Unsupported encoding.");
+}
+
+size_t AggregationHashTable::FindOrInsertGroup(const int64_t *key) {
+  size_t key_words = key_types_.size();
+  uint64_t hash = HashKey(key, key_words);
+  size_t mask = directory_.size() - 1;
+  for (size_t bucket = hash & mask;; bucket = (bucket + 1) & mask) {
+    uint32_t entry = directory_[bucket];
+    if (entry == 0) {
+      if (frozen_) {
+        return NO_GROUP;
+      }
+      size_t group_idx = group_count_++;
+      keys_.insert(keys_.end(), key, key + key_words);
+      hashes_.push_back(hash);
+      slots_.resize(slots_.size() + agg_exprs_.size(), 0);
+      seen_.resize(seen_.size() + agg_exprs_.size(), false);
+      if (has_value_slots_) {
+        value_slots_.resize(value_slots_.size() + agg_exprs_.size());
+      }
+      directory_[bucket] = static_cast<uint32_t>(group_idx + 1);
+      if (group_count_ * 2 > directory_.size()) {
+        Grow();
+      }
+      frozen_ = memory_budget_ != 0 && GetMemoryUsage() > memory_budget_;
+      return group_idx;
+    }
+    size_t group_idx = entry - 1;
+    if (hashes_[group_idx] == hash && std::equal(key, key + key_words, keys_.data() + group_idx * key_words)) {
+      return group_idx;
+    }
+  }
+}
+
+void AggregationHashTable::Grow() {
+  std::vector<uint32_t> directory(directory_.size() * 2, 0);
+  size_t mask = directory.size() - 1;
+  for (size_t group_idx = 0; group_idx < group_count_; group_idx++) {
+    size_t bucket = hashes_[group_idx] & mask;
+    while (directory[bucket] != 0) {
+      bucket = (bucket + 1) & mask;
+    }
+    directory[bucket] = static_cast<uint32_t>(group_idx + 1);
+  }
+  directory_ = std::move(directory);
+}
+
+void AggregationHashTable::Accumulate(size_t group_idx, size_t agg_idx, bool is_null, int64_t word,
+                                      const Value *value) {
+  size_t slot_idx = group_idx * agg_exprs_.size() + agg_idx;
+  int64_t &slot = slots_[slot_idx];
+  SlotKind kind = slot_kinds_[agg_idx];
+  if (kind == SlotKind::Count) {
+    // COUNT counts every row, like the interpreted aggregation always did.
+    slot++;
+    return;
+  }
+  if (is_null) {
+    return;
+  }
+  bool first = !seen_[slot_idx];
+  seen_[slot_idx] = true;
+  switch (kind) {
+    case SlotKind::IntegerSum:
+      if (__builtin_add_overflow(slot, word, &slot)) {
+        throw Exception(ExceptionType::OUT_OF_RANGE, "Numeric value out of range.");
+      }
+      break;
+    case SlotKind::DecimalSum:
+      slot = DoubleToWord(WordToDouble(slot) + WordToDouble(word));
+      break;
+    case SlotKind::IntegerMin:
+      slot = first ? word : std::min(slot, word);
+      break;
+    case SlotKind::IntegerMax:
+      slot = first ? word : std::max(slot, word);
+      break;
+    case SlotKind::DecimalMin:
+      slot = first ? word : DoubleToWord(std::min(WordToDouble(slot), WordToDouble(word)));
+      break;
+    case SlotKind::DecimalMax:
+      slot = first ? word : DoubleToWord(std::max(WordToDouble(slot), WordToDouble(word)));
+      break;
+    case SlotKind::ValueMin:
+      value_slots_[slot_idx] = first ? *value : value_slots_[slot_idx].Min(*value);
+      break;
+    case SlotKind::ValueMax:
+      value_slots_[slot_idx] = first ? *value : value_slots_[slot_idx].Max(*value);
+      break;
+    case SlotKind::Count:
+      break;
+  }
+}
+
+bool AggregationHashTable::Insert(const Tuple *tuple, const Schema *schema) {
+  std::vector<int64_t> key(group_bys_.size());
+  for (size_t i = 0; i < group_bys_.size(); i++) {
+    key[i] = Encode(group_bys_[i]->Evaluate(tuple, schema), key_encodings_[i], !frozen_);
+  }
+  size_t group_idx = FindOrInsertGroup(key.data());
+  if (group_idx == NO_GROUP) {
+    return false;
+  }
+  for (size_t i = 0; i < agg_exprs_.size(); i++) {
+    if (slot_kinds_[i] == SlotKind::Count) {
+      Accumulate(group_idx, i, false, 0, nullptr);
+      continue;
+    }
+    Value value = agg_exprs_[i]->Evaluate(tuple, schema);
+    int64_t word = 0;
+    if (!value.IsNull() && TupleBatch::IsIntegerType(value.GetTypeId())) {
+      word = TupleBatch::IntegerOf(value);
+    } else if (!value.IsNull() && value.GetTypeId() == TypeId::DECIMAL) {
+      word = DoubleToWord(value.GetAs<double>());
+    }
+    Accumulate(group_idx, i, value.IsNull(), word, &value);
+  }
+  return true;
+}
+
+void AggregationHashTable::InsertBatch(const TupleBatch *batch, std::vector<uint32_t> *misses) {
+  // Resolve once per batch which keys and inputs can be read straight from an integer column array.
+  std::vector<int64_t> key_columns(group_bys_.size());
+  for (size_t i = 0; i < group_bys_.size(); i++) {
+    key_columns[i] = DirectIntegerColumn(group_bys_[i], batch);
+  }
+  std::vector<int64_t> input_columns(agg_exprs_.size());
+  std::vector<int64_t> input_nulls(agg_exprs_.size());
+  for (size_t i = 0; i < agg_exprs_.size(); i++) {
+    input_columns[i] = slot_kinds_[i] == SlotKind::Count ? -1 : DirectIntegerColumn(agg_exprs_[i], batch);
+    if (input_columns[i] >= 0) {
+      input_nulls[i] = TupleBatch::IntegerNull(batch->GetSchema()->GetColumn(input_columns[i]).GetType());
+    }
+  }
+
+  std::vector<int64_t> key(group_bys_.size());
+  for (uint32_t row_idx = 0; row_idx < batch->GetRowCount(); row_idx++) {
+    for (size_t i = 0; i < group_bys_.size(); i++) {
+      key[i] = key_columns[i] >= 0
+                   ? batch->GetIntegerColumn(key_columns[i])[row_idx]
+                   : Encode(group_bys_[i]->EvaluateRow(batch, row_idx), key_encodings_[i], !frozen_);
+    }
+    size_t group_idx = FindOrInsertGroup(key.data());
+    if (group_idx == NO_GROUP) {
+      BUSTUB_ASSERT(misses != nullptr, "A table with a memory budget needs somewhere to report its misses.");
+      misses->push_back(row_idx);
+      continue;
+    }
+    for (size_t i = 0; i < agg_exprs_.size(); i++) {
+      if (slot_kinds_[i] == SlotKind::Count) {
+        Accumulate(group_idx, i, false, 0, nullptr);
+      } else if (input_columns[i] >= 0) {
+        int64_t word = batch->GetIntegerColumn(input_columns[i])[row_idx];
+        Accumulate(group_idx, i, word == input_nulls[i], word, nullptr);
+      } else {
+        Value value = agg_exprs_[i]->EvaluateRow(batch, row_idx);
+        int64_t word = 0;
+        if (!value.IsNull() && TupleBatch::IsIntegerType(value.GetTypeId())) {
+          word = TupleBatch::IntegerOf(value);
+        } else if (!value.IsNull() && value.GetTypeId() == TypeId::DECIMAL) {
+          word = DoubleToWord(value.GetAs<double>());
+        }
+        Accumulate(group_idx, i, value.IsNull(), word, &value);
+      }
+    }
+  }
+}
+
+size_t AggregationHashTable::GetMemoryUsage() const {
+  return keys_.capacity() * sizeof(int64_t) + hashes_.capacity() * sizeof(uint64_t) +
+         slots_.capacity() * sizeof(int64_t) + seen_.capacity() / 8 + value_slots_.capacity() * sizeof(Value) +
+         directory_.capacity() * sizeof(uint32_t) + string_bytes_;
+}
+
+void AggregationHashTable::MergeGroup(const AggregationHashTable &other, size_t group_idx) {
+  size_t key_words = key_types_.size();
+  const int64_t *key = other.keys_.data() + group_idx * key_words;
+  std::vector<int64_t> local_key;
+  if (has_varchar_keys_) {
+    // Dictionary ids are local to a table, so VARCHAR words are translated into this table's dictionary.
+    local_key.assign(key, key + key_words);
+    for (size_t i = 0; i < key_words; i++) {
+      if (key_encodings_[i] == Encoding::Varchar && key[i] != VARCHAR_NULL_ID) {
+        local_key[i] = Encode(other.Decode(key[i], key_types_[i]), Encoding::Varchar);
+      }
+    }
+    key = local_key.data();
+  }
+  size_t local_idx = FindOrInsertGroup(key);
+  for (size_t i = 0; i < agg_exprs_.size(); i++) {
+    size_t other_slot_idx = group_idx * agg_exprs_.size() + i;
+    int64_t word = other.slots_[other_slot_idx];
+    if (slot_kinds_[i] == SlotKind::Count) {
+      slots_[local_idx * agg_exprs_.size() + i] += word;
+    } else if (other.seen_[other_slot_idx]) {
+      // Partial sums add up and partial extremes compare like inputs, so a seen slot folds in as one input.
+      const Value *value = has_value_slots_ ? &other.value_slots_[other_slot_idx] : nullptr;
+      Accumulate(local_idx, i, false, word, value);
+    }
+  }
+}
+
+uint64_t AggregationHashTable::GetPartitionHash(size_t group_idx) const {
+  size_t key_words = key_types_.size();
+  const int64_t *key = keys_.data() + group_idx * key_words;
+  if (!has_varchar_keys_) {
+    return hashes_[group_idx];
+  }
+  std::vector<int64_t> content_key(key, key + key_words);
+  for (size_t i = 0; i < key_words; i++) {
+    if (key_encodings_[i] == Encoding::Varchar && key[i] != VARCHAR_NULL_ID) {
+      content_key[i] = static_cast<int64_t>(std::hash<std::string>()(strings_[key[i]]));
+    }
+  }
+  return HashKey(content_key.data(), key_words);
+}
+
+void AggregationHashTable::GetGroup(size_t group_idx, std::vector<Value> *group_bys,
+                                    std::vector<Value> *aggregates) const {
+  group_bys->clear();
+  for (size_t i = 0; i < key_types_.size(); i++) {
+    group_bys->push_back(Decode(keys_[group_idx * key_types_.size() + i], key_types_[i]));
+  }
+  aggregates->clear();
+  for (size_t i = 0; i < agg_exprs_.size(); i++) {
+    size_t slot_idx = group_idx * agg_exprs_.size() + i;
+    int64_t slot = slots_[slot_idx];
+    TypeId type = agg_input_types_[i];
+    if (slot_kinds_[i] == SlotKind::Count) {
+      CheckIntegerRange(slot, TypeId::INTEGER);
+      aggregates->push_back(ValueFactory::GetIntegerValue(static_cast<int32_t>(slot)));
+      continue;
+    }
+    if (!seen_[slot_idx]) {
+      aggregates->push_back(ValueFactory::GetNullValueByType(type));
+      continue;
+    }
+    switch (slot_kinds_[i]) {
+      case SlotKind::IntegerSum:
+        CheckIntegerRange(slot, type);
+        aggregates->push_back(Value(type, slot));
+        break;
+      case SlotKind::IntegerMin:
+      case SlotKind::IntegerMax:
+        aggregates->push_back(Value(type, slot));
+        break;
+      case SlotKind::DecimalSum:
+      case SlotKind::DecimalMin:
+      case SlotKind::DecimalMax:
+        aggregates->push_back(Value(type, WordToDouble(slot)));
+        break;
+      default:
+        aggregates->push_back(value_slots_[slot_idx]);
+        break;
+    }
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,307 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// exchange_executor.cpp
+//
+// Identification: src/execution/exchange_executor.cpp
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+#include "common/util/hash_util.h"
+#include "execution/executor_factory.h"
+#include "execution/executors/exchange_executor.h"
+#include "execution/plans/seq_scan_plan.h"
+
+namespace bustub {
+
+ExchangeState::ExchangeState(ExecutorContext *exec_ctx, const ExchangePlanNode *plan, uint32_t consumer_count)
+    : exec_ctx_(exec_ctx), plan_(plan) {
+  uint32_t parallelism = std::max<uint32_t>(plan_->GetParallelism(), 1);
+  std::vector<ParallelInstance> instances(parallelism);
+  for (uint32_t i = 0; i < parallelism; i++) {
+    instances[i].index_ = i;
+    instances[i].count_ = parallelism;
+  }
+
+  // The copies split the input at the bottom of the leftmost path only; every other input, e.g. the inner side of a
+  // join, is read in full by every copy. A repartition exchange on the path consumes in the copies, and any other
+  // exchange starts a parallel plan of its own.
+  const AbstractPlanNode *node = plan_->GetChildPlan();
+  while (true) {
+    if (node->GetType() == PlanType::SeqScan) {
+      auto scan_plan = static_cast<const SeqScanPlanNode *>(node);
+      TableHeap *table_heap = exec_ctx_->GetCatalog()->GetTable(scan_plan->GetTableOid())->table_.get();
+      dispensers_.emplace_back(std::make_unique<MorselDispenser>(table_heap, parallelism));
+      for (auto &instance : instances) {
+        instance.dispensers_[node] = dispensers_.back().get();
+      }
+      break;
+    }
+    if (node->GetType() == PlanType::Exchange) {
+      auto exchange_plan = static_cast<const ExchangePlanNode *>(node);
+      if (exchange_plan->GetExchangeType() == ExchangeType::Repartition) {
+        auto shared = std::make_shared<ExchangeState>(exec_ctx_, exchange_plan, parallelism);
+        for (auto &instance : instances) {
+          instance.exchanges_[node] = shared;
+        }
+      }
+      break;
+    }
+    if (node->GetChildren().empty()) {
+      break;
+    }
+    node = node->GetChildAt(0);
+  }
+
+  for (const auto &instance : instances) {
+    producers_.emplace_back(ExecutorFactory::CreateExecutor(exec_ctx_, plan_->GetChildPlan(), &instance));
+  }
+  for (uint32_t i = 0; i < consumer_count; i++) {
+    queues_.emplace_back(std::make_unique<ConsumerQueue>(QUEUE_CAPACITY));
+  }
+}
+
+ExchangeState::~ExchangeState() { Stop(); }
+
+void ExchangeState::Start() {
+  std::lock_guard<std::mutex> guard(latch_);
+  if (started_) {
+    return;
+  }
+  started_ = true;
+  ThreadPool *pool = exec_ctx_->GetThreadPool();
+  if (pool == nullptr) {
+    own_pool_ = std::make_unique<ThreadPool>();
+    pool = own_pool_.get();
+  }
+  active_producers_ = static_cast<uint32_t>(producers_.size());
+  running_producers_ = static_cast<uint32_t>(producers_.size());
+  for (uint32_t producer_idx = 0; producer_idx < producers_.size(); producer_idx++) {
+    pool->Submit([this, producer_idx] { Produce(producer_idx); });
+  }
+}
+
+bool ExchangeState::Pop(uint32_t consumer_idx, TupleBatch *batch) {
+  ConsumerQueue &queue = *queues_[consumer_idx];
+  std::unique_ptr<TupleBatch> popped;
+  for (uint32_t attempt = 0; !queue.batches_.TryPop(&popped); attempt++) {
+    if (stopped_) {
+      RethrowError();
+      return false;
+    }
+    if (active_producers_ == 0) {
+      // The last batches may have been pushed between the failed pop and the check.
+      if (queue.batches_.TryPop(&popped)) {
+        break;
+      }
+      RethrowError();
+      return false;
+    }
+    if (attempt < SPIN_COUNT) {
+      std::this_thread::yield();
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(queue.latch_);
+    queue.waiters_++;
+    // Pairs with the fence in Wake(): either the pop below sees the push, or the pusher sees the waiter.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    queue.cv_.wait(lock, [&] { return queue.batches_.TryPop(&popped) || stopped_ || active_producers_ == 0; });
+    queue.waiters_--;
+    if (popped != nullptr) {
+      break;
+    }
+  }
+  Wake(&queue);
+  std::swap(*batch, *popped);
+  return true;
+}
+
+void ExchangeState::Produce(uint32_t producer_idx) {
+  try {
+    AbstractExecutor *producer = producers_[producer_idx].get();
+    producer->Init();
+    if (plan_->GetExchangeType() == ExchangeType::Gather || queues_.size() == 1) {
+      ProduceGather(producer);
+    } else {
+      ProduceRepartition(producer);
+    }
+  } catch (...) {
+    std::lock_guard<std::mutex> guard(latch_);
+    if (error_ == nullptr) {
+      error_ = std::current_exception();
+    }
+    stopped_ = true;
+  }
+  active_producers_--;
+  WakeAll();
+  std::lock_guard<std::mutex> guard(latch_);
+  running_producers_--;
+  finished_cv_.notify_all();
+}
+
+void ExchangeState::ProduceGather(AbstractExecutor *producer) {
+  const Schema *schema = producer->GetOutputSchema();
+  auto batch = std::make_unique<TupleBatch>(schema);
+  while (!stopped_ && producer->NextBatch(batch.get())) {
+    if (!Push(0, &batch)) {
+      return;
+    }
+    batch = std::make_unique<TupleBatch>(schema);
+  }
+}
+
+void ExchangeState::ProduceRepartition(AbstractExecutor *producer) {
+  const Schema *schema = producer->GetOutputSchema();
+  const auto &partition_keys = plan_->GetPartitionKeys();
+  auto consumer_count = static_cast<uint32_t>(queues_.size());
+  // Rows are staged in one batch per consumer, which is pushed once it is full.
+  std::vector<std::unique_ptr<TupleBatch>> staged(consumer_count);
+  for (auto &staged_batch : staged) {
+    staged_batch = std::make_unique<TupleBatch>(schema);
+  }
+  TupleBatch batch(schema);
+  std::vector<Value> values(schema->GetColumnCount());
+  while (!stopped_ && producer->NextBatch(&batch)) {
+    for (uint32_t row_idx = 0; row_idx < batch.GetRowCount(); row_idx++) {
+      hash_t hash = 0;
+      for (const auto *partition_key : partition_keys) {
+        Value key = partition_key->EvaluateRow(&batch, row_idx);
+        if (!key.IsNull()) {
+          hash = HashUtil::CombineHashes(hash, HashUtil::HashValue(&key));
+        }
+      }
+      uint32_t consumer_idx = hash % consumer_count;
+      for (uint32_t col_idx = 0; col_idx < values.size(); col_idx++) {
+        values[col_idx] = batch.GetValue(row_idx, col_idx);
+      }
+      staged[consumer_idx]->AppendRow(values, batch.GetRid(row_idx));
+      if (staged[consumer_idx]->IsFull()) {
+        if (!Push(consumer_idx, &staged[consumer_idx])) {
+          return;
+        }
+        staged[consumer_idx] = std::make_unique<TupleBatch>(schema);
+      }
+    }
+  }
+  for (uint32_t consumer_idx = 0; consumer_idx < consumer_count; consumer_idx++) {
+    if (!staged[consumer_idx]->IsEmpty() && !Push(consumer_idx, &staged[consumer_idx])) {
+      return;
+    }
+  }
+}
+
+bool ExchangeState::Push(uint32_t consumer_idx, std::unique_ptr<TupleBatch> *batch) {
+  ConsumerQueue &queue = *queues_[consumer_idx];
+  for (uint32_t attempt = 0; !queue.batches_.TryPush(batch); attempt++) {
+    if (stopped_) {
+      return false;
+    }
+    if (attempt < SPIN_COUNT) {
+      std::this_thread::yield();
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(queue.latch_);
+    queue.waiters_++;
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    queue.cv_.wait(lock, [&] { return queue.batches_.TryPush(batch) || stopped_; });
+    queue.waiters_--;
+    // A pushed batch has been moved from.
+    if (*batch == nullptr) {
+      break;
+    }
+  }
+  Wake(&queue);
+  return true;
+}
+
+void ExchangeState::Stop() {
+  stopped_ = true;
+  WakeAll();
+  std::unique_lock<std::mutex> lock(latch_);
+  finished_cv_.wait(lock, [&] { return running_producers_ == 0; });
+}
+
+void ExchangeState::Wake(ConsumerQueue *queue) {
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (queue->waiters_ > 0) {
+    // Taking the latch makes sure that the sleeper is either waiting already or will see the change.
+    std::lock_guard<std::mutex> guard(queue->latch_);
+    queue->cv_.notify_all();
+  }
+}
+
+void ExchangeState::WakeAll() {
+  for (auto &queue : queues_) {
+    std::lock_guard<std::mutex> guard(queue->latch_);
+    queue->cv_.notify_all();
+  }
+}
+
+void ExchangeState::RethrowError() {
+  std::lock_guard<std::mutex> guard(latch_);
+  if (error_ != nullptr) {
+    std::rethrow_exception(error_);
+  }
+}
+
+ExchangeExecutor::ExchangeExecutor(ExecutorContext *exec_ctx, const ExchangePlanNode *plan,
+                                   const ParallelInstance *instance)
+    : AbstractExecutor(exec_ctx), plan_(plan), batch_(plan->OutputSchema()) {
+  if (instance != nullptr && instance->exchanges_.count(plan) != 0) {
+    state_ = instance->exchanges_.at(plan);
+    shared_state_ = true;
+    consumer_idx_ = instance->index_;
+  } else if (enable_logging) {
+    serial_child_ = ExecutorFactory::CreateExecutor(exec_ctx_, plan_->GetChildPlan());
+  }
+}
+
+void ExchangeExecutor::Init() {
+  batch_.Clear();
+  batch_row_idx_ = 0;
+  if (serial_child_ != nullptr) {
+    serial_child_->Init();
+    return;
+  }
+  if (!shared_state_) {
+    // Rewinding starts over with new producers, once the old ones have stopped.
+    state_.reset();
+    state_ = std::make_shared<ExchangeState>(exec_ctx_, plan_, 1);
+  }
+  state_->Start();
+}
+
+bool ExchangeExecutor::Next(Tuple *tuple, RID *rid) {
+  if (serial_child_ != nullptr) {
+    return serial_child_->Next(tuple, rid);
+  }
+  while (batch_row_idx_ == batch_.GetRowCount()) {
+    if (!state_->Pop(consumer_idx_, &batch_)) {
+      return false;
+    }
+    batch_row_idx_ = 0;
+  }
+  *tuple = batch_.GetTuple(batch_row_idx_);
+  *rid = batch_.GetRid(batch_row_idx_);
+  batch_row_idx_++;
+  return true;
+}
+
+bool ExchangeExecutor::NextBatch(TupleBatch *batch) {
+  if (serial_child_ != nullptr) {
+    return serial_child_->NextBatch(batch);
+  }
+  return state_->Pop(consumer_idx_, batch);
+}
+
+}  // namespace bustub
@@ -17,23 +17,32 @@
 #include "execution/executors/abstract_executor.h"
 #include "execution/executors/aggregation_executor.h"
 #include "execution/executors/delete_executor.h"
+#include "execution/executors/exchange_executor.h"
 #include "execution/executors/index_scan_executor.h"
 #include "execution/executors/insert_executor.h"
 #include "execution/executors/limit_executor.h"
 #include "execution/executors/nested_index_join_executor.h"
 #include "execution/executors/nested_loop_join_executor.h"
 #include "execution/executors/seq_scan_executor.h"
+#include "execution/executors/sort_executor.h"
+#include "execution/executors/top_n_executor.h"
 #include "execution/executors/update_executor.h"
 #include "storage/index/generic_key.h"
 
 namespace bustub {
 
 std::unique_ptr<AbstractExecutor> ExecutorFactory::CreateExecutor(ExecutorContext *exec_ctx,
-                                                                  const AbstractPlanNode *plan) {
+                                                                  const AbstractPlanNode *plan,
+                                                                  const ParallelInstance *instance) {
   switch (plan->GetType()) {
     // Create a new sequential scan executor.
     case PlanType::SeqScan: {
-      return std::make_unique<SeqScanExecutor>(exec_ctx, dynamic_cast<const SeqScanPlanNode *>(plan));
+      // A scan that the copies of a parallel plan split between them claims morsels from their shared dispenser.
+      MorselDispenser *dispenser = nullptr;
+      if (instance != nullptr && instance->dispensers_.count(plan) != 0) {
+        dispenser = instance->dispensers_.at(plan);
+      }
+      return std::make_unique<SeqScanExecutor>(exec_ctx, dynamic_cast<const SeqScanPlanNode *>(plan), dispenser);
     }
 
     case PlanType::IndexScan: {
@@ -43,50 +52,71 @@ std::unique_ptr<AbstractExecutor> ExecutorFactory::CreateExecutor(ExecutorContex
     // Create a new insert executor.
     case PlanType::Insert: {
       auto insert_plan = dynamic_cast<const InsertPlanNode *>(plan);
-      auto child_executor =
-          insert_plan->IsRawInsert() ? nullptr : ExecutorFactory::CreateExecutor(exec_ctx, insert_plan->GetChildPlan());
+      auto child_executor = insert_plan->IsRawInsert()
+                                ? nullptr
+                                : ExecutorFactory::CreateExecutor(exec_ctx, insert_plan->GetChildPlan(), instance);
       return std::make_unique<InsertExecutor>(exec_ctx, insert_plan, std::move(child_executor));
     }
 
     case PlanType::Update: {
       auto update_plan = dynamic_cast<const UpdatePlanNode *>(plan);
-      auto child_executor = ExecutorFactory::CreateExecutor(exec_ctx, update_plan->GetChildPlan());
+      auto child_executor = ExecutorFactory::CreateExecutor(exec_ctx, update_plan->GetChildPlan(), instance);
       return std::make_unique<UpdateExecutor>(exec_ctx, update_plan, std::move(child_executor));
     }
 
     case PlanType::Delete: {
       auto delete_plan = dynamic_cast<const DeletePlanNode *>(plan);
-      auto child_executor = ExecutorFactory::CreateExecutor(exec_ctx, delete_plan->GetChildPlan());
+      auto child_executor = ExecutorFactory::CreateExecutor(exec_ctx, delete_plan->GetChildPlan(), instance);
       return std::make_unique<DeleteExecutor>(exec_ctx, delete_plan, std::move(child_executor));
     }
 
     case PlanType::Limit: {
       auto limit_plan = dynamic_cast<const LimitPlanNode *>(plan);
-      auto child_executor = ExecutorFactory::CreateExecutor(exec_ctx, limit_plan->GetChildPlan());
+      // ORDER BY ... LIMIT keeps only the rows that can still make the cut, unless the cut is too large for memory.
+      if (limit_plan->GetChildPlan()->GetType() == PlanType::Sort &&
+          limit_plan->GetLimit() <= TopNExecutor::MAX_HEAP_SIZE &&
+          limit_plan->GetOffset() <= TopNExecutor::MAX_HEAP_SIZE - limit_plan->GetLimit()) {
+        auto sort_plan = dynamic_cast<const SortPlanNode *>(limit_plan->GetChildPlan());
+        auto child_executor = ExecutorFactory::CreateExecutor(exec_ctx, sort_plan->GetChildPlan(), instance);
+        return std::make_unique<TopNExecutor>(exec_ctx, limit_plan, sort_plan, std::move(child_executor));
+      }
+      auto child_executor = ExecutorFactory::CreateExecutor(exec_ctx, limit_plan->GetChildPlan(), instance);
       return std::make_unique<LimitExecutor>(exec_ctx, limit_plan, std::move(child_executor));
     }
 
     // Create a new aggregation executor.
     case PlanType::Aggregation: {
       auto agg_plan = dynamic_cast<const AggregationPlanNode *>(plan);
-      auto child_executor = ExecutorFactory::CreateExecutor(exec_ctx, agg_plan->GetChildPlan());
+      auto child_executor = ExecutorFactory::CreateExecutor(exec_ctx, agg_plan->GetChildPlan(), instance);
       return std::make_unique<AggregationExecutor>(exec_ctx, agg_plan, std::move(child_executor));
     }
 
     case PlanType::NestedLoopJoin: {
       auto nested_loop_join_plan = dynamic_cast<const NestedLoopJoinPlanNode *>(plan);
-      auto left = ExecutorFactory::CreateExecutor(exec_ctx, nested_loop_join_plan->GetLeftPlan());
-      auto right = ExecutorFactory::CreateExecutor(exec_ctx, nested_loop_join_plan->GetRightPlan());
+      auto left = ExecutorFactory::CreateExecutor(exec_ctx, nested_loop_join_plan->GetLeftPlan(), instance);
+      auto right = ExecutorFactory::CreateExecutor(exec_ctx, nested_loop_join_plan->GetRightPlan(), instance);
       return std::make_unique<NestedLoopJoinExecutor>(exec_ctx, nested_loop_join_plan, std::move(left),
                                                       std::move(right));
     }
 
     case PlanType::NestedIndexJoin: {
       auto nested_index_join_plan = dynamic_cast<const NestedIndexJoinPlanNode *>(plan);
-      auto left = ExecutorFactory::CreateExecutor(exec_ctx, nested_index_join_plan->GetChildPlan());
+      auto left = ExecutorFactory::CreateExecutor(exec_ctx, nested_index_join_plan->GetChildPlan(), instance);
       return std::make_unique<NestIndexJoinExecutor>(exec_ctx, nested_index_join_plan, std::move(left));
     }
 
+    // Create a new exchange executor.
+    case PlanType::Exchange: {
+      return std::make_unique<ExchangeExecutor>(exec_ctx, dynamic_cast<const ExchangePlanNode *>(plan), instance);
+    }
+
+    // Create a new sort executor.
+    case PlanType::Sort: {
+      auto sort_plan = dynamic_cast<const SortPlanNode *>(plan);
+      auto child_executor = ExecutorFactory::CreateExecutor(exec_ctx, sort_plan->GetChildPlan(), instance);
+      return std::make_unique<SortExecutor>(exec_ctx, sort_plan, std::move(child_executor));
+    }
+
     default: {
       BUSTUB_ASSERT(false, "Unsupported plan type.");
     }
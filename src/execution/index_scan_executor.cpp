@@ -9,14 +9,205 @@
 // Copyright (c) 2015-19, Carnegie Mellon University Database Group
 //
 //===----------------------------------------------------------------------===//
+#include <algorithm>
+#include <utility>
+
 #include "execution/executors/index_scan_executor.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
 
 namespace bustub {
+
 IndexScanExecutor::IndexScanExecutor(ExecutorContext *exec_ctx, const IndexScanPlanNode *plan)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      index_info_(exec_ctx_->GetCatalog()->GetIndex(plan_->GetIndexOid())),
+      table_meta_(exec_ctx_->GetCatalog()->GetTable(index_info_->table_name_)) {
+  if (plan_->GetPredicate() != nullptr) {
+    compiled_predicate_ = CompiledPredicate::Compile(plan_->GetPredicate(), &table_meta_->schema_);
+    BuildKeyRange();
+  }
+}
+
+void IndexScanExecutor::Init() {
+  rids_.clear();
+  rid_idx_ = 0;
+  rid_order_ = false;
+  Index *index = index_info_->index_.get();
+  Transaction *txn = exec_ctx_->GetTransaction();
+  if (point_lookup_) {
+    index->ScanKey(*low_key_, &rids_, txn);
+  } else {
+    index->ScanRange(low_key_.get(), high_key_.get(), &rids_, txn);
+  }
+
+  // Fetching in key order fetches a page once per run of RIDs on it, fetching in RID order once per distinct page.
+  std::vector<RID> sorted = rids_;
+  std::sort(sorted.begin(), sorted.end(), [](const RID &lhs, const RID &rhs) { return lhs.Get() < rhs.Get(); });
+  size_t key_order_fetches = 0;
+  size_t rid_order_fetches = 0;
+  for (size_t i = 0; i < rids_.size(); i++) {
+    key_order_fetches += i == 0 || rids_[i].GetPageId() != rids_[i - 1].GetPageId() ? 1 : 0;
+    rid_order_fetches += i == 0 || sorted[i].GetPageId() != sorted[i - 1].GetPageId() ? 1 : 0;
+  }
+  if (key_order_fetches > rid_order_fetches) {
+    rids_ = std::move(sorted);
+    rid_order_ = true;
+  }
+}
+
+bool IndexScanExecutor::Next(Tuple *tuple, RID *rid) {
+  Tuple table_tuple;
+  if (!FetchNext(&table_tuple)) {
+    return false;
+  }
+  std::vector<Value> values;
+  Project(table_tuple, &values);
+  *tuple = Tuple(values, GetOutputSchema());
+  *rid = table_tuple.GetRid();
+  return true;
+}
+
+bool IndexScanExecutor::NextBatch(TupleBatch *batch) {
+  batch->Clear();
+  std::vector<Value> values;
+  values.reserve(GetOutputSchema()->GetColumnCount());
+  Tuple table_tuple;
+  while (!batch->IsFull() && FetchNext(&table_tuple)) {
+    Project(table_tuple, &values);
+    batch->AppendRow(values, table_tuple.GetRid());
+  }
+  return !batch->IsEmpty();
+}
+
+bool IndexScanExecutor::FetchNext(Tuple *table_tuple) {
+  TableHeap *table_heap = table_meta_->table_.get();
+  Transaction *txn = exec_ctx_->GetTransaction();
+  while (rid_idx_ < rids_.size()) {
+    const RID &rid = rids_[rid_idx_++];
+    if (!table_heap->GetTuple(rid, table_tuple, txn)) {
+      continue;
+    }
+    bool matches = compiled_predicate_ != nullptr
+                       ? compiled_predicate_->Evaluate(table_tuple)
+                       : plan_->GetPredicate() == nullptr ||
+                             plan_->GetPredicate()->Evaluate(table_tuple, &table_meta_->schema_).GetAs<bool>();
+    if (matches) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void IndexScanExecutor::Project(const Tuple &table_tuple, std::vector<Value> *values) const {
+  values->clear();
+  for (const auto &column : plan_->OutputSchema()->GetColumns()) {
+    values->push_back(column.GetExpr()->Evaluate(&table_tuple, &table_meta_->schema_));
+  }
+}
+
+void IndexScanExecutor::CollectRanges(const AbstractExpression *expr,
+                                      std::unordered_map<uint32_t, ColumnRange> *ranges) {
+  if (auto logic = dynamic_cast<const LogicExpression *>(expr); logic != nullptr) {
+    if (logic->GetLogicType() == LogicType::And) {
+      CollectRanges(logic->GetChildAt(0), ranges);
+      CollectRanges(logic->GetChildAt(1), ranges);
+    }
+    return;
+  }
+  auto comparison = dynamic_cast<const ComparisonExpression *>(expr);
+  if (comparison == nullptr) {
+    return;
+  }
+  ComparisonType comp_type = comparison->GetComparisonType();
+  auto column = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(0));
+  auto constant = dynamic_cast<const ConstantValueExpression *>(comparison->GetChildAt(1));
+  if (column == nullptr || constant == nullptr) {
+    column = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(1));
+    constant = dynamic_cast<const ConstantValueExpression *>(comparison->GetChildAt(0));
+    comp_type = ComparisonExpression::Commute(comp_type);
+  }
+  if (column == nullptr || constant == nullptr || column->GetTupleIdx() != 0 || constant->GetValue().IsNull()) {
+    return;
+  }
+  // An exclusive bound is kept inclusive; the predicate drops the boundary key itself.
+  const Value &value = constant->GetValue();
+  ColumnRange &range = (*ranges)[column->GetColIdx()];
+  bool narrows_low = comp_type == ComparisonType::Equal || comp_type == ComparisonType::GreaterThan ||
+                     comp_type == ComparisonType::GreaterThanOrEqual;
+  bool narrows_high = comp_type == ComparisonType::Equal || comp_type == ComparisonType::LessThan ||
+                      comp_type == ComparisonType::LessThanOrEqual;
+  if (narrows_low && (!range.has_low_ || value.CompareGreaterThan(range.low_) == CmpBool::CmpTrue)) {
+    range.has_low_ = true;
+    range.low_ = value;
+  }
+  if (narrows_high && (!range.has_high_ || value.CompareLessThan(range.high_) == CmpBool::CmpTrue)) {
+    range.has_high_ = true;
+    range.high_ = value;
+  }
+}
+
+void IndexScanExecutor::BuildKeyRange() {
+  std::unordered_map<uint32_t, ColumnRange> ranges;
+  CollectRanges(plan_->GetPredicate(), &ranges);
+  const Schema *key_schema = &index_info_->key_schema_;
+  const std::vector<uint32_t> &key_attrs = index_info_->index_->GetKeyAttrs();
+  std::vector<Value> low_values;
+  std::vector<Value> high_values;
+  bool has_low = false;
+  bool has_high = false;
+  uint32_t key_idx = 0;
 
-void IndexScanExecutor::Init() {}
+  // Equalities on a prefix of the key columns.
+  for (; key_idx < key_attrs.size(); key_idx++) {
+    auto it = ranges.find(key_attrs[key_idx]);
+    TypeId type = key_schema->GetColumn(key_idx).GetType();
+    if (it == ranges.end() || !it->second.has_low_ || !it->second.has_high_ || it->second.low_.GetTypeId() != type ||
+        it->second.high_.GetTypeId() != type || it->second.low_.CompareEquals(it->second.high_) != CmpBool::CmpTrue) {
+      break;
+    }
+    low_values.push_back(it->second.low_);
+    high_values.push_back(it->second.high_);
+    has_low = has_high = true;
+  }
+  if (key_idx == key_attrs.size()) {
+    low_key_ = std::make_unique<Tuple>(low_values, key_schema);
+    point_lookup_ = true;
+    return;
+  }
 
-bool IndexScanExecutor::Next(Tuple *tuple, RID *rid) { return false; }
+  // At most one range on the next key column; the columns after it span their whole domain.
+  for (uint32_t range_idx = key_idx; range_idx < key_attrs.size(); range_idx++) {
+    TypeId type = key_schema->GetColumn(range_idx).GetType();
+    auto it = range_idx == key_idx ? ranges.find(key_attrs[range_idx]) : ranges.end();
+    if (it != ranges.end() && it->second.has_low_ && it->second.low_.GetTypeId() == type) {
+      low_values.push_back(it->second.low_);
+      has_low = true;
+    } else if (type != TypeId::VARCHAR) {
+      low_values.push_back(Type::GetMinValue(type));
+    } else {
+      has_low = false;
+    }
+    if (it != ranges.end() && it->second.has_high_ && it->second.high_.GetTypeId() == type) {
+      high_values.push_back(it->second.high_);
+      has_high = true;
+    } else if (type != TypeId::VARCHAR) {
+      high_values.push_back(Type::GetMaxValue(type));
+    } else {
+      has_high = false;
+    }
+    if (!has_low && !has_high) {
+      return;
+    }
+  }
+  if (has_low && low_values.size() == key_attrs.size()) {
+    low_key_ = std::make_unique<Tuple>(low_values, key_schema);
+  }
+  if (has_high && high_values.size() == key_attrs.size()) {
+    high_key_ = std::make_unique<Tuple>(high_values, key_schema);
+  }
+}
 
 }  // namespace bustub
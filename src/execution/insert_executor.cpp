@@ -1,56 +1,104 @@
-//===----------------------------------------------------------------------===//
-//
-//                         BusTub
-//
-// insert_executor.cpp
-//
-// Identification: src/execution/insert_executor.cpp
-//
-// Copyright (c) 2015-19, Carnegie Mellon University Database Group
-//
-//===----------------------------------------------------------------------===//
-#include <memory>
-
-#include "execution/executors/insert_executor.h"
-
-namespace bustub {
-
-InsertExecutor::InsertExecutor(ExecutorContext *exec_ctx, const InsertPlanNode *plan,
-                               std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx),
-      plan_(plan),
-      child_exe_(std::move(child_executor)),
-      table_meta_(exec_ctx_->GetCatalog()->GetTable(plan_->GetTableOid())),
-      table_heap_(table_meta_->table_.get()) {}
-
-void InsertExecutor::Init() {
-  if (!plan_->IsRawInsert()) {
-    child_exe_->Init();
-  }
-}
-
-bool InsertExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) {
-  Schema *schema = &GetExecutorContext()->GetCatalog()->GetTable(this->plan_->GetTableOid())->schema_;
-  if (plan_->IsRawInsert()) {
-    auto size = plan_->RawValues().size();
-    for (size_t index = 0; index < size; index++) {
-      Tuple to_be_inserted = Tuple(plan_->RawValuesAt(index), schema);
-      bool successfulInsert = table_heap_->InsertTuple(to_be_inserted, rid, GetExecutorContext()->GetTransaction());
-      if (!successfulInsert) {
-        return false;
-      }
-    }
-    LOG_INFO("LOOK AT ME: finish initted");
-    return false;
-  }
-  // not rawinsert.
-  while (child_exe_->Next(tuple, rid)) {
-    bool successfulInsert = table_heap_->InsertTuple(*tuple, rid, GetExecutorContext()->GetTransaction());
-    if (!successfulInsert) {
-      return false;
-    }
-  }
-  return false;
-}
-
-}  // namespace bustub
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// insert_executor.cpp
+//
+// Identification: src/execution/insert_executor.cpp
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+#include "concurrency/transaction.h"
+#include "execution/executors/insert_executor.h"
+
+namespace bustub {
+
+namespace {
+
+/** @return true if index key lhs sorts before index key rhs */
+bool KeyLessThan(const Tuple &lhs, const Tuple &rhs, const Schema *key_schema) {
+  for (uint32_t i = 0; i < key_schema->GetColumnCount(); i++) {
+    Value lhs_value = lhs.GetValue(key_schema, i);
+    Value rhs_value = rhs.GetValue(key_schema, i);
+    if (lhs_value.CompareLessThan(rhs_value) == CmpBool::CmpTrue) {
+      return true;
+    }
+    if (lhs_value.CompareGreaterThan(rhs_value) == CmpBool::CmpTrue) {
+      return false;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+InsertExecutor::InsertExecutor(ExecutorContext *exec_ctx, const InsertPlanNode *plan,
+                               std::unique_ptr<AbstractExecutor> &&child_executor)
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      child_exe_(std::move(child_executor)),
+      table_meta_(exec_ctx_->GetCatalog()->GetTable(plan_->GetTableOid())),
+      table_heap_(table_meta_->table_.get()),
+      indexes_(exec_ctx_->GetCatalog()->GetTableIndexes(table_meta_->name_)) {}
+
+void InsertExecutor::Init() {
+  if (!plan_->IsRawInsert()) {
+    child_exe_->Init();
+  }
+}
+
+bool InsertExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) {
+  std::vector<Tuple> tuples;
+  if (plan_->IsRawInsert()) {
+    tuples.reserve(plan_->RawValues().size());
+    for (const auto &values : plan_->RawValues()) {
+      tuples.emplace_back(values, &table_meta_->schema_);
+    }
+    InsertBatch(tuples);
+    return false;
+  }
+  // not rawinsert.
+  TupleBatch batch(child_exe_->GetOutputSchema());
+  tuples.reserve(batch.GetCapacity());
+  while (child_exe_->NextBatch(&batch)) {
+    tuples.clear();
+    for (uint32_t row_idx = 0; row_idx < batch.GetRowCount(); row_idx++) {
+      tuples.push_back(batch.GetTuple(row_idx));
+    }
+    InsertBatch(tuples);
+  }
+  return false;
+}
+
+void InsertExecutor::InsertBatch(const std::vector<Tuple> &tuples) {
+  Transaction *txn = exec_ctx_->GetTransaction();
+  if (!table_heap_->AppendTuples(tuples, &rids_, txn)) {
+    // The tuples appended before the failure have no index entries; the rollback of the transaction removes them.
+    throw TransactionAbortException(txn->GetTransactionId(), AbortReason::DEADLOCK);
+  }
+  std::vector<std::pair<Tuple, size_t>> keys;
+  keys.reserve(tuples.size());
+  for (IndexInfo *index_info : indexes_) {
+    Index *index = index_info->index_.get();
+    const Schema *key_schema = &index_info->key_schema_;
+    keys.clear();
+    for (size_t i = 0; i < tuples.size(); i++) {
+      keys.emplace_back(tuples[i].KeyFromTuple(table_meta_->schema_, *key_schema, index->GetKeyAttrs()), i);
+    }
+    std::stable_sort(keys.begin(), keys.end(), [key_schema](const auto &lhs, const auto &rhs) {
+      return KeyLessThan(lhs.first, rhs.first, key_schema);
+    });
+    for (const auto &[key, i] : keys) {
+      index->InsertEntry(key, rids_[i], txn);
+      txn->GetIndexWriteSet()->emplace_back(rids_[i], table_meta_->oid_, WType::INSERT, tuples[i],
+                                            index_info->index_oid_, exec_ctx_->GetCatalog());
+    }
+  }
+}
+
+}  // namespace bustub
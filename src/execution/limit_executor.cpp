@@ -10,16 +10,52 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+
 #include "execution/executors/limit_executor.h"
 
 namespace bustub {
 
 LimitExecutor::LimitExecutor(ExecutorContext *exec_ctx, const LimitPlanNode *plan,
                              std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {}
+
+void LimitExecutor::Init() {
+  child_executor_->Init();
+  skipped_ = 0;
+  produced_ = 0;
+}
 
-void LimitExecutor::Init() {}
+bool LimitExecutor::Next(Tuple *tuple, RID *rid) {
+  while (produced_ < plan_->GetLimit() && child_executor_->Next(tuple, rid)) {
+    if (skipped_ < plan_->GetOffset()) {
+      skipped_++;
+      continue;
+    }
+    produced_++;
+    return true;
+  }
+  return false;
+}
 
-bool LimitExecutor::Next(Tuple *tuple, RID *rid) { return false; }
+bool LimitExecutor::NextBatch(TupleBatch *batch) {
+  while (produced_ < plan_->GetLimit() && child_executor_->NextBatch(batch)) {
+    if (skipped_ < plan_->GetOffset()) {
+      size_t skip = std::min<size_t>(plan_->GetOffset() - skipped_, batch->GetRowCount());
+      batch->EraseFront(static_cast<uint32_t>(skip));
+      skipped_ += skip;
+    }
+    size_t remaining = plan_->GetLimit() - produced_;
+    if (batch->GetRowCount() > remaining) {
+      batch->Truncate(static_cast<uint32_t>(remaining));
+    }
+    produced_ += batch->GetRowCount();
+    if (!batch->IsEmpty()) {
+      return true;
+    }
+  }
+  batch->Clear();
+  return false;
+}
 
 }  // namespace bustub
@@ -12,14 +12,236 @@
 
 #include "execution/executors/nested_index_join_executor.h"
 
+#include <algorithm>
+
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/logic_expression.h"
+
 namespace bustub {
 
 NestIndexJoinExecutor::NestIndexJoinExecutor(ExecutorContext *exec_ctx, const NestedIndexJoinPlanNode *plan,
                                              std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      child_executor_(std::move(child_executor)),
+      inner_table_(exec_ctx->GetCatalog()->GetTable(plan->GetInnerTableOid())),
+      index_info_(exec_ctx->GetCatalog()->GetIndex(plan->GetIndexName(), inner_table_->name_)) {
+  if (plan_->Predicate() != nullptr) {
+    compiled_predicate_ =
+        CompiledPredicate::Compile(plan_->Predicate(), plan_->OuterTableSchema(), plan_->InnerTableSchema());
+  }
+  BuildOuterKey();
+}
+
+void NestIndexJoinExecutor::CollectEqualities(const AbstractExpression *expr,
+                                              std::unordered_map<uint32_t, const AbstractExpression *> *outer_exprs) {
+  if (auto logic = dynamic_cast<const LogicExpression *>(expr); logic != nullptr) {
+    if (logic->GetLogicType() == LogicType::And) {
+      CollectEqualities(logic->GetChildAt(0), outer_exprs);
+      CollectEqualities(logic->GetChildAt(1), outer_exprs);
+    }
+    return;
+  }
+  auto comparison = dynamic_cast<const ComparisonExpression *>(expr);
+  if (comparison == nullptr || comparison->GetComparisonType() != ComparisonType::Equal) {
+    return;
+  }
+  auto outer = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(0));
+  auto inner = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(1));
+  if (outer == nullptr || inner == nullptr) {
+    return;
+  }
+  if (outer->GetTupleIdx() == 1) {
+    std::swap(outer, inner);
+  }
+  if (outer->GetTupleIdx() == 0 && inner->GetTupleIdx() == 1) {
+    outer_exprs->emplace(inner->GetColIdx(), outer);
+  }
+}
+
+void NestIndexJoinExecutor::BuildOuterKey() {
+  std::unordered_map<uint32_t, const AbstractExpression *> outer_exprs;
+  CollectEqualities(plan_->Predicate(), &outer_exprs);
+  // The inner table schema of the plan may project the inner table, while the index key attributes are columns of
+  // the table itself.
+  const Schema *inner_schema = plan_->InnerTableSchema();
+  for (uint32_t key_attr : index_info_->index_->GetKeyAttrs()) {
+    const AbstractExpression *outer_expr = nullptr;
+    for (uint32_t col_idx = 0; col_idx < inner_schema->GetColumnCount(); col_idx++) {
+      auto column = dynamic_cast<const ColumnValueExpression *>(inner_schema->GetColumn(col_idx).GetExpr());
+      uint32_t table_col_idx = column != nullptr ? column->GetColIdx() : col_idx;
+      if (table_col_idx == key_attr && outer_exprs.count(col_idx) != 0) {
+        outer_expr = outer_exprs.at(col_idx);
+        break;
+      }
+    }
+    BUSTUB_ASSERT(outer_expr != nullptr, "The join predicate must equate every index key column with the outer tuple.");
+    outer_key_exprs_.push_back(outer_expr);
+  }
+}
+
+Tuple NestIndexJoinExecutor::OuterKey(const Tuple &outer_tuple) const {
+  std::vector<Value> values;
+  values.reserve(outer_key_exprs_.size());
+  for (const AbstractExpression *expr : outer_key_exprs_) {
+    values.push_back(expr->Evaluate(&outer_tuple, plan_->OuterTableSchema()));
+  }
+  return Tuple(values, &index_info_->key_schema_);
+}
+
+void NestIndexJoinExecutor::Init() {
+  child_executor_->Init();
+  outer_batch_.clear();
+  joined_.clear();
+  joined_idx_ = 0;
+}
+
+bool NestIndexJoinExecutor::Next(Tuple *tuple, RID *rid) {
+  while (joined_idx_ >= joined_.size()) {
+    if (!ProbeNextBatch()) {
+      return false;
+    }
+  }
+  std::vector<Value> values;
+  NextOutput(&values);
+  *tuple = Tuple(values, GetOutputSchema());
+  return true;
+}
+
+bool NestIndexJoinExecutor::NextBatch(TupleBatch *batch) {
+  batch->Clear();
+  std::vector<Value> values;
+  values.reserve(GetOutputSchema()->GetColumnCount());
+  while (!batch->IsFull()) {
+    if (joined_idx_ >= joined_.size() && !ProbeNextBatch()) {
+      break;
+    }
+    if (joined_idx_ < joined_.size()) {
+      NextOutput(&values);
+      batch->AppendRow(values, RID());
+    }
+  }
+  return !batch->IsEmpty();
+}
+
+void NestIndexJoinExecutor::NextOutput(std::vector<Value> *values) {
+  const auto &pair = joined_[joined_idx_++];
+  const Tuple &outer_tuple = outer_batch_[pair.first];
+  const Tuple &inner_tuple = pair.second;
+  values->clear();
+  for (const auto &column : GetOutputSchema()->GetColumns()) {
+    values->push_back(column.GetExpr()->EvaluateJoin(&outer_tuple, plan_->OuterTableSchema(), &inner_tuple,
+                                                     plan_->InnerTableSchema()));
+  }
+}
+
+bool NestIndexJoinExecutor::ProbeNextBatch() {
+  joined_.clear();
+  joined_idx_ = 0;
+  outer_batch_.clear();
+
+  Tuple outer;
+  RID outer_rid;
+  while (outer_batch_.size() < OUTER_BATCH_SIZE && child_executor_->Next(&outer, &outer_rid)) {
+    outer_batch_.push_back(outer);
+  }
+  if (outer_batch_.empty()) {
+    return false;
+  }
+
+  const Schema *outer_schema = plan_->OuterTableSchema();
+  const Schema *inner_schema = plan_->InnerTableSchema();
+  Index *index = index_info_->index_.get();
+  Transaction *txn = exec_ctx_->GetTransaction();
+
+  // Build the index key of every outer tuple and sort the batch by key, so that the probes walk the index in order.
+  std::vector<std::pair<Tuple, size_t>> keys;
+  keys.reserve(outer_batch_.size());
+  for (size_t i = 0; i < outer_batch_.size(); i++) {
+    keys.emplace_back(OuterKey(outer_batch_[i]), i);
+  }
+  std::stable_sort(keys.begin(), keys.end(),
+                   [this](const auto &lhs, const auto &rhs) { return KeyLessThan(lhs.first, rhs.first); });
+
+  // Probe the index once per distinct key and remember which outer tuple each matching RID belongs to.
+  std::vector<std::pair<RID, size_t>> matches;
+  std::vector<RID> rids;
+  for (size_t i = 0; i < keys.size(); i++) {
+    bool same_key = i > 0 && !KeyLessThan(keys[i - 1].first, keys[i].first);
+    if (!same_key) {
+      rids.clear();
+      index->ScanKey(keys[i].first, &rids, txn);
+    }
+    for (const auto &inner_rid : rids) {
+      matches.emplace_back(inner_rid, keys[i].second);
+    }
+  }
+
+  // Fetch the inner tuples in page order. Ties keep the outer order so that the output of a batch is deterministic.
+  std::sort(matches.begin(), matches.end(), [](const auto &lhs, const auto &rhs) {
+    if (lhs.first.GetPageId() != rhs.first.GetPageId()) {
+      return lhs.first.GetPageId() < rhs.first.GetPageId();
+    }
+    if (lhs.first.GetSlotNum() != rhs.first.GetSlotNum()) {
+      return lhs.first.GetSlotNum() < rhs.first.GetSlotNum();
+    }
+    return lhs.second < rhs.second;
+  });
+
+  Tuple inner;
+  RID fetched_rid;
+  bool fetched = false;
+  for (const auto &match : matches) {
+    if (!fetched || !(match.first == fetched_rid)) {
+      Tuple table_tuple;
+      fetched = inner_table_->table_->GetTuple(match.first, &table_tuple, txn);
+      if (!fetched) {
+        continue;
+      }
+      fetched_rid = match.first;
+      inner = ProjectInner(table_tuple);
+    }
+    const Tuple &outer_tuple = outer_batch_[match.second];
+    bool matches = compiled_predicate_ != nullptr
+                       ? compiled_predicate_->EvaluateJoin(&outer_tuple, &inner)
+                       : plan_->Predicate() == nullptr ||
+                             plan_->Predicate()->EvaluateJoin(&outer_tuple, outer_schema, &inner, inner_schema)
+                                 .GetAs<bool>();
+    if (!matches) {
+      continue;
+    }
+    joined_.emplace_back(match.second, inner);
+  }
+  return true;
+}
 
-void NestIndexJoinExecutor::Init() {}
+bool NestIndexJoinExecutor::KeyLessThan(const Tuple &lhs, const Tuple &rhs) const {
+  const Schema *key_schema = &index_info_->key_schema_;
+  for (uint32_t i = 0; i < key_schema->GetColumnCount(); i++) {
+    Value lhs_value = lhs.GetValue(key_schema, i);
+    Value rhs_value = rhs.GetValue(key_schema, i);
+    if (lhs_value.CompareLessThan(rhs_value) == CmpBool::CmpTrue) {
+      return true;
+    }
+    if (lhs_value.CompareGreaterThan(rhs_value) == CmpBool::CmpTrue) {
+      return false;
+    }
+  }
+  return false;
+}
 
-bool NestIndexJoinExecutor::Next(Tuple *tuple, RID *rid) { return false; }
+Tuple NestIndexJoinExecutor::ProjectInner(const Tuple &table_tuple) const {
+  const Schema *inner_schema = plan_->InnerTableSchema();
+  std::vector<Value> values;
+  values.reserve(inner_schema->GetColumnCount());
+  for (const auto &column : inner_schema->GetColumns()) {
+    if (column.GetExpr() == nullptr) {
+      return table_tuple;
+    }
+    values.push_back(column.GetExpr()->Evaluate(&table_tuple, &inner_table_->schema_));
+  }
+  return Tuple(values, inner_schema);
+}
 
 }  // namespace bustub
@@ -16,49 +16,91 @@ namespace bustub {
 NestedLoopJoinExecutor::NestedLoopJoinExecutor(ExecutorContext *exec_ctx, const NestedLoopJoinPlanNode *plan,
                                                std::unique_ptr<AbstractExecutor> &&left_executor,
                                                std::unique_ptr<AbstractExecutor> &&right_executor)
-    : AbstractExecutor(exec_ctx), plan_(plan), left_(std::move(left_executor)), right_(std::move(right_executor)) {}
+    : AbstractExecutor(exec_ctx), plan_(plan), left_(std::move(left_executor)), right_(std::move(right_executor)) {
+  if (plan_->Predicate() != nullptr) {
+    compiled_predicate_ = CompiledPredicate::Compile(plan_->Predicate(), plan_->GetLeftPlan()->OutputSchema(),
+                                                     plan_->GetRightPlan()->OutputSchema());
+  }
+}
 
 void NestedLoopJoinExecutor::Init() {
+  left_->Init();
+  left_block_.clear();
+  has_right_ = false;
+  block_idx_ = 0;
+}
+
+bool NestedLoopJoinExecutor::LoadLeftBlock() {
+  left_block_.clear();
   Tuple left_tuple;
-  Tuple right_tuple;
-  Tuple result_tuple;
   RID left_rid;
+  size_t block_bytes = 0;
+  while (block_bytes < LEFT_BLOCK_SIZE && left_->Next(&left_tuple, &left_rid)) {
+    block_bytes += left_tuple.GetLength();
+    left_block_.push_back(left_tuple);
+  }
+  if (left_block_.empty()) {
+    return false;
+  }
+  right_->Init();  // rescan the right side once per block
+  has_right_ = false;
+  return true;
+}
+
+bool NestedLoopJoinExecutor::NextMatch(std::vector<Value> *values) {
+  const Schema *left_schema = plan_->GetLeftPlan()->OutputSchema();
+  const Schema *right_schema = plan_->GetRightPlan()->OutputSchema();
   RID right_rid;
-  while (left_->Next(&left_tuple, &left_rid)) {
-    // LOG_INFO("left loop");
-    right_->Init();  // do this to reset right pointer to its original position each time.
-    while (right_->Next(&right_tuple, &right_rid)) {
-      // LOG_INFO("right loop");
-      if (plan_->Predicate()
-              ->EvaluateJoin(&left_tuple, plan_->GetLeftPlan()->OutputSchema(), &right_tuple,
-                             plan_->GetRightPlan()->OutputSchema())
-              .GetAs<bool>()) {
-        LOG_INFO("need to join");
-        std::vector<Value> result_vector;
-        for (size_t index = 0; index < plan_->GetLeftPlan()->OutputSchema()->GetColumnCount(); index++) {
-          // LOG_INFO("1st for with index = %li", index);
-          // LOG_INFO("1st for with size = %ui", left_tuple.GetLength());
-          result_vector.push_back(left_tuple.GetValue(plan_->GetLeftPlan()->OutputSchema(), index));
-          // LOG_INFO("passed push_back for 1st loop");
-        }
-        for (size_t index = 0; index < plan_->GetRightPlan()->OutputSchema()->GetColumnCount(); index++) {
-          // LOG_INFO("2nd for");
-          result_vector.push_back(right_tuple.GetValue(plan_->GetRightPlan()->OutputSchema(), index));
-        }
-        result_tuples.emplace_back(Tuple(result_vector, GetOutputSchema()));
-        LOG_INFO("size %li", result_tuples.size());
+  while (true) {
+    if (left_block_.empty() && !LoadLeftBlock()) {
+      return false;
+    }
+    if (!has_right_) {
+      has_right_ = right_->Next(&right_tuple_, &right_rid);
+      block_idx_ = 0;
+      if (!has_right_) {
+        // The right side is exhausted for this block, move on to the next one.
+        left_block_.clear();
+        continue;
+      }
+    }
+    while (block_idx_ < left_block_.size()) {
+      const Tuple &left_tuple = left_block_[block_idx_++];
+      bool matches = compiled_predicate_ != nullptr
+                         ? compiled_predicate_->EvaluateJoin(&left_tuple, &right_tuple_)
+                         : plan_->Predicate() == nullptr ||
+                               plan_->Predicate()->EvaluateJoin(&left_tuple, left_schema, &right_tuple_, right_schema)
+                                   .GetAs<bool>();
+      if (!matches) {
+        continue;
       }
+      values->clear();
+      for (const auto &column : GetOutputSchema()->GetColumns()) {
+        values->push_back(column.GetExpr()->EvaluateJoin(&left_tuple, left_schema, &right_tuple_, right_schema));
+      }
+      return true;
     }
+    has_right_ = false;
   }
 }
 
 bool NestedLoopJoinExecutor::Next(Tuple *tuple, RID *rid) {
-  if (result_tuples.empty()) {
+  std::vector<Value> values;
+  if (!NextMatch(&values)) {
     return false;
   }
-  *tuple = result_tuples.back();
-  result_tuples.pop_back();
+  *tuple = Tuple(values, GetOutputSchema());
   return true;
 }
 
+bool NestedLoopJoinExecutor::NextBatch(TupleBatch *batch) {
+  batch->Clear();
+  std::vector<Value> values;
+  values.reserve(GetOutputSchema()->GetColumnCount());
+  while (!batch->IsFull() && NextMatch(&values)) {
+    batch->AppendRow(values, RID());
+  }
+  return !batch->IsEmpty();
+}
+
 }  // namespace bustub
@@ -1,48 +1,159 @@
-//===----------------------------------------------------------------------===//
-//
-//                         BusTub
-//
-// seq_scan_executor.cpp
-//
-// Identification: src/execution/seq_scan_executor.cpp
-//
-// Copyright (c) 2015-19, Carnegie Mellon University Database Group
-//
-//===----------------------------------------------------------------------===//
-#include "execution/executors/seq_scan_executor.h"
-
-namespace bustub {
-
-SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan)
-    : AbstractExecutor(exec_ctx),
-      plan_(plan),
-      table_meta_(exec_ctx_->GetCatalog()->GetTable(plan_->GetTableOid())),
-      table_heap_(table_meta_->table_.get()),
-      ite_(table_heap_->Begin(exec_ctx_->GetTransaction())) {}
-
-void SeqScanExecutor::Init() {
-  // LOG_INFO("LOOK AT ME: init entered");
-  table_heap_ = table_meta_->table_.get();
-  ite_ = table_heap_->Begin(exec_ctx_->GetTransaction());
-  // LOG_INFO("LOOK AT ME: finish initted");
-}
-
-bool SeqScanExecutor::Next(Tuple *tuple, RID *rid) {
-  // LOG_INFO("entered Next");
-  while (ite_ != table_heap_->End()) {
-    auto tuple_tested = *(ite_++);
-    if (plan_->GetPredicate() != nullptr) {
-      if (plan_->GetPredicate()->Evaluate(&tuple_tested, GetOutputSchema()).GetAs<bool>()) {
-        *tuple = Tuple(tuple_tested);
-        return true;
-      }
-    } else {
-      *tuple = Tuple(tuple_tested);
-      return true;
-    }
-  }
-  // LOG_INFO("LOOK AT ME: returnin false");
-  return false;
-}
-
-}  // namespace bustub
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// seq_scan_executor.cpp
+//
+// Identification: src/execution/seq_scan_executor.cpp
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#include <algorithm>
+#include <numeric>
+
+#include "concurrency/transaction.h"
+#include "execution/executors/seq_scan_executor.h"
+
+namespace bustub {
+
+SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan, MorselDispenser *dispenser)
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      table_meta_(exec_ctx_->GetCatalog()->GetTable(plan_->GetTableOid())),
+      table_heap_(table_meta_->table_.get()),
+      ite_(table_heap_->Begin(exec_ctx_->GetTransaction())),
+      scan_batch_(&table_meta_->schema_),
+      dispenser_(dispenser) {
+  if (plan_->GetPredicate() != nullptr) {
+    compiled_predicate_ = CompiledPredicate::Compile(plan_->GetPredicate(), &table_meta_->schema_);
+  }
+}
+
+void SeqScanExecutor::Init() {
+  // LOG_INFO("LOOK AT ME: init entered");
+  table_heap_ = table_meta_->table_.get();
+  if (dispenser_ != nullptr) {
+    morsel_.clear();
+    morsel_page_idx_ = 0;
+    scan_batch_.Clear();
+    selection_.clear();
+    selection_idx_ = 0;
+    return;
+  }
+  ite_ = table_heap_->Begin(exec_ctx_->GetTransaction());
+  // LOG_INFO("LOOK AT ME: finish initted");
+}
+
+bool SeqScanExecutor::Next(Tuple *tuple, RID *rid) {
+  std::vector<Value> values;
+  if (dispenser_ != nullptr) {
+    uint32_t row_idx;
+    if (!NextMorselRow(&row_idx)) {
+      return false;
+    }
+    ProjectRow(row_idx, &values);
+    *tuple = Tuple(values, GetOutputSchema());
+    *rid = scan_batch_.GetRid(row_idx);
+    return true;
+  }
+  while (ite_ != table_heap_->End()) {
+    const Tuple &table_tuple = *ite_;
+    if (Matches(table_tuple)) {
+      Project(table_tuple, &values);
+      *tuple = Tuple(values, GetOutputSchema());
+      *rid = table_tuple.GetRid();
+      ++ite_;
+      return true;
+    }
+    ++ite_;
+  }
+  return false;
+}
+
+bool SeqScanExecutor::NextBatch(TupleBatch *batch) {
+  batch->Clear();
+  std::vector<Value> values;
+  values.reserve(GetOutputSchema()->GetColumnCount());
+  if (dispenser_ != nullptr) {
+    uint32_t row_idx;
+    while (!batch->IsFull() && NextMorselRow(&row_idx)) {
+      ProjectRow(row_idx, &values);
+      batch->AppendRow(values, scan_batch_.GetRid(row_idx));
+    }
+    return !batch->IsEmpty();
+  }
+  const TableIterator end = table_heap_->End();
+  while (!batch->IsFull() && ite_ != end) {
+    // Deserialize a chunk of table tuples, filter the whole chunk with the predicate, then project the survivors.
+    uint32_t chunk_size = std::min(scan_batch_.GetCapacity(), batch->GetCapacity() - batch->GetRowCount());
+    scan_batch_.Clear();
+    while (scan_batch_.GetRowCount() < chunk_size && ite_ != end) {
+      scan_batch_.AppendTuple(*ite_, ite_->GetRid());
+      ++ite_;
+    }
+    Filter();
+    for (uint32_t row_idx : selection_) {
+      ProjectRow(row_idx, &values);
+      batch->AppendRow(values, scan_batch_.GetRid(row_idx));
+    }
+  }
+  return !batch->IsEmpty();
+}
+
+bool SeqScanExecutor::NextMorselRow(uint32_t *row_idx) {
+  while (selection_idx_ == selection_.size()) {
+    if (morsel_page_idx_ == morsel_.size()) {
+      if (!dispenser_->Claim(&morsel_)) {
+        return false;
+      }
+      morsel_page_idx_ = 0;
+    }
+    scan_batch_.Clear();
+    Transaction *txn = exec_ctx_->GetTransaction();
+    if (!table_heap_->ScanPage(morsel_[morsel_page_idx_++], &scan_batch_, txn)) {
+      // The transaction was aborted, and the partial page is dropped. Running out of rows would read as the end of
+      // the table, so the abort goes up to the query, through the exchange that runs the scan if there is one.
+      scan_batch_.Clear();
+      selection_.clear();
+      selection_idx_ = 0;
+      throw TransactionAbortException(txn->GetTransactionId(), AbortReason::DEADLOCK);
+    }
+    Filter();
+    selection_idx_ = 0;
+  }
+  *row_idx = selection_[selection_idx_++];
+  return true;
+}
+
+void SeqScanExecutor::Filter() {
+  selection_.resize(scan_batch_.GetRowCount());
+  std::iota(selection_.begin(), selection_.end(), 0);
+  if (plan_->GetPredicate() != nullptr) {
+    plan_->GetPredicate()->EvaluateSelection(&scan_batch_, &selection_);
+  }
+}
+
+bool SeqScanExecutor::Matches(const Tuple &table_tuple) const {
+  if (compiled_predicate_ != nullptr) {
+    return compiled_predicate_->Evaluate(&table_tuple);
+  }
+  return plan_->GetPredicate() == nullptr ||
+         plan_->GetPredicate()->Evaluate(&table_tuple, &table_meta_->schema_).GetAs<bool>();
+}
+
+void SeqScanExecutor::Project(const Tuple &table_tuple, std::vector<Value> *values) const {
+  values->clear();
+  for (const auto &column : plan_->OutputSchema()->GetColumns()) {
+    values->push_back(column.GetExpr()->Evaluate(&table_tuple, &table_meta_->schema_));
+  }
+}
+
+void SeqScanExecutor::ProjectRow(uint32_t row_idx, std::vector<Value> *values) const {
+  values->clear();
+  for (const auto &column : plan_->OutputSchema()->GetColumns()) {
+    values->push_back(column.GetExpr()->EvaluateRow(&scan_batch_, row_idx));
+  }
+}
+
+}  // namespace bustub
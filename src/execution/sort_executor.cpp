@@ -0,0 +1,300 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// sort_executor.cpp
+//
+// Identification: src/execution/sort_executor.cpp
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "execution/executors/sort_executor.h"
+
+namespace bustub {
+
+namespace {
+
+/** @return the number of bytes of a record, including its size field */
+size_t RecordSize(const char *record) {
+  uint32_t size;
+  memcpy(&size, record, sizeof(size));
+  return sizeof(uint32_t) + size;
+}
+
+/** @return the length of the sort key of a record */
+uint32_t RecordKeyLength(const char *record) {
+  uint32_t key_length;
+  memcpy(&key_length, record + sizeof(uint32_t), sizeof(key_length));
+  return key_length;
+}
+
+/** @return the sort key of a record */
+const char *RecordKey(const char *record) { return record + 2 * sizeof(uint32_t); }
+
+/** @return the RID of the tuple of a record */
+RID RecordRid(const char *record) {
+  int64_t rid;
+  memcpy(&rid, RecordKey(record) + RecordKeyLength(record), sizeof(rid));
+  return RID(rid);
+}
+
+/** @return a negative number, zero or a positive number if record a sorts before, with or after record b */
+int CompareRecords(const char *a, const char *b) {
+  return SortKeyEncoder::Compare(RecordKey(a), RecordKeyLength(a), RecordKey(b), RecordKeyLength(b));
+}
+
+}  // namespace
+
+SortExecutor::SortExecutor(ExecutorContext *exec_ctx, const SortPlanNode *plan,
+                           std::unique_ptr<AbstractExecutor> &&child)
+    : AbstractExecutor(exec_ctx), plan_(plan), child_(std::move(child)), encoder_(plan_->GetOrderBys()) {}
+
+SortExecutor::~SortExecutor() { DropRuns(); }
+
+void SortExecutor::Init() {
+  DropRuns();
+  buffer_.clear();
+  entries_.clear();
+  entry_idx_ = 0;
+  merging_ = false;
+  run_count_ = 0;
+
+  child_->Init();
+  size_t memory_budget = plan_->GetMemoryBudget();
+  TupleBatch batch(child_->GetOutputSchema());
+  while (child_->NextBatch(&batch)) {
+    for (uint32_t row_idx = 0; row_idx < batch.GetRowCount(); row_idx++) {
+      BufferRow(&batch, row_idx);
+      if (memory_budget != 0 && GetBufferMemoryUsage() > memory_budget) {
+        SpillBuffer();
+      }
+    }
+  }
+  if (runs_.empty()) {
+    SortBuffer();
+    return;
+  }
+  if (!entries_.empty()) {
+    SpillBuffer();
+  }
+
+  // Merge consecutive groups of runs into longer runs, in order, until the runs can be merged at once.
+  while (runs_.size() > MAX_MERGE_FAN_IN) {
+    std::vector<SortRun> inputs = std::move(runs_);
+    runs_.clear();
+    for (size_t begin = 0; begin < inputs.size(); begin += MAX_MERGE_FAN_IN) {
+      size_t end = std::min(begin + MAX_MERGE_FAN_IN, inputs.size());
+      RunMerge merge;
+      OpenMerge(std::vector<SortRun>(std::make_move_iterator(inputs.begin() + begin),
+                                     std::make_move_iterator(inputs.begin() + end)),
+                &merge);
+      RunWriter writer;
+      while (merge.cursors_[merge.winner_].record_ != nullptr) {
+        WriteRecord(&writer, merge.cursors_[merge.winner_].record_);
+        AdvanceMerge(&merge);
+      }
+      FinishRun(&writer);
+    }
+  }
+  OpenMerge(std::move(runs_), &merge_);
+  runs_.clear();
+  merging_ = true;
+}
+
+bool SortExecutor::Next(Tuple *tuple, RID *rid) {
+  const char *record;
+  if (merging_) {
+    record = merge_.cursors_[merge_.winner_].record_;
+    if (record == nullptr) {
+      return false;
+    }
+  } else {
+    if (entry_idx_ == entries_.size()) {
+      return false;
+    }
+    record = buffer_.data() + entries_[entry_idx_++].offset_;
+  }
+  tuple->DeserializeFrom(RecordKey(record) + RecordKeyLength(record) + sizeof(int64_t));
+  *rid = RecordRid(record);
+  if (merging_) {
+    AdvanceMerge(&merge_);
+  }
+  return true;
+}
+
+void SortExecutor::BufferRow(const TupleBatch *batch, uint32_t row_idx) {
+  size_t offset = buffer_.size();
+  // The size and the key length are filled in once they are known.
+  buffer_.append(2 * sizeof(uint32_t), '\0');
+  encoder_.EncodeRow(batch, row_idx, &buffer_);
+  auto key_length = static_cast<uint32_t>(buffer_.size() - offset - 2 * sizeof(uint32_t));
+  int64_t rid = batch->GetRid(row_idx).Get();
+  buffer_.append(reinterpret_cast<const char *>(&rid), sizeof(rid));
+  Tuple tuple = batch->GetTuple(row_idx);
+  size_t tuple_offset = buffer_.size();
+  buffer_.resize(tuple_offset + sizeof(uint32_t) + tuple.GetLength());
+  tuple.SerializeTo(&buffer_[tuple_offset]);
+  auto size = static_cast<uint32_t>(buffer_.size() - offset - sizeof(uint32_t));
+  memcpy(&buffer_[offset], &size, sizeof(size));
+  memcpy(&buffer_[offset + sizeof(uint32_t)], &key_length, sizeof(key_length));
+  entries_.push_back({SortKeyEncoder::Prefix(RecordKey(&buffer_[offset]), key_length), offset});
+}
+
+void SortExecutor::SortBuffer() {
+  const char *buffer = buffer_.data();
+  std::stable_sort(entries_.begin(), entries_.end(), [buffer](const SortEntry &a, const SortEntry &b) {
+    if (a.prefix_ != b.prefix_) {
+      return a.prefix_ < b.prefix_;
+    }
+    return CompareRecords(buffer + a.offset_, buffer + b.offset_) < 0;
+  });
+}
+
+void SortExecutor::SpillBuffer() {
+  SortBuffer();
+  RunWriter writer;
+  for (const auto &entry : entries_) {
+    WriteRecord(&writer, buffer_.data() + entry.offset_);
+  }
+  FinishRun(&writer);
+  buffer_.clear();
+  entries_.clear();
+}
+
+void SortExecutor::WriteRecord(RunWriter *writer, const char *record) {
+  // A TmpTuple is a size followed by data, which is exactly the layout of a record.
+  Tuple tmp;
+  tmp.DeserializeFrom(record);
+  TmpTuple tmp_tuple(INVALID_PAGE_ID, 0);
+  if (writer->page_ != nullptr && writer->page_->Insert(tmp, &tmp_tuple)) {
+    return;
+  }
+  BufferPoolManager *bpm = exec_ctx_->GetBufferPoolManager();
+  if (writer->page_ != nullptr) {
+    bpm->UnpinPage(writer->run_.page_ids_.back(), true);
+  }
+  page_id_t page_id;
+  writer->page_ = reinterpret_cast<TmpTuplePage *>(bpm->NewPage(&page_id));
+  BUSTUB_ASSERT(writer->page_ != nullptr, "Couldn't allocate a page for a sorted run.");
+  writer->page_->Init(page_id, PAGE_SIZE);
+  writer->run_.page_ids_.push_back(page_id);
+  bool inserted __attribute__((unused)) = writer->page_->Insert(tmp, &tmp_tuple);
+  BUSTUB_ASSERT(inserted, "A sort record must fit in an empty page.");
+}
+
+void SortExecutor::FinishRun(RunWriter *writer) {
+  if (writer->page_ == nullptr) {
+    return;
+  }
+  exec_ctx_->GetBufferPoolManager()->UnpinPage(writer->run_.page_ids_.back(), true);
+  writer->page_ = nullptr;
+  runs_.push_back(std::move(writer->run_));
+  run_count_++;
+}
+
+void SortExecutor::AdvanceCursor(RunCursor *cursor) {
+  if (cursor->offset_idx_ == cursor->offsets_.size()) {
+    cursor->records_.clear();
+    cursor->offsets_.clear();
+    cursor->offset_idx_ = 0;
+    if (cursor->page_idx_ == cursor->page_ids_.size()) {
+      cursor->record_ = nullptr;
+      return;
+    }
+    // Copy the records of the next page out and delete it, so that a merge keeps no pages pinned.
+    BufferPoolManager *bpm = exec_ctx_->GetBufferPoolManager();
+    page_id_t page_id = cursor->page_ids_[cursor->page_idx_++];
+    auto page = reinterpret_cast<TmpTuplePage *>(bpm->FetchPage(page_id));
+    BUSTUB_ASSERT(page != nullptr, "Couldn't fetch a page of a sorted run.");
+    TmpTuple cur(INVALID_PAGE_ID, 0);
+    for (bool found = page->GetFirstTmpTuple(&cur); found; found = page->GetNextTmpTuple(cur, &cur)) {
+      cursor->offsets_.push_back(cur.GetOffset());
+    }
+    // A page is iterated from its newest record, i.e. backwards.
+    std::reverse(cursor->offsets_.begin(), cursor->offsets_.end());
+    for (size_t &offset : cursor->offsets_) {
+      const char *record = page->GetData() + offset;
+      offset = cursor->records_.size();
+      cursor->records_.append(record, RecordSize(record));
+    }
+    bpm->UnpinPage(page_id, false);
+    bpm->DeletePage(page_id);
+    BUSTUB_ASSERT(!cursor->offsets_.empty(), "A page of a sorted run cannot be empty.");
+  }
+  cursor->record_ = cursor->records_.data() + cursor->offsets_[cursor->offset_idx_++];
+}
+
+void SortExecutor::OpenMerge(std::vector<SortRun> &&runs, RunMerge *merge) {
+  size_t run_count = runs.size();
+  merge->cursors_.clear();
+  merge->cursors_.resize(run_count);
+  for (size_t i = 0; i < run_count; i++) {
+    merge->cursors_[i].page_ids_ = std::move(runs[i].page_ids_);
+    AdvanceCursor(&merge->cursors_[i]);
+  }
+  // Play the initial tournament bottom-up: node n has children 2n and 2n + 1, and the leaves follow the inner nodes.
+  std::vector<size_t> winners(2 * run_count);
+  for (size_t i = 0; i < run_count; i++) {
+    winners[run_count + i] = i;
+  }
+  merge->losers_.assign(run_count, 0);
+  for (size_t node = run_count - 1; node >= 1; node--) {
+    size_t a = winners[2 * node];
+    size_t b = winners[2 * node + 1];
+    bool a_wins = CursorLess(*merge, a, b);
+    winners[node] = a_wins ? a : b;
+    merge->losers_[node] = a_wins ? b : a;
+  }
+  merge->winner_ = winners[1];
+}
+
+void SortExecutor::AdvanceMerge(RunMerge *merge) {
+  size_t winner = merge->winner_;
+  AdvanceCursor(&merge->cursors_[winner]);
+  // Only the matches on the path from the winner's leaf to the root can change.
+  for (size_t node = (merge->cursors_.size() + winner) / 2; node >= 1; node /= 2) {
+    if (CursorLess(*merge, merge->losers_[node], winner)) {
+      std::swap(merge->losers_[node], winner);
+    }
+  }
+  merge->winner_ = winner;
+}
+
+bool SortExecutor::CursorLess(const RunMerge &merge, size_t a, size_t b) const {
+  const char *a_record = merge.cursors_[a].record_;
+  const char *b_record = merge.cursors_[b].record_;
+  if (a_record == nullptr || b_record == nullptr) {
+    // An exhausted run loses every match.
+    return b_record == nullptr && a_record != nullptr;
+  }
+  int cmp = CompareRecords(a_record, b_record);
+  // Ties go to the earlier run, which keeps rows with equal keys in input order across runs.
+  return cmp != 0 ? cmp < 0 : a < b;
+}
+
+void SortExecutor::DropRuns() {
+  BufferPoolManager *bpm = exec_ctx_->GetBufferPoolManager();
+  for (const auto &run : runs_) {
+    for (page_id_t page_id : run.page_ids_) {
+      bpm->DeletePage(page_id);
+    }
+  }
+  runs_.clear();
+  for (const auto &cursor : merge_.cursors_) {
+    for (size_t page_idx = cursor.page_idx_; page_idx < cursor.page_ids_.size(); page_idx++) {
+      bpm->DeletePage(cursor.page_ids_[page_idx]);
+    }
+  }
+  merge_.cursors_.clear();
+  merge_.losers_.clear();
+  merging_ = false;
+}
+
+}  // namespace bustub
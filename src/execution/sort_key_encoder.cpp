@@ -0,0 +1,97 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// sort_key_encoder.cpp
+//
+// Identification: src/execution/sort_key_encoder.cpp
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/sort_key_encoder.h"
+
+#include <cstring>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+namespace {
+
+/** Appends the low width bytes of bits, most significant first. */
+void AppendBigEndian(uint64_t bits, size_t width, std::string *key) {
+  for (size_t i = width; i > 0; i--) {
+    key->push_back(static_cast<char>(bits >> (8 * (i - 1))));
+  }
+}
+
+}  // namespace
+
+void SortKeyEncoder::EncodeRow(const TupleBatch *batch, uint32_t row_idx, std::string *key) const {
+  for (const auto &[order_by_type, expr] : order_bys_) {
+    EncodeValue(expr->EvaluateRow(batch, row_idx), order_by_type, key);
+  }
+}
+
+void SortKeyEncoder::EncodeTuple(const Tuple *tuple, const Schema *schema, std::string *key) const {
+  for (const auto &[order_by_type, expr] : order_bys_) {
+    EncodeValue(expr->Evaluate(tuple, schema), order_by_type, key);
+  }
+}
+
+void SortKeyEncoder::EncodeValue(const Value &value, OrderByType order_by_type, std::string *key) {
+  size_t begin = key->size();
+  if (value.IsNull()) {
+    key->push_back(0);
+  } else {
+    key->push_back(1);
+    switch (value.GetTypeId()) {
+      case TypeId::BOOLEAN:
+        key->push_back(value.GetAs<int8_t>());
+        break;
+      case TypeId::TINYINT:
+      case TypeId::SMALLINT:
+      case TypeId::INTEGER:
+      case TypeId::BIGINT: {
+        size_t width = Type::GetTypeSize(value.GetTypeId());
+        uint64_t sign = uint64_t{1} << (8 * width - 1);
+        AppendBigEndian(static_cast<uint64_t>(TupleBatch::IntegerOf(value)) ^ sign, width, key);
+        break;
+      }
+      case TypeId::DECIMAL: {
+        // -0.0 and 0.0 compare equal, so they get the same key.
+        double decimal = value.GetAs<double>() == 0 ? 0.0 : value.GetAs<double>();
+        uint64_t bits;
+        memcpy(&bits, &decimal, sizeof(bits));
+        AppendBigEndian((bits >> 63) != 0 ? ~bits : bits ^ (uint64_t{1} << 63), sizeof(bits), key);
+        break;
+      }
+      case TypeId::TIMESTAMP:
+        AppendBigEndian(value.GetAs<uint64_t>(), sizeof(uint64_t), key);
+        break;
+      case TypeId::VARCHAR: {
+        const char *data = value.GetData();
+        for (uint32_t i = 0; i + 1 < value.GetLength(); i++) {
+          key->push_back(data[i]);
+          if (data[i] == 0) {
+            key->push_back(static_cast<char>(0xFF));
+          }
+        }
+        key->push_back(0);
+        key->push_back(0);
+        break;
+      }
+      default:
+        UNREACHABLE("Unsupported sort key type.");
+    }
+  }
+  if (order_by_type == OrderByType::Descending) {
+    for (size_t i = begin; i < key->size(); i++) {
+      (*key)[i] = static_cast<char>(~(*key)[i]);
+    }
+  }
+}
+
+}  // namespace bustub
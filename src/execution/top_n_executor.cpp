@@ -0,0 +1,86 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// top_n_executor.cpp
+//
+// Identification: src/execution/top_n_executor.cpp
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#include <algorithm>
+#include <utility>
+
+#include "execution/executors/top_n_executor.h"
+
+namespace bustub {
+
+TopNExecutor::TopNExecutor(ExecutorContext *exec_ctx, const LimitPlanNode *limit_plan, const SortPlanNode *sort_plan,
+                           std::unique_ptr<AbstractExecutor> &&child)
+    : AbstractExecutor(exec_ctx),
+      limit_plan_(limit_plan),
+      sort_plan_(sort_plan),
+      child_(std::move(child)),
+      encoder_(sort_plan_->GetOrderBys()) {}
+
+void TopNExecutor::Init() {
+  entries_.clear();
+  heap_.clear();
+  output_idx_ = limit_plan_->GetOffset();
+  child_->Init();
+  size_t capacity = limit_plan_->GetLimit() + limit_plan_->GetOffset();
+  if (capacity == 0) {
+    return;
+  }
+  entries_.reserve(capacity);
+  auto heap_less = [this](uint32_t a, uint32_t b) { return EntryLess(a, b); };
+  TupleBatch batch(child_->GetOutputSchema());
+  std::string key;
+  uint64_t seq = 0;
+  while (child_->NextBatch(&batch)) {
+    for (uint32_t row_idx = 0; row_idx < batch.GetRowCount(); row_idx++, seq++) {
+      key.clear();
+      encoder_.EncodeRow(&batch, row_idx, &key);
+      if (heap_.size() < capacity) {
+        heap_.push_back(static_cast<uint32_t>(entries_.size()));
+        entries_.push_back({key, batch.GetTuple(row_idx), batch.GetRid(row_idx), seq});
+        std::push_heap(heap_.begin(), heap_.end(), heap_less);
+        continue;
+      }
+      // The row replaces the worst kept row only if it sorts strictly before it, since it comes later in the input.
+      const TopNEntry &top = entries_[heap_.front()];
+      if (SortKeyEncoder::Compare(key.data(), key.size(), top.key_.data(), top.key_.size()) >= 0) {
+        continue;
+      }
+      std::pop_heap(heap_.begin(), heap_.end(), heap_less);
+      TopNEntry &slot = entries_[heap_.back()];
+      slot.key_.swap(key);
+      slot.tuple_ = batch.GetTuple(row_idx);
+      slot.rid_ = batch.GetRid(row_idx);
+      slot.seq_ = seq;
+      std::push_heap(heap_.begin(), heap_.end(), heap_less);
+    }
+  }
+  std::sort_heap(heap_.begin(), heap_.end(), heap_less);
+}
+
+bool TopNExecutor::Next(Tuple *tuple, RID *rid) {
+  if (output_idx_ >= heap_.size()) {
+    return false;
+  }
+  const TopNEntry &entry = entries_[heap_[output_idx_++]];
+  *tuple = entry.tuple_;
+  *rid = entry.rid_;
+  return true;
+}
+
+bool TopNExecutor::EntryLess(uint32_t a, uint32_t b) const {
+  const TopNEntry &a_entry = entries_[a];
+  const TopNEntry &b_entry = entries_[b];
+  int cmp = SortKeyEncoder::Compare(a_entry.key_.data(), a_entry.key_.size(), b_entry.key_.data(),
+                                    b_entry.key_.size());
+  return cmp != 0 ? cmp < 0 : a_entry.seq_ < b_entry.seq_;
+}
+
+}  // namespace bustub
@@ -15,6 +15,7 @@
 #include <list>
 #include <mutex>  // NOLINT
 #include <unordered_map>
+#include <vector>
 
 #include "buffer/lru_replacer.h"
 #include "recovery/log_manager.h"
@@ -25,6 +26,9 @@ namespace bustub {
 
 /**
  * BufferPoolManager reads disk pages to and from its internal buffer pool.
+ *
+ * With logging enabled, a dirty page is written only after the log up to its LSN is persistent (write-ahead logging),
+ * whether it is evicted or flushed.
  */
 class BufferPoolManager {
  public:
@@ -88,6 +92,13 @@ class BufferPoolManager {
    */
   void FlushAllPages();
 
+  /**
+   * Collects the ids of the pages in the buffer pool that are dirty or pinned; a pinned page may have been changed and
+   * not been marked dirty yet.
+   * @param[out] page_ids the ids of the pages
+   */
+  void GetDirtyPageIds(std::vector<page_id_t> *page_ids);
+
  protected:
   /** Number of pages in the buffer pool. */
   size_t pool_size_;
@@ -96,7 +107,7 @@ class BufferPoolManager {
   /** Pointer to the disk manager. */
   DiskManager *disk_manager_;
   /** Pointer to the log manager. */
-  LogManager *log_manager_ __attribute__((__unused__));
+  LogManager *log_manager_;
   /** Page table for keeping track of buffer pool pages. */
   std::unordered_map<page_id_t, frame_id_t> page_table_;
   /** Replacer to find unpinned pages for replacement. */
@@ -106,21 +117,26 @@ class BufferPoolManager {
   /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
   std::mutex latch_;
 
-  frame_id_t FindFrameId() {
-    frame_id_t frame_id = -1;
-    if (!free_list_.empty()) {
-      frame_id = free_list_.front();
-      free_list_.pop_front();
-    } else if (replacer_->Size() > 0) {
-      replacer_->Victim(&frame_id);
-      page_table_.erase(pages_[frame_id].page_id_);
-      if (pages_[frame_id].is_dirty_) {
-        disk_manager_->WritePage(pages_[frame_id].page_id_, pages_[frame_id].GetData());
-      }
-    }
-    return frame_id;
+  /**
+   * Takes a frame from the free list, or evicts the page of a victim frame. A dirty victim whose log records are not
+   * persistent yet is written once the log is flushed, unless it is fetched meanwhile and the search starts over.
+   * @param lock the lock on latch_, which is released while the log is flushed
+   * @return the frame, or -1 if every frame is pinned
+   */
+  frame_id_t FindFrameId(std::unique_lock<std::mutex> *lock);
+
+  /** @return true if the log records that changed a page are persistent, or if nothing is logged */
+  bool IsLogged(Page *page) {
+    return !enable_logging || log_manager_ == nullptr || page->GetLSN() <= log_manager_->GetPersistentLSN();
   }
 
+  /**
+   * Flushes the log up to the LSN of the page of a frame. latch_ is released meanwhile, so that other threads do not
+   * wait for the log; the page is pinned, so that it is neither evicted nor deleted.
+   * @param lock the lock on latch_
+   */
+  void WaitForLog(frame_id_t frame_id, std::unique_lock<std::mutex> *lock);
+
   void InitNewPage(frame_id_t frame_id, page_id_t page_id) {
     pages_[frame_id].page_id_ = page_id;
     pages_[frame_id].pin_count_ = 1;
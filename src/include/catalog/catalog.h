@@ -78,7 +78,7 @@ class Catalog {
   TableMetadata *CreateTable(Transaction *txn, const std::string &table_name, const Schema &schema) {
     BUSTUB_ASSERT(names_.count(table_name) == 0, "Table names should be unique!");
     table_oid_t new_table_id = next_table_oid_++;
-    TableHeap *new_table = new TableHeap(bpm_, lock_manager_, log_manager_, txn);
+    TableHeap *new_table = new TableHeap(bpm_, lock_manager_, log_manager_, txn, new_table_id);
     TableMetadata *new_table_metadata =
         new TableMetadata(schema, table_name, std::unique_ptr<TableHeap>(new_table), new_table_id);
     tables_.insert({new_table_id, std::unique_ptr<TableMetadata>(new_table_metadata)});
@@ -110,17 +110,42 @@ class Catalog {
   IndexInfo *CreateIndex(Transaction *txn, const std::string &index_name, const std::string &table_name,
                          const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs,
                          size_t keysize) {
-    return nullptr;
+    index_oid_t new_index_id = next_index_oid_++;
+    auto *index_metadata = new IndexMetadata(index_name, table_name, &schema, key_attrs);
+    auto index = std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(index_metadata, bpm_);
+    // Populate the index with the tuples already present in the table.
+    TableHeap *table = GetTable(table_name)->table_.get();
+    for (auto it = table->Begin(txn); it != table->End(); ++it) {
+      index->InsertEntry(it->KeyFromTuple(schema, key_schema, key_attrs), it->GetRid(), txn);
+    }
+    auto *new_index_info = new IndexInfo(key_schema, index_name, std::move(index), new_index_id, table_name, keysize);
+    indexes_.insert({new_index_id, std::unique_ptr<IndexInfo>(new_index_info)});
+    index_names_[table_name].insert({index_name, new_index_id});
+    return new_index_info;
   }
 
   /** @return index info by name. Throw a std::out_of_range exception if no such index exists. */
-  IndexInfo *GetIndex(const std::string &index_name, const std::string &table_name) { return nullptr; }
+  IndexInfo *GetIndex(const std::string &index_name, const std::string &table_name) {
+    index_oid_t target = index_names_.at(table_name).at(index_name);
+    return indexes_.at(target).get();
+  }
 
   /** @return index metadata by oid */
-  IndexInfo *GetIndex(index_oid_t index_oid) { return nullptr; }
+  IndexInfo *GetIndex(index_oid_t index_oid) { return indexes_.at(index_oid).get(); }
 
   /** @return a vector of index infos for a given table. */
-  std::vector<IndexInfo *> GetTableIndexes(const std::string &table_name) { return std::vector<IndexInfo *>(); }
+  std::vector<IndexInfo *> GetTableIndexes(const std::string &table_name) {
+    std::vector<IndexInfo *> result;
+    auto table_indexes = index_names_.find(table_name);
+    if (table_indexes == index_names_.end()) {
+      return result;
+    }
+    result.reserve(table_indexes->second.size());
+    for (const auto &entry : table_indexes->second) {
+      result.push_back(indexes_.at(entry.second).get());
+    }
+    return result;
+  }
 
  private:
   [[maybe_unused]] BufferPoolManager *bpm_;
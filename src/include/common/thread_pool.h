@@ -0,0 +1,78 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// thread_pool.h
+//
+// Identification: src/include/common/thread_pool.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <functional>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * ThreadPool runs tasks on a set of worker threads that are reused across tasks and queries.
+ *
+ * The pool is elastic: a task that is submitted while no worker is idle starts a new worker instead of waiting for a
+ * busy one. Tasks of the execution engine may block on each other (the producers of an exchange wait for room in the
+ * queues of their consumer), so a fixed number of workers could deadlock on a deep enough plan. Workers never exit
+ * before the pool is destroyed, so the pool grows to the largest number of tasks that ever ran at once.
+ */
+class ThreadPool {
+ public:
+  ThreadPool() = default;
+
+  /** Runs the tasks that are still queued, then joins every worker. */
+  ~ThreadPool();
+
+  DISALLOW_COPY_AND_MOVE(ThreadPool);
+
+  /**
+   * Runs a task on a worker thread. The task must not throw.
+   * @param task the task
+   */
+  void Submit(std::function<void()> &&task);
+
+  /**
+   * Runs task(0), ..., task(task_count - 1) in parallel and waits for all of them. task(0) runs on the calling thread.
+   * If some tasks throw, the first exception caught is rethrown once every task has finished.
+   * @param task_count the number of tasks
+   * @param task the task, called with the index of each task
+   */
+  void Run(size_t task_count, const std::function<void(size_t)> &task);
+
+  /** @return the number of worker threads */
+  size_t GetThreadCount();
+
+ private:
+  /** The loop of every worker thread. */
+  void WorkerLoop();
+
+  /** Protects the members below. */
+  std::mutex latch_;
+  /** Signaled when a task is queued or the pool shuts down. */
+  std::condition_variable cv_;
+  /** The tasks that no worker has picked up yet. */
+  std::deque<std::function<void()>> tasks_;
+  /** The worker threads. */
+  std::vector<std::thread> threads_;
+  /** The number of workers waiting for a task. */
+  size_t idle_count_{0};
+  /** True once the pool is being destroyed. */
+  bool shutdown_{false};
+};
+
+}  // namespace bustub
@@ -13,6 +13,8 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <chrono>  // NOLINT
 #include <condition_variable>  // NOLINT
 #include <list>
 #include <memory>
@@ -29,44 +31,109 @@ namespace bustub {
 class TransactionManager;
 
 /**
- * LockManager handles transactions asking for locks on records.
+ * DeadlockMode enumerates the ways in which a LockManager deals with deadlocks. DETECTION lets transactions wait and
+ * aborts the youngest transaction of a cycle in the waits-for graph. The other two prevent cycles by deciding at once
+ * whether a request that conflicts with another transaction may wait, using the transaction ids as ages:
+ * under WOUND_WAIT an older transaction aborts the younger ones in its way and a younger one waits, and under
+ * WAIT_DIE an older transaction waits and a younger one aborts itself.
+ */
+enum class DeadlockMode { DETECTION, WOUND_WAIT, WAIT_DIE };
+
+/**
+ * LockManager handles transactions asking for locks on tables, pages and records.
+ *
+ * Locks follow two-phase locking: the first unlock moves a transaction from GROWING to SHRINKING, after which it may
+ * not take locks any more. Only READ_COMMITTED may release shared locks early without shrinking, and READ_UNCOMMITTED
+ * takes no shared locks at all.
+ *
+ * Locking is multi-granular. A lock on a table or a page implicitly locks all of its rows, and a transaction announces
+ * row locks by intention locks on the page and the table of the row, which LockRow() takes on its own. A transaction
+ * that holds more than escalation_threshold row locks on a table trades them, and its page locks on the table, for a
+ * single shared or exclusive table lock, provided that the table lock can be granted at once; until it can, the
+ * transaction keeps taking row locks. Locks already covered by a table or page lock are not taken at all.
+ *
+ * Every table, page and RID has a FIFO queue of lock requests. A request is granted once it is compatible with every
+ * granted request and every request ahead of it; until then the requesting thread waits on the condition variable of
+ * the queue. The lock table is split into LOCK_TABLE_SHARDS shards by the hash of the locked item, each with its own
+ * latch, so that transactions locking different items rarely contend on the same latch.
+ *
+ * Deadlocks are detected incrementally. A waiting transaction keeps its outgoing edges of the waits-for graph up to
+ * date each time it wakes up and still cannot be granted, and drops them once it stops waiting. Whenever a waiter
+ * gains an edge, the cycle detection thread is woken up to check for a cycle through that waiter only; the youngest
+ * transaction of a cycle, i.e. the one with the highest id, is aborted and woken up.
  */
 class LockManager {
-  enum class LockMode { SHARED, EXCLUSIVE };
+ public:
+  /** The default number of row locks on one table above which a transaction escalates to a table lock. */
+  static constexpr size_t DEFAULT_ESCALATION_THRESHOLD = 1000;
+
+  /** Counters of the cycle detection thread. */
+  struct DetectionStats {
+    /** The number of cycle checks, one per waiter that gained edges. */
+    uint64_t checks_{0};
+    /** The number of deadlocks found, i.e. of transactions aborted. */
+    uint64_t deadlocks_{0};
+    /** The time from the edge that closed a cycle being added to the victim being picked, summed and at most. */
+    std::chrono::nanoseconds total_detection_latency_{0};
+    std::chrono::nanoseconds max_detection_latency_{0};
+    /** The time that a pass of the detection thread held the graph latch, summed and at most. */
+    std::chrono::nanoseconds total_pause_{0};
+    std::chrono::nanoseconds max_pause_{0};
+  };
 
+ private:
   class LockRequest {
    public:
-    LockRequest(txn_id_t txn_id, LockMode lock_mode) : txn_id_(txn_id), lock_mode_(lock_mode), granted_(false) {}
+    LockRequest(txn_id_t txn_id, LockMode lock_mode, Transaction *txn = nullptr)
+        : txn_id_(txn_id), lock_mode_(lock_mode), granted_(false), txn_(txn) {}
 
     txn_id_t txn_id_;
     LockMode lock_mode_;
     bool granted_;
+    /** The requesting transaction, which a wound aborts. */
+    Transaction *txn_;
   };
 
   class LockRequestQueue {
    public:
     std::list<LockRequest> request_queue_;
-    std::condition_variable cv_;  // for notifying blocked transactions on this rid
+    std::condition_variable cv_;  // for notifying blocked transactions on this item
     bool upgrading_ = false;
   };
 
  public:
   /**
-   * Creates a new lock manager configured for the deadlock detection policy.
+   * Creates a new lock manager configured for a deadlock policy. Only DETECTION runs the cycle detection thread.
+   * @param deadlock_mode the deadlock policy
+   * @param escalation_threshold the number of row locks on one table above which a transaction escalates
    */
-  LockManager() {
-    enable_cycle_detection_ = true;
-    cycle_detection_thread_ = new std::thread(&LockManager::RunCycleDetection, this);
-    LOG_INFO("Cycle detection thread launched");
+  explicit LockManager(DeadlockMode deadlock_mode = DeadlockMode::DETECTION,
+                       size_t escalation_threshold = DEFAULT_ESCALATION_THRESHOLD)
+      : deadlock_mode_(deadlock_mode), escalation_threshold_(escalation_threshold) {
+    enable_cycle_detection_ = deadlock_mode_ == DeadlockMode::DETECTION;
+    if (enable_cycle_detection_) {
+      cycle_detection_thread_ = new std::thread(&LockManager::RunCycleDetection, this);
+      LOG_INFO("Cycle detection thread launched");
+    }
   }
 
   ~LockManager() {
-    enable_cycle_detection_ = false;
+    if (cycle_detection_thread_ == nullptr) {
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> guard(latch_);
+      enable_cycle_detection_ = false;
+    }
+    detection_cv_.notify_all();
     cycle_detection_thread_->join();
     delete cycle_detection_thread_;
     LOG_INFO("Cycle detection thread stopped");
   }
 
+  /** @return the deadlock policy of this lock manager */
+  DeadlockMode GetDeadlockMode() const { return deadlock_mode_; }
+
   /*
    * [LOCK_NOTE]: For all locking functions, we:
    * 1. return false if the transaction is aborted; and
@@ -107,6 +174,55 @@ class LockManager {
    */
   bool Unlock(Transaction *txn, const RID &rid);
 
+  /**
+   * Acquire a lock on a table, or convert the lock that the transaction holds on it to the weakest mode that covers
+   * both the held and the requested mode. See [LOCK_NOTE] in header file, except that locking a table again is fine.
+   * @param txn the transaction requesting the lock
+   * @param table_oid the table to be locked
+   * @param lock_mode the mode in which the table is to be locked
+   * @return true if the lock is granted, false otherwise
+   */
+  bool LockTable(Transaction *txn, table_oid_t table_oid, LockMode lock_mode);
+
+  /**
+   * Acquire a lock on a page of a table, after the matching intention lock on the table. Nothing is locked beyond the
+   * intention lock if the table lock already covers the page. See LockTable() for locking a page again.
+   * @param txn the transaction requesting the lock
+   * @param table_oid the table of the page
+   * @param page_id the page to be locked
+   * @param lock_mode the mode in which the page is to be locked
+   * @return true if the lock is granted, false otherwise
+   */
+  bool LockPage(Transaction *txn, table_oid_t table_oid, page_id_t page_id, LockMode lock_mode);
+
+  /**
+   * Acquire a lock on a row of a table, after the matching intention locks on the table and the page of the row.
+   * Nothing is locked beyond the intention locks if a table or page lock already covers the row, and a shared row
+   * lock is upgraded if an exclusive one is asked for. Locking a row may escalate the row locks of the transaction on
+   * the table to a table lock, which never waits.
+   * @param txn the transaction requesting the lock
+   * @param table_oid the table of the row
+   * @param rid the row to be locked
+   * @param lock_mode SHARED or EXCLUSIVE
+   * @return true if the lock is granted, false otherwise
+   */
+  bool LockRow(Transaction *txn, table_oid_t table_oid, const RID &rid, LockMode lock_mode);
+
+  /**
+   * Release the lock held by the transaction on a table. Its row and page locks on the table should be gone already.
+   * @return true if the unlock is successful, false otherwise
+   */
+  bool UnlockTable(Transaction *txn, table_oid_t table_oid);
+
+  /**
+   * Release the lock held by the transaction on a page. Its row locks on the page should be gone already.
+   * @return true if the unlock is successful, false otherwise
+   */
+  bool UnlockPage(Transaction *txn, page_id_t page_id);
+
+  /** @return the number of tables, pages and records with lock requests, for testing only! */
+  size_t GetLockTableSize();
+
   /*** Graph API ***/
   /**
    * Adds edge t1->t2
@@ -131,15 +247,201 @@ class LockManager {
   /** Runs cycle detection in the background. */
   void RunCycleDetection();
 
+  /** @return the counters of the cycle detection thread */
+  DetectionStats GetDetectionStats();
+
  private:
+  /** The number of shards of the lock table, a power of two. */
+  static constexpr size_t LOCK_TABLE_SHARDS = 16;
+
+  /** The kinds of items that can be locked. */
+  enum class LockGranularity : uint8_t { TABLE, PAGE, ROW };
+
+  /** A lockable item: a table by its oid, a page by its id or a row by its RID. */
+  struct LockKey {
+    LockGranularity granularity_;
+    int64_t id_;
+
+    bool operator==(const LockKey &other) const { return granularity_ == other.granularity_ && id_ == other.id_; }
+  };
+
+  /** Hashes lock keys. Ids are small and dense, so the bits are mixed for the shards, which use the top bits. */
+  struct LockKeyHash {
+    size_t operator()(const LockKey &key) const {
+      return (static_cast<uint64_t>(key.id_) * 4 + static_cast<uint64_t>(key.granularity_)) * 0x9E3779B97F4A7C15ULL;
+    }
+  };
+
+  static LockKey TableKey(table_oid_t table_oid) { return {LockGranularity::TABLE, table_oid}; }
+  static LockKey PageKey(page_id_t page_id) { return {LockGranularity::PAGE, page_id}; }
+  static LockKey RowKey(const RID &rid) { return {LockGranularity::ROW, rid.Get()}; }
+
+  /** A part of the lock table with its own latch. */
+  struct alignas(64) LockTableShard {
+    /** Protects lock_table_ and every queue in it. */
+    std::mutex latch_;
+    /** Lock table for lock requests. */
+    std::unordered_map<LockKey, LockRequestQueue, LockKeyHash> lock_table_;
+  };
+
+  /** @return the shard of the lock table that an item belongs to */
+  LockTableShard *GetShard(const LockKey &key);
+
+  /** @return true if two transactions may hold locks of these modes on the same item at once */
+  static bool AreCompatible(LockMode a, LockMode b);
+
+  /** @return true if a lock of mode held allows everything that a lock of mode requested allows */
+  static bool Covers(LockMode held, LockMode requested);
+
+  /** @return the weakest mode that covers both a and b */
+  static LockMode Combine(LockMode a, LockMode b);
+
+  /**
+   * @param mode the mode of a table or page lock
+   * @param[out] implicit_mode the mode in which the lock locks every page or row below it
+   * @return false if the lock only announces locks below it
+   */
+  static bool GetImplicitMode(LockMode mode, LockMode *implicit_mode);
+
+  /** Checks that a transaction may lock in a mode, i.e. that it is not shrinking, aborting it otherwise. */
+  void CheckLockable(Transaction *txn, LockMode lock_mode);
+
+  /** Appends a request to the queue of an item and waits until it is granted. */
+  void Acquire(Transaction *txn, const LockKey &key, LockMode lock_mode);
+
+  /**
+   * Converts the granted request of a transaction on an item to a stronger mode. The converted request goes ahead of
+   * every waiting request and waits until it is granted.
+   * @return false if the transaction holds no lock on the item
+   * @throws TransactionAbortException if another conversion is pending on the item, or on a deadlock
+   */
+  bool Convert(Transaction *txn, const LockKey &key, LockMode lock_mode);
+
+  /** Converts the granted request of a transaction on an item to a stronger mode if that is possible at once. */
+  bool TryConvert(Transaction *txn, const LockKey &key, LockMode lock_mode);
+
+  /** Removes the request of a transaction from the queue of an item. */
+  void Release(Transaction *txn, const LockKey &key);
+
+  /** Moves a transaction from GROWING to SHRINKING on an unlock, unless a READ_COMMITTED read lock is released. */
+  static void Shrink(Transaction *txn, bool read_lock);
+
+  /**
+   * Trades the row and page locks of a transaction on a table for a table lock, if the table lock can be granted at
+   * once. Called once the transaction holds more than escalation_threshold_ row locks on the table.
+   */
+  void Escalate(Transaction *txn, table_oid_t table_oid);
+
+  /**
+   * Turns a wound into the ABORTED state. Called on the thread of the transaction only, which owns its state.
+   * @return true if the transaction is aborted
+   */
+  static bool IsAborted(Transaction *txn);
+
+  /**
+   * Sets the state of a transaction to ABORTED and throws.
+   * @throws TransactionAbortException always
+   */
+  [[noreturn]] void AbortTransaction(Transaction *txn, AbortReason reason);
+
+  /** @return true if no granted request and no request ahead of the request in its queue conflicts with it */
+  static bool IsGrantable(const LockRequestQueue &queue, std::list<LockRequest>::iterator request);
+
+  /**
+   * Waits until a request is granted. If the transaction is aborted meanwhile, the request is removed and the
+   * transaction gives up.
+   * @param shard the shard of the item, whose latch is held by lock
+   * @param lock the lock on the latch of the shard
+   * @param key the item being locked
+   * @param request the request of the transaction in the queue of the item
+   * @param upgrade true if the request is an upgrade, whose queue is marked as upgrading
+   * @throws TransactionAbortException if the transaction was aborted while waiting
+   */
+  void WaitForGrant(LockTableShard *shard, std::unique_lock<std::mutex> *lock, Transaction *txn, const LockKey &key,
+                    std::list<LockRequest>::iterator request, bool upgrade = false);
+
+  /** @return the granted requests and the requests ahead of a request that conflict with it, i.e. it waits for */
+  static std::vector<LockRequest *> GetBlockers(LockRequestQueue *queue, std::list<LockRequest>::iterator request);
+
+  /**
+   * Applies the deadlock prevention policy to a request that cannot be granted yet: wounds the younger blockers under
+   * WOUND_WAIT, and tells the requesting transaction to die under WAIT_DIE if a blocker is older.
+   * Called with the latch of the shard of the item held.
+   * @param[out] wake_up the items on whose queues wounded transactions wait, which have to be woken up
+   * @return false if the requesting transaction has to die rather than wait
+   */
+  bool PreventDeadlock(LockRequestQueue *queue, Transaction *txn, std::list<LockRequest>::iterator request,
+                       std::vector<LockKey> *wake_up);
+
+  /**
+   * Records that a transaction is about to wait on the queue of an item, so that a wound can wake it up.
+   * @return false if the transaction has been aborted and must not wait
+   */
+  bool RegisterWaiter(Transaction *txn, const LockKey &key);
+
+  /** Wakes up the waiters on the queues of some items. Called with no latch held. */
+  void WakeUp(const std::vector<LockKey> &keys);
+
+  /** Removes a request from the queue of an item, waking up the waiters or dropping the queue if it is now empty. */
+  static void RemoveRequest(LockTableShard *shard, const LockKey &key, std::list<LockRequest>::iterator request);
+
+  /**
+   * Replaces the outgoing edges of a waiting transaction by edges to the transactions whose requests block its
+   * request, and queues a cycle check if an edge is new. Called with the latch of the shard of the item held.
+   */
+  void UpdateWaitsFor(Transaction *txn, const LockKey &key, LockRequestQueue *queue,
+                      std::list<LockRequest>::iterator request);
+
+  /** Removes the outgoing edges and the waiter entry of a transaction that no longer waits. */
+  void ClearWaitsFor(txn_id_t txn_id);
+
+  /**
+   * Looks for a cycle through a transaction by a depth-first search from it. Called with latch_ held.
+   * @param txn_id the transaction
+   * @param[out] cycle the transactions on the cycle, if any
+   * @return true if there is a cycle through the transaction
+   */
+  bool FindCycle(txn_id_t txn_id, std::vector<txn_id_t> *cycle);
+
+  /** A transaction that waits for a lock. */
+  struct Waiter {
+    Transaction *txn_;
+    /** The item whose queue the transaction waits on. */
+    LockKey key_;
+  };
+
+  /** A waiter that gained edges and has to be checked for cycles. */
+  struct PendingCheck {
+    txn_id_t txn_id_;
+    /** When the edges were added. */
+    std::chrono::steady_clock::time_point added_;
+  };
+
+  /** The deadlock policy. */
+  const DeadlockMode deadlock_mode_;
+  /** The number of row locks on one table above which a transaction escalates. */
+  const size_t escalation_threshold_;
+
+  /**
+   * Protects the waits-for graph, waiters_, pending_checks_ and stats_. A transaction is aborted by another thread
+   * only with this latch held, which a waiter also holds when it registers itself.
+   */
   std::mutex latch_;
+  /** Signaled when a check is queued or the detection is disabled. */
+  std::condition_variable detection_cv_;
   std::atomic<bool> enable_cycle_detection_;
-  std::thread *cycle_detection_thread_;
+  std::thread *cycle_detection_thread_{nullptr};
 
-  /** Lock table for lock requests. */
-  std::unordered_map<RID, LockRequestQueue> lock_table_;
+  /** The shards of the lock table. */
+  std::array<LockTableShard, LOCK_TABLE_SHARDS> shards_;
   /** Waits-for graph representation. */
   std::unordered_map<txn_id_t, std::vector<txn_id_t>> waits_for_;
+  /** The transactions that wait for a lock. */
+  std::unordered_map<txn_id_t, Waiter> waiters_;
+  /** The checks queued for the cycle detection thread. */
+  std::vector<PendingCheck> pending_checks_;
+  /** The counters of the cycle detection thread. */
+  DetectionStats stats_;
 };
 
 }  // namespace bustub
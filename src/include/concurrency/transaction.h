@@ -17,7 +17,9 @@
 #include <memory>
 #include <string>
 #include <thread>  // NOLINT
+#include <unordered_map>
 #include <unordered_set>
+#include <utility>
 
 #include "common/config.h"
 #include "common/logger.h"
@@ -44,9 +46,17 @@ namespace bustub {
 enum class TransactionState { GROWING, SHRINKING, COMMITTED, ABORTED };
 
 /**
- * Transaction isolation level.
+ * Transaction isolation level. A SNAPSHOT_ISOLATION transaction reads, without locks, the versions of the rows that
+ * were committed when it began (see VersionStore); its writes conflict with every write committed since.
  */
-enum class IsolationLevel { READ_UNCOMMITTED, REPEATABLE_READ, READ_COMMITTED };
+enum class IsolationLevel { READ_UNCOMMITTED, REPEATABLE_READ, READ_COMMITTED, SNAPSHOT_ISOLATION };
+
+/**
+ * Lock modes. Rows are locked SHARED or EXCLUSIVE. Tables and pages may also be locked in an intention mode, which
+ * announces locks on their rows: INTENTION_SHARED for shared row locks, INTENTION_EXCLUSIVE for exclusive row locks,
+ * and SHARED_INTENTION_EXCLUSIVE for a shared lock on the whole table or page plus exclusive row locks.
+ */
+enum class LockMode { SHARED, EXCLUSIVE, INTENTION_SHARED, INTENTION_EXCLUSIVE, SHARED_INTENTION_EXCLUSIVE };
 
 /**
  * Type of write operation.
@@ -155,7 +165,9 @@ class Transaction {
         txn_id_(txn_id),
         prev_lsn_(INVALID_LSN),
         shared_lock_set_{new std::unordered_set<RID>},
-        exclusive_lock_set_{new std::unordered_set<RID>} {
+        exclusive_lock_set_{new std::unordered_set<RID>},
+        table_lock_set_{new std::unordered_map<table_oid_t, LockMode>},
+        page_lock_set_{new std::unordered_map<page_id_t, std::pair<table_oid_t, LockMode>>} {
     // Initialize the sets that will be tracked.
     table_write_set_ = std::make_shared<std::deque<TableWriteRecord>>();
     index_write_set_ = std::make_shared<std::deque<IndexWriteRecord>>();
@@ -228,6 +240,33 @@ class Transaction {
   /** @return true if rid is exclusively locked by this transaction */
   bool IsExclusiveLocked(const RID &rid) { return exclusive_lock_set_->find(rid) != exclusive_lock_set_->end(); }
 
+  /** @return the table locks held by this transaction, by table */
+  inline std::shared_ptr<std::unordered_map<table_oid_t, LockMode>> GetTableLockSet() { return table_lock_set_; }
+
+  /** @return the page locks held by this transaction, by page, with the table of each page */
+  inline std::shared_ptr<std::unordered_map<page_id_t, std::pair<table_oid_t, LockMode>>> GetPageLockSet() {
+    return page_lock_set_;
+  }
+
+  /** @return the number of row locks taken by LockManager::LockRow() that this transaction holds, by table */
+  inline std::unordered_map<table_oid_t, size_t> *GetRowLockCounts() { return &row_lock_counts_; }
+
+  /**
+   * @return true if a row of a table is exclusively locked by this transaction, either itself or through an
+   * exclusive lock on its page or on the table
+   */
+  bool IsRowExclusiveLocked(table_oid_t table_oid, const RID &rid) {
+    if (IsExclusiveLocked(rid)) {
+      return true;
+    }
+    auto table = table_lock_set_->find(table_oid);
+    if (table != table_lock_set_->end() && table->second == LockMode::EXCLUSIVE) {
+      return true;
+    }
+    auto page = page_lock_set_->find(rid.GetPageId());
+    return page != page_lock_set_->end() && page->second.second == LockMode::EXCLUSIVE;
+  }
+
   /** @return the current state of the transaction */
   inline TransactionState GetState() { return state_; }
 
@@ -237,6 +276,33 @@ class Transaction {
    */
   inline void SetState(TransactionState state) { state_ = state; }
 
+  /**
+   * Marks the transaction to be aborted by a deadlock policy, from any thread. The state of the transaction is changed
+   * by its own thread only, once it notices the wound at its next lock request or when it commits.
+   */
+  inline void Wound() { wounded_ = true; }
+
+  /** @return true if the transaction has been wounded */
+  inline bool IsWounded() const { return wounded_; }
+
+  /** @return the commit timestamp of the snapshot that this transaction reads */
+  inline timestamp_t GetReadTs() const { return read_ts_; }
+
+  /**
+   * Set the read timestamp.
+   * @param read_ts the commit timestamp of the last transaction that committed before this one began
+   */
+  inline void SetReadTs(timestamp_t read_ts) { read_ts_ = read_ts; }
+
+  /** @return the commit timestamp of this transaction, once it has committed */
+  inline timestamp_t GetCommitTs() const { return commit_ts_; }
+
+  /**
+   * Set the commit timestamp.
+   * @param commit_ts new commit timestamp
+   */
+  inline void SetCommitTs(timestamp_t commit_ts) { commit_ts_ = commit_ts; }
+
   /** @return the previous LSN */
   inline lsn_t GetPrevLSN() { return prev_lsn_; }
 
@@ -249,6 +315,8 @@ class Transaction {
  private:
   /** The current transaction state. */
   TransactionState state_;
+  /** True once another transaction has wounded this one. */
+  std::atomic<bool> wounded_{false};
   /** The isolation level of the transaction. */
   IsolationLevel isolation_level_;
   /** The thread ID, used in single-threaded transactions. */
@@ -262,6 +330,10 @@ class Transaction {
   std::shared_ptr<std::deque<IndexWriteRecord>> index_write_set_;
   /** The LSN of the last record written by the transaction. */
   lsn_t prev_lsn_;
+  /** The commit timestamp of the snapshot that the transaction reads. */
+  timestamp_t read_ts_{0};
+  /** The commit timestamp of the transaction. */
+  timestamp_t commit_ts_{0};
 
   /** Concurrent index: the pages that were latched during index operation. */
   std::shared_ptr<std::deque<Page *>> page_set_;
@@ -272,6 +344,12 @@ class Transaction {
   std::shared_ptr<std::unordered_set<RID>> shared_lock_set_;
   /** LockManager: the set of exclusive-locked tuples held by this transaction. */
   std::shared_ptr<std::unordered_set<RID>> exclusive_lock_set_;
+  /** LockManager: the locks on tables held by this transaction. */
+  std::shared_ptr<std::unordered_map<table_oid_t, LockMode>> table_lock_set_;
+  /** LockManager: the locks on pages held by this transaction, with the table of each page. */
+  std::shared_ptr<std::unordered_map<page_id_t, std::pair<table_oid_t, LockMode>>> page_lock_set_;
+  /** LockManager: the number of row locks taken through LockRow() that are held, by table. */
+  std::unordered_map<table_oid_t, size_t> row_lock_counts_;
 };
 
 }  // namespace bustub
@@ -12,9 +12,13 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
+#include <map>
+#include <mutex>  // NOLINT
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "common/config.h"
 #include "concurrency/lock_manager.h"
@@ -26,6 +30,19 @@ class LockManager;
 
 /**
  * TransactionManager keeps track of all the transactions running in the system.
+ *
+ * It also issues the timestamps of multi-version concurrency control: a transaction reads the snapshot of the last
+ * commit before it began, and a committing transaction gets the next commit timestamp, with which it stamps the
+ * versions that it wrote before new snapshots may see them. Every commit then collects the versions of the tables it
+ * wrote that are older than the oldest running snapshot.
+ *
+ * With logging enabled, a transaction logs its BEGIN, COMMIT and ABORT records. A committing transaction waits for its
+ * COMMIT record to be persistent before any other transaction may see its writes; the log manager writes the COMMIT
+ * records of concurrent commits together (group commit).
+ *
+ * Running transactions are kept in a registry that is sharded by transaction id, so that transactions that begin and
+ * commit on different threads do not contend on a latch. Nothing blocks all transactions: checkpoints are fuzzy (see
+ * CheckpointManager).
  */
 class TransactionManager {
  public:
@@ -43,8 +60,9 @@ class TransactionManager {
   Transaction *Begin(Transaction *txn = nullptr, IsolationLevel isolation_level = IsolationLevel::REPEATABLE_READ);
 
   /**
-   * Commits a transaction.
+   * Commits a transaction. A wounded transaction is aborted instead.
    * @param txn the transaction to commit
+   * @throws TransactionAbortException if the transaction was wounded
    */
   void Commit(Transaction *txn);
 
@@ -55,31 +73,50 @@ class TransactionManager {
   void Abort(Transaction *txn);
 
   /**
-   * Global list of running transactions
+   * Locates and returns the running transaction with the given transaction ID.
+   * @param txn_id the id of the transaction to be found, it must exist!
+   * @return the transaction with the given transaction id
    */
+  Transaction *GetTransaction(txn_id_t txn_id);
 
-  /** The transaction map is a global list of all the running transactions in the system. */
-  static std::unordered_map<txn_id_t, Transaction *> txn_map;
+  /**
+   * Collects the transactions that have begun and not committed or aborted yet.
+   * @param[out] txns the running transactions
+   */
+  void GetRunningTransactions(std::vector<Transaction *> *txns);
 
   /**
-   * Locates and returns the transaction with the given transaction ID.
-   * @param txn_id the id of the transaction to be found, it must exist!
-   * @return the transaction with the given transaction id
+   * @return the oldest read timestamp of a running SNAPSHOT_ISOLATION transaction, or the last commit timestamp if
+   * there is none; no snapshot reads a version that was replaced at or before it
    */
-  static Transaction *GetTransaction(txn_id_t txn_id) {
-    assert(TransactionManager::txn_map.find(txn_id) != TransactionManager::txn_map.end());
-    auto *res = TransactionManager::txn_map[txn_id];
-    assert(res != nullptr);
-    return res;
+  timestamp_t GetWatermark();
+
+ private:
+  /** The number of shards of the registry of running transactions. */
+  static constexpr size_t REGISTRY_SHARD_COUNT = 64;
+
+  /** A shard of the registry, on a cache line of its own. */
+  struct alignas(64) RegistryShard {
+    std::mutex latch_;
+    std::unordered_map<txn_id_t, Transaction *> txns_;
+  };
+
+  RegistryShard &RegistryShardOf(txn_id_t txn_id) {
+    return registry_[static_cast<size_t>(txn_id) % REGISTRY_SHARD_COUNT];
   }
 
-  /** Prevents all transactions from performing operations, used for checkpointing. */
-  void BlockAllTransactions();
+  /** Removes a transaction that ends from the registry, and forgets its snapshot. */
+  void EndTransaction(Transaction *txn);
 
-  /** Resumes all transactions, used for checkpointing. */
-  void ResumeTransactions();
+  /** Forgets the snapshot of a transaction that ends. */
+  void EndSnapshot(Transaction *txn);
+
+  /**
+   * Appends a BEGIN, COMMIT or ABORT record of a transaction to the log, if logging is enabled.
+   * @return the LSN of the record, or INVALID_LSN if nothing was logged
+   */
+  lsn_t AppendLogRecord(Transaction *txn, LogRecordType log_record_type);
 
- private:
   /**
    * Releases all the locks held by the given transaction.
    * @param txn the transaction whose locks should be released
@@ -95,14 +132,37 @@ class TransactionManager {
     for (auto locked_rid : lock_set) {
       lock_manager_->Unlock(txn, locked_rid);
     }
+    // Pages and tables are unlocked after their rows.
+    std::vector<page_id_t> locked_pages;
+    for (const auto &item : *txn->GetPageLockSet()) {
+      locked_pages.push_back(item.first);
+    }
+    for (auto locked_page : locked_pages) {
+      lock_manager_->UnlockPage(txn, locked_page);
+    }
+    std::vector<table_oid_t> locked_tables;
+    for (const auto &item : *txn->GetTableLockSet()) {
+      locked_tables.push_back(item.first);
+    }
+    for (auto locked_table : locked_tables) {
+      lock_manager_->UnlockTable(txn, locked_table);
+    }
   }
 
   std::atomic<txn_id_t> next_txn_id_{0};
+  /** Serializes commits, so that a snapshot of the last commit timestamp sees every version stamped with it. */
+  std::mutex commit_latch_;
+  /** The timestamp of the last commit. */
+  std::atomic<timestamp_t> last_commit_ts_{0};
+  /** Protects snapshots_, and makes taking a snapshot atomic with respect to GetWatermark(). */
+  std::mutex snapshot_latch_;
+  /** The number of running SNAPSHOT_ISOLATION transactions, by read timestamp. */
+  std::map<timestamp_t, size_t> snapshots_;
   LockManager *lock_manager_ __attribute__((__unused__));
-  LogManager *log_manager_ __attribute__((__unused__));
+  LogManager *log_manager_;
 
-  /** The global transaction latch is used for checkpointing. */
-  ReaderWriterLatch global_txn_latch_;
+  /** The running transactions. */
+  std::array<RegistryShard, REGISTRY_SHARD_COUNT> registry_;
 };
 
 }  // namespace bustub
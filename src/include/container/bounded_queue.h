@@ -0,0 +1,125 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bounded_queue.h
+//
+// Identification: src/include/container/bounded_queue.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <utility>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * BoundedQueue is a lock-free FIFO queue of fixed capacity that any number of threads may push to and pop from.
+ *
+ * The queue is a ring of cells, each carrying a sequence number that tells whose turn it is: a producer may fill the
+ * cell at position pos when its sequence is pos, and a consumer may empty it when its sequence is pos + 1. Producers
+ * and consumers claim positions with a compare-and-swap on their own counter, so a push and a pop only contend on the
+ * cell they share. Neither operation blocks; a full or empty queue is reported to the caller, which decides how to
+ * wait.
+ */
+template <typename T>
+class BoundedQueue {
+ public:
+  /**
+   * Creates a new empty queue.
+   * @param capacity the minimum number of items that the queue holds; rounded up to a power of two
+   */
+  explicit BoundedQueue(size_t capacity) {
+    size_t cell_count = 2;
+    while (cell_count < capacity) {
+      cell_count *= 2;
+    }
+    mask_ = cell_count - 1;
+    cells_ = std::make_unique<Cell[]>(cell_count);
+    for (size_t pos = 0; pos < cell_count; pos++) {
+      cells_[pos].sequence_.store(pos, std::memory_order_relaxed);
+    }
+  }
+
+  DISALLOW_COPY_AND_MOVE(BoundedQueue);
+
+  /** @return the number of items that the queue holds */
+  size_t GetCapacity() const { return mask_ + 1; }
+
+  /**
+   * Appends an item, unless the queue is full.
+   * @param item the item, which is moved from if it was appended
+   * @return false if the queue is full
+   */
+  bool TryPush(T *item) {
+    size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    while (true) {
+      Cell &cell = cells_[pos & mask_];
+      size_t sequence = cell.sequence_.load(std::memory_order_acquire);
+      auto diff = static_cast<int64_t>(sequence) - static_cast<int64_t>(pos);
+      if (diff == 0) {
+        if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          cell.item_ = std::move(*item);
+          cell.sequence_.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        // The cell still holds the item pushed one lap ago.
+        return false;
+      } else {
+        pos = enqueue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /**
+   * Removes the oldest item, unless the queue is empty.
+   * @param[out] item the item
+   * @return false if the queue is empty
+   */
+  bool TryPop(T *item) {
+    size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+    while (true) {
+      Cell &cell = cells_[pos & mask_];
+      size_t sequence = cell.sequence_.load(std::memory_order_acquire);
+      auto diff = static_cast<int64_t>(sequence) - static_cast<int64_t>(pos + 1);
+      if (diff == 0) {
+        if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          *item = std::move(cell.item_);
+          cell.sequence_.store(pos + mask_ + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        // The cell has not been filled in this lap yet.
+        return false;
+      } else {
+        pos = dequeue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+ private:
+  /** A slot of the ring. */
+  struct Cell {
+    std::atomic<size_t> sequence_;
+    T item_;
+  };
+
+  /** The ring of cells. */
+  std::unique_ptr<Cell[]> cells_;
+  /** The number of cells minus one; positions are mapped to cells by masking. */
+  size_t mask_;
+  /** The position of the next push. Kept on its own cache line, away from the consumers' counter. */
+  alignas(64) std::atomic<size_t> enqueue_pos_{0};
+  /** The position of the next pop. */
+  alignas(64) std::atomic<size_t> dequeue_pos_{0};
+};
+
+}  // namespace bustub
@@ -0,0 +1,217 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// aggregation_hash_table.h
+//
+// Identification: src/include/execution/aggregation_hash_table.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "execution/expressions/abstract_expression.h"
+#include "execution/plans/aggregation_plan.h"
+#include "storage/table/tuple.h"
+#include "storage/table/tuple_batch.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * AggregationHashTable is an open-addressing hash table from group-by keys to typed aggregate accumulators.
+ *
+ * Every group-by value is encoded into one 64-bit word, so a group key is a fixed-width array of words that is compared
+ * and hashed without building Values. Integer, boolean and timestamp values are stored as their integer value, DECIMAL
+ * values as their bit pattern, and VARCHAR values as an index into a per-table string dictionary; NULL of a type is
+ * its null sentinel, so NULLs group together.
+ *
+ * Every aggregate has a typed 64-bit accumulator slot: COUNT keeps an int64 count, SUM an int64 (integer inputs) or
+ * double (DECIMAL input) sum, and MIN/MAX an int64 or double extreme. MIN/MAX over other types fall back to a Value.
+ * NULL inputs are ignored by SUM, MIN and MAX, and an aggregate that saw no input produces NULL.
+ *
+ * Groups are stored densely in insertion order, and the directory is a power-of-two array of group indexes probed
+ * linearly. It doubles when it is half full.
+ *
+ * A table with a memory budget freezes once creating a group makes it exceed the budget. A frozen table keeps
+ * aggregating the rows of its groups, but creates no more groups and reports the rows of missing groups instead, so
+ * that a spilling aggregation can process them later.
+ */
+class AggregationHashTable {
+ public:
+  /**
+   * Creates a new aggregation hash table.
+   * @param group_bys the group-by expressions
+   * @param agg_exprs the aggregate input expressions
+   * @param agg_types the aggregate functions
+   * @param memory_budget the number of bytes after which the table freezes, 0 for no limit
+   */
+  AggregationHashTable(const std::vector<const AbstractExpression *> &group_bys,
+                       const std::vector<const AbstractExpression *> &agg_exprs,
+                       const std::vector<AggregationType> &agg_types, size_t memory_budget = 0);
+
+  /**
+   * Aggregates a tuple.
+   * @param tuple the tuple
+   * @param schema the schema that the expressions are evaluated against
+   * @return false if the table is frozen and the group of the tuple is missing
+   */
+  bool Insert(const Tuple *tuple, const Schema *schema);
+
+  /**
+   * Aggregates every row of a batch. Group-by keys and aggregate inputs that are integer columns of the batch are read
+   * straight from the column arrays.
+   * @param batch the batch, laid out according to the schema that the expressions were built against
+   * @param[out] misses the rows that were not aggregated because the table is frozen and their group is missing; may
+   * only be nullptr for a table without a memory budget
+   */
+  void InsertBatch(const TupleBatch *batch, std::vector<uint32_t> *misses = nullptr);
+
+  /**
+   * Folds a group of another table into this table. Both tables must have been created with the same expressions.
+   * @param other the table that the group belongs to
+   * @param group_idx the index of the group in other
+   */
+  void MergeGroup(const AggregationHashTable &other, size_t group_idx);
+
+  /**
+   * Returns the hash that partitions a group. Unlike the directory hash, it does not depend on the string dictionary
+   * of the table, so the same group has the same partition hash in every table built with the same expressions.
+   * @param group_idx the index of the group
+   * @return the partition hash of the group
+   */
+  uint64_t GetPartitionHash(size_t group_idx) const;
+
+  /** @return the approximate number of bytes that the groups, the directory and the string dictionary occupy */
+  size_t GetMemoryUsage() const;
+
+  /** @return true if the table has exceeded its memory budget and creates no more groups */
+  bool IsFrozen() const { return frozen_; }
+
+  /** @return the number of groups */
+  size_t GetGroupCount() const { return group_count_; }
+
+  /**
+   * Materializes a group.
+   * @param group_idx the index of the group, in [0, GetGroupCount())
+   * @param[out] group_bys the group-by values of the group
+   * @param[out] aggregates the aggregate values of the group; an integer SUM has the type of its input
+   * @throws Exception OUT_OF_RANGE if an integer SUM does not fit its type
+   */
+  void GetGroup(size_t group_idx, std::vector<Value> *group_bys, std::vector<Value> *aggregates) const;
+
+ private:
+  /** The group index returned for a missing group. */
+  static constexpr size_t NO_GROUP = static_cast<size_t>(-1);
+  /** The encoding of a NULL VARCHAR. */
+  static constexpr int64_t VARCHAR_NULL_ID = -1;
+  /** The encoding of a VARCHAR that is not in the dictionary of a frozen table; it matches no group. */
+  static constexpr int64_t VARCHAR_UNKNOWN_ID = -2;
+
+  /** How an accumulator slot is updated. */
+  enum class SlotKind {
+    Count,
+    IntegerSum,
+    DecimalSum,
+    IntegerMin,
+    IntegerMax,
+    DecimalMin,
+    DecimalMax,
+    ValueMin,
+    ValueMax
+  };
+
+  /** How a value of a type is encoded into a 64-bit word. */
+  enum class Encoding { Integer, Decimal, Boolean, Timestamp, Varchar };
+
+  /** @return the encoding used for values of the given type */
+  static Encoding EncodingOf(TypeId type);
+
+  /** @return the hash of a group key */
+  static uint64_t HashKey(const int64_t *key, size_t key_words);
+
+  /**
+   * @param value the value to be encoded
+   * @param encoding the encoding of the value
+   * @param add_strings false to leave the string dictionary unchanged; a string that is not in it has no encoding then
+   * @return the word that encodes the value, or VARCHAR_UNKNOWN_ID for a string without an encoding
+   */
+  int64_t Encode(const Value &value, Encoding encoding, bool add_strings = true);
+
+  /** @return the value that the word encodes */
+  Value Decode(int64_t word, TypeId type) const;
+
+  /**
+   * @param key the key of the group
+   * @return the index of the group with the given key, which is created if it does not exist yet and the table is
+   * not frozen; NO_GROUP if the group does not exist and the table is frozen
+   */
+  size_t FindOrInsertGroup(const int64_t *key);
+
+  /** Doubles the directory and rehashes every group into it. */
+  void Grow();
+
+  /**
+   * Folds one aggregate input into a group.
+   * @param group_idx the group
+   * @param agg_idx the aggregate
+   * @param is_null true if the input is NULL
+   * @param word the input encoded as a word, used by the typed slots
+   * @param value the input as a Value, used by the Value slots only
+   */
+  void Accumulate(size_t group_idx, size_t agg_idx, bool is_null, int64_t word, const Value *value);
+
+  /** The group-by expressions. */
+  std::vector<const AbstractExpression *> group_bys_;
+  /** The aggregate input expressions. */
+  std::vector<const AbstractExpression *> agg_exprs_;
+  /** The aggregate functions. */
+  std::vector<AggregationType> agg_types_;
+  /** The type of each group-by value. */
+  std::vector<TypeId> key_types_;
+  /** The encoding of each group-by value. */
+  std::vector<Encoding> key_encodings_;
+  /** The input type of each aggregate. */
+  std::vector<TypeId> agg_input_types_;
+  /** The slot kind of each aggregate. */
+  std::vector<SlotKind> slot_kinds_;
+  /** True if some aggregate falls back to Value accumulators. */
+  bool has_value_slots_{false};
+  /** True if some group-by value is a VARCHAR. */
+  bool has_varchar_keys_{false};
+  /** The number of bytes after which the table freezes, 0 for no limit. */
+  size_t memory_budget_;
+  /** True once the table has exceeded its memory budget. */
+  bool frozen_{false};
+
+  /** The number of groups. */
+  size_t group_count_{0};
+  /** The keys of all groups, group_bys_.size() words per group. */
+  std::vector<int64_t> keys_;
+  /** The hash of every group key. */
+  std::vector<uint64_t> hashes_;
+  /** The accumulator slots of all groups, agg_exprs_.size() words per group; doubles are stored by bit pattern. */
+  std::vector<int64_t> slots_;
+  /** Whether each accumulator slot has seen a non-NULL input. */
+  std::vector<bool> seen_;
+  /** The accumulators of the MIN/MAX aggregates that fall back to Values, agg_exprs_.size() per group. */
+  std::vector<Value> value_slots_;
+  /** The directory: group index + 1 per bucket, 0 for an empty bucket. */
+  std::vector<uint32_t> directory_;
+
+  /** The strings of the VARCHAR group-by values, indexed by their encoding. */
+  std::vector<std::string> strings_;
+  /** The encoding of every string in strings_. */
+  std::unordered_map<std::string, int64_t> string_ids_;
+  /** The approximate number of bytes that strings_ and string_ids_ occupy. */
+  size_t string_bytes_{0};
+};
+
+}  // namespace bustub
@@ -16,12 +16,18 @@
 
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/catalog.h"
+#include "common/thread_pool.h"
 #include "concurrency/transaction_manager.h"
 #include "execution/executor_context.h"
 #include "execution/executor_factory.h"
 #include "execution/plans/abstract_plan.h"
 #include "storage/table/tuple.h"
+#include "storage/table/tuple_batch.h"
 namespace bustub {
+/**
+ * ExecutionEngine builds the executor tree of a plan and pulls it on the calling thread. The engine owns the worker
+ * thread pool that the exchanges and parallel operators of every query run on.
+ */
 class ExecutionEngine {
  public:
   ExecutionEngine(BufferPoolManager *bpm, TransactionManager *txn_mgr, Catalog *catalog)
@@ -32,6 +38,7 @@ class ExecutionEngine {
   bool Execute(const AbstractPlanNode *plan, std::vector<Tuple> *result_set, Transaction *txn,
                ExecutorContext *exec_ctx) {
     // construct executor
+    exec_ctx->SetThreadPool(&thread_pool_);
     auto executor = ExecutorFactory::CreateExecutor(exec_ctx, plan);
 
     // prepare
@@ -54,10 +61,39 @@ class ExecutionEngine {
     return true;
   }
 
+  /**
+   * Executes the plan a batch at a time.
+   * @param plan the plan to be executed
+   * @param[out] result_set the batches produced by the plan, may be nullptr
+   * @param txn the transaction that the plan runs in
+   * @param exec_ctx the executor context that the plan runs in
+   * @return true
+   */
+  bool ExecuteBatch(const AbstractPlanNode *plan, std::vector<TupleBatch> *result_set, Transaction *txn,
+                    ExecutorContext *exec_ctx) {
+    exec_ctx->SetThreadPool(&thread_pool_);
+    auto executor = ExecutorFactory::CreateExecutor(exec_ctx, plan);
+    executor->Init();
+    try {
+      TupleBatch batch(executor->GetOutputSchema());
+      while (executor->NextBatch(&batch)) {
+        if (result_set != nullptr) {
+          result_set->push_back(batch);
+        }
+      }
+    } catch (Exception &e) {
+      // this is where exceptions thrown by executors would be handled
+    }
+
+    return true;
+  }
+
  private:
   [[maybe_unused]] BufferPoolManager *bpm_;
   [[maybe_unused]] TransactionManager *txn_mgr_;
   [[maybe_unused]] Catalog *catalog_;
+  /** The worker threads shared by the queries that the engine executes. */
+  ThreadPool thread_pool_;
 };
 
 }  // namespace bustub
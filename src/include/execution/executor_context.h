@@ -17,6 +17,7 @@
 #include <vector>
 
 #include "catalog/catalog.h"
+#include "common/thread_pool.h"
 #include "concurrency/transaction.h"
 #include "storage/page/tmp_tuple_page.h"
 
@@ -60,12 +61,19 @@ class ExecutorContext {
   /** @return the transaction manager */
   TransactionManager *GetTransactionManager() { return txn_mgr_; }
 
+  /** @return the thread pool that runs the parallel parts of the query, nullptr if the context has none */
+  ThreadPool *GetThreadPool() { return thread_pool_; }
+
+  /** Sets the thread pool that runs the parallel parts of the query. */
+  void SetThreadPool(ThreadPool *thread_pool) { thread_pool_ = thread_pool; }
+
  private:
   Transaction *transaction_;
   Catalog *catalog_;
   BufferPoolManager *bpm_;
   TransactionManager *txn_mgr_;
   LockManager *lock_mgr_;
+  ThreadPool *thread_pool_{nullptr};
 };
 
 }  // namespace bustub
@@ -15,6 +15,7 @@
 #include <memory>
 
 #include "execution/executors/abstract_executor.h"
+#include "execution/parallel_instance.h"
 #include "execution/plans/abstract_plan.h"
 
 namespace bustub {
@@ -27,8 +28,11 @@ class ExecutorFactory {
    * Creates a new executor given the executor context and plan node.
    * @param exec_ctx the executor context for the created executor
    * @param plan the plan node that needs to be executed
+   * @param instance the copy of the plan that the executor belongs to if the plan is run in parallel below an
+   * exchange, nullptr otherwise
    * @return an executor for the given plan and context
    */
-  static std::unique_ptr<AbstractExecutor> CreateExecutor(ExecutorContext *exec_ctx, const AbstractPlanNode *plan);
+  static std::unique_ptr<AbstractExecutor> CreateExecutor(ExecutorContext *exec_ctx, const AbstractPlanNode *plan,
+                                                          const ParallelInstance *instance = nullptr);
 };
 }  // namespace bustub
@@ -14,10 +14,13 @@
 
 #include "execution/executor_context.h"
 #include "storage/table/tuple.h"
+#include "storage/table/tuple_batch.h"
 
 namespace bustub {
 /**
  * AbstractExecutor implements the Volcano tuple-at-a-time iterator model.
+ * Executors may additionally produce a batch of rows per call through NextBatch(). A consumer uses either Next() or
+ * NextBatch() on a given executor, never both.
  */
 class AbstractExecutor {
  public:
@@ -44,6 +47,22 @@ class AbstractExecutor {
    */
   virtual bool Next(Tuple *tuple, RID *rid) = 0;
 
+  /**
+   * Produces the next batch of rows from this executor. The default implementation fills the batch by calling Next();
+   * executors that can produce rows in columnar form override it.
+   * @param[out] batch the batch to be filled, laid out according to GetOutputSchema(); its previous rows are removed
+   * @return true if at least one row was produced, false if there are no more rows
+   */
+  virtual bool NextBatch(TupleBatch *batch) {
+    batch->Clear();
+    Tuple tuple;
+    RID rid;
+    while (!batch->IsFull() && Next(&tuple, &rid)) {
+      batch->AppendTuple(tuple, rid);
+    }
+    return !batch->IsEmpty();
+  }
+
   /** @return the schema of the tuples that this executor produces */
   virtual const Schema *GetOutputSchema() = 0;
 
@@ -17,140 +17,32 @@
 #include <utility>
 #include <vector>
 
-#include "common/util/hash_util.h"
-#include "container/hash/hash_function.h"
+#include "execution/aggregation_hash_table.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/expressions/abstract_expression.h"
 #include "execution/plans/aggregation_plan.h"
+#include "execution/plans/seq_scan_plan.h"
+#include "storage/page/tmp_tuple_page.h"
 #include "storage/table/tuple.h"
 #include "type/value_factory.h"
 
 namespace bustub {
-/**
- * A simplified hash table that has all the necessary functionality for aggregations.
- */
-class SimpleAggregationHashTable {
- public:
-  /**
-   * Create a new simplified aggregation hash table.
-   * @param agg_exprs the aggregation expressions
-   * @param agg_types the types of aggregations
-   */
-  SimpleAggregationHashTable(const std::vector<const AbstractExpression *> &agg_exprs,
-                             const std::vector<AggregationType> &agg_types)
-      : agg_exprs_{agg_exprs}, agg_types_{agg_types} {}
-
-  /** @return the initial aggregrate value for this aggregation executor */
-  AggregateValue GenerateInitialAggregateValue() {
-    std::vector<Value> values;
-    for (const auto &agg_type : agg_types_) {
-      switch (agg_type) {
-        case AggregationType::CountAggregate:
-          // Count starts at zero.
-          values.emplace_back(ValueFactory::GetIntegerValue(0));
-          break;
-        case AggregationType::SumAggregate:
-          // Sum starts at zero.
-          values.emplace_back(ValueFactory::GetIntegerValue(0));
-          break;
-        case AggregationType::MinAggregate:
-          // Min starts at INT_MAX.
-          values.emplace_back(ValueFactory::GetIntegerValue(BUSTUB_INT32_MAX));
-          break;
-        case AggregationType::MaxAggregate:
-          // Max starts at INT_MIN.
-          values.emplace_back(ValueFactory::GetIntegerValue(BUSTUB_INT32_MIN));
-          break;
-      }
-    }
-    return {values};
-  }
-
-  /** Combines the input into the aggregation result. */
-  void CombineAggregateValues(AggregateValue *result, const AggregateValue &input) {
-    for (uint32_t i = 0; i < agg_exprs_.size(); i++) {
-      switch (agg_types_[i]) {
-        case AggregationType::CountAggregate:
-          // Count increases by one.
-          result->aggregates_[i] = result->aggregates_[i].Add(ValueFactory::GetIntegerValue(1));
-          break;
-        case AggregationType::SumAggregate:
-          // Sum increases by addition.
-          result->aggregates_[i] = result->aggregates_[i].Add(input.aggregates_[i]);
-          break;
-        case AggregationType::MinAggregate:
-          // Min is just the min.
-          result->aggregates_[i] = result->aggregates_[i].Min(input.aggregates_[i]);
-          break;
-        case AggregationType::MaxAggregate:
-          // Max is just the max.
-          result->aggregates_[i] = result->aggregates_[i].Max(input.aggregates_[i]);
-          break;
-      }
-    }
-  }
-
-  /**
-   * Inserts a value into the hash table and then combines it with the current aggregation.
-   * @param agg_key the key to be inserted
-   * @param agg_val the value to be inserted
-   */
-  void InsertCombine(const AggregateKey &agg_key, const AggregateValue &agg_val) {
-    if (ht.count(agg_key) == 0) {
-      ht.insert({agg_key, GenerateInitialAggregateValue()});
-    }
-    CombineAggregateValues(&ht[agg_key], agg_val);
-  }
-
-  /**
-   * An iterator through the simplified aggregation hash table.
-   */
-  class Iterator {
-   public:
-    /** Creates an iterator for the aggregate map. */
-    explicit Iterator(std::unordered_map<AggregateKey, AggregateValue>::const_iterator iter) : iter_(iter) {}
-
-    /** @return the key of the iterator */
-    const AggregateKey &Key() { return iter_->first; }
-
-    /** @return the value of the iterator */
-    const AggregateValue &Val() { return iter_->second; }
-
-    /** @return the iterator before it is incremented */
-    Iterator &operator++() {
-      ++iter_;
-      return *this;
-    }
-
-    /** @return true if both iterators are identical */
-    bool operator==(const Iterator &other) { return this->iter_ == other.iter_; }
-
-    /** @return true if both iterators are different */
-    bool operator!=(const Iterator &other) { return this->iter_ != other.iter_; }
-
-   private:
-    /** Aggregates map. */
-    std::unordered_map<AggregateKey, AggregateValue>::const_iterator iter_;
-  };
-
-  /** @return iterator to the start of the hash table */
-  Iterator Begin() { return Iterator{ht.cbegin()}; }
-
-  /** @return iterator to the end of the hash table */
-  Iterator End() { return Iterator{ht.cend()}; }
-
- private:
-  /** The hash table is just a map from aggregate keys to aggregate values. */
-  std::unordered_map<AggregateKey, AggregateValue> ht{};
-  /** The aggregate expressions that we have. */
-  const std::vector<const AbstractExpression *> &agg_exprs_;
-  /** The types of aggregations that we have. */
-  const std::vector<AggregationType> &agg_types_;
-};
-
 /**
  * AggregationExecutor executes an aggregation operation (e.g. COUNT, SUM, MIN, MAX) on the tuples of a child executor.
+ *
+ * If the plan allows more than one thread and the child is a sequential scan, the executor scans the table itself:
+ * every worker, a task on the thread pool of the execution engine, pulls a parallel scan worker that claims morsels of
+ * table pages, and pre-aggregates into a thread-local hash table. The local tables are then merged by hash partition,
+ * one task per partition. Tuple reads take locks on the transaction, which is not thread-safe, so the executor falls
+ * back to pulling its child when logging is enabled.
+ *
+ * If the plan has a memory budget, the executor pulls its child and aggregates in memory until the hash table
+ * exceeds the budget. From then on the table is frozen: rows of groups that are already in memory are still
+ * aggregated, and the rows of all other groups are hash-partitioned into TmpTuplePages through the buffer pool. Once
+ * the in-memory groups have been returned, every partition is aggregated the same way, spilling again with a
+ * different hash if it does not fit either. Every group is aggregated entirely in memory or entirely from one
+ * partition, so no group is returned twice. Spilling plans are aggregated by one thread.
  */
 class AggregationExecutor : public AbstractExecutor {
  public:
@@ -172,32 +64,69 @@ class AggregationExecutor : public AbstractExecutor {
 
   bool Next(Tuple *tuple, RID *rid) override;
 
-  /** @return the tuple as an AggregateKey */
-  AggregateKey MakeKey(const Tuple *tuple) {
-    std::vector<Value> keys;
-    for (const auto &expr : plan_->GetGroupBys()) {
-      keys.emplace_back(expr->Evaluate(tuple, child_->GetOutputSchema()));
-    }
-    return {keys};
-  }
-
-  /** @return the tuple as an AggregateValue */
-  AggregateValue MakeVal(const Tuple *tuple) {
-    std::vector<Value> vals;
-    for (const auto &expr : plan_->GetAggregates()) {
-      vals.emplace_back(expr->Evaluate(tuple, child_->GetOutputSchema()));
-    }
-    return {vals};
-  }
+  bool NextBatch(TupleBatch *batch) override;
+
+  ~AggregationExecutor() override { DropSpilledPartitions(); }
 
  private:
+  /** A hash partition of the rows that were spilled, stored as child output tuples in TmpTuplePages. */
+  struct SpillPartition {
+    /** The pages of the partition. */
+    std::vector<page_id_t> page_ids_;
+    /** The last page, which stays pinned while rows are being spilled to the partition. */
+    TmpTuplePage *page_{nullptr};
+    /** The number of times that the rows of the partition have been spilled. */
+    uint32_t level_{0};
+  };
+
+  /** The number of partitions that a frozen hash table spills to. */
+  static constexpr size_t SPILL_FANOUT = 16;
+  /** Partitions spilled this many times are aggregated in memory regardless of the budget. */
+  static constexpr uint32_t MAX_SPILL_LEVEL = 6;
+  /**
+   * Advances the hash table iterator to the next group that satisfies the having clause.
+   * @param[out] values the output row of that group
+   * @return false if there are no more groups
+   */
+  bool NextGroup(std::vector<Value> *values);
+
+  /**
+   * Aggregates the table of a sequential scan with several threads, leaving one hash table per partition in tables_.
+   * @param scan_plan the sequential scan child plan
+   * @param parallelism the number of worker threads and of partitions
+   */
+  void AggregateInParallel(const SeqScanPlanNode *scan_plan, uint32_t parallelism);
+
+  /**
+   * Aggregates a batch of child rows into tables_.back(), spilling the rows of the groups that do not fit.
+   * @param batch the rows
+   * @param level the number of times that the rows have been spilled before
+   * @param[in,out] spills the partitions that the table spills to, empty until the table freezes
+   */
+  void Consume(const TupleBatch *batch, uint32_t level, std::vector<SpillPartition> *spills);
+
+  /** Unpins the last page of every spill partition and queues the non-empty partitions for aggregation. */
+  void FinishSpilling(std::vector<SpillPartition> *spills);
+
+  /** Replaces tables_ by a table that aggregates a spilled partition, deleting its pages. */
+  void AggregatePartition(const SpillPartition &partition);
+
+  /** Deletes the pages of every partition that has not been aggregated yet. */
+  void DropSpilledPartitions();
+
   /** The aggregation plan node. */
   const AggregationPlanNode *plan_;
   /** The child executor whose tuples we are aggregating. */
   std::unique_ptr<AbstractExecutor> child_;
-  /** Simple aggregation hash table. */
-  SimpleAggregationHashTable aht_;
-  /** Simple aggregation hash table iterator. */
-  SimpleAggregationHashTable::Iterator aht_iterator_;
+  /** The aggregation hash tables, one per partition; the groups of different tables are disjoint. */
+  std::vector<AggregationHashTable> tables_;
+  /** The index of the table that holds the next group to be returned. */
+  size_t table_idx_{0};
+  /** The index of the next group of tables_[table_idx_] to be returned. */
+  size_t group_idx_{0};
+  /** The spilled partitions that have not been aggregated yet. */
+  std::vector<SpillPartition> pending_partitions_;
+  /** Scratch space for the rows that a frozen table did not aggregate. */
+  std::vector<uint32_t> misses_;
 };
 }  // namespace bustub
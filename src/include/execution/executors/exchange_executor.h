@@ -0,0 +1,189 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// exchange_executor.h
+//
+// Identification: src/include/execution/executors/exchange_executor.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <exception>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "common/thread_pool.h"
+#include "container/bounded_queue.h"
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/morsel_dispenser.h"
+#include "execution/parallel_instance.h"
+#include "execution/plans/exchange_plan.h"
+#include "storage/table/tuple_batch.h"
+
+namespace bustub {
+
+/**
+ * ExchangeState holds the producers of an exchange and the queues between them and the consumers.
+ *
+ * Every producer pulls one copy of the child plan on a task of the thread pool and pushes batches into the queue of
+ * the consumer that they are routed to, waiting while that queue is full. A consumer pops batches from its own queue
+ * until the queue is empty and every producer has finished. An exception thrown by a producer stops the other
+ * producers and is rethrown to the consumers.
+ *
+ * The queues are lock-free. A thread that finds its queue full or empty yields a few times, and then sleeps on the
+ * queue's condition variable until the other side pops or pushes, or the producers finish or stop. Pushes and pops
+ * take the queue's latch only when someone sleeps on it.
+ */
+class ExchangeState {
+ public:
+  /** The number of batches that the queue of a consumer holds. */
+  static constexpr size_t QUEUE_CAPACITY = 8;
+  /** The number of times a thread yields on a full or empty queue before it sleeps. */
+  static constexpr uint32_t SPIN_COUNT = 32;
+
+  /**
+   * Creates the producers of an exchange. They are started by Start().
+   * @param exec_ctx the executor context
+   * @param plan the exchange plan
+   * @param consumer_count the number of consumers
+   */
+  ExchangeState(ExecutorContext *exec_ctx, const ExchangePlanNode *plan, uint32_t consumer_count);
+
+  /** Stops the producers and waits for them. */
+  ~ExchangeState();
+
+  DISALLOW_COPY_AND_MOVE(ExchangeState);
+
+  /** Starts the producers, unless they have been started already. */
+  void Start();
+
+  /**
+   * Pops the next batch of a consumer, waiting until one is produced.
+   * @param consumer_idx the consumer
+   * @param[out] batch the batch, whose previous rows are removed
+   * @return false if every producer has finished and every batch of the consumer has been popped
+   */
+  bool Pop(uint32_t consumer_idx, TupleBatch *batch);
+
+ private:
+  /** The queue of a consumer, and where its consumer and producers wait for it. */
+  struct ConsumerQueue {
+    explicit ConsumerQueue(size_t capacity) : batches_(capacity) {}
+
+    BoundedQueue<std::unique_ptr<TupleBatch>> batches_;
+    /** The number of threads that sleep on cv_. */
+    std::atomic<uint32_t> waiters_{0};
+    std::mutex latch_;
+    /** Signaled when a batch is pushed or popped while someone sleeps, and when the producers finish or stop. */
+    std::condition_variable cv_;
+  };
+
+  /** Runs the producer_idx'th producer to completion. */
+  void Produce(uint32_t producer_idx);
+
+  /** Pushes every batch of a producer into the queue of the single consumer. */
+  void ProduceGather(AbstractExecutor *producer);
+
+  /** Routes every row of a producer to the consumer picked by the hash of its partition keys. */
+  void ProduceRepartition(AbstractExecutor *producer);
+
+  /**
+   * Pushes a batch into the queue of a consumer, waiting while the queue is full.
+   * @return false if the producers have been stopped
+   */
+  bool Push(uint32_t consumer_idx, std::unique_ptr<TupleBatch> *batch);
+
+  /** Stops the producers and waits until none of them is running. */
+  void Stop();
+
+  /** Wakes the threads that sleep on a queue, if any, after a push or a pop. */
+  void Wake(ConsumerQueue *queue);
+
+  /** Wakes the threads that sleep on any queue, after the producers finished or stopped. */
+  void WakeAll();
+
+  /** Rethrows the exception of a failed producer, if any. */
+  void RethrowError();
+
+  ExecutorContext *exec_ctx_;
+  const ExchangePlanNode *plan_;
+  /** The morsel dispensers that the copies of the child plan share. */
+  std::vector<std::unique_ptr<MorselDispenser>> dispensers_;
+  /** One copy of the child plan per producer. */
+  std::vector<std::unique_ptr<AbstractExecutor>> producers_;
+  /** One queue per consumer. */
+  std::vector<std::unique_ptr<ConsumerQueue>> queues_;
+  /** The pool that runs the producers when the executor context has none. */
+  std::unique_ptr<ThreadPool> own_pool_;
+  /** The number of producers that have not finished; a consumer whose queue is empty is done when it reaches 0. */
+  std::atomic<uint32_t> active_producers_{0};
+  /** Set to make the producers stop early. */
+  std::atomic<bool> stopped_{false};
+
+  /** Protects the members below. */
+  std::mutex latch_;
+  /** Signaled when a producer task finishes. */
+  std::condition_variable finished_cv_;
+  /** True once the producers have been started. */
+  bool started_{false};
+  /** The number of producer tasks that have not returned. */
+  uint32_t running_producers_{0};
+  /** The first exception thrown by a producer. */
+  std::exception_ptr error_;
+};
+
+/**
+ * ExchangeExecutor executes an exchange: it runs the copies of the child plan on the thread pool of the execution
+ * engine and returns the rows routed to it, in no particular order.
+ *
+ * Every executor of a gather exchange owns its producers. The producers of a repartition exchange below a gather
+ * exchange are shared by the executors of the copies between the two exchanges and started by the first of them;
+ * such an executor cannot be rewound by calling Init() again.
+ *
+ * Tuple reads take locks on the transaction, which is not thread-safe, so when logging is enabled the exchange runs a
+ * single copy of the child plan on the calling thread.
+ */
+class ExchangeExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Creates a new exchange executor.
+   * @param exec_ctx the executor context
+   * @param plan the exchange plan to be executed
+   * @param instance the copy of the enclosing parallel plan that the executor belongs to, nullptr if none
+   */
+  ExchangeExecutor(ExecutorContext *exec_ctx, const ExchangePlanNode *plan, const ParallelInstance *instance);
+
+  void Init() override;
+
+  bool Next(Tuple *tuple, RID *rid) override;
+
+  bool NextBatch(TupleBatch *batch) override;
+
+  const Schema *GetOutputSchema() override { return plan_->OutputSchema(); }
+
+ private:
+  /** The exchange plan node to be executed. */
+  const ExchangePlanNode *plan_;
+  /** The producers and queues, shared with the other consumers of a repartition exchange. */
+  std::shared_ptr<ExchangeState> state_;
+  /** True if state_ belongs to an enclosing parallel plan rather than to this executor. */
+  bool shared_state_{false};
+  /** The index of the consumer that this executor is. */
+  uint32_t consumer_idx_{0};
+  /** The child plan run on the calling thread when logging is enabled, nullptr otherwise. */
+  std::unique_ptr<AbstractExecutor> serial_child_;
+  /** The batch that Next() returns rows from. */
+  TupleBatch batch_;
+  /** The index in batch_ of the next row to be returned by Next(). */
+  uint32_t batch_row_idx_{0};
+};
+
+}  // namespace bustub
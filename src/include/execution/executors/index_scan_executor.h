@@ -6,17 +6,19 @@
 //
 // Identification: src/include/execution/executors/index_scan_executor.h
 //
-// Copyright (c) 2015-20, Carnegie Mellon University Database Group
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
 //
 //===----------------------------------------------------------------------===//
-
 #pragma once
 
+#include <memory>
+#include <unordered_map>
 #include <vector>
 
 #include "common/rid.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
+#include "execution/expressions/compiled_predicate.h"
 #include "execution/plans/index_scan_plan.h"
 #include "storage/table/tuple.h"
 
@@ -24,8 +26,17 @@ namespace bustub {
 
 /**
  * IndexScanExecutor executes an index scan over a table.
+ *
+ * The predicate is searched for comparisons between key columns and constants that are joined by AND; they bound the
+ * scan to a range of keys: equalities on a prefix of the key columns, then at most one range on the next column.
+ * Bounds whose constant has a different type than the key column are ignored. The RIDs of the range are collected
+ * first, and every fetched tuple is then tested against the whole predicate, so the range only has to include every
+ * qualifying key.
+ *
+ * When fetching the RIDs in key order would fetch some table page more than once, which happens once a good fraction
+ * of a table whose order is unrelated to the key qualifies, the RIDs are sorted and the tuples are fetched a page at a
+ * time instead, in the manner of a bitmap heap scan. The output is then in RID order rather than in key order.
  */
-
 class IndexScanExecutor : public AbstractExecutor {
  public:
   /**
@@ -41,8 +52,55 @@ class IndexScanExecutor : public AbstractExecutor {
 
   bool Next(Tuple *tuple, RID *rid) override;
 
+  bool NextBatch(TupleBatch *batch) override;
+
+  /** @return true if the last Init() chose to fetch the tuples in RID order rather than in key order */
+  bool IsFetchingInRidOrder() const { return rid_order_; }
+
  private:
+  /** The inclusive bounds that the predicate puts on a table column. */
+  struct ColumnRange {
+    bool has_low_{false};
+    Value low_;
+    bool has_high_{false};
+    Value high_;
+  };
+
+  /** Collects the bounds that the conjuncts of expr put on table columns. */
+  static void CollectRanges(const AbstractExpression *expr, std::unordered_map<uint32_t, ColumnRange> *ranges);
+
+  /** Derives low_key_, high_key_ and point_lookup_ from the predicate of the plan. */
+  void BuildKeyRange();
+
+  /**
+   * Fetches the next tuple of rids_ that satisfies the predicate.
+   * @param[out] table_tuple the tuple, laid out according to the table schema
+   * @return false if every RID has been fetched
+   */
+  bool FetchNext(Tuple *table_tuple);
+
+  /** Projects the table tuple onto the output schema, replacing the contents of values. */
+  void Project(const Tuple &table_tuple, std::vector<Value> *values) const;
+
   /** The index scan plan node to be executed. */
   const IndexScanPlanNode *plan_;
+  /** The scanned index. */
+  IndexInfo *index_info_;
+  /** The table of the index. */
+  TableMetadata *table_meta_;
+  /** The predicate compiled at construction, or nullptr if it has to be interpreted. */
+  std::unique_ptr<CompiledPredicate> compiled_predicate_;
+  /** The smallest key of the range, nullptr if the range is open below. */
+  std::unique_ptr<Tuple> low_key_;
+  /** The largest key of the range, nullptr if the range is open above. */
+  std::unique_ptr<Tuple> high_key_;
+  /** True if the range is a single key on every key column. */
+  bool point_lookup_{false};
+  /** The RIDs of the range, in the order in which they are fetched. */
+  std::vector<RID> rids_;
+  /** The index in rids_ of the next RID to be fetched. */
+  size_t rid_idx_{0};
+  /** True if rids_ is sorted by RID. */
+  bool rid_order_{false};
 };
 }  // namespace bustub
@@ -14,6 +14,7 @@
 
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
@@ -24,6 +25,11 @@ namespace bustub {
 /**
  * InsertExecutor executes an insert into a table.
  * Inserted values can either be embedded in the plan itself ("raw insert") or come from a child executor.
+ *
+ * Rows are inserted a batch at a time: the child is pulled with NextBatch(), and every batch is appended to the end of
+ * the table with TableHeap::AppendTuples(). Then, for every index of the table, the keys of the batch are sorted and
+ * inserted in key order, so that consecutive entries mostly go to the same leaf. Each index entry is recorded in the
+ * index write set of the transaction so that an abort removes it.
  */
 class InsertExecutor : public AbstractExecutor {
  public:
@@ -46,10 +52,20 @@ class InsertExecutor : public AbstractExecutor {
   bool Next([[maybe_unused]] Tuple *tuple, RID *rid) override;
 
  private:
+  /**
+   * Inserts a batch of tuples into the table and its indexes.
+   * @throws TransactionAbortException if the insert failed and the transaction was aborted
+   */
+  void InsertBatch(const std::vector<Tuple> &tuples);
+
   /** The insert plan node to be executed. */
   const InsertPlanNode *plan_;
   std::unique_ptr<AbstractExecutor> child_exe_;
   TableMetadata *table_meta_;
   TableHeap *table_heap_;
+  /** The indexes of the table. */
+  std::vector<IndexInfo *> indexes_;
+  /** The rids of the batch being inserted. */
+  std::vector<RID> rids_;
 };
 }  // namespace bustub
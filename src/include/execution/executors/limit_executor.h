@@ -39,10 +39,16 @@ class LimitExecutor : public AbstractExecutor {
 
   bool Next(Tuple *tuple, RID *rid) override;
 
+  bool NextBatch(TupleBatch *batch) override;
+
  private:
   /** The limit plan node to be executed. */
   const LimitPlanNode *plan_;
   /** The child executor to obtain value from. */
   std::unique_ptr<AbstractExecutor> child_executor_;
+  /** The number of child tuples skipped so far because of the offset. */
+  size_t skipped_{0};
+  /** The number of tuples produced so far. */
+  size_t produced_{0};
 };
 }  // namespace bustub
@@ -21,6 +21,7 @@
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/expressions/abstract_expression.h"
+#include "execution/expressions/compiled_predicate.h"
 #include "execution/plans/nested_index_join_plan.h"
 #include "storage/table/tmp_tuple.h"
 #include "storage/table/tuple.h"
@@ -29,6 +30,9 @@ namespace bustub {
 
 /**
  * IndexJoinExecutor executes index join operations.
+ * Outer tuples are pulled from the child in batches. The index keys of a batch are sorted before probing so that
+ * consecutive probes land on the same B+ tree leaves, and the matching RIDs are sorted by page before the inner
+ * tuples are fetched from the table heap so that each heap page is visited once per batch.
  */
 class NestIndexJoinExecutor : public AbstractExecutor {
  public:
@@ -47,8 +51,57 @@ class NestIndexJoinExecutor : public AbstractExecutor {
 
   bool Next(Tuple *tuple, RID *rid) override;
 
+  bool NextBatch(TupleBatch *batch) override;
+
+  /** The maximum number of outer tuples that are probed against the index together. */
+  static constexpr size_t OUTER_BATCH_SIZE = 256;
+
  private:
+  /**
+   * Pulls the next batch of outer tuples, probes the index and fills joined_ with the matching pairs.
+   * @return false if the child executor is exhausted, true otherwise (the batch may still produce no results)
+   */
+  bool ProbeNextBatch();
+
+  /**
+   * Collects the equalities between a column of the outer tuple and a column of the inner tuple among the conjuncts
+   * of expr, keyed by the inner column.
+   */
+  static void CollectEqualities(const AbstractExpression *expr,
+                                std::unordered_map<uint32_t, const AbstractExpression *> *outer_exprs);
+
+  /** Finds the outer column that the join predicate equates with each index key column. */
+  void BuildOuterKey();
+
+  /** @return the index key that an outer tuple probes for */
+  Tuple OuterKey(const Tuple &outer_tuple) const;
+
+  /** @return true if the index key lhs sorts before the index key rhs */
+  bool KeyLessThan(const Tuple &lhs, const Tuple &rhs) const;
+
+  /** @return the inner table tuple projected onto the inner table schema of the plan */
+  Tuple ProjectInner(const Tuple &table_tuple) const;
+
+  /** Evaluates the output schema over the next pair in joined_, replacing the contents of values. */
+  void NextOutput(std::vector<Value> *values);
+
   /** The nested index join plan node. */
   const NestedIndexJoinPlanNode *plan_;
+  /** The child executor that produces the outer tuples. */
+  std::unique_ptr<AbstractExecutor> child_executor_;
+  /** The inner table whose tuples are fetched through the index. */
+  TableMetadata *inner_table_;
+  /** The index over the inner table. */
+  IndexInfo *index_info_;
+  /** The outer expressions that give the index key of an outer tuple, in the order of the key attributes. */
+  std::vector<const AbstractExpression *> outer_key_exprs_;
+  /** The predicate compiled at construction, or nullptr if it has to be interpreted. */
+  std::unique_ptr<CompiledPredicate> compiled_predicate_;
+  /** The current batch of outer tuples. */
+  std::vector<Tuple> outer_batch_;
+  /** The pairs of (outer tuple position in outer_batch_, projected inner tuple) that the current batch joined. */
+  std::vector<std::pair<size_t, Tuple>> joined_;
+  /** The position of the next pair in joined_ to be returned. */
+  size_t joined_idx_{0};
 };
 }  // namespace bustub
@@ -16,15 +16,18 @@
 #include <utility>
 #include <vector>
 
+#include "common/config.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
+#include "execution/expressions/compiled_predicate.h"
 #include "execution/plans/nested_loop_join_plan.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
 /**
- * NestedLoopJoinExecutor joins two tables using nested loop.
- * The child executor can either be a sequential scan
+ * NestedLoopJoinExecutor joins two tables using a pipelined block nested loop.
+ * A block of about LEFT_BLOCK_SIZE bytes of left tuples is buffered, and the right child is rescanned once per
+ * block. Joined tuples are produced one at a time, so memory stays bounded by the block size.
  */
 class NestedLoopJoinExecutor : public AbstractExecutor {
  public:
@@ -46,12 +49,38 @@ class NestedLoopJoinExecutor : public AbstractExecutor {
 
   bool Next(Tuple *tuple, RID *rid) override;
 
+  bool NextBatch(TupleBatch *batch) override;
+
+  /** The number of bytes of left tuples after which a block is considered full. */
+  static constexpr size_t LEFT_BLOCK_SIZE = PAGE_SIZE;
+
  private:
+  /**
+   * Buffers the next block of left tuples and restarts the right child.
+   * @return false if the left child is exhausted
+   */
+  bool LoadLeftBlock();
+
+  /**
+   * Advances to the next pair of left and right tuples that satisfies the predicate.
+   * @param[out] values the output row of that pair
+   * @return false if the join is exhausted
+   */
+  bool NextMatch(std::vector<Value> *values);
+
   /** The NestedLoop plan node to be executed. */
   const NestedLoopJoinPlanNode *plan_;
   std::unique_ptr<AbstractExecutor> left_;
   std::unique_ptr<AbstractExecutor> right_;
-  std::vector<Tuple>::iterator curr_tuple_ite_;
-  std::vector<Tuple> result_tuples;
+  /** The predicate compiled at construction, or nullptr if it has to be interpreted. */
+  std::unique_ptr<CompiledPredicate> compiled_predicate_;
+  /** The current block of left tuples. */
+  std::vector<Tuple> left_block_;
+  /** The right tuple that is currently joined against the block. */
+  Tuple right_tuple_;
+  /** True if right_tuple_ holds a tuple that has not been joined against the whole block yet. */
+  bool has_right_{false};
+  /** The position of the next left tuple in the block to be joined with right_tuple_. */
+  size_t block_idx_{0};
 };
 }  // namespace bustub
@@ -12,10 +12,13 @@
 
 #pragma once
 
+#include <memory>
 #include <vector>
 
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
+#include "execution/expressions/compiled_predicate.h"
+#include "execution/morsel_dispenser.h"
 #include "execution/plans/seq_scan_plan.h"
 #include "storage/table/tuple.h"
 
@@ -23,6 +26,11 @@ namespace bustub {
 
 /**
  * SeqScanExecutor executes a sequential scan over a table.
+ *
+ * A scan created with a MorselDispenser is one worker of a parallel scan: instead of walking the whole page list, it
+ * claims morsels from the dispenser that it shares with the other workers and scans the pages of each morsel. Every
+ * worker filters and projects its own pages, so the workers together return every qualifying tuple exactly once, in
+ * no particular order. Each worker must be pulled by a single thread.
  */
 class SeqScanExecutor : public AbstractExecutor {
  public:
@@ -30,20 +38,56 @@ class SeqScanExecutor : public AbstractExecutor {
    * Creates a new sequential scan executor.
    * @param exec_ctx the executor context
    * @param plan the sequential scan plan to be executed
+   * @param dispenser the morsel dispenser shared by the workers of a parallel scan, nullptr for a serial scan
    */
-  SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan);
+  SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan, MorselDispenser *dispenser = nullptr);
 
   void Init() override;
 
   bool Next(Tuple *tuple, RID *rid) override;
 
+  bool NextBatch(TupleBatch *batch) override;
+
   const Schema *GetOutputSchema() override { return plan_->OutputSchema(); }
 
  private:
+  /** @return true if the table tuple satisfies the predicate of the plan */
+  bool Matches(const Tuple &table_tuple) const;
+
+  /** Projects the table tuple onto the output schema, replacing the contents of values. */
+  void Project(const Tuple &table_tuple, std::vector<Value> *values) const;
+
+  /** Projects a row of scan_batch_ onto the output schema, replacing the contents of values. */
+  void ProjectRow(uint32_t row_idx, std::vector<Value> *values) const;
+
+  /** Sets selection_ to the rows of scan_batch_ that satisfy the predicate of the plan. */
+  void Filter();
+
+  /**
+   * Advances to the next row of the morsels that satisfies the predicate, claiming morsels as needed.
+   * @param[out] row_idx the row of scan_batch_
+   * @return false if the dispenser has run out of morsels
+   */
+  bool NextMorselRow(uint32_t *row_idx);
+
   /** The sequential scan plan node to be executed. */
   const SeqScanPlanNode *plan_;
   TableMetadata *table_meta_;
   TableHeap *table_heap_;
   TableIterator ite_;
+  /** The table tuples of the chunk that NextBatch() is filtering, laid out according to the table schema. */
+  TupleBatch scan_batch_;
+  /** The rows of scan_batch_ that satisfy the predicate. */
+  std::vector<uint32_t> selection_;
+  /** The predicate compiled at construction, or nullptr if it has to be interpreted. */
+  std::unique_ptr<CompiledPredicate> compiled_predicate_;
+  /** The dispenser of a parallel scan, nullptr for a serial scan. */
+  MorselDispenser *dispenser_;
+  /** The pages of the morsel being scanned. */
+  std::vector<page_id_t> morsel_;
+  /** The index in morsel_ of the next page to be scanned. */
+  size_t morsel_page_idx_{0};
+  /** The index in selection_ of the next row to be returned from the page being scanned. */
+  size_t selection_idx_{0};
 };
 }  // namespace bustub
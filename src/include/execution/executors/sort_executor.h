@@ -0,0 +1,172 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// sort_executor.h
+//
+// Identification: src/include/execution/executors/sort_executor.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/plans/sort_plan.h"
+#include "execution/sort_key_encoder.h"
+#include "storage/page/tmp_tuple_page.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * SortExecutor executes a sort with an external merge sort.
+ *
+ * Every child row is turned into a record that holds its normalized sort key (see SortKeyEncoder), its RID and the
+ * tuple, and the records are appended to an in-memory buffer. The buffer is sorted by comparing the first 8 key bytes
+ * as an integer and the rest of the keys byte-wise only on ties. If the plan has a memory budget and the buffer
+ * exceeds it, the buffer is sorted and written out as a run of TmpTuplePages through the buffer pool, and buffering
+ * starts over. Once the child is exhausted, either the buffer is returned directly, or it becomes the last run and the
+ * runs are merged with a loser tree, at most MAX_MERGE_FAN_IN at a time: while there are more runs, consecutive groups
+ * of runs are merged into longer runs. A run is read a page at a time, and every page is deleted as soon as it has been
+ * read. The sort is stable.
+ */
+class SortExecutor : public AbstractExecutor {
+ public:
+  /** The maximum number of runs that are merged at once. */
+  static constexpr size_t MAX_MERGE_FAN_IN = 16;
+
+  /**
+   * Creates a new sort executor.
+   * @param exec_ctx the executor context
+   * @param plan the sort plan to be executed
+   * @param child the child executor
+   */
+  SortExecutor(ExecutorContext *exec_ctx, const SortPlanNode *plan, std::unique_ptr<AbstractExecutor> &&child);
+
+  ~SortExecutor() override;
+
+  void Init() override;
+
+  bool Next(Tuple *tuple, RID *rid) override;
+
+  const Schema *GetOutputSchema() override { return plan_->OutputSchema(); }
+
+  /** @return the number of runs that have been written out since the last Init(), including merged runs */
+  size_t GetRunCount() const { return run_count_; }
+
+ private:
+  /** A buffered record: its offset in buffer_ and the first bytes of its key. */
+  struct SortEntry {
+    /** SortKeyEncoder::Prefix() of the key. */
+    uint64_t prefix_;
+    /** The offset of the record in buffer_. */
+    size_t offset_;
+  };
+
+  /** A sorted run; each TmpTuple of its pages is a record, and the records are in order across the pages. */
+  struct SortRun {
+    std::vector<page_id_t> page_ids_;
+  };
+
+  /** Reads a run a page at a time. */
+  struct RunCursor {
+    /** The pages of the run that have not been read yet. */
+    std::vector<page_id_t> page_ids_;
+    /** The index in page_ids_ of the next page to be read. */
+    size_t page_idx_{0};
+    /** The records of the page that was read last, in order. */
+    std::string records_;
+    /** The offset in records_ of every record. */
+    std::vector<size_t> offsets_;
+    /** The index in offsets_ of the current record. */
+    size_t offset_idx_{0};
+    /** The current record, nullptr once the run is exhausted. */
+    const char *record_{nullptr};
+  };
+
+  /** A k-way merge of runs. */
+  struct RunMerge {
+    /** One cursor per run. */
+    std::vector<RunCursor> cursors_;
+    /** The loser of the match at every inner node of the tree; the leaf of cursor i is node cursors_.size() + i. */
+    std::vector<size_t> losers_;
+    /** The cursor whose record comes next. */
+    size_t winner_{0};
+  };
+
+  /** Writes a run. */
+  struct RunWriter {
+    /** The run being written. */
+    SortRun run_;
+    /** The last page of the run, which stays pinned while records are written. */
+    TmpTuplePage *page_{nullptr};
+  };
+
+  /** Appends a child row to buffer_ and entries_. */
+  void BufferRow(const TupleBatch *batch, uint32_t row_idx);
+
+  /** @return the number of bytes that the buffered records occupy */
+  size_t GetBufferMemoryUsage() const { return buffer_.size() + entries_.size() * sizeof(SortEntry); }
+
+  /** Sorts entries_, keeping equal keys in input order. */
+  void SortBuffer();
+
+  /** Sorts the buffer, writes it out as a run and empties it. */
+  void SpillBuffer();
+
+  /** Appends a record to a run. */
+  void WriteRecord(RunWriter *writer, const char *record);
+
+  /** Unpins the last page of a run and adds the run to runs_. */
+  void FinishRun(RunWriter *writer);
+
+  /** Moves a cursor to the next record of its run, reading the next page if needed. */
+  void AdvanceCursor(RunCursor *cursor);
+
+  /** Starts a merge of runs, which are consumed. */
+  void OpenMerge(std::vector<SortRun> &&runs, RunMerge *merge);
+
+  /** Advances the winner of a merge and replays its matches up the tree. */
+  void AdvanceMerge(RunMerge *merge);
+
+  /** @return true if the current record of cursor a sorts before the current record of cursor b */
+  bool CursorLess(const RunMerge &merge, size_t a, size_t b) const;
+
+  /** Deletes the pages of every run and of every cursor of the final merge. */
+  void DropRuns();
+
+  /** The sort plan node to be executed. */
+  const SortPlanNode *plan_;
+  /** The child executor. */
+  std::unique_ptr<AbstractExecutor> child_;
+  /** The encoder of the sort keys. */
+  SortKeyEncoder encoder_;
+
+  /**
+   * The buffered records. A record is a uint32 size followed by the size bytes of a TmpTuple: a uint32 key length,
+   * the key, the int64 RID and the serialized tuple.
+   */
+  std::string buffer_;
+  /** One entry per buffered record. */
+  std::vector<SortEntry> entries_;
+  /** The index in entries_ of the next record to be returned, if the sort did not spill. */
+  size_t entry_idx_{0};
+
+  /** The runs that have not been merged yet. */
+  std::vector<SortRun> runs_;
+  /** The final merge, if the sort spilled. */
+  RunMerge merge_;
+  /** True if the output is read from merge_ rather than from the buffer. */
+  bool merging_{false};
+  /** The number of runs written since the last Init(). */
+  size_t run_count_{0};
+};
+
+}  // namespace bustub
@@ -0,0 +1,93 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// top_n_executor.h
+//
+// Identification: src/include/execution/executors/top_n_executor.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/plans/limit_plan.h"
+#include "execution/plans/sort_plan.h"
+#include "execution/sort_key_encoder.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * TopNExecutor executes a limit over a sort, i.e. ORDER BY ... LIMIT n OFFSET m, in one pass over the input of the
+ * sort and in O(n + m) memory.
+ *
+ * The executor keeps the n + m best rows seen so far in a max-heap on their normalized sort keys (see SortKeyEncoder),
+ * so the worst kept row is at the top. A row that does not sort before the top is dropped after encoding its key,
+ * without materializing its tuple; any other row replaces the top. Rows with equal keys keep their input order, like
+ * with SortExecutor. Once the input is exhausted, the kept rows are sorted and the first m are skipped.
+ *
+ * ExecutorFactory creates a TopNExecutor for every limit plan whose child is a sort plan and whose n + m is at most
+ * MAX_HEAP_SIZE; larger limits are executed by a LimitExecutor over a SortExecutor, which can spill.
+ */
+class TopNExecutor : public AbstractExecutor {
+ public:
+  /** The maximum number of rows that a top-N keeps in memory. */
+  static constexpr size_t MAX_HEAP_SIZE = 1 << 16;
+
+  /**
+   * Creates a new top-N executor.
+   * @param exec_ctx the executor context
+   * @param limit_plan the limit plan to be executed
+   * @param sort_plan the sort plan that is the child of the limit plan
+   * @param child the executor of the child plan of the sort plan
+   */
+  TopNExecutor(ExecutorContext *exec_ctx, const LimitPlanNode *limit_plan, const SortPlanNode *sort_plan,
+               std::unique_ptr<AbstractExecutor> &&child);
+
+  void Init() override;
+
+  bool Next(Tuple *tuple, RID *rid) override;
+
+  const Schema *GetOutputSchema() override { return limit_plan_->OutputSchema(); }
+
+ private:
+  /** A kept row. */
+  struct TopNEntry {
+    /** The normalized sort key. */
+    std::string key_;
+    /** The tuple. */
+    Tuple tuple_;
+    /** The RID of the tuple. */
+    RID rid_;
+    /** The position of the row in the input, which breaks ties between equal keys. */
+    uint64_t seq_;
+  };
+
+  /** @return true if entry a sorts before entry b */
+  bool EntryLess(uint32_t a, uint32_t b) const;
+
+  /** The limit plan node to be executed. */
+  const LimitPlanNode *limit_plan_;
+  /** The sort plan node below the limit plan node. */
+  const SortPlanNode *sort_plan_;
+  /** The executor of the input of the sort. */
+  std::unique_ptr<AbstractExecutor> child_;
+  /** The encoder of the sort keys. */
+  SortKeyEncoder encoder_;
+  /** The kept rows; a replaced row's slot is reused. */
+  std::vector<TopNEntry> entries_;
+  /** The indexes in entries_ of the kept rows: a max-heap while reading the input, sorted afterwards. */
+  std::vector<uint32_t> heap_;
+  /** The index in heap_ of the next row to be returned. */
+  size_t output_idx_{0};
+};
+
+}  // namespace bustub
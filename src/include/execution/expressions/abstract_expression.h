@@ -17,6 +17,7 @@
 
 #include "catalog/schema.h"
 #include "storage/table/tuple.h"
+#include "storage/table/tuple_batch.h"
 
 namespace bustub {
 /**
@@ -50,6 +51,32 @@ class AbstractExpression {
   virtual Value EvaluateJoin(const Tuple *left_tuple, const Schema *left_schema, const Tuple *right_tuple,
                              const Schema *right_schema) const = 0;
 
+  /**
+   * Returns the value obtained by evaluating a row of a batch.
+   * @param batch the batch, laid out according to the schema this expression was built against
+   * @param row_idx the index of the row in the batch
+   * @return the value obtained by evaluating the row_idx'th row of the batch
+   */
+  virtual Value EvaluateRow(const TupleBatch *batch, uint32_t row_idx) const = 0;
+
+  /**
+   * Evaluates this expression as a predicate over the rows of a batch. The default implementation calls EvaluateRow()
+   * on every selected row; expressions that can work on whole columns override it.
+   * @param batch the batch, laid out according to the schema this expression was built against
+   * @param[in,out] selection the ascending indexes of the rows to be tested; on return, only the indexes of the rows
+   * for which the predicate is true (a NULL result does not select the row)
+   */
+  virtual void EvaluateSelection(const TupleBatch *batch, std::vector<uint32_t> *selection) const {
+    size_t selected = 0;
+    for (uint32_t row_idx : *selection) {
+      Value result = EvaluateRow(batch, row_idx);
+      if (!result.IsNull() && result.GetAs<bool>()) {
+        (*selection)[selected++] = row_idx;
+      }
+    }
+    selection->resize(selected);
+  }
+
   /**
    * Returns the value obtained by evaluating the aggregates.
    * @param group_bys the group by values
@@ -44,6 +44,11 @@ class AggregateValueExpression : public AbstractExpression {
     exit(1);
   }
 
+  Value EvaluateRow(const TupleBatch *batch, uint32_t row_idx) const override {
+    BUSTUB_ASSERT(false, "Aggregation should only refer to group-by and aggregates.");
+    exit(1);
+  }
+
   Value EvaluateAggregate(const std::vector<Value> &group_bys, const std::vector<Value> &aggregates) const override {
     return is_group_by_term_ ? group_bys[term_idx_] : aggregates[term_idx_];
   }
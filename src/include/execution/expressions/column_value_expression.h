@@ -41,6 +41,10 @@ class ColumnValueExpression : public AbstractExpression {
                            : right_tuple->GetValue(right_schema, col_idx_);
   }
 
+  Value EvaluateRow(const TupleBatch *batch, uint32_t row_idx) const override {
+    return batch->GetValue(row_idx, col_idx_);
+  }
+
   Value EvaluateAggregate(const std::vector<Value> &group_bys, const std::vector<Value> &aggregates) const override {
     BUSTUB_ASSERT(false, "Aggregation should only refer to group-by and aggregates.");
     exit(1);
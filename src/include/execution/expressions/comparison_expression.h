@@ -12,11 +12,15 @@
 
 #pragma once
 
+#include <algorithm>
+#include <functional>
 #include <utility>
 #include <vector>
 
 #include "catalog/schema.h"
 #include "execution/expressions/abstract_expression.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/constant_value_expression.h"
 #include "storage/table/tuple.h"
 #include "type/value_factory.h"
 
@@ -47,12 +51,76 @@ class ComparisonExpression : public AbstractExpression {
     return ValueFactory::GetBooleanValue(PerformComparison(lhs, rhs));
   }
 
+  Value EvaluateRow(const TupleBatch *batch, uint32_t row_idx) const override {
+    Value lhs = GetChildAt(0)->EvaluateRow(batch, row_idx);
+    Value rhs = GetChildAt(1)->EvaluateRow(batch, row_idx);
+    return ValueFactory::GetBooleanValue(PerformComparison(lhs, rhs));
+  }
+
+  void EvaluateSelection(const TupleBatch *batch, std::vector<uint32_t> *selection) const override {
+    // Comparisons between an integer column and an integer constant run directly on the column array.
+    ComparisonType comp_type = comp_type_;
+    auto column = dynamic_cast<const ColumnValueExpression *>(GetChildAt(0));
+    auto constant = dynamic_cast<const ConstantValueExpression *>(GetChildAt(1));
+    if (column == nullptr || constant == nullptr) {
+      column = dynamic_cast<const ColumnValueExpression *>(GetChildAt(1));
+      constant = dynamic_cast<const ConstantValueExpression *>(GetChildAt(0));
+      comp_type = Commute(comp_type_);
+    }
+    if (column == nullptr || constant == nullptr || !batch->IsIntegerColumn(column->GetColIdx()) ||
+        !TupleBatch::IsIntegerType(constant->GetValue().GetTypeId())) {
+      AbstractExpression::EvaluateSelection(batch, selection);
+      return;
+    }
+    if (constant->GetValue().IsNull()) {
+      selection->clear();
+      return;
+    }
+    const int64_t *values = batch->GetIntegerColumn(column->GetColIdx());
+    int64_t null_value = TupleBatch::IntegerNull(batch->GetSchema()->GetColumn(column->GetColIdx()).GetType());
+    int64_t rhs = TupleBatch::IntegerOf(constant->GetValue());
+    uint32_t row_count = batch->GetRowCount();
+    switch (comp_type) {
+      case ComparisonType::Equal:
+        return SelectIntegers(values, null_value, rhs, row_count, selection, std::equal_to<>());
+      case ComparisonType::NotEqual:
+        return SelectIntegers(values, null_value, rhs, row_count, selection, std::not_equal_to<>());
+      case ComparisonType::LessThan:
+        return SelectIntegers(values, null_value, rhs, row_count, selection, std::less<>());
+      case ComparisonType::LessThanOrEqual:
+        return SelectIntegers(values, null_value, rhs, row_count, selection, std::less_equal<>());
+      case ComparisonType::GreaterThan:
+        return SelectIntegers(values, null_value, rhs, row_count, selection, std::greater<>());
+      case ComparisonType::GreaterThanOrEqual:
+        return SelectIntegers(values, null_value, rhs, row_count, selection, std::greater_equal<>());
+    }
+  }
+
+  /** @return the type of comparison */
+  ComparisonType GetComparisonType() const { return comp_type_; }
+
   Value EvaluateAggregate(const std::vector<Value> &group_bys, const std::vector<Value> &aggregates) const override {
     Value lhs = GetChildAt(0)->EvaluateAggregate(group_bys, aggregates);
     Value rhs = GetChildAt(1)->EvaluateAggregate(group_bys, aggregates);
     return ValueFactory::GetBooleanValue(PerformComparison(lhs, rhs));
   }
 
+  /** @return the comparison type that gives the same result when the operands are swapped */
+  static ComparisonType Commute(ComparisonType comp_type) {
+    switch (comp_type) {
+      case ComparisonType::LessThan:
+        return ComparisonType::GreaterThan;
+      case ComparisonType::LessThanOrEqual:
+        return ComparisonType::GreaterThanOrEqual;
+      case ComparisonType::GreaterThan:
+        return ComparisonType::LessThan;
+      case ComparisonType::GreaterThanOrEqual:
+        return ComparisonType::LessThanOrEqual;
+      default:
+        return comp_type;
+    }
+  }
+
  private:
   CmpBool PerformComparison(const Value &lhs, const Value &rhs) const {
     switch (comp_type_) {
@@ -73,6 +141,38 @@ class ComparisonExpression : public AbstractExpression {
     }
   }
 
+  /**
+   * Narrows the selection to the rows whose value is not NULL and satisfies compare(value, rhs).
+   * When every row is selected, the comparison runs over the contiguous column in chunks without branches so that the
+   * compiler can vectorize it, and the chunk's mask is then compacted into the selection.
+   */
+  template <class Compare>
+  static void SelectIntegers(const int64_t *values, int64_t null_value, int64_t rhs, uint32_t row_count,
+                             std::vector<uint32_t> *selection, Compare compare) {
+    uint32_t *out = selection->data();
+    size_t selected = 0;
+    if (selection->size() == row_count) {
+      constexpr uint32_t chunk_size = 256;
+      uint8_t mask[chunk_size];
+      for (uint32_t begin = 0; begin < row_count; begin += chunk_size) {
+        uint32_t end = std::min(row_count, begin + chunk_size);
+        for (uint32_t i = begin; i < end; i++) {
+          mask[i - begin] = static_cast<uint8_t>(compare(values[i], rhs) & (values[i] != null_value));
+        }
+        for (uint32_t i = begin; i < end; i++) {
+          out[selected] = i;
+          selected += mask[i - begin];
+        }
+      }
+    } else {
+      for (uint32_t row_idx : *selection) {
+        out[selected] = row_idx;
+        selected += static_cast<size_t>(compare(values[row_idx], rhs) & (values[row_idx] != null_value));
+      }
+    }
+    selection->resize(selected);
+  }
+
   std::vector<const AbstractExpression *> children_;
   ComparisonType comp_type_;
 };
@@ -0,0 +1,207 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compiled_predicate.h
+//
+// Identification: src/include/execution/expressions/compiled_predicate.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <functional>
+#include <limits>
+#include <memory>
+
+#include "catalog/schema.h"
+#include "common/macros.h"
+#include "execution/expressions/abstract_expression.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "storage/table/tuple.h"
+#include "storage/table/tuple_batch.h"
+
+namespace bustub {
+
+/**
+ * CompiledPredicate is a comparison expression compiled against the schemas of its input tuples at plan time.
+ * Column offsets are resolved once, and the comparison is a template instantiation specialized on the operand types
+ * and the comparison type. Evaluating a tuple is one call through a function pointer that reads the operands straight
+ * out of the tuple data, with no virtual dispatch and no Value allocation.
+ *
+ * Only comparisons between fixed-width integer columns and integer constants are compiled; Compile() returns nullptr
+ * for anything else and the caller keeps interpreting the expression tree. A NULL operand makes the predicate false.
+ */
+class CompiledPredicate {
+ public:
+  /**
+   * Compiles a predicate.
+   * @param predicate the predicate to be compiled
+   * @param left_schema the schema of the evaluated tuple, or of the left tuple of a join
+   * @param right_schema the schema of the right tuple of a join, nullptr if the predicate is not a join predicate
+   * @return the compiled predicate, or nullptr if the predicate cannot be compiled
+   */
+  static std::unique_ptr<CompiledPredicate> Compile(const AbstractExpression *predicate, const Schema *left_schema,
+                                                    const Schema *right_schema = nullptr) {
+    auto comparison = dynamic_cast<const ComparisonExpression *>(predicate);
+    if (comparison == nullptr) {
+      return nullptr;
+    }
+    Operand operands[2];
+    TypeId types[2];
+    for (uint32_t i = 0; i < 2; i++) {
+      if (!CompileOperand(comparison->GetChildAt(i), left_schema, right_schema, &operands[i], &types[i])) {
+        return nullptr;
+      }
+    }
+    if (types[0] == TypeId::INVALID && types[1] == TypeId::INVALID) {
+      // Constant folding is not worth a specialization.
+      return nullptr;
+    }
+    EvalFn eval = SelectLhs(types[0], types[1], comparison->GetComparisonType());
+    return std::unique_ptr<CompiledPredicate>(new CompiledPredicate(eval, operands[0], operands[1]));
+  }
+
+  /** @return the predicate evaluated on a tuple */
+  bool Evaluate(const Tuple *tuple) const { return eval_(lhs_, rhs_, tuple, tuple); }
+
+  /** @return the join predicate evaluated on a pair of tuples */
+  bool EvaluateJoin(const Tuple *left_tuple, const Tuple *right_tuple) const {
+    return eval_(lhs_, rhs_, left_tuple, right_tuple);
+  }
+
+ private:
+  /** A column at a fixed offset of the left (tuple_idx_ 0) or right (tuple_idx_ 1) tuple, or a constant. */
+  struct Operand {
+    uint32_t tuple_idx_{0};
+    uint32_t offset_{0};
+    int64_t constant_{0};
+  };
+
+  using EvalFn = bool (*)(const Operand &lhs, const Operand &rhs, const Tuple *left_tuple, const Tuple *right_tuple);
+
+  CompiledPredicate(EvalFn eval, const Operand &lhs, const Operand &rhs) : eval_(eval), lhs_(lhs), rhs_(rhs) {}
+
+  /** Reads a column of type T. NULL is the minimum value of T. */
+  template <class T>
+  struct ColumnReader {
+    static bool Read(const Operand &operand, const Tuple *left_tuple, const Tuple *right_tuple, int64_t *value) {
+      const Tuple *tuple = operand.tuple_idx_ == 0 ? left_tuple : right_tuple;
+      T raw = *reinterpret_cast<const T *>(tuple->GetData() + operand.offset_);
+      *value = raw;
+      return raw != std::numeric_limits<T>::min();
+    }
+  };
+
+  /** Reads a constant. */
+  struct ConstantReader {
+    static bool Read(const Operand &operand, const Tuple *left_tuple, const Tuple *right_tuple, int64_t *value) {
+      *value = operand.constant_;
+      return true;
+    }
+  };
+
+  template <class LhsReader, class RhsReader, class Compare>
+  static bool Eval(const Operand &lhs, const Operand &rhs, const Tuple *left_tuple, const Tuple *right_tuple) {
+    int64_t lhs_value;
+    int64_t rhs_value;
+    return LhsReader::Read(lhs, left_tuple, right_tuple, &lhs_value) &&
+           RhsReader::Read(rhs, left_tuple, right_tuple, &rhs_value) && Compare()(lhs_value, rhs_value);
+  }
+
+  template <class LhsReader, class RhsReader>
+  static EvalFn SelectComparison(ComparisonType comp_type) {
+    switch (comp_type) {
+      case ComparisonType::Equal:
+        return &Eval<LhsReader, RhsReader, std::equal_to<>>;
+      case ComparisonType::NotEqual:
+        return &Eval<LhsReader, RhsReader, std::not_equal_to<>>;
+      case ComparisonType::LessThan:
+        return &Eval<LhsReader, RhsReader, std::less<>>;
+      case ComparisonType::LessThanOrEqual:
+        return &Eval<LhsReader, RhsReader, std::less_equal<>>;
+      case ComparisonType::GreaterThan:
+        return &Eval<LhsReader, RhsReader, std::greater<>>;
+      case ComparisonType::GreaterThanOrEqual:
+        return &Eval<LhsReader, RhsReader, std::greater_equal<>>;
+    }
+    UNREACHABLE("Unsupported comparison type.");
+  }
+
+  /** Picks the reader for the right operand; TypeId::INVALID denotes a constant. */
+  template <class LhsReader>
+  static EvalFn SelectRhs(TypeId rhs_type, ComparisonType comp_type) {
+    switch (rhs_type) {
+      case TypeId::TINYINT:
+        return SelectComparison<LhsReader, ColumnReader<int8_t>>(comp_type);
+      case TypeId::SMALLINT:
+        return SelectComparison<LhsReader, ColumnReader<int16_t>>(comp_type);
+      case TypeId::INTEGER:
+        return SelectComparison<LhsReader, ColumnReader<int32_t>>(comp_type);
+      case TypeId::BIGINT:
+        return SelectComparison<LhsReader, ColumnReader<int64_t>>(comp_type);
+      default:
+        return SelectComparison<LhsReader, ConstantReader>(comp_type);
+    }
+  }
+
+  /** Picks the reader for the left operand; TypeId::INVALID denotes a constant. */
+  static EvalFn SelectLhs(TypeId lhs_type, TypeId rhs_type, ComparisonType comp_type) {
+    switch (lhs_type) {
+      case TypeId::TINYINT:
+        return SelectRhs<ColumnReader<int8_t>>(rhs_type, comp_type);
+      case TypeId::SMALLINT:
+        return SelectRhs<ColumnReader<int16_t>>(rhs_type, comp_type);
+      case TypeId::INTEGER:
+        return SelectRhs<ColumnReader<int32_t>>(rhs_type, comp_type);
+      case TypeId::BIGINT:
+        return SelectRhs<ColumnReader<int64_t>>(rhs_type, comp_type);
+      default:
+        return SelectRhs<ConstantReader>(rhs_type, comp_type);
+    }
+  }
+
+  /**
+   * Resolves an operand of the comparison.
+   * @param[out] operand the resolved operand
+   * @param[out] type the type of the column, or TypeId::INVALID for a constant
+   * @return false if the operand cannot be compiled
+   */
+  static bool CompileOperand(const AbstractExpression *expr, const Schema *left_schema, const Schema *right_schema,
+                             Operand *operand, TypeId *type) {
+    if (auto column_expr = dynamic_cast<const ColumnValueExpression *>(expr)) {
+      bool is_right = right_schema != nullptr && column_expr->GetTupleIdx() == 1;
+      const Column &column = (is_right ? right_schema : left_schema)->GetColumn(column_expr->GetColIdx());
+      if (!TupleBatch::IsIntegerType(column.GetType())) {
+        return false;
+      }
+      operand->tuple_idx_ = is_right ? 1 : 0;
+      operand->offset_ = column.GetOffset();
+      *type = column.GetType();
+      return true;
+    }
+    if (auto constant_expr = dynamic_cast<const ConstantValueExpression *>(expr)) {
+      const Value &value = constant_expr->GetValue();
+      if (!TupleBatch::IsIntegerType(value.GetTypeId()) || value.IsNull()) {
+        return false;
+      }
+      operand->constant_ = TupleBatch::IntegerOf(value);
+      *type = TypeId::INVALID;
+      return true;
+    }
+    return false;
+  }
+
+  /** The specialized evaluation function. */
+  EvalFn eval_;
+  /** The left operand of the comparison. */
+  Operand lhs_;
+  /** The right operand of the comparison. */
+  Operand rhs_;
+};
+
+}  // namespace bustub
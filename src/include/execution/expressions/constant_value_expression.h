@@ -32,10 +32,15 @@ class ConstantValueExpression : public AbstractExpression {
     return val_;
   }
 
+  Value EvaluateRow(const TupleBatch *batch, uint32_t row_idx) const override { return val_; }
+
   Value EvaluateAggregate(const std::vector<Value> &group_bys, const std::vector<Value> &aggregates) const override {
     return val_;
   }
 
+  /** @return the constant value */
+  const Value &GetValue() const { return val_; }
+
  private:
   Value val_;
 };
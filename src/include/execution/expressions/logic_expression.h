@@ -0,0 +1,101 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// logic_expression.h
+//
+// Identification: src/include/execution/expressions/logic_expression.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <vector>
+
+#include "catalog/schema.h"
+#include "execution/expressions/abstract_expression.h"
+#include "storage/table/tuple.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+/** LogicType represents the connective of a logic expression. */
+enum class LogicType { And, Or };
+
+/**
+ * LogicExpression represents two predicates joined by AND or OR, with three-valued logic: false AND NULL is false,
+ * true OR NULL is true, and every other combination with a NULL operand is NULL.
+ */
+class LogicExpression : public AbstractExpression {
+ public:
+  /** Creates a new logic expression representing (left logic_type right). */
+  LogicExpression(const AbstractExpression *left, const AbstractExpression *right, LogicType logic_type)
+      : AbstractExpression({left, right}, TypeId::BOOLEAN), logic_type_{logic_type} {}
+
+  Value Evaluate(const Tuple *tuple, const Schema *schema) const override {
+    Value lhs = GetChildAt(0)->Evaluate(tuple, schema);
+    Value rhs = GetChildAt(1)->Evaluate(tuple, schema);
+    return ValueFactory::GetBooleanValue(PerformLogic(lhs, rhs));
+  }
+
+  Value EvaluateJoin(const Tuple *left_tuple, const Schema *left_schema, const Tuple *right_tuple,
+                     const Schema *right_schema) const override {
+    Value lhs = GetChildAt(0)->EvaluateJoin(left_tuple, left_schema, right_tuple, right_schema);
+    Value rhs = GetChildAt(1)->EvaluateJoin(left_tuple, left_schema, right_tuple, right_schema);
+    return ValueFactory::GetBooleanValue(PerformLogic(lhs, rhs));
+  }
+
+  Value EvaluateRow(const TupleBatch *batch, uint32_t row_idx) const override {
+    Value lhs = GetChildAt(0)->EvaluateRow(batch, row_idx);
+    Value rhs = GetChildAt(1)->EvaluateRow(batch, row_idx);
+    return ValueFactory::GetBooleanValue(PerformLogic(lhs, rhs));
+  }
+
+  void EvaluateSelection(const TupleBatch *batch, std::vector<uint32_t> *selection) const override {
+    if (logic_type_ == LogicType::Or) {
+      AbstractExpression::EvaluateSelection(batch, selection);
+      return;
+    }
+    // A row is selected by a conjunction iff both operands select it, so the right operand only tests the survivors.
+    GetChildAt(0)->EvaluateSelection(batch, selection);
+    if (!selection->empty()) {
+      GetChildAt(1)->EvaluateSelection(batch, selection);
+    }
+  }
+
+  Value EvaluateAggregate(const std::vector<Value> &group_bys, const std::vector<Value> &aggregates) const override {
+    Value lhs = GetChildAt(0)->EvaluateAggregate(group_bys, aggregates);
+    Value rhs = GetChildAt(1)->EvaluateAggregate(group_bys, aggregates);
+    return ValueFactory::GetBooleanValue(PerformLogic(lhs, rhs));
+  }
+
+  /** @return the connective of this expression */
+  LogicType GetLogicType() const { return logic_type_; }
+
+ private:
+  CmpBool PerformLogic(const Value &lhs, const Value &rhs) const {
+    CmpBool l = ToCmpBool(lhs);
+    CmpBool r = ToCmpBool(rhs);
+    // The value that decides the result on its own: false for AND, true for OR.
+    CmpBool dominant = logic_type_ == LogicType::And ? CmpBool::CmpFalse : CmpBool::CmpTrue;
+    if (l == dominant || r == dominant) {
+      return dominant;
+    }
+    if (l == CmpBool::CmpNull || r == CmpBool::CmpNull) {
+      return CmpBool::CmpNull;
+    }
+    return l;
+  }
+
+  static CmpBool ToCmpBool(const Value &value) {
+    if (value.IsNull()) {
+      return CmpBool::CmpNull;
+    }
+    return value.GetAs<bool>() ? CmpBool::CmpTrue : CmpBool::CmpFalse;
+  }
+
+  LogicType logic_type_;
+};
+}  // namespace bustub
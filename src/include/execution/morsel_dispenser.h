@@ -0,0 +1,79 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// morsel_dispenser.h
+//
+// Identification: src/include/execution/morsel_dispenser.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#include "common/config.h"
+#include "storage/table/table_heap.h"
+
+namespace bustub {
+
+/**
+ * MorselDispenser hands out the pages of a table in morsels, i.e. runs of consecutive pages, to the threads of a
+ * parallel scan. Threads claim morsels until the table is exhausted, so a thread that is slowed down by its input or
+ * by its parent simply claims fewer morsels, and every page is claimed by exactly one thread.
+ *
+ * The page list is read once at construction; pages appended to the table afterwards are not scanned.
+ */
+class MorselDispenser {
+ public:
+  /** The maximum number of pages per morsel. */
+  static constexpr size_t MAX_PAGES_PER_MORSEL = 8;
+  /** The number of morsels that every worker should get to claim on a small table. */
+  static constexpr size_t MORSELS_PER_WORKER = 4;
+
+  /**
+   * Creates a new morsel dispenser. Morsels are as large as MAX_PAGES_PER_MORSEL allows, but small enough that every
+   * worker gets to claim MORSELS_PER_WORKER of them, so that small tables are spread over the workers too.
+   * @param table_heap the table to be scanned
+   * @param num_workers the number of workers that claim morsels
+   */
+  explicit MorselDispenser(TableHeap *table_heap, size_t num_workers = 1) : table_heap_(table_heap) {
+    table_heap_->GetPageIds(&page_ids_);
+    pages_per_morsel_ = std::clamp<size_t>(page_ids_.size() / (num_workers * MORSELS_PER_WORKER), 1,
+                                           MAX_PAGES_PER_MORSEL);
+  }
+
+  /** @return the table that is being scanned */
+  TableHeap *GetTableHeap() const { return table_heap_; }
+
+  /**
+   * Claims the next morsel. Safe to call from several threads.
+   * @param[out] morsel the ids of the pages of the morsel
+   * @return false if every page has been claimed
+   */
+  bool Claim(std::vector<page_id_t> *morsel) {
+    size_t begin = next_page_idx_.fetch_add(pages_per_morsel_);
+    if (begin >= page_ids_.size()) {
+      return false;
+    }
+    size_t end = std::min(begin + pages_per_morsel_, page_ids_.size());
+    morsel->assign(page_ids_.begin() + begin, page_ids_.begin() + end);
+    return true;
+  }
+
+ private:
+  /** The table that is being scanned. */
+  TableHeap *table_heap_;
+  /** The number of pages per morsel. */
+  size_t pages_per_morsel_;
+  /** The pages of the table, in the order of the page list. */
+  std::vector<page_id_t> page_ids_;
+  /** The index in page_ids_ of the first page of the next morsel. */
+  std::atomic<size_t> next_page_idx_{0};
+};
+
+}  // namespace bustub
@@ -0,0 +1,40 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_instance.h
+//
+// Identification: src/include/execution/parallel_instance.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+
+#include "execution/morsel_dispenser.h"
+#include "execution/plans/abstract_plan.h"
+
+namespace bustub {
+
+class ExchangeState;
+
+/**
+ * ParallelInstance identifies one of the copies of a plan that the producers of an exchange run in parallel, and
+ * carries the state that the executors of a copy share with the executors of the other copies.
+ */
+struct ParallelInstance {
+  /** The index of the copy, in [0, count_). */
+  uint32_t index_{0};
+  /** The number of copies. */
+  uint32_t count_{1};
+  /** The morsel dispenser of every sequential scan that the copies split between them. */
+  std::unordered_map<const AbstractPlanNode *, MorselDispenser *> dispensers_;
+  /** The state of every repartition exchange whose consumers are the copies. */
+  std::unordered_map<const AbstractPlanNode *, std::shared_ptr<ExchangeState>> exchanges_;
+};
+
+}  // namespace bustub
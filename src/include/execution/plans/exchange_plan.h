@@ -0,0 +1,90 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// exchange_plan.h
+//
+// Identification: src/include/execution/plans/exchange_plan.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "execution/expressions/abstract_expression.h"
+#include "execution/plans/abstract_plan.h"
+
+namespace bustub {
+
+/** ExchangeType enumerates the ways in which an exchange routes the rows of its producers to its consumers. */
+enum class ExchangeType {
+  /** Every row goes to the single consumer. */
+  Gather,
+  /** Every row goes to the consumer picked by the hash of its partition keys. */
+  Repartition
+};
+
+/**
+ * Exchange runs several copies of its child plan in parallel on the worker threads of the execution engine, and
+ * passes the rows that they produce to its consumers through bounded queues.
+ *
+ * The copies of the child plan split the table scanned at the bottom of its leftmost path: its sequential scan hands
+ * out morsels of pages to the copies, while every other input of the child plan is read in full by every copy.
+ *
+ * A gather exchange has one consumer, its parent. A repartition exchange below a gather exchange has one consumer per
+ * copy of the plan between the two exchanges, and sends every row to the consumer picked by the hash of its partition
+ * keys, so that e.g. an aggregation on the partition keys sees every row of its groups:
+ *
+ *   Exchange(Gather, 4) <- Aggregation(GROUP BY k) <- Exchange(Repartition, 4, {k}) <- SeqScan
+ *
+ * A repartition exchange that is not below a gather exchange has a single consumer. The output schema of an exchange
+ * is the output schema of its child.
+ */
+class ExchangePlanNode : public AbstractPlanNode {
+ public:
+  /**
+   * Creates a new exchange plan node.
+   * @param output_schema the output schema of the child plan
+   * @param child the plan that is run in parallel
+   * @param exchange_type how rows are routed to the consumers
+   * @param parallelism the number of copies of the child plan
+   * @param partition_keys the expressions whose hash picks the consumer of a row; only used by repartition exchanges
+   */
+  ExchangePlanNode(const Schema *output_schema, const AbstractPlanNode *child, ExchangeType exchange_type,
+                   uint32_t parallelism, std::vector<const AbstractExpression *> &&partition_keys = {})
+      : AbstractPlanNode(output_schema, {child}),
+        exchange_type_(exchange_type),
+        parallelism_(parallelism),
+        partition_keys_(std::move(partition_keys)) {}
+
+  PlanType GetType() const override { return PlanType::Exchange; }
+
+  /** @return how rows are routed to the consumers */
+  ExchangeType GetExchangeType() const { return exchange_type_; }
+
+  /** @return the number of copies of the child plan */
+  uint32_t GetParallelism() const { return parallelism_; }
+
+  /** @return the expressions whose hash picks the consumer of a row */
+  const std::vector<const AbstractExpression *> &GetPartitionKeys() const { return partition_keys_; }
+
+  /** @return the child plan */
+  const AbstractPlanNode *GetChildPlan() const {
+    BUSTUB_ASSERT(GetChildren().size() == 1, "Exchange should have exactly one child plan.");
+    return GetChildAt(0);
+  }
+
+ private:
+  /** How rows are routed to the consumers. */
+  ExchangeType exchange_type_;
+  /** The number of copies of the child plan. */
+  uint32_t parallelism_;
+  /** The expressions whose hash picks the consumer of a row. */
+  std::vector<const AbstractExpression *> partition_keys_;
+};
+
+}  // namespace bustub
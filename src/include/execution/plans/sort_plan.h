@@ -0,0 +1,69 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// sort_plan.h
+//
+// Identification: src/include/execution/plans/sort_plan.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "execution/expressions/abstract_expression.h"
+#include "execution/plans/abstract_plan.h"
+
+namespace bustub {
+
+/** OrderByType enumerates the directions in which a sort key can be ordered. */
+enum class OrderByType { Ascending, Descending };
+
+/** An ORDER BY key: the direction and the expression, evaluated against the output schema of the child. */
+using OrderBy = std::pair<OrderByType, const AbstractExpression *>;
+
+/**
+ * Sort returns the tuples of its child ordered by a list of keys; ties on the first key are ordered by the second key,
+ * and so on. NULL sorts before every other value of its type in ascending order, and after it in descending order.
+ * The output schema of a sort is the output schema of its child.
+ */
+class SortPlanNode : public AbstractPlanNode {
+ public:
+  /**
+   * Creates a new sort plan node.
+   * @param output_schema the output schema of the child plan
+   * @param child the child plan to obtain tuples from
+   * @param order_bys the sort keys, most significant first
+   * @param memory_budget the number of bytes of input that are sorted in memory before they are written out as a
+   * sorted run, 0 for no limit
+   */
+  SortPlanNode(const Schema *output_schema, const AbstractPlanNode *child, std::vector<OrderBy> &&order_bys,
+               size_t memory_budget = 0)
+      : AbstractPlanNode(output_schema, {child}), order_bys_(std::move(order_bys)), memory_budget_(memory_budget) {}
+
+  PlanType GetType() const override { return PlanType::Sort; }
+
+  /** @return the child plan */
+  const AbstractPlanNode *GetChildPlan() const {
+    BUSTUB_ASSERT(GetChildren().size() == 1, "Sort should have exactly one child plan.");
+    return GetChildAt(0);
+  }
+
+  /** @return the sort keys, most significant first */
+  const std::vector<OrderBy> &GetOrderBys() const { return order_bys_; }
+
+  /** @return the number of bytes of input that are sorted in memory, 0 for no limit */
+  size_t GetMemoryBudget() const { return memory_budget_; }
+
+ private:
+  /** The sort keys. */
+  std::vector<OrderBy> order_bys_;
+  /** The number of bytes of input that are sorted in memory, 0 for no limit. */
+  size_t memory_budget_;
+};
+
+}  // namespace bustub
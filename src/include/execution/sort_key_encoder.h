@@ -0,0 +1,91 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// sort_key_encoder.h
+//
+// Identification: src/include/execution/sort_key_encoder.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "execution/plans/sort_plan.h"
+#include "storage/table/tuple.h"
+#include "storage/table/tuple_batch.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * SortKeyEncoder turns the ORDER BY keys of a row into a normalized key: a byte string whose byte-wise comparison
+ * orders rows like comparing their keys one by one would. Sorting on normalized keys needs no Values and no dispatch
+ * on the key types, and the first bytes of a key are enough to tell most rows apart.
+ *
+ * Every key value starts with a byte that sorts NULL first. Integers follow big-endian at the width of their type
+ * with the sign bit flipped, booleans as one byte, timestamps big-endian, decimals big-endian with the sign bit flipped
+ * (all bits for negative numbers), and strings with every 0x00 byte escaped as 0x00 0xFF and a 0x00 0x00 terminator,
+ * so that a string sorts before its extensions. The bytes of a descending key are inverted.
+ */
+class SortKeyEncoder {
+ public:
+  /**
+   * Creates a new encoder.
+   * @param order_bys the sort keys, most significant first
+   */
+  explicit SortKeyEncoder(const std::vector<OrderBy> &order_bys) : order_bys_(order_bys) {}
+
+  /**
+   * Appends the normalized key of a row of a batch.
+   * @param batch the batch, laid out according to the schema that the key expressions were built against
+   * @param row_idx the row
+   * @param[out] key the string that the key is appended to
+   */
+  void EncodeRow(const TupleBatch *batch, uint32_t row_idx, std::string *key) const;
+
+  /**
+   * Appends the normalized key of a tuple.
+   * @param tuple the tuple
+   * @param schema the schema that the key expressions were built against
+   * @param[out] key the string that the key is appended to
+   */
+  void EncodeTuple(const Tuple *tuple, const Schema *schema, std::string *key) const;
+
+  /** @return a negative number, zero or a positive number if key a sorts before, with or after key b */
+  static int Compare(const char *a, size_t a_length, const char *b, size_t b_length) {
+    int cmp = memcmp(a, b, std::min(a_length, b_length));
+    if (cmp != 0) {
+      return cmp;
+    }
+    return a_length < b_length ? -1 : (a_length > b_length ? 1 : 0);
+  }
+
+  /**
+   * @return the first 8 bytes of a key as a big-endian integer, padded with zeros; keys with different prefixes
+   * compare like their prefixes
+   */
+  static uint64_t Prefix(const char *key, size_t length) {
+    uint64_t prefix = 0;
+    for (size_t i = 0; i < sizeof(uint64_t); i++) {
+      prefix = prefix << 8 | (i < length ? static_cast<uint8_t>(key[i]) : 0);
+    }
+    return prefix;
+  }
+
+ private:
+  /** Appends the encoding of a key value. */
+  static void EncodeValue(const Value &value, OrderByType order_by_type, std::string *key);
+
+  /** The sort keys. */
+  std::vector<OrderBy> order_bys_;
+};
+
+}  // namespace bustub
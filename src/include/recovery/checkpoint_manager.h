@@ -19,7 +19,12 @@
 namespace bustub {
 
 /**
- * CheckpointManager creates consistent checkpoints by blocking all other transactions temporarily.
+ * CheckpointManager creates fuzzy checkpoints: it writes the dirty pages of the buffer pool one at a time while
+ * transactions keep running, latching only the page being written.
+ *
+ * With logging enabled, a checkpoint is bracketed by a BEGIN_CHECKPOINT and an END_CHECKPOINT log record. Every change
+ * logged before the BEGIN_CHECKPOINT record is on disk once the END_CHECKPOINT record is, so recovery redoes the log
+ * from the BEGIN_CHECKPOINT record of the last completed checkpoint on.
  */
 class CheckpointManager {
  public:
@@ -31,13 +36,20 @@ class CheckpointManager {
 
   ~CheckpointManager() = default;
 
+  /** Logs the beginning of the checkpoint, and writes every page that is dirty when the checkpoint begins. */
   void BeginCheckpoint();
+
+  /** Completes the checkpoint: logs its end, if every page could be written, and waits until the log is persistent. */
   void EndCheckpoint();
 
  private:
   TransactionManager *transaction_manager_ __attribute__((__unused__));
-  LogManager *log_manager_ __attribute__((__unused__));
-  BufferPoolManager *buffer_pool_manager_ __attribute__((__unused__));
+  LogManager *log_manager_;
+  BufferPoolManager *buffer_pool_manager_;
+  /** The LSN of the BEGIN_CHECKPOINT record of the running checkpoint, or INVALID_LSN. */
+  lsn_t begin_lsn_{INVALID_LSN};
+  /** True if the running checkpoint has written every page that was dirty when it began. */
+  bool complete_{false};
 };
 
 }  // namespace bustub
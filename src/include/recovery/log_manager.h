@@ -13,9 +13,12 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <condition_variable>  // NOLINT
 #include <future>              // NOLINT
 #include <mutex>               // NOLINT
+#include <thread>              // NOLINT
 
 #include "recovery/log_record.h"
 #include "storage/disk/disk_manager.h"
@@ -25,11 +28,24 @@ namespace bustub {
 /**
  * LogManager maintains a separate thread that is awakened whenever the log buffer is full or whenever a timeout
  * happens. When the thread is awakened, the log buffer's content is written into the disk log file.
+ *
+ * Committing transactions use group commit: a transaction appends its COMMIT record and waits in Flush() until the
+ * persistent LSN passes it. The flush thread is woken by the first waiter and writes the log buffer, with the COMMIT
+ * records of all the transactions that have appended theirs by then, in a single DiskManager::WriteLog(); the
+ * transactions that commit while it writes are served by the next write. With group commit disabled, every
+ * transaction writes the log buffer itself instead.
+ *
+ * Appending takes no latch. An appender reserves the LSN and the range of the buffer for its record together, by
+ * bumping a single atomic word, and then serializes the record into its range in parallel with the other appenders.
+ * log_buffer_ and flush_buffer_ take turns: the word also says which of the two is appended to, and a flush switches
+ * it over to the other one, which the previous write has freed. The reserved ranges of the buffer that was switched
+ * away from form a prefix of it; the flush waits until every appender has filled its range, and writes only that
+ * contiguous, fully-filled prefix.
  */
 class LogManager {
  public:
   explicit LogManager(DiskManager *disk_manager)
-      : next_lsn_(0), persistent_lsn_(INVALID_LSN), disk_manager_(disk_manager) {
+      : persistent_lsn_(INVALID_LSN), disk_manager_(disk_manager) {
     log_buffer_ = new char[LOG_BUFFER_SIZE];
     flush_buffer_ = new char[LOG_BUFFER_SIZE];
   }
@@ -46,29 +62,82 @@ class LogManager {
 
   lsn_t AppendLogRecord(LogRecord *log_record);
 
-  inline lsn_t GetNextLSN() { return next_lsn_; }
+  /**
+   * Waits until the log records up to and including lsn are persistent.
+   * @param lsn the LSN of the last log record that must be persistent; an LSN that was not handed out yet stands for
+   * the last one that was
+   */
+  void Flush(lsn_t lsn);
+
+  /**
+   * Enables or disables group commit. Without it, or without a running flush thread, Flush() writes the log buffer on
+   * the caller's thread.
+   * @param group_commit true to let the flush thread write the log for all the waiting transactions at once
+   */
+  inline void SetGroupCommit(bool group_commit) { group_commit_ = group_commit; }
+
+  inline lsn_t GetNextLSN() { return LSNOf(reservation_); }
+
+  /**
+   * Continues the LSNs of an existing log, which recovery has read. Nothing may have been appended yet.
+   * @param lsn the LSN of the next log record
+   */
+  void SetNextLSN(lsn_t lsn);
+
   inline lsn_t GetPersistentLSN() { return persistent_lsn_; }
   inline void SetPersistentLSN(lsn_t lsn) { persistent_lsn_ = lsn; }
-  inline char *GetLogBuffer() { return log_buffer_; }
+  inline char *GetLogBuffer() { return BufferOf(reservation_); }
 
  private:
-  // TODO(students): you may add your own member variables
+  /** Serializes a log record into the buffer at dest, which has room for log_record->GetSize() bytes. */
+  static void SerializeLogRecord(const LogRecord &log_record, char *dest);
 
-  /** The atomic counter which records the next log sequence number. */
-  std::atomic<lsn_t> next_lsn_;
+  /** Switches appending over to the other buffer and writes the log records that were appended so far. */
+  void FlushBuffer();
+
+  /** The bit of a reservation word that is set while flush_buffer_ is appended to. */
+  static constexpr uint64_t FLUSH_BUFFER_BIT = uint64_t{1} << 63;
+
+  /** @return the reservation word of the next append */
+  static uint64_t MakeReservation(lsn_t lsn, int offset, bool flush_buffer) {
+    return (flush_buffer ? FLUSH_BUFFER_BIT : 0) | static_cast<uint64_t>(lsn) << 32 | static_cast<uint32_t>(offset);
+  }
+  static lsn_t LSNOf(uint64_t reservation) { return static_cast<lsn_t>((reservation & ~FLUSH_BUFFER_BIT) >> 32); }
+  static int OffsetOf(uint64_t reservation) { return static_cast<int>(reservation & 0xFFFFFFFF); }
+  static int BufferIndexOf(uint64_t reservation) { return (reservation & FLUSH_BUFFER_BIT) != 0 ? 1 : 0; }
+  char *BufferOf(uint64_t reservation) { return BufferIndexOf(reservation) == 0 ? log_buffer_ : flush_buffer_; }
+
+  /**
+   * The next log sequence number, the number of bytes reserved in the buffer that is appended to, and which buffer
+   * that is, in one word (see MakeReservation()).
+   */
+  std::atomic<uint64_t> reservation_{0};
   /** The log records before and including the persistent lsn have been written to disk. */
   std::atomic<lsn_t> persistent_lsn_;
 
   char *log_buffer_;
   char *flush_buffer_;
+  /** The number of bytes that appenders have finished serializing into log_buffer_ and flush_buffer_. */
+  std::array<std::atomic<int>, 2> filled_{};
 
+  /** Protects the persistent LSN for the waiters in Flush(), and the state of the flush thread. */
   std::mutex latch_;
+  /** Serializes the flushes, so that a buffer is appended to only once its last write is done; taken before latch_. */
+  std::mutex flush_latch_;
 
-  std::thread *flush_thread_ __attribute__((__unused__));
+  std::thread *flush_thread_{nullptr};
+  /** True while the flush thread should keep running. */
+  bool running_{false};
+  /** True if a transaction waits in Flush() for the flush thread. */
+  bool flush_requested_{false};
+  std::atomic<bool> group_commit_{true};
 
+  /** Wakes the flush thread. */
   std::condition_variable cv_;
+  /** Wakes the transactions waiting for the persistent LSN to advance. */
+  std::condition_variable flushed_cv_;
 
-  DiskManager *disk_manager_ __attribute__((__unused__));
+  DiskManager *disk_manager_;
 };
 
 }  // namespace bustub
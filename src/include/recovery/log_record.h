@@ -32,6 +32,10 @@ enum class LogRecordType {
   ABORT,
   /** Creating a new page in the table heap. */
   NEWPAGE,
+  /** The beginning of a checkpoint, before it writes the dirty pages. */
+  BEGIN_CHECKPOINT,
+  /** The end of a checkpoint that has written every page that was dirty when it began. */
+  END_CHECKPOINT,
 };
 
 /**
@@ -54,9 +58,13 @@ enum class LogRecordType {
  * | HEADER | tuple_rid | tuple_size | old_tuple_data | tuple_size | new_tuple_data |
  *-----------------------------------------------------------------------------------
  * For new page type log record
- *--------------------------
- * | HEADER | prev_page_id |
- *--------------------------
+ *------------------------------------
+ * | HEADER | prev_page_id | page_id |
+ *------------------------------------
+ * For end checkpoint type log record (begin checkpoint type log records have only the HEADER)
+ *------------------------------------
+ * | HEADER | begin_checkpoint_lsn |
+ *------------------------------------
  */
 class LogRecord {
   friend class LogManager;
@@ -110,6 +118,12 @@ class LogRecord {
     size_ = HEADER_SIZE + sizeof(page_id_t) * 2;
   }
 
+  // constructor for END_CHECKPOINT type
+  LogRecord(LogRecordType log_record_type, lsn_t begin_checkpoint_lsn)
+      : size_(HEADER_SIZE + sizeof(lsn_t)),
+        log_record_type_(log_record_type),
+        begin_checkpoint_lsn_(begin_checkpoint_lsn) {}
+
   ~LogRecord() = default;
 
   inline Tuple &GetDeleteTuple() { return delete_tuple_; }
@@ -128,6 +142,10 @@ class LogRecord {
 
   inline page_id_t GetNewPageRecord() { return prev_page_id_; }
 
+  inline page_id_t GetNewPageId() { return page_id_; }
+
+  inline lsn_t GetBeginCheckpointLSN() { return begin_checkpoint_lsn_; }
+
   inline int32_t GetSize() { return size_; }
 
   inline lsn_t GetLSN() { return lsn_; }
@@ -176,6 +194,9 @@ class LogRecord {
   // case4: for new page operation
   page_id_t prev_page_id_{INVALID_PAGE_ID};
   page_id_t page_id_{INVALID_PAGE_ID};
+
+  // case5: for end checkpoint
+  lsn_t begin_checkpoint_lsn_{INVALID_LSN};
   static const int HEADER_SIZE = 20;
 };  // namespace bustub
 
@@ -15,21 +15,45 @@
 #include <algorithm>
 #include <mutex>  // NOLINT
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
 #include "concurrency/lock_manager.h"
+#include "recovery/log_manager.h"
 #include "recovery/log_record.h"
+#include "storage/page/table_page.h"
 
 namespace bustub {
 
 /**
- * Read log file from disk, redo and undo.
+ * Read log file from disk, redo and undo, in the three passes of ARIES.
+ *
+ * Analysis reads the whole log. It finds the transactions that neither committed nor aborted (active_txn_, with the
+ * LSN of their last log record), the pages whose logged changes may be missing on disk (the dirty page table, with the
+ * first such change), and the last completed checkpoint, which put the changes logged before it began on disk. The
+ * log file offsets of the records of the active transactions end up in lsn_mapping_.
+ *
+ * Redo repeats history from the oldest change in the dirty page table on, which is never before the last completed
+ * checkpoint began, and applies a change only if the LSN of its page shows that the page has not seen it yet.
+ *
+ * Undo rolls the active transactions back, newest change first, following the prev LSN chain of each through
+ * lsn_mapping_. Given a log manager, it logs every reverted change as a compensation record: a record of the inverse
+ * change whose prev LSN is that of the reverted one, so that the chain skips the changes that are reverted already.
+ * Recovering again redoes the compensation records and does not undo them, so a crash during undo does not revert a
+ * change twice. Undo then writes all the pages and logs an ABORT record for every transaction that it rolled back.
+ *
+ * Analysis and redo read the log sequentially in chunks of LOG_READ_SIZE bytes.
  */
 class LogRecovery {
  public:
-  LogRecovery(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager)
-      : disk_manager_(disk_manager), buffer_pool_manager_(buffer_pool_manager), offset_(0) {
-    log_buffer_ = new char[LOG_BUFFER_SIZE];
+  /** The number of bytes of the log that are read at once. */
+  static constexpr int LOG_READ_SIZE = 1 << 22;
+
+  LogRecovery(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, LogManager *log_manager = nullptr)
+      : disk_manager_(disk_manager), buffer_pool_manager_(buffer_pool_manager), log_manager_(log_manager) {
+    log_buffer_ = new char[LOG_READ_SIZE];
   }
 
   ~LogRecovery() {
@@ -37,20 +61,60 @@ class LogRecovery {
     log_buffer_ = nullptr;
   }
 
+  /** Analyzes the log and redoes the changes that the pages on disk miss. */
   void Redo();
+  /** Rolls back the transactions that were active at the end of the log; Redo() must have run. */
   void Undo();
   bool DeserializeLogRecord(const char *data, LogRecord *log_record);
 
  private:
-  DiskManager *disk_manager_ __attribute__((__unused__));
-  BufferPoolManager *buffer_pool_manager_ __attribute__((__unused__));
+  /** A page whose logged changes may be missing on disk. */
+  struct DirtyPage {
+    /** The LSN and the log file offset of the first change that may be missing. */
+    lsn_t rec_lsn_;
+    int rec_offset_;
+    /** The LSN of the last change. */
+    lsn_t last_lsn_;
+  };
+
+  /** Builds active_txn_, lsn_mapping_ and the dirty page table from the whole log. */
+  void Analyze();
+
+  /**
+   * Reads the log sequentially from offset on, in chunks of LOG_READ_SIZE bytes.
+   * @param offset the log file offset of the first log record to read
+   * @param visit called with every complete log record and its log file offset
+   */
+  template <typename Visitor>
+  void ScanLog(int offset, Visitor &&visit);
+
+  /** @return the page that a log record changes, or INVALID_PAGE_ID */
+  static page_id_t GetPageId(const char *data);
+
+  /** Applies a change to its page, unless the page has it already. */
+  void RedoLogRecord(LogRecord *log_record, page_id_t page_id);
+  /** Reverts a change of its page, and logs a compensation record for it. */
+  void UndoLogRecord(LogRecord *log_record, page_id_t page_id);
+  /** Logs a compensation record, given a log manager, as the last change of its page and its transaction. */
+  void Compensate(TablePage *page, LogRecord *compensation);
+
+  DiskManager *disk_manager_;
+  BufferPoolManager *buffer_pool_manager_;
+  LogManager *log_manager_;
 
   /** Maintain active transactions and its corresponding latest lsn. */
   std::unordered_map<txn_id_t, lsn_t> active_txn_;
   /** Mapping the log sequence number to log file offset for undos. */
   std::unordered_map<lsn_t, int> lsn_mapping_;
+  /** The LSNs of the compensation records, which undo skips. */
+  std::unordered_set<lsn_t> compensations_;
+  /** The LSNs and log file offsets of the log records of the transactions that have not ended, during analysis. */
+  std::unordered_map<txn_id_t, std::vector<std::pair<lsn_t, int>>> txn_records_;
+  /** The pages whose logged changes may be missing on disk. */
+  std::unordered_map<page_id_t, DirtyPage> dirty_page_table_;
+  /** The LSN after the last log record. */
+  lsn_t next_lsn_{0};
 
-  int offset_ __attribute__((__unused__));
   char *log_buffer_;
 };
 
@@ -55,7 +55,7 @@ class DiskManager {
   void ReadPage(page_id_t page_id, char *page_data);
 
   /**
-   * Flush the entire log buffer into disk.
+   * Flush the entire log buffer into disk, and sync the log file so that it is durable on return.
    * @param log_data raw log data
    * @param size size of log entry
    */
@@ -104,6 +104,8 @@ class DiskManager {
   int GetFileSize(const std::string &file_name);
   // stream to write log file
   std::fstream log_io_;
+  // file descriptor to sync the log file
+  int log_fd_{-1};
   std::string log_name_;
   // stream to write db file
   std::fstream db_io_;
@@ -55,6 +55,9 @@ class BPlusTree {
   // return the value associated with a given key
   bool GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction = nullptr);
 
+  // append the values whose keys lie in [*low_key, *high_key] to result, in key order; nullptr leaves an end open
+  void GetRange(const KeyType *low_key, const KeyType *high_key, std::vector<ValueType> *result);
+
   // index iterator
   INDEXITERATOR_TYPE begin();
   INDEXITERATOR_TYPE Begin(const KeyType &key);
@@ -18,6 +18,7 @@
 #include <vector>
 
 #include "catalog/schema.h"
+#include "common/exception.h"
 #include "storage/table/tuple.h"
 #include "type/value.h"
 
@@ -137,6 +138,13 @@ class Index {
 
   virtual void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) = 0;
 
+  // append the RIDs of the entries whose keys lie in [low_key, high_key] to result, in key order; a nullptr bound
+  // leaves that end of the range open. Only ordered indexes support range scans.
+  virtual void ScanRange(const Tuple *low_key, const Tuple *high_key, std::vector<RID> *result,
+                         Transaction *transaction) {
+    throw NotImplementedException("The index does not support range scans.");
+  }
+
  private:
   //===--------------------------------------------------------------------===//
   //  Data members
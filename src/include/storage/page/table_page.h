@@ -15,7 +15,7 @@
 #include <cstring>
 
 #include "common/rid.h"
-#include "concurrency/lock_manager.h"
+#include "concurrency/transaction.h"
 #include "recovery/log_manager.h"
 #include "storage/page/page.h"
 #include "storage/table/tuple.h"
@@ -77,34 +77,30 @@ class TablePage : public Page {
    * @param tuple tuple to insert
    * @param[out] rid rid of the inserted tuple
    * @param txn transaction performing the insert
-   * @param lock_manager the lock manager
    * @param log_manager the log manager
    * @return true if the insert is successful (i.e. there is enough space)
    */
-  bool InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, LockManager *lock_manager, LogManager *log_manager);
+  bool InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, LogManager *log_manager);
 
   /**
    * Mark a tuple as deleted. This does not actually delete the tuple.
    * @param rid rid of the tuple to mark as deleted
-   * @param txn transaction performing the delete
-   * @param lock_manager the lock manager
+   * @param txn transaction performing the delete, which must hold an exclusive lock on the tuple
    * @param log_manager the log manager
    * @return true if marking the tuple as deleted is successful (i.e the tuple exists)
    */
-  bool MarkDelete(const RID &rid, Transaction *txn, LockManager *lock_manager, LogManager *log_manager);
+  bool MarkDelete(const RID &rid, Transaction *txn, LogManager *log_manager);
 
   /**
    * Update a tuple.
    * @param new_tuple new value of the tuple
    * @param[out] old_tuple old value of the tuple
    * @param rid rid of the tuple
-   * @param txn transaction performing the update
-   * @param lock_manager the lock manager
+   * @param txn transaction performing the update, which must hold an exclusive lock on the tuple
    * @param log_manager the log manager
    * @return true if updating the tuple succeeded
    */
-  bool UpdateTuple(const Tuple &new_tuple, Tuple *old_tuple, const RID &rid, Transaction *txn,
-                   LockManager *lock_manager, LogManager *log_manager);
+  bool UpdateTuple(const Tuple &new_tuple, Tuple *old_tuple, const RID &rid, Transaction *txn, LogManager *log_manager);
 
   /** To be called on commit or abort. Actually perform the delete or rollback an insert. */
   void ApplyDelete(const RID &rid, Transaction *txn, LogManager *log_manager);
@@ -116,26 +112,44 @@ class TablePage : public Page {
    * Read a tuple from a table.
    * @param rid rid of the tuple to read
    * @param[out] tuple the tuple that was read
-   * @param txn transaction performing the read
-   * @param lock_manager the lock manager
+   * @param txn transaction performing the read, which must hold the lock that its isolation level asks for
    * @return true if the read is successful (i.e. the tuple exists)
    */
-  bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, LockManager *lock_manager);
+  bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn);
+
+  /**
+   * Read a tuple from a table whether or not it is marked deleted. This never aborts a transaction.
+   * @param rid rid of the tuple to read
+   * @param[out] tuple the tuple that was read
+   * @param[out] is_deleted set to true if the tuple is marked deleted
+   * @return true if the slot holds a tuple, false if it is empty or does not exist
+   */
+  bool ReadTuple(const RID &rid, Tuple *tuple, bool *is_deleted);
 
   /** @return the rid of the first tuple in this page */
 
   /**
    * @param[out] first_rid the RID of the first tuple in this page
+   * @param all_slots if true, deleted tuples and empty slots count as tuples too
    * @return true if the first tuple exists, false otherwise
    */
-  bool GetFirstTupleRid(RID *first_rid);
+  bool GetFirstTupleRid(RID *first_rid, bool all_slots = false);
 
   /**
    * @param cur_rid the RID of the current tuple
    * @param[out] next_rid the RID of the tuple following the current tuple
+   * @param all_slots if true, deleted tuples and empty slots count as tuples too
    * @return true if the next tuple exists, false otherwise
    */
-  bool GetNextTupleRid(const RID &cur_rid, RID *next_rid);
+  bool GetNextTupleRid(const RID &cur_rid, RID *next_rid, bool all_slots = false);
+
+  /** @return the number of bytes between the slot array and the tuples, i.e. the space left for new tuples */
+  uint32_t GetFreeSpaceRemaining() {
+    return GetFreeSpacePointer() - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE * GetTupleCount();
+  }
+
+  /** @return the number of free bytes that InsertTuple() needs for a tuple of tuple_size bytes */
+  static uint32_t GetSpaceNeeded(uint32_t tuple_size) { return tuple_size + SIZE_TUPLE; }
 
  private:
   static_assert(sizeof(page_id_t) == 4);
@@ -166,10 +180,6 @@ class TablePage : public Page {
   /** Set the number of tuples in this page. */
   void SetTupleCount(uint32_t tuple_count) { memcpy(GetData() + OFFSET_TUPLE_COUNT, &tuple_count, sizeof(uint32_t)); }
 
-  uint32_t GetFreeSpaceRemaining() {
-    return GetFreeSpacePointer() - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE * GetTupleCount();
-  }
-
   /** @return tuple offset at slot slot_num */
   uint32_t GetTupleOffsetAtSlot(uint32_t slot_num) {
     return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_TUPLE_OFFSET + SIZE_TUPLE * slot_num);
@@ -1,15 +1,13 @@
 #pragma once
 
+#include <cstring>
+
 #include "storage/page/page.h"
 #include "storage/table/tmp_tuple.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
 
-// To pass the test cases for this class, you must follow the existing TmpTuplePage format and implement the
-// existing functions exactly as they are! It may be helpful to look at TablePage.
-// Remember that this task is optional, you get full credit if you finish the next task.
-
 /**
  * TmpTuplePage format:
  *
@@ -17,17 +15,82 @@ namespace bustub {
  * | PageId (4) | LSN (4) | FreeSpace (4) | (free space) | TupleSize2 | TupleData2 | TupleSize1 | TupleData1 |
  *
  * We choose this format because DeserializeExpression expects to read Size followed by Data.
+ *
+ * A TmpTuplePage holds tuples that operators write out temporarily, e.g. the input of a spilling aggregation. Tuples
+ * are appended from the end of the page towards the header and are never deleted; a tuple is addressed by a TmpTuple,
+ * i.e. the page id and the offset of its size field. Iteration starts at the most recently inserted tuple.
  */
 class TmpTuplePage : public Page {
  public:
-  void Init(page_id_t page_id, uint32_t page_size) {}
+  /**
+   * Initializes an empty page.
+   * @param page_id the id of this page
+   * @param page_size the size of this page
+   */
+  void Init(page_id_t page_id, uint32_t page_size) {
+    memcpy(GetData() + OFFSET_PAGE_ID, &page_id, sizeof(page_id_t));
+    SetFreeSpacePointer(page_size);
+  }
+
+  /** @return the id of this page */
+  page_id_t GetTablePageId() { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_PAGE_ID); }
 
-  page_id_t GetTablePageId() { return INVALID_PAGE_ID; }
+  /**
+   * Appends a tuple to this page.
+   * @param tuple the tuple to be appended
+   * @param[out] out the location of the appended tuple
+   * @return false if the page does not have enough free space left
+   */
+  bool Insert(const Tuple &tuple, TmpTuple *out) {
+    uint32_t size = tuple.GetLength() + sizeof(uint32_t);
+    if (GetFreeSpacePointer() < SIZE_HEADER + size) {
+      return false;
+    }
+    uint32_t offset = GetFreeSpacePointer() - size;
+    tuple.SerializeTo(GetData() + offset);
+    SetFreeSpacePointer(offset);
+    *out = TmpTuple(GetTablePageId(), offset);
+    return true;
+  }
 
-  bool Insert(const Tuple &tuple, TmpTuple *out) { return false; }
+  /**
+   * Reads a tuple of this page.
+   * @param tmp_tuple the location of the tuple
+   * @param[out] tuple the tuple
+   */
+  void Get(const TmpTuple &tmp_tuple, Tuple *tuple) { tuple->DeserializeFrom(GetData() + tmp_tuple.GetOffset()); }
+
+  /**
+   * @param[out] first the location of the most recently inserted tuple
+   * @return false if the page is empty
+   */
+  bool GetFirstTmpTuple(TmpTuple *first) {
+    *first = TmpTuple(GetTablePageId(), GetFreeSpacePointer());
+    return GetFreeSpacePointer() < PAGE_SIZE;
+  }
+
+  /**
+   * @param cur the location of the current tuple
+   * @param[out] next the location of the tuple that was inserted before the current one
+   * @return false if the current tuple is the first tuple inserted into the page
+   */
+  bool GetNextTmpTuple(const TmpTuple &cur, TmpTuple *next) {
+    size_t offset = cur.GetOffset() + sizeof(uint32_t) + *reinterpret_cast<uint32_t *>(GetData() + cur.GetOffset());
+    *next = TmpTuple(cur.GetPageId(), offset);
+    return offset < PAGE_SIZE;
+  }
 
  private:
   static_assert(sizeof(page_id_t) == 4);
+  static constexpr size_t SIZE_HEADER = 12;
+  static constexpr size_t OFFSET_PAGE_ID = 0;
+  static constexpr size_t OFFSET_FREE_SPACE = 8;
+
+  uint32_t GetFreeSpacePointer() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_FREE_SPACE); }
+
+  void SetFreeSpacePointer(uint32_t free_space_pointer) {
+    memcpy(GetData() + OFFSET_FREE_SPACE, &free_space_pointer, sizeof(uint32_t));
+  }
 };
 
 }  // namespace bustub
@@ -0,0 +1,90 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_directory.h
+//
+// Identification: src/include/storage/table/free_space_directory.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * FreeSpaceDirectory remembers how much free space the pages of a table heap have, so that an insert can go straight
+ * to a page with room instead of walking the page list.
+ *
+ * The pages are kept in buckets of BUCKET_WIDTH bytes of free space. A page in a bucket whose lower bound is at least
+ * the requested size certainly has room; among all such pages, the caller's hint picks one, so that concurrent
+ * inserters with different hints end up on different pages. Only if there is none, a few pages of the bucket just
+ * below are checked against their exact free space. The recorded free space is only as fresh as the last Update() of
+ * a page, so a page that is returned may turn out to be full; the caller then records its actual free space and asks
+ * again.
+ *
+ * The directory lives in memory only. It is thread-safe.
+ */
+class FreeSpaceDirectory {
+ public:
+  /** The number of buckets. */
+  static constexpr uint32_t BUCKET_COUNT = 32;
+  /** The range of free space, in bytes, that a bucket covers. */
+  static constexpr uint32_t BUCKET_WIDTH = PAGE_SIZE / BUCKET_COUNT;
+  /** Pages with less free space than this are not kept. */
+  static constexpr uint32_t MIN_FREE_SPACE = 16;
+  /** The number of pages of the bucket below the first certain one that Find() checks. */
+  static constexpr uint32_t MAX_PROBES = 4;
+
+  /**
+   * Records the free space of a page, adding the page if it is not in the directory yet.
+   * @param page_id the page
+   * @param free_space the number of free bytes of the page
+   */
+  void Update(page_id_t page_id, uint32_t free_space);
+
+  /**
+   * Picks a page that had at least size free bytes when it was last updated.
+   * @param size the number of free bytes needed
+   * @param hint a value that is the same for the calls of one inserter and differs between inserters
+   * @param min_pages the number of pages that must certainly have room; if there are fewer, no page is returned, so
+   * that the caller adds a page
+   * @return the page, or INVALID_PAGE_ID if there is none
+   */
+  page_id_t Find(uint32_t size, size_t hint, size_t min_pages = 1);
+
+  /** @return the number of pages in the directory */
+  size_t GetPageCount();
+
+ private:
+  /** A page in a bucket. */
+  struct Entry {
+    page_id_t page_id_;
+    uint32_t free_space_;
+  };
+
+  /** @return the bucket of pages with free_space free bytes */
+  static uint32_t BucketOf(uint32_t free_space) { return std::min(free_space / BUCKET_WIDTH, BUCKET_COUNT - 1); }
+
+  /** Removes the entry at position pos of a bucket, moving the last entry of the bucket into its place. */
+  void RemoveEntry(uint32_t bucket, size_t pos);
+
+  std::mutex latch_;
+  /** The pages, by free space. */
+  std::array<std::vector<Entry>, BUCKET_COUNT> buckets_;
+  /** The bucket and the position in it of every page. */
+  std::unordered_map<page_id_t, std::pair<uint32_t, size_t>> positions_;
+};
+
+}  // namespace bustub
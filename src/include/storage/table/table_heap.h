@@ -12,17 +12,39 @@
 
 #pragma once
 
+#include <atomic>
+#include <mutex>  // NOLINT
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
+#include "concurrency/lock_manager.h"
 #include "recovery/log_manager.h"
 #include "storage/page/table_page.h"
+#include "storage/table/free_space_directory.h"
 #include "storage/table/table_iterator.h"
 #include "storage/table/tuple.h"
+#include "storage/table/tuple_batch.h"
+#include "storage/table/version_store.h"
 
 namespace bustub {
 
 /**
  * TableHeap represents a physical table on disk.
  * This is just a doubly-linked list of pages.
+ *
+ * Inserts find a page with room through a FreeSpaceDirectory rather than by walking the list, and new pages are
+ * chained after the last page, which is found from a hint. The directory is built by one walk of the list on the
+ * first insert, and kept up to date by every operation that changes the free space of a page.
+ *
+ * If logging is enabled, the heap locks what it reads and writes through LockManager::LockRow(), under the oid of
+ * its table, so that a transaction that holds a lock on the table or a page does not lock the rows below it. The
+ * table lock is taken before any page is latched.
+ *
+ * Every write is versioned in a VersionStore for SNAPSHOT_ISOLATION transactions, which read without locks from their
+ * snapshot and see every row whose version they read, deleted or not in the page. Their writes still lock rows
+ * exclusively, so that they wait for a concurrent writer, and then fail if it committed: first updater wins. A
+ * committed delete frees its slot at once, as the older snapshots read the deleted tuple from the version store.
+ * Indexes are not versioned.
  */
 class TableHeap {
   friend class TableIterator;
@@ -36,9 +58,10 @@ class TableHeap {
    * @param lock_manager the lock manager
    * @param log_manager the log manager
    * @param first_page_id the id of the first page
+   * @param table_oid the oid of the table, under which rows are locked
    */
   TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
-            page_id_t first_page_id);
+            page_id_t first_page_id, table_oid_t table_oid = 0);
 
   /**
    * Create a table heap with a transaction. (create table)
@@ -46,12 +69,15 @@ class TableHeap {
    * @param lock_manager the lock manager
    * @param log_manager the log manager
    * @param txn the creating transaction
+   * @param table_oid the oid of the table, under which rows are locked
    */
   TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
-            Transaction *txn);
+            Transaction *txn, table_oid_t table_oid = 0);
 
   /**
    * Insert a tuple into the table. If the tuple is too large (>= page_size), return false.
+   * The tuple goes to a page that the free space directory picks. Concurrent inserters are spread over different
+   * pages: while there are fewer pages with room than inserters, a new page is added rather than shared.
    * @param tuple tuple to insert
    * @param[out] rid the rid of the inserted tuple
    * @param txn the transaction performing the insert
@@ -59,6 +85,18 @@ class TableHeap {
    */
   bool InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn);
 
+  /**
+   * Append tuples to the end of the table, filling the last page before allocating new ones. The page being filled
+   * stays latched and pinned from one tuple to the next, so every page is fetched once. Unlike InsertTuple(), this
+   * does not look for free space in earlier pages.
+   * @param tuples the tuples to insert
+   * @param[out] rids the rids of the inserted tuples, in order
+   * @param txn the transaction performing the insert
+   * @return true iff every tuple was inserted; otherwise the transaction is aborted, and rids holds the rids of the
+   * tuples inserted before the failure
+   */
+  bool AppendTuples(const std::vector<Tuple> &tuples, std::vector<RID> *rids, Transaction *txn);
+
   /**
    * Mark the tuple as deleted. The actual delete will occur when ApplyDelete is called.
    * @param rid resource id of the tuple of delete
@@ -77,12 +115,27 @@ class TableHeap {
   bool UpdateTuple(const Tuple &tuple, const RID &rid, Transaction *txn);
 
   /**
-   * Called on Commit/Abort to actually delete a tuple or rollback an insert.
+   * Called on Commit to actually delete a tuple.
    * @param rid rid of the tuple to delete
    * @param txn transaction performing the delete.
    */
   void ApplyDelete(const RID &rid, Transaction *txn);
 
+  /**
+   * Called on abort to rollback an insert.
+   * @param rid rid of the inserted tuple.
+   * @param txn transaction performing the rollback
+   */
+  void RollbackInsert(const RID &rid, Transaction *txn);
+
+  /**
+   * Called on abort to rollback an update.
+   * @param old_tuple the value of the tuple before the update
+   * @param rid rid of the updated tuple.
+   * @param txn transaction performing the rollback
+   */
+  void RollbackUpdate(const Tuple &old_tuple, const RID &rid, Transaction *txn);
+
   /**
    * Called on abort to rollback a delete.
    * @param rid rid of the deleted tuple.
@@ -99,6 +152,23 @@ class TableHeap {
    */
   bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn);
 
+  /**
+   * Collects the ids of the pages of this table, in the order of the page list.
+   * @param[out] page_ids the page ids
+   */
+  void GetPageIds(std::vector<page_id_t> *page_ids);
+
+  /**
+   * Appends every tuple of one page of this table to a batch. Scanning disjoint pages from several threads is safe as
+   * long as each thread passes its own batch.
+   * @param page_id the id of the page to be read
+   * @param[out] batch the batch, laid out according to the table schema
+   * @param txn the transaction performing the read
+   * @return false if a lock could not be taken, in which case the transaction is aborted and the batch holds only some
+   * of the page
+   */
+  bool ScanPage(page_id_t page_id, TupleBatch *batch, Transaction *txn);
+
   /** @return the begin iterator of this table */
   TableIterator Begin(Transaction *txn);
 
@@ -108,11 +178,69 @@ class TableHeap {
   /** @return the id of the first page of this table */
   inline page_id_t GetFirstPageId() const { return first_page_id_; }
 
+  /** @return the oid of the table, under which rows are locked */
+  inline table_oid_t GetTableOid() const { return table_oid_; }
+
+  /** @return the older versions of the rows of this table */
+  inline VersionStore *GetVersionStore() { return &versions_; }
+
  private:
   BufferPoolManager *buffer_pool_manager_;
   LockManager *lock_manager_;
   LogManager *log_manager_;
+  table_oid_t table_oid_;
   page_id_t first_page_id_{};
+  /**
+   * Locks a row for a transaction that is about to write it, unless logging is off or the transaction holds an
+   * exclusive lock on it already, possibly through its page or the table.
+   * @return false if the lock could not be taken
+   */
+  bool LockRowForWrite(const RID &rid, Transaction *txn);
+
+  /**
+   * Locks a row for a transaction that is about to read it, unless logging is off or the transaction reads
+   * uncommitted data or a snapshot, which take no shared locks.
+   * @return false if the lock could not be taken
+   */
+  bool LockRowForRead(const RID &rid, Transaction *txn);
+
+  /**
+   * Locks a tuple that a transaction has just inserted into a page. If the lock cannot be taken, the tuple is taken
+   * out of the page again and the transaction is aborted.
+   * @param page the page holding the tuple, WLatched
+   * @return false if the lock could not be taken
+   */
+  bool LockNewTuple(TablePage *page, const RID &rid, Transaction *txn);
+
+  /** Deletes a tuple from its page and releases its lock, for a commit of a delete or a rollback of an insert. */
+  void RemoveTuple(const RID &rid, Transaction *txn, bool is_rollback);
+
+  /** Records the free space of every page into free_space_, once. */
+  void LoadFreeSpace();
+
+  /**
+   * Chains a new page after the last page of the list.
+   * @return the new page, WLatched and pinned, or nullptr if no page could be allocated
+   */
+  TablePage *AppendPage(Transaction *txn);
+
+  /**
+   * Chains a new page after a page, which is unlatched and unpinned in any case.
+   * @param last_page the last page of the list, WLatched and pinned
+   * @return the new page, WLatched and pinned, or nullptr if no page could be allocated
+   */
+  TablePage *LinkNewPage(TablePage *last_page, Transaction *txn);
+
+  /** A page at or before the end of the page list, from which the last page is looked for. */
+  std::atomic<page_id_t> last_page_id_{INVALID_PAGE_ID};
+  /** The free space of the pages. */
+  FreeSpaceDirectory free_space_;
+  /** Set once free_space_ has been loaded. */
+  std::once_flag free_space_loaded_;
+  /** The number of InsertTuple() calls in progress. */
+  std::atomic<uint32_t> active_inserters_{0};
+  /** The older versions of the rows. */
+  VersionStore versions_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,136 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tuple_batch.h
+//
+// Identification: src/include/storage/table/tuple_batch.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/rid.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * TupleBatch holds up to GetCapacity() rows of a schema in columnar form, plus the RID of every row. Fixed-width
+ * integer columns (TINYINT, SMALLINT, INTEGER, BIGINT) are stored as contiguous arrays of 64-bit integers so that
+ * predicates can be evaluated over them without materializing Values; every other column is stored as Values.
+ * Executors that support batch-at-a-time execution fill a TupleBatch in NextBatch() instead of producing one
+ * serialized Tuple per call to Next().
+ */
+class TupleBatch {
+ public:
+  /** The default number of rows in a batch. */
+  static constexpr uint32_t DEFAULT_BATCH_SIZE = 1024;
+
+  /**
+   * Creates a new empty batch.
+   * @param schema the schema of the rows in the batch
+   * @param capacity the maximum number of rows in the batch
+   */
+  explicit TupleBatch(const Schema *schema, uint32_t capacity = DEFAULT_BATCH_SIZE);
+
+  /** @return true if values of the given type are stored as integers */
+  static bool IsIntegerType(TypeId type) {
+    return type == TypeId::TINYINT || type == TypeId::SMALLINT || type == TypeId::INTEGER || type == TypeId::BIGINT;
+  }
+
+  /** @return the integer value, widened to 64 bits, of a value whose type satisfies IsIntegerType() */
+  static int64_t IntegerOf(const Value &value);
+
+  /** @return the widened integer that represents NULL for the given integer type */
+  static int64_t IntegerNull(TypeId type);
+
+  /** @return the schema of the rows in the batch */
+  const Schema *GetSchema() const { return schema_; }
+
+  /** @return the maximum number of rows in the batch */
+  uint32_t GetCapacity() const { return capacity_; }
+
+  /** @return the number of rows in the batch */
+  uint32_t GetRowCount() const { return static_cast<uint32_t>(rids_.size()); }
+
+  /** @return true if the batch holds no rows */
+  bool IsEmpty() const { return rids_.empty(); }
+
+  /** @return true if no more rows can be appended to the batch */
+  bool IsFull() const { return rids_.size() >= capacity_; }
+
+  /** @return true if the col_idx'th column is stored as integers */
+  bool IsIntegerColumn(uint32_t col_idx) const { return IsIntegerType(types_[col_idx]); }
+
+  /** @return the values of the col_idx'th column, which must be stored as integers */
+  const int64_t *GetIntegerColumn(uint32_t col_idx) const { return integers_[col_idx].data(); }
+
+  /** @return the value of the col_idx'th column of the row_idx'th row */
+  Value GetValue(uint32_t row_idx, uint32_t col_idx) const {
+    if (IsIntegerColumn(col_idx)) {
+      return Value(types_[col_idx], integers_[col_idx][row_idx]);
+    }
+    return values_[col_idx][row_idx];
+  }
+
+  /** @return the RID of the row_idx'th row */
+  const RID &GetRid(uint32_t row_idx) const { return rids_[row_idx]; }
+
+  /**
+   * Appends a row to the batch.
+   * @param values the values of the row, one per column of the schema
+   * @param rid the RID of the row
+   */
+  void AppendRow(const std::vector<Value> &values, const RID &rid);
+
+  /**
+   * Appends a tuple to the batch.
+   * @param tuple a tuple laid out according to the schema of the batch
+   * @param rid the RID of the tuple
+   */
+  void AppendTuple(const Tuple &tuple, const RID &rid);
+
+  /** @return the row_idx'th row serialized as a tuple */
+  Tuple GetTuple(uint32_t row_idx) const;
+
+  /** Removes every row from the batch. The column vectors keep their memory. */
+  void Clear();
+
+  /** Removes every row from row_count onwards. */
+  void Truncate(uint32_t row_count);
+
+  /** Removes the first row_count rows. */
+  void EraseFront(uint32_t row_count);
+
+ private:
+  /** Appends value to the col_idx'th column. */
+  void AppendValue(uint32_t col_idx, const Value &value) {
+    if (IsIntegerColumn(col_idx)) {
+      integers_[col_idx].push_back(IntegerOf(value));
+    } else {
+      values_[col_idx].push_back(value);
+    }
+  }
+
+  /** The schema of the rows in the batch. */
+  const Schema *schema_;
+  /** The maximum number of rows in the batch. */
+  uint32_t capacity_;
+  /** The type of each column. */
+  std::vector<TypeId> types_;
+  /** The values of each integer column; empty for the other columns. */
+  std::vector<std::vector<int64_t>> integers_;
+  /** The values of each non-integer column; empty for the integer columns. */
+  std::vector<std::vector<Value>> values_;
+  /** The RID of each row. */
+  std::vector<RID> rids_;
+};
+
+}  // namespace bustub
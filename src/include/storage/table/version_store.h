@@ -0,0 +1,146 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// version_store.h
+//
+// Identification: src/include/storage/table/version_store.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "common/config.h"
+#include "common/rid.h"
+#include "concurrency/transaction.h"
+#include "storage/page/table_page.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * VersionStore keeps the older versions of the rows of a table heap, for the snapshots of SNAPSHOT_ISOLATION
+ * transactions.
+ *
+ * The newest version of a row is the one in its table page. A row that has older versions that someone may still read,
+ * or that a transaction has written and not committed yet, has a version chain: the transaction that writes the row,
+ * the commit timestamp of the version in the page, and the older versions with the commit timestamps from which they
+ * were valid. The first write of a transaction to a row copies the version in the page to the chain; the version is
+ * stamped when the transaction commits, and put back into the chain's head when it aborts. A snapshot reads the newest
+ * version whose timestamp is at most its read timestamp. A row without a chain was committed before every snapshot.
+ *
+ * Every write is versioned, whatever the isolation level of the writer: a snapshot may begin while the write is not
+ * committed yet, and it must neither see the write nor miss that the row changed after its read timestamp. The chain
+ * of a committed write is dropped at the next GarbageCollect() if no snapshot is running.
+ *
+ * Versions that no snapshot can read anymore, because a newer version was committed at or before the oldest read
+ * timestamp, are dropped by GarbageCollect().
+ *
+ * The chains live in memory only and are sharded by RID. The caller holds the latch of the row's page, so that the
+ * version in the page does not change under the store.
+ */
+class VersionStore {
+ public:
+  /** The number of shards of the chains. */
+  static constexpr size_t SHARD_COUNT = 16;
+
+  /**
+   * Prepares a row for a write. The first write of a transaction to a versioned row copies the current version into
+   * the chain. First updater wins: the write conflicts if another transaction has written the row and not committed
+   * yet, or if a snapshot writer's row has a version committed after its snapshot.
+   * @param rid the row
+   * @param txn the writing transaction
+   * @param page the row's page, latched exclusively
+   * @return false if the write conflicts, in which case the caller aborts the transaction
+   */
+  bool BeginWrite(const RID &rid, Transaction *txn, TablePage *page);
+
+  /**
+   * Records that a transaction inserted a row. The slot of the row was empty before, possibly because of a committed
+   * delete that older snapshots do not see yet, so an insert never conflicts.
+   * @param rid the row that was inserted
+   * @param txn the inserting transaction
+   */
+  void BeginInsert(const RID &rid, Transaction *txn);
+
+  /**
+   * Undoes one BeginWrite() or BeginInsert() of a transaction. Once all its writes to the row are undone, the version
+   * that the transaction copied becomes the row's head again; the caller has restored it into the page already.
+   * @param rid the row
+   * @param txn the transaction whose write is undone
+   */
+  void AbortWrite(const RID &rid, Transaction *txn);
+
+  /**
+   * Stamps the version that a transaction wrote with its commit timestamp.
+   * @param rid the row
+   * @param txn the committing transaction
+   * @param commit_ts the commit timestamp
+   */
+  void CommitWrite(const RID &rid, Transaction *txn, timestamp_t commit_ts);
+
+  /**
+   * Reads the version of a row that a snapshot sees, which is either the one in the page or an older one.
+   * @param rid the row
+   * @param txn the reading transaction
+   * @param page the row's page, latched
+   * @param[out] tuple the version that was read
+   * @return true if the row exists in the snapshot
+   */
+  bool ReadVersion(const RID &rid, Transaction *txn, TablePage *page, Tuple *tuple);
+
+  /**
+   * Drops the versions that no snapshot with a read timestamp of at least watermark reads, and the chains that have
+   * nothing left to tell. Does nothing if the watermark has not advanced since the last call.
+   * @param watermark the oldest read timestamp of a running snapshot, or the last commit timestamp if there is none
+   * @return the number of versions dropped
+   */
+  size_t GarbageCollect(timestamp_t watermark);
+
+  /** @return the number of older versions kept */
+  size_t GetVersionCount();
+
+ private:
+  /** An older version of a row. */
+  struct Version {
+    /** The commit timestamp from which the version was valid. */
+    timestamp_t ts_;
+    /** True if the row did not exist in this version. */
+    bool deleted_;
+    /** The tuple, unless deleted_. */
+    Tuple tuple_;
+  };
+
+  /** The versions of a row. */
+  struct VersionChain {
+    /** The transaction that wrote the version in the page and has not committed yet, or INVALID_TXN_ID. */
+    txn_id_t writer_{INVALID_TXN_ID};
+    /** The number of writes of writer_ that were not undone. */
+    uint32_t write_count_{0};
+    /** The commit timestamp of the version in the page, unless there is a writer_. */
+    timestamp_t head_ts_{0};
+    /** The older versions, oldest first. */
+    std::vector<Version> undo_;
+  };
+
+  struct Shard {
+    std::mutex latch_;
+    std::unordered_map<RID, VersionChain> chains_;
+  };
+
+  Shard &ShardOf(const RID &rid) { return shards_[std::hash<RID>()(rid) % SHARD_COUNT]; }
+
+  std::array<Shard, SHARD_COUNT> shards_;
+  std::mutex gc_latch_;
+  /** The watermark of the last GarbageCollect(). */
+  timestamp_t gc_watermark_{-1};
+};
+
+}  // namespace bustub
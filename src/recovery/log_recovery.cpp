@@ -12,6 +12,9 @@
 
 #include "recovery/log_recovery.h"
 
+#include <cstring>
+#include <queue>
+
 #include "storage/page/table_page.h"
 
 namespace bustub {
@@ -20,21 +23,335 @@ namespace bustub {
  * @return: true means deserialize succeed, otherwise can't deserialize cause
  * incomplete log record
  */
-bool LogRecovery::DeserializeLogRecord(const char *data, LogRecord *log_record) { return false; }
+bool LogRecovery::DeserializeLogRecord(const char *data, LogRecord *log_record) {
+  memcpy(&log_record->size_, data, sizeof(int32_t));
+  memcpy(&log_record->lsn_, data + 4, sizeof(lsn_t));
+  memcpy(&log_record->txn_id_, data + 8, sizeof(txn_id_t));
+  memcpy(&log_record->prev_lsn_, data + 12, sizeof(lsn_t));
+  memcpy(&log_record->log_record_type_, data + 16, sizeof(LogRecordType));
+  if (log_record->size_ < LogRecord::HEADER_SIZE || log_record->log_record_type_ == LogRecordType::INVALID ||
+      log_record->log_record_type_ > LogRecordType::END_CHECKPOINT) {
+    return false;
+  }
+  const char *pos = data + LogRecord::HEADER_SIZE;
+  switch (log_record->log_record_type_) {
+    case LogRecordType::INSERT:
+      memcpy(&log_record->insert_rid_, pos, sizeof(RID));
+      log_record->insert_tuple_.DeserializeFrom(pos + sizeof(RID));
+      break;
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      memcpy(&log_record->delete_rid_, pos, sizeof(RID));
+      log_record->delete_tuple_.DeserializeFrom(pos + sizeof(RID));
+      break;
+    case LogRecordType::UPDATE:
+      memcpy(&log_record->update_rid_, pos, sizeof(RID));
+      pos += sizeof(RID);
+      log_record->old_tuple_.DeserializeFrom(pos);
+      pos += sizeof(int32_t) + log_record->old_tuple_.GetLength();
+      log_record->new_tuple_.DeserializeFrom(pos);
+      break;
+    case LogRecordType::NEWPAGE:
+      memcpy(&log_record->prev_page_id_, pos, sizeof(page_id_t));
+      memcpy(&log_record->page_id_, pos + sizeof(page_id_t), sizeof(page_id_t));
+      break;
+    case LogRecordType::END_CHECKPOINT:
+      memcpy(&log_record->begin_checkpoint_lsn_, pos, sizeof(lsn_t));
+      break;
+    default:
+      break;
+  }
+  return true;
+}
 
 /*
- *redo phase on TABLE PAGE level(table/table_page.h)
- *read log file from the beginning to end (you must prefetch log records into
- *log buffer to reduce unnecessary I/O operations), remember to compare page's
- *LSN with log_record's sequence number, and also build active_txn_ table &
- *lsn_mapping_ table
+ * redo phase on TABLE PAGE level(table/table_page.h)
+ * analyze the whole log first, then read the log file from the oldest change
+ * in the dirty page table on, and compare each page's LSN with the log
+ * record's sequence number
  */
-void LogRecovery::Redo() {}
+void LogRecovery::Redo() {
+  Analyze();
+  if (dirty_page_table_.empty()) {
+    return;
+  }
+  int offset = dirty_page_table_.begin()->second.rec_offset_;
+  for (const auto &dirty_page : dirty_page_table_) {
+    offset = std::min(offset, dirty_page.second.rec_offset_);
+  }
+  ScanLog(offset, [this](const char *data, int /* offset */) {
+    auto dirty_page = dirty_page_table_.find(GetPageId(data));
+    lsn_t lsn = *reinterpret_cast<const lsn_t *>(data + 4);
+    if (dirty_page == dirty_page_table_.end() || lsn < dirty_page->second.rec_lsn_) {
+      return;
+    }
+    LogRecord log_record;
+    if (DeserializeLogRecord(data, &log_record)) {
+      RedoLogRecord(&log_record, dirty_page->first);
+    }
+  });
+}
 
 /*
- *undo phase on TABLE PAGE level(table/table_page.h)
- *iterate through active txn map and undo each operation
+ * undo phase on TABLE PAGE level(table/table_page.h)
+ * undo the operations of the active txns, newest first
  */
-void LogRecovery::Undo() {}
+void LogRecovery::Undo() {
+  if (log_manager_ != nullptr) {
+    // The compensation records continue the log.
+    log_manager_->SetNextLSN(next_lsn_);
+  }
+  std::priority_queue<lsn_t> lsns;
+  for (const auto &txn : active_txn_) {
+    lsns.push(txn.second);
+  }
+  while (!lsns.empty()) {
+    lsn_t lsn = lsns.top();
+    lsns.pop();
+    auto offset = lsn_mapping_.find(lsn);
+    BUSTUB_ASSERT(offset != lsn_mapping_.end(), "The log records of active transactions must be mapped.");
+    // Log records fit into the log buffer.
+    disk_manager_->ReadLog(log_buffer_, LOG_BUFFER_SIZE, offset->second);
+    LogRecord log_record;
+    if (!DeserializeLogRecord(log_buffer_, &log_record)) {
+      continue;
+    }
+    // A compensation record was redone already, and its prev LSN skips the changes that an earlier undo reverted.
+    if (compensations_.count(lsn) == 0) {
+      UndoLogRecord(&log_record, GetPageId(log_buffer_));
+    }
+    if (log_record.prev_lsn_ != INVALID_LSN) {
+      lsns.push(log_record.prev_lsn_);
+    }
+  }
+
+  if (log_manager_ == nullptr) {
+    return;
+  }
+  // The rollbacks are on disk before their ABORT records are.
+  buffer_pool_manager_->FlushAllPages();
+  lsn_t lsn = INVALID_LSN;
+  for (const auto &txn : active_txn_) {
+    LogRecord log_record(txn.first, txn.second, LogRecordType::ABORT);
+    lsn = log_manager_->AppendLogRecord(&log_record);
+  }
+  if (lsn != INVALID_LSN) {
+    log_manager_->Flush(lsn);
+  }
+}
+
+void LogRecovery::Analyze() {
+  active_txn_.clear();
+  lsn_mapping_.clear();
+  dirty_page_table_.clear();
+  compensations_.clear();
+  next_lsn_ = 0;
+  lsn_t begin_checkpoint_lsn = INVALID_LSN;
+  int begin_checkpoint_offset = 0;
+  ScanLog(0, [&](const char *data, int offset) {
+    lsn_t lsn = *reinterpret_cast<const lsn_t *>(data + 4);
+    txn_id_t txn_id = *reinterpret_cast<const txn_id_t *>(data + 8);
+    LogRecordType log_record_type = *reinterpret_cast<const LogRecordType *>(data + 16);
+    next_lsn_ = lsn + 1;
+    switch (log_record_type) {
+      case LogRecordType::BEGIN_CHECKPOINT:
+        begin_checkpoint_lsn = lsn;
+        begin_checkpoint_offset = offset;
+        return;
+      case LogRecordType::END_CHECKPOINT: {
+        if (*reinterpret_cast<const lsn_t *>(data + LogRecord::HEADER_SIZE) != begin_checkpoint_lsn) {
+          return;
+        }
+        // The checkpoint wrote every change logged before it began. A page that changed again since is redone from
+        // the beginning of the checkpoint on, as the exact change is not known anymore.
+        for (auto it = dirty_page_table_.begin(); it != dirty_page_table_.end();) {
+          if (it->second.last_lsn_ < begin_checkpoint_lsn) {
+            it = dirty_page_table_.erase(it);
+            continue;
+          }
+          if (it->second.rec_lsn_ < begin_checkpoint_lsn) {
+            it->second.rec_lsn_ = begin_checkpoint_lsn;
+            it->second.rec_offset_ = begin_checkpoint_offset;
+          }
+          ++it;
+        }
+        return;
+      }
+      case LogRecordType::COMMIT:
+      case LogRecordType::ABORT:
+        txn_records_.erase(txn_id);
+        return;
+      default:
+        break;
+    }
+    // Every log record of a transaction links to the one before it, except for a compensation record.
+    auto &records = txn_records_[txn_id];
+    lsn_t prev_lsn = *reinterpret_cast<const lsn_t *>(data + 12);
+    if (prev_lsn != (records.empty() ? INVALID_LSN : records.back().first)) {
+      compensations_.insert(lsn);
+    }
+    records.emplace_back(lsn, offset);
+    page_id_t page_id = GetPageId(data);
+    if (page_id != INVALID_PAGE_ID) {
+      auto dirty_page = dirty_page_table_.emplace(page_id, DirtyPage{lsn, offset, lsn});
+      dirty_page.first->second.last_lsn_ = lsn;
+    }
+  });
+
+  // Only the transactions that did not end need their log records mapped.
+  for (const auto &txn : txn_records_) {
+    active_txn_[txn.first] = txn.second.back().first;
+    for (const auto &record : txn.second) {
+      lsn_mapping_[record.first] = record.second;
+    }
+  }
+  txn_records_.clear();
+}
+
+template <typename Visitor>
+void LogRecovery::ScanLog(int offset, Visitor &&visit) {
+  while (disk_manager_->ReadLog(log_buffer_, LOG_READ_SIZE, offset)) {
+    int pos = 0;
+    while (pos + LogRecord::HEADER_SIZE <= LOG_READ_SIZE) {
+      int32_t size = *reinterpret_cast<const int32_t *>(log_buffer_ + pos);
+      // The log ends with zeros; a record that the chunk cuts off is read again with the next chunk.
+      if (size < LogRecord::HEADER_SIZE || pos + size > LOG_READ_SIZE) {
+        break;
+      }
+      visit(log_buffer_ + pos, offset + pos);
+      pos += size;
+    }
+    if (pos == 0) {
+      break;
+    }
+    offset += pos;
+  }
+}
+
+page_id_t LogRecovery::GetPageId(const char *data) {
+  const char *pos = data + LogRecord::HEADER_SIZE;
+  switch (*reinterpret_cast<const LogRecordType *>(data + 16)) {
+    case LogRecordType::INSERT:
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+    case LogRecordType::UPDATE:
+      return reinterpret_cast<const RID *>(pos)->GetPageId();
+    case LogRecordType::NEWPAGE:
+      return *reinterpret_cast<const page_id_t *>(pos + sizeof(page_id_t));
+    default:
+      return INVALID_PAGE_ID;
+  }
+}
+
+void LogRecovery::RedoLogRecord(LogRecord *log_record, page_id_t page_id) {
+  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+  BUSTUB_ASSERT(page != nullptr, "The buffer pool must have room for a page.");
+  bool redo = page->GetLSN() < log_record->lsn_;
+  if (redo) {
+    switch (log_record->log_record_type_) {
+      case LogRecordType::INSERT: {
+        RID rid;
+        page->InsertTuple(log_record->insert_tuple_, &rid, nullptr, nullptr);
+        BUSTUB_ASSERT(rid == log_record->insert_rid_, "Redo must insert into the same slot.");
+        break;
+      }
+      case LogRecordType::MARKDELETE:
+        page->MarkDelete(log_record->delete_rid_, nullptr, nullptr);
+        break;
+      case LogRecordType::APPLYDELETE:
+        page->ApplyDelete(log_record->delete_rid_, nullptr, nullptr);
+        break;
+      case LogRecordType::ROLLBACKDELETE:
+        page->RollbackDelete(log_record->delete_rid_, nullptr, nullptr);
+        break;
+      case LogRecordType::UPDATE: {
+        Tuple old_tuple;
+        page->UpdateTuple(log_record->new_tuple_, &old_tuple, log_record->update_rid_, nullptr, nullptr);
+        break;
+      }
+      case LogRecordType::NEWPAGE:
+        page->Init(page_id, PAGE_SIZE, log_record->prev_page_id_, nullptr, nullptr);
+        break;
+      default:
+        break;
+    }
+    page->SetLSN(log_record->lsn_);
+  }
+  buffer_pool_manager_->UnpinPage(page_id, redo);
+
+  if (log_record->log_record_type_ == LogRecordType::NEWPAGE && log_record->prev_page_id_ != INVALID_PAGE_ID) {
+    // Linking the new page into the table is not logged, so it is redone along with the new page.
+    auto prev_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(log_record->prev_page_id_));
+    BUSTUB_ASSERT(prev_page != nullptr, "The buffer pool must have room for a page.");
+    bool link = prev_page->GetNextPageId() != page_id;
+    if (link) {
+      prev_page->SetNextPageId(page_id);
+    }
+    buffer_pool_manager_->UnpinPage(log_record->prev_page_id_, link);
+  }
+}
+
+void LogRecovery::UndoLogRecord(LogRecord *log_record, page_id_t page_id) {
+  if (page_id == INVALID_PAGE_ID || log_record->log_record_type_ == LogRecordType::NEWPAGE) {
+    // A new page stays in the table, empty.
+    return;
+  }
+  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+  BUSTUB_ASSERT(page != nullptr, "The buffer pool must have room for a page.");
+  txn_id_t txn_id = log_record->txn_id_;
+  lsn_t undo_next_lsn = log_record->prev_lsn_;
+  switch (log_record->log_record_type_) {
+    case LogRecordType::INSERT: {
+      page->ApplyDelete(log_record->insert_rid_, nullptr, nullptr);
+      LogRecord compensation(txn_id, undo_next_lsn, LogRecordType::APPLYDELETE, log_record->insert_rid_,
+                             log_record->insert_tuple_);
+      Compensate(page, &compensation);
+      break;
+    }
+    case LogRecordType::MARKDELETE: {
+      page->RollbackDelete(log_record->delete_rid_, nullptr, nullptr);
+      LogRecord compensation(txn_id, undo_next_lsn, LogRecordType::ROLLBACKDELETE, log_record->delete_rid_,
+                             log_record->delete_tuple_);
+      Compensate(page, &compensation);
+      break;
+    }
+    case LogRecordType::APPLYDELETE: {
+      RID rid;
+      page->InsertTuple(log_record->delete_tuple_, &rid, nullptr, nullptr);
+      LogRecord compensation(txn_id, undo_next_lsn, LogRecordType::INSERT, rid, log_record->delete_tuple_);
+      Compensate(page, &compensation);
+      break;
+    }
+    case LogRecordType::ROLLBACKDELETE: {
+      page->MarkDelete(log_record->delete_rid_, nullptr, nullptr);
+      LogRecord compensation(txn_id, undo_next_lsn, LogRecordType::MARKDELETE, log_record->delete_rid_,
+                             log_record->delete_tuple_);
+      Compensate(page, &compensation);
+      break;
+    }
+    case LogRecordType::UPDATE: {
+      Tuple new_tuple;
+      page->UpdateTuple(log_record->old_tuple_, &new_tuple, log_record->update_rid_, nullptr, nullptr);
+      LogRecord compensation(txn_id, undo_next_lsn, LogRecordType::UPDATE, log_record->update_rid_, new_tuple,
+                             log_record->old_tuple_);
+      Compensate(page, &compensation);
+      break;
+    }
+    default:
+      break;
+  }
+  buffer_pool_manager_->UnpinPage(page_id, true);
+}
+
+void LogRecovery::Compensate(TablePage *page, LogRecord *compensation) {
+  if (log_manager_ == nullptr) {
+    return;
+  }
+  lsn_t lsn = log_manager_->AppendLogRecord(compensation);
+  page->SetLSN(lsn);
+  active_txn_[compensation->txn_id_] = lsn;
+}
 
 }  // namespace bustub
@@ -10,7 +10,9 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <unistd.h>
 #include <cassert>
 #include <cstring>
 #include <iostream>
@@ -51,6 +53,11 @@ DiskManager::DiskManager(const std::string &db_file)
       throw Exception("can't open dblog file");
     }
   }
+  // The stream has no file descriptor to sync, so the log is synced through one of its own.
+  log_fd_ = open(log_name_.c_str(), O_RDONLY);
+  if (log_fd_ < 0) {
+    throw Exception("can't open dblog file");
+  }
 
   db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
   // directory or file does not exist
@@ -74,6 +81,10 @@ DiskManager::DiskManager(const std::string &db_file)
 void DiskManager::ShutDown() {
   db_io_.close();
   log_io_.close();
+  if (log_fd_ >= 0) {
+    close(log_fd_);
+    log_fd_ = -1;
+  }
 }
 
 /**
@@ -103,6 +114,8 @@ void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
   if (offset > GetFileSize(file_name_)) {
     LOG_DEBUG("I/O error reading past end of file");
     // std::cerr << "I/O error while reading" << std::endl;
+    // A page that was never written, e.g. one that recovery recreates, reads as zeros.
+    memset(page_data, 0, PAGE_SIZE);
   } else {
     // set read cursor to offset
     db_io_.seekp(offset);
@@ -151,8 +164,12 @@ void DiskManager::WriteLog(char *log_data, int size) {
     LOG_DEBUG("I/O error while writing log");
     return;
   }
-  // needs to flush to keep disk file in sync
+  // needs to flush to keep disk file in sync, and to sync for the log to be durable
   log_io_.flush();
+  if (fsync(log_fd_) != 0) {
+    LOG_DEBUG("I/O error while syncing log");
+    return;
+  }
   flush_log_ = false;
 }
 
@@ -67,6 +67,64 @@ bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
   return res;
 }
 
+/*
+ * Append the values whose keys lie in [*low_key, *high_key] to result, in key
+ * order. A null low_key starts at the leftmost leaf and a null high_key stops
+ * at the end of the leaf chain.
+ * Latches are crabbed down the tree and then along the leaf chain, so that at
+ * most two pages are pinned at a time and the values are collected before the
+ * caller touches any other page.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::GetRange(const KeyType *low_key, const KeyType *high_key, std::vector<ValueType> *result) {
+  root_id_mutex_.lock();
+  if (IsEmpty()) {
+    root_id_mutex_.unlock();
+    return;
+  }
+  Page *page = buffer_pool_manager_->FetchPage(root_page_id_);
+  page->RLatch();
+  root_id_mutex_.unlock();
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  while (!node->IsLeafPage()) {
+    auto *internal = static_cast<InternalPage *>(node);
+    page_id_t child_id = low_key == nullptr ? internal->ValueAt(0) : internal->Lookup(*low_key, comparator_);
+    Page *child = buffer_pool_manager_->FetchPage(child_id);
+    child->RLatch();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = child;
+    node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  }
+
+  auto *leaf = static_cast<LeafPage *>(node);
+  int index = low_key == nullptr ? 0 : leaf->KeyIndex(*low_key, comparator_);
+  while (true) {
+    for (; index < leaf->GetSize(); index++) {
+      const MappingType &item = leaf->GetItem(index);
+      if (high_key != nullptr && comparator_(item.first, *high_key) > 0) {
+        page->RUnlatch();
+        buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+        return;
+      }
+      result->push_back(item.second);
+    }
+    page_id_t next_id = leaf->GetNextPageId();
+    if (next_id == INVALID_PAGE_ID) {
+      break;
+    }
+    Page *next = buffer_pool_manager_->FetchPage(next_id);
+    next->RLatch();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = next;
+    leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    index = 0;
+  }
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+}
+
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
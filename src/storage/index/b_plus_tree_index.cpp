@@ -48,6 +48,23 @@ void BPLUSTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, T
   container_.GetValue(index_key, result, transaction);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::ScanRange(const Tuple *low_key, const Tuple *high_key, std::vector<RID> *result,
+                                     Transaction *transaction) {
+  // construct range bounds
+  KeyType low_index_key;
+  KeyType high_index_key;
+  if (low_key != nullptr) {
+    low_index_key.SetFromKey(*low_key);
+  }
+  if (high_key != nullptr) {
+    high_index_key.SetFromKey(*high_key);
+  }
+
+  container_.GetRange(low_key == nullptr ? nullptr : &low_index_key, high_key == nullptr ? nullptr : &high_index_key,
+                      result);
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetBeginIterator() { return container_.begin(); }
 
@@ -0,0 +1,86 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_directory.cpp
+//
+// Identification: src/storage/table/free_space_directory.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/free_space_directory.h"
+
+namespace bustub {
+
+void FreeSpaceDirectory::Update(page_id_t page_id, uint32_t free_space) {
+  std::lock_guard<std::mutex> guard(latch_);
+  uint32_t bucket = BucketOf(free_space);
+  auto it = positions_.find(page_id);
+  if (it != positions_.end()) {
+    auto [old_bucket, pos] = it->second;
+    if (old_bucket == bucket && free_space >= MIN_FREE_SPACE) {
+      buckets_[bucket][pos].free_space_ = free_space;
+      return;
+    }
+    RemoveEntry(old_bucket, pos);
+  }
+  if (free_space < MIN_FREE_SPACE) {
+    return;
+  }
+  positions_[page_id] = {bucket, buckets_[bucket].size()};
+  buckets_[bucket].push_back({page_id, free_space});
+}
+
+page_id_t FreeSpaceDirectory::Find(uint32_t size, size_t hint, size_t min_pages) {
+  std::lock_guard<std::mutex> guard(latch_);
+  // Every page from this bucket on has at least size free bytes.
+  uint32_t first_certain = (size + BUCKET_WIDTH - 1) / BUCKET_WIDTH;
+  size_t certain = 0;
+  for (uint32_t bucket = first_certain; bucket < BUCKET_COUNT; bucket++) {
+    certain += buckets_[bucket].size();
+  }
+  if (certain > 0) {
+    if (certain < min_pages) {
+      return INVALID_PAGE_ID;
+    }
+    size_t idx = hint % certain;
+    for (uint32_t bucket = first_certain;; bucket++) {
+      if (idx < buckets_[bucket].size()) {
+        return buckets_[bucket][idx].page_id_;
+      }
+      idx -= buckets_[bucket].size();
+    }
+  }
+  if (first_certain == 0) {
+    return INVALID_PAGE_ID;
+  }
+  // The pages of the bucket below may or may not have room.
+  const auto &candidates = buckets_[std::min(first_certain - 1, BUCKET_COUNT - 1)];
+  size_t probes = std::min<size_t>(candidates.size(), MAX_PROBES);
+  for (size_t probe = 0; probe < probes; probe++) {
+    const Entry &entry = candidates[(hint + probe) % candidates.size()];
+    if (entry.free_space_ >= size) {
+      return entry.page_id_;
+    }
+  }
+  return INVALID_PAGE_ID;
+}
+
+size_t FreeSpaceDirectory::GetPageCount() {
+  std::lock_guard<std::mutex> guard(latch_);
+  return positions_.size();
+}
+
+void FreeSpaceDirectory::RemoveEntry(uint32_t bucket, size_t pos) {
+  auto &entries = buckets_[bucket];
+  positions_.erase(entries[pos].page_id_);
+  if (pos + 1 != entries.size()) {
+    entries[pos] = entries.back();
+    positions_[entries[pos].page_id_].second = pos;
+  }
+  entries.pop_back();
+}
+
+}  // namespace bustub
@@ -11,6 +11,9 @@
 //===----------------------------------------------------------------------===//
 
 #include <cassert>
+#include <functional>
+#include <thread>  // NOLINT
+#include <vector>
 
 #include "common/logger.h"
 #include "storage/table/table_heap.h"
@@ -18,15 +21,20 @@
 namespace bustub {
 
 TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
-                     page_id_t first_page_id)
+                     page_id_t first_page_id, table_oid_t table_oid)
     : buffer_pool_manager_(buffer_pool_manager),
       lock_manager_(lock_manager),
       log_manager_(log_manager),
-      first_page_id_(first_page_id) {}
+      table_oid_(table_oid),
+      first_page_id_(first_page_id),
+      last_page_id_(first_page_id) {}
 
 TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
-                     Transaction *txn)
-    : buffer_pool_manager_(buffer_pool_manager), lock_manager_(lock_manager), log_manager_(log_manager) {
+                     Transaction *txn, table_oid_t table_oid)
+    : buffer_pool_manager_(buffer_pool_manager),
+      lock_manager_(lock_manager),
+      log_manager_(log_manager),
+      table_oid_(table_oid) {
   // Initialize the first table page.
   auto first_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(&first_page_id_));
   BUSTUB_ASSERT(first_page != nullptr, "Couldn't create a page for the table heap.");
@@ -34,6 +42,7 @@ TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_m
   first_page->Init(first_page_id_, PAGE_SIZE, INVALID_LSN, log_manager_, txn);
   first_page->WUnlatch();
   buffer_pool_manager_->UnpinPage(first_page_id_, true);
+  last_page_id_ = first_page_id_;
 }
 
 bool TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) {
@@ -41,57 +50,205 @@ bool TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) {
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
+  if (enable_logging && !lock_manager_->LockTable(txn, table_oid_, LockMode::INTENTION_EXCLUSIVE)) {
+    return false;
+  }
+  LoadFreeSpace();
 
-  auto cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
-  if (cur_page == nullptr) {
+  uint32_t space_needed = TablePage::GetSpaceNeeded(tuple.size_);
+  // Threads hash to different pages of the directory.
+  size_t hint = std::hash<std::thread::id>()(std::this_thread::get_id());
+  uint32_t inserters = ++active_inserters_;
+  bool inserted = false;
+  while (!inserted) {
+    page_id_t page_id = free_space_.Find(space_needed, hint, inserters);
+    TablePage *cur_page;
+    bool is_new_page = page_id == INVALID_PAGE_ID;
+    if (is_new_page) {
+      cur_page = AppendPage(txn);
+    } else {
+      cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+      if (cur_page != nullptr) {
+        cur_page->WLatch();
+      }
+    }
+    if (cur_page == nullptr) {
+      break;
+    }
+    inserted = cur_page->InsertTuple(tuple, rid, txn, log_manager_);
+    if (inserted && !LockNewTuple(cur_page, *rid, txn)) {
+      cur_page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
+      active_inserters_--;
+      return false;
+    }
+    if (inserted) {
+      versions_.BeginInsert(*rid, txn);
+    }
+    // If the page was fuller than the directory thought, recording its actual free space keeps it from being picked
+    // again for this tuple.
+    free_space_.Update(cur_page->GetTablePageId(), cur_page->GetFreeSpaceRemaining());
+    cur_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), inserted || is_new_page);
+    if (is_new_page && !inserted) {
+      break;
+    }
+  }
+  active_inserters_--;
+  if (!inserted) {
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
+  // Update the transaction's write set.
+  txn->GetWriteSet()->emplace_back(*rid, WType::INSERT, Tuple{}, this);
+  return true;
+}
 
+bool TableHeap::AppendTuples(const std::vector<Tuple> &tuples, std::vector<RID> *rids, Transaction *txn) {
+  rids->clear();
+  if (tuples.empty()) {
+    return true;
+  }
+  for (const auto &tuple : tuples) {
+    if (tuple.size_ + 32 > PAGE_SIZE) {  // larger than one page size
+      txn->SetState(TransactionState::ABORTED);
+      return false;
+    }
+  }
+  if (enable_logging && !lock_manager_->LockTable(txn, table_oid_, LockMode::INTENTION_EXCLUSIVE)) {
+    return false;
+  }
+  rids->reserve(tuples.size());
+
+  auto cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(last_page_id_));
+  if (cur_page == nullptr) {
+    txn->SetState(TransactionState::ABORTED);
+    return false;
+  }
   cur_page->WLatch();
-  // Insert into the first page with enough space. If no such page exists, create a new page and insert into that.
-  // INVARIANT: cur_page is WLatched if you leave the loop normally.
-  while (!cur_page->InsertTuple(tuple, rid, txn, lock_manager_, log_manager_)) {
+  // Pages appended by other inserters since the hint was read are linked from the hinted page.
+  // INVARIANT: cur_page is WLatched and pinned inside the loops below.
+  while (cur_page->GetNextPageId() != INVALID_PAGE_ID) {
     auto next_page_id = cur_page->GetNextPageId();
-    // If the next page is a valid page,
-    if (next_page_id != INVALID_PAGE_ID) {
-      // Unlatch and unpin the current page.
-      cur_page->WUnlatch();
-      buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), false);
-      // And repeat the process with the next page.
-      cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(next_page_id));
-      cur_page->WLatch();
-    } else {
-      // Otherwise we have run out of valid pages. We need to create a new page.
-      auto new_page = static_cast<TablePage *>(buffer_pool_manager_->NewPage(&next_page_id));
-      // If we could not create a new page,
-      if (new_page == nullptr) {
-        // Then life sucks and we abort the transaction.
-        cur_page->WUnlatch();
-        buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), false);
+    cur_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), false);
+    cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(next_page_id));
+    if (cur_page == nullptr) {
+      txn->SetState(TransactionState::ABORTED);
+      return false;
+    }
+    cur_page->WLatch();
+  }
+
+  for (const auto &tuple : tuples) {
+    RID rid;
+    while (!cur_page->InsertTuple(tuple, &rid, txn, log_manager_)) {
+      // The last page is full, so chain a new one after it and keep filling that one.
+      cur_page = LinkNewPage(cur_page, txn);
+      if (cur_page == nullptr) {
         txn->SetState(TransactionState::ABORTED);
         return false;
       }
-      // Otherwise we were able to create a new page. We initialize it now.
-      new_page->WLatch();
-      cur_page->SetNextPageId(next_page_id);
-      new_page->Init(next_page_id, PAGE_SIZE, cur_page->GetTablePageId(), log_manager_, txn);
+    }
+    if (!LockNewTuple(cur_page, rid, txn)) {
       cur_page->WUnlatch();
       buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
-      cur_page = new_page;
+      return false;
     }
+    versions_.BeginInsert(rid, txn);
+    rids->push_back(rid);
+    // Update the transaction's write set.
+    txn->GetWriteSet()->emplace_back(rid, WType::INSERT, Tuple{}, this);
   }
-  // This line has caused most of us to double-take and "whoa double unlatch".
-  // We are not, in fact, double unlatching. See the invariant above.
+  free_space_.Update(cur_page->GetTablePageId(), cur_page->GetFreeSpaceRemaining());
   cur_page->WUnlatch();
   buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
-  // Update the transaction's write set.
-  txn->GetWriteSet()->emplace_back(*rid, WType::INSERT, Tuple{}, this);
   return true;
 }
 
+bool TableHeap::LockNewTuple(TablePage *page, const RID &rid, Transaction *txn) {
+  if (!enable_logging) {
+    return true;
+  }
+  bool locked;
+  try {
+    locked = lock_manager_->LockRow(txn, table_oid_, rid, LockMode::EXCLUSIVE);
+  } catch (const TransactionAbortException &) {
+    locked = false;
+  }
+  if (!locked) {
+    // The tuple has no write record yet, so it is taken out here rather than by the rollback.
+    page->ApplyDelete(rid, txn, log_manager_);
+    free_space_.Update(page->GetTablePageId(), page->GetFreeSpaceRemaining());
+    txn->SetState(TransactionState::ABORTED);
+  }
+  return locked;
+}
+
+void TableHeap::LoadFreeSpace() {
+  std::call_once(free_space_loaded_, [this] {
+    page_id_t page_id = first_page_id_;
+    while (page_id != INVALID_PAGE_ID) {
+      auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+      BUSTUB_ASSERT(page != nullptr, "Couldn't fetch a page of the table heap.");
+      page->RLatch();
+      free_space_.Update(page_id, page->GetFreeSpaceRemaining());
+      page_id_t next_page_id = page->GetNextPageId();
+      page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      if (next_page_id == INVALID_PAGE_ID) {
+        last_page_id_ = page_id;
+      }
+      page_id = next_page_id;
+    }
+  });
+}
+
+TablePage *TableHeap::AppendPage(Transaction *txn) {
+  auto cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(last_page_id_));
+  if (cur_page == nullptr) {
+    return nullptr;
+  }
+  cur_page->WLatch();
+  // Pages appended by other inserters since the hint was read are linked from the hinted page.
+  while (cur_page->GetNextPageId() != INVALID_PAGE_ID) {
+    auto next_page_id = cur_page->GetNextPageId();
+    cur_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), false);
+    cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(next_page_id));
+    if (cur_page == nullptr) {
+      return nullptr;
+    }
+    cur_page->WLatch();
+  }
+  return LinkNewPage(cur_page, txn);
+}
+
+TablePage *TableHeap::LinkNewPage(TablePage *last_page, Transaction *txn) {
+  page_id_t last_page_id = last_page->GetTablePageId();
+  page_id_t new_page_id;
+  auto new_page = static_cast<TablePage *>(buffer_pool_manager_->NewPage(&new_page_id));
+  // If we could not create a new page, then life sucks and the caller aborts the transaction.
+  if (new_page == nullptr) {
+    last_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(last_page_id, true);
+    return nullptr;
+  }
+  new_page->WLatch();
+  last_page->SetNextPageId(new_page_id);
+  new_page->Init(new_page_id, PAGE_SIZE, last_page_id, log_manager_, txn);
+  free_space_.Update(last_page_id, last_page->GetFreeSpaceRemaining());
+  last_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(last_page_id, true);
+  last_page_id_ = new_page_id;
+  return new_page;
+}
+
 bool TableHeap::MarkDelete(const RID &rid, Transaction *txn) {
   // TODO(Amadou): remove empty page
+  if (!LockRowForWrite(rid, txn)) {
+    return false;
+  }
   // Find the page which contains the tuple.
   auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
   // If the page could not be found, then abort the transaction.
@@ -99,9 +256,15 @@ bool TableHeap::MarkDelete(const RID &rid, Transaction *txn) {
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
-  // Otherwise, mark the tuple as deleted.
+  // Otherwise, mark the tuple as deleted, unless someone else wrote it first.
   page->WLatch();
-  page->MarkDelete(rid, txn, lock_manager_, log_manager_);
+  if (!versions_.BeginWrite(rid, txn, page)) {
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetTablePageId(), false);
+    txn->SetState(TransactionState::ABORTED);
+    return false;
+  }
+  page->MarkDelete(rid, txn, log_manager_);
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
   // Update the transaction's write set.
@@ -110,6 +273,9 @@ bool TableHeap::MarkDelete(const RID &rid, Transaction *txn) {
 }
 
 bool TableHeap::UpdateTuple(const Tuple &tuple, const RID &rid, Transaction *txn) {
+  if (!LockRowForWrite(rid, txn)) {
+    return false;
+  }
   // Find the page which contains the tuple.
   auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
   // If the page could not be found, then abort the transaction.
@@ -120,40 +286,149 @@ bool TableHeap::UpdateTuple(const Tuple &tuple, const RID &rid, Transaction *txn
   // Update the tuple; but first save the old value for rollbacks.
   Tuple old_tuple;
   page->WLatch();
-  bool is_updated = page->UpdateTuple(tuple, &old_tuple, rid, txn, lock_manager_, log_manager_);
+  if (!versions_.BeginWrite(rid, txn, page)) {
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetTablePageId(), false);
+    txn->SetState(TransactionState::ABORTED);
+    return false;
+  }
+  bool is_updated = page->UpdateTuple(tuple, &old_tuple, rid, txn, log_manager_);
+  if (is_updated) {
+    free_space_.Update(rid.GetPageId(), page->GetFreeSpaceRemaining());
+  }
+  if (!is_updated) {
+    // The write did not happen and has no write record to be rolled back.
+    versions_.AbortWrite(rid, txn);
+  }
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), is_updated);
   // Update the transaction's write set.
-  if (is_updated && txn->GetState() != TransactionState::ABORTED) {
+  if (is_updated) {
     txn->GetWriteSet()->emplace_back(rid, WType::UPDATE, old_tuple, this);
   }
   return is_updated;
 }
 
-void TableHeap::ApplyDelete(const RID &rid, Transaction *txn) {
+void TableHeap::ApplyDelete(const RID &rid, Transaction *txn) { RemoveTuple(rid, txn, false); }
+
+void TableHeap::RollbackInsert(const RID &rid, Transaction *txn) { RemoveTuple(rid, txn, true); }
+
+void TableHeap::RollbackUpdate(const Tuple &old_tuple, const RID &rid, Transaction *txn) {
+  BUSTUB_ASSERT(!enable_logging || txn->IsRowExclusiveLocked(table_oid_, rid), "We must own the exclusive lock!");
+  // Find the page which contains the tuple.
+  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  BUSTUB_ASSERT(page != nullptr, "Couldn't find a page containing that RID.");
+  // Put the old value back.
+  Tuple new_tuple;
+  page->WLatch();
+  page->UpdateTuple(old_tuple, &new_tuple, rid, txn, log_manager_);
+  free_space_.Update(rid.GetPageId(), page->GetFreeSpaceRemaining());
+  versions_.AbortWrite(rid, txn);
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+}
+
+void TableHeap::RemoveTuple(const RID &rid, Transaction *txn, bool is_rollback) {
+  BUSTUB_ASSERT(!enable_logging || txn->IsRowExclusiveLocked(table_oid_, rid), "We must own the exclusive lock!");
   // Find the page which contains the tuple.
   auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
   BUSTUB_ASSERT(page != nullptr, "Couldn't find a page containing that RID.");
   // Delete the tuple from the page.
   page->WLatch();
   page->ApplyDelete(rid, txn, log_manager_);
+  if (is_rollback) {
+    versions_.AbortWrite(rid, txn);
+  }
+  free_space_.Update(rid.GetPageId(), page->GetFreeSpaceRemaining());
   lock_manager_->Unlock(txn, rid);
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
 }
 
 void TableHeap::RollbackDelete(const RID &rid, Transaction *txn) {
+  BUSTUB_ASSERT(!enable_logging || txn->IsRowExclusiveLocked(table_oid_, rid), "We must own the exclusive lock!");
   // Find the page which contains the tuple.
   auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
   BUSTUB_ASSERT(page != nullptr, "Couldn't find a page containing that RID.");
   // Rollback the delete.
   page->WLatch();
   page->RollbackDelete(rid, txn, log_manager_);
+  versions_.AbortWrite(rid, txn);
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
 }
 
+void TableHeap::GetPageIds(std::vector<page_id_t> *page_ids) {
+  page_ids->clear();
+  page_id_t page_id = first_page_id_;
+  while (page_id != INVALID_PAGE_ID) {
+    page_ids->push_back(page_id);
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    BUSTUB_ASSERT(page != nullptr, "Couldn't fetch a page of the table heap.");
+    page->RLatch();
+    page_id = page->GetNextPageId();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_ids->back(), false);
+  }
+}
+
+bool TableHeap::ScanPage(page_id_t page_id, TupleBatch *batch, Transaction *txn) {
+  // The intention lock on the page is taken before the latch.
+  bool snapshot = txn->GetIsolationLevel() == IsolationLevel::SNAPSHOT_ISOLATION;
+  bool lock_rows = enable_logging && txn->GetIsolationLevel() != IsolationLevel::READ_UNCOMMITTED && !snapshot;
+  if (lock_rows && !lock_manager_->LockPage(txn, table_oid_, page_id, LockMode::INTENTION_SHARED)) {
+    return false;
+  }
+  auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+  BUSTUB_ASSERT(page != nullptr, "Couldn't fetch a page of the table heap.");
+  Tuple tuple;
+  RID rid;
+  page->RLatch();
+  if (!lock_rows) {
+    // A snapshot may see rows that are deleted in the page.
+    for (bool found = page->GetFirstTupleRid(&rid, snapshot); found;
+         found = page->GetNextTupleRid(rid, &rid, snapshot)) {
+      if (snapshot ? versions_.ReadVersion(rid, txn, page, &tuple) : page->GetTuple(rid, &tuple, txn)) {
+        batch->AppendTuple(tuple, rid);
+      }
+    }
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    return true;
+  }
+
+  // Locking a row may wait for a writer that needs the page latch to commit or roll back, or abort the transaction,
+  // so the rows are locked with the page released, and read once they are all locked.
+  std::vector<RID> rids;
+  for (bool found = page->GetFirstTupleRid(&rid); found; found = page->GetNextTupleRid(rid, &rid)) {
+    rids.push_back(rid);
+  }
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  for (const auto &row_rid : rids) {
+    if (!LockRowForRead(row_rid, txn)) {
+      return false;
+    }
+  }
+  page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+  BUSTUB_ASSERT(page != nullptr, "Couldn't fetch a page of the table heap.");
+  page->RLatch();
+  for (const auto &row_rid : rids) {
+    // A row whose delete was committed before it was locked is gone.
+    bool is_deleted = false;
+    if (page->ReadTuple(row_rid, &tuple, &is_deleted) && !is_deleted) {
+      batch->AppendTuple(tuple, row_rid);
+    }
+  }
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  return true;
+}
+
 bool TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn) {
+  if (!LockRowForRead(rid, txn)) {
+    return false;
+  }
   // Find the page which contains the tuple.
   auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
   // If the page could not be found, then abort the transaction.
@@ -161,9 +436,11 @@ bool TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn) {
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
-  // Read the tuple from the page.
+  // Read the tuple from the page, or the version that the transaction's snapshot sees.
   page->RLatch();
-  bool res = page->GetTuple(rid, tuple, txn, lock_manager_);
+  bool res = txn->GetIsolationLevel() == IsolationLevel::SNAPSHOT_ISOLATION
+                 ? versions_.ReadVersion(rid, txn, page, tuple)
+                 : page->GetTuple(rid, tuple, txn);
   page->RUnlatch();
   buffer_pool_manager_->UnpinPage(rid.GetPageId(), false);
   return res;
@@ -173,12 +450,14 @@ TableIterator TableHeap::Begin(Transaction *txn) {
   // Start an iterator from the first page.
   // TODO(Wuwen): Hacky fix for now. Removing empty pages is a better way to handle this.
   RID rid;
+  // A snapshot may see rows that are deleted in the page; the iterator skips the rows that it does not see.
+  bool all_slots = txn->GetIsolationLevel() == IsolationLevel::SNAPSHOT_ISOLATION;
   auto page_id = first_page_id_;
   while (page_id != INVALID_PAGE_ID) {
     auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
     page->RLatch();
     // If this fails because there is no tuple, then RID will be the default-constructed value, which means EOF.
-    auto found_tuple = page->GetFirstTupleRid(&rid);
+    auto found_tuple = page->GetFirstTupleRid(&rid, all_slots);
     page->RUnlatch();
     buffer_pool_manager_->UnpinPage(page_id, false);
     if (found_tuple) {
@@ -191,4 +470,16 @@ TableIterator TableHeap::Begin(Transaction *txn) {
 
 TableIterator TableHeap::End() { return TableIterator(this, RID(INVALID_PAGE_ID, 0), nullptr); }
 
+bool TableHeap::LockRowForWrite(const RID &rid, Transaction *txn) {
+  // A wounded transaction goes to the lock manager even for a lock it holds, to notice the wound.
+  return !enable_logging || (txn->IsRowExclusiveLocked(table_oid_, rid) && !txn->IsWounded()) ||
+         lock_manager_->LockRow(txn, table_oid_, rid, LockMode::EXCLUSIVE);
+}
+
+bool TableHeap::LockRowForRead(const RID &rid, Transaction *txn) {
+  return !enable_logging || txn->GetIsolationLevel() == IsolationLevel::READ_UNCOMMITTED ||
+         txn->GetIsolationLevel() == IsolationLevel::SNAPSHOT_ISOLATION ||
+         lock_manager_->LockRow(txn, table_oid_, rid, LockMode::SHARED);
+}
+
 }  // namespace bustub
@@ -25,9 +25,13 @@ Tuple::Tuple(std::vector<Value> values, const Schema *schema) : allocated_(true)
   assert(values.size() == schema->GetColumnCount());
 
   // 1. Calculate the size of the tuple.
+  // A NULL varlen value is stored as its length field alone.
+  auto varlen_size = [](const Value &value) -> uint32_t {
+    return (value.IsNull() ? 0 : value.GetLength()) + sizeof(uint32_t);
+  };
   uint32_t tuple_size = schema->GetLength();
   for (auto &i : schema->GetUnlinedColumns()) {
-    tuple_size += (values[i].GetLength() + sizeof(uint32_t));
+    tuple_size += varlen_size(values[i]);
   }
 
   // 2. Allocate memory.
@@ -46,7 +50,7 @@ Tuple::Tuple(std::vector<Value> values, const Schema *schema) : allocated_(true)
       *reinterpret_cast<uint32_t *>(data_ + col.GetOffset()) = offset;
       // Serialize varchar value, in place (size+data).
       values[i].SerializeTo(data_ + offset);
-      offset += (values[i].GetLength() + sizeof(uint32_t));
+      offset += varlen_size(values[i]);
     } else {
       values[i].SerializeTo(data_ + col.GetOffset());
     }
@@ -96,7 +100,8 @@ Value Tuple::GetValue(const Schema *schema, const uint32_t column_idx) const {
   return Value::DeserializeFrom(data_ptr, column_type);
 }
 
-Tuple Tuple::KeyFromTuple(const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs) {
+Tuple Tuple::KeyFromTuple(const Schema &schema, const Schema &key_schema,
+                          const std::vector<uint32_t> &key_attrs) const {
   std::vector<Value> values;
   values.reserve(key_attrs.size());
   for (auto idx : key_attrs) {
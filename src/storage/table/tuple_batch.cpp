@@ -0,0 +1,132 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tuple_batch.cpp
+//
+// Identification: src/storage/table/tuple_batch.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include "common/macros.h"
+#include "storage/table/tuple_batch.h"
+#include "type/limits.h"
+
+namespace bustub {
+
+TupleBatch::TupleBatch(const Schema *schema, uint32_t capacity)
+    : schema_(schema),
+      capacity_(capacity),
+      integers_(schema->GetColumnCount()),
+      values_(schema->GetColumnCount()) {
+  types_.reserve(schema->GetColumnCount());
+  for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+    types_.push_back(schema->GetColumn(i).GetType());
+    if (IsIntegerColumn(i)) {
+      integers_[i].reserve(capacity_);
+    } else {
+      values_[i].reserve(capacity_);
+    }
+  }
+  rids_.reserve(capacity_);
+}
+
+int64_t TupleBatch::IntegerOf(const Value &value) {
+  switch (value.GetTypeId()) {
+    case TypeId::TINYINT:
+      return value.GetAs<int8_t>();
+    case TypeId::SMALLINT:
+      return value.GetAs<int16_t>();
+    case TypeId::INTEGER:
+      return value.GetAs<int32_t>();
+    case TypeId::BIGINT:
+      return value.GetAs<int64_t>();
+    default:
+      UNREACHABLE("Value is not an integer.");
+  }
+}
+
+int64_t TupleBatch::IntegerNull(TypeId type) {
+  switch (type) {
+    case TypeId::TINYINT:
+      return BUSTUB_INT8_NULL;
+    case TypeId::SMALLINT:
+      return BUSTUB_INT16_NULL;
+    case TypeId::INTEGER:
+      return BUSTUB_INT32_NULL;
+    case TypeId::BIGINT:
+      return BUSTUB_INT64_NULL;
+    default:
+      UNREACHABLE("Type is not an integer type.");
+  }
+}
+
+void TupleBatch::AppendRow(const std::vector<Value> &values, const RID &rid) {
+  BUSTUB_ASSERT(values.size() == types_.size(), "Row does not match the schema of the batch.");
+  BUSTUB_ASSERT(!IsFull(), "Batch is full.");
+  for (uint32_t i = 0; i < types_.size(); i++) {
+    AppendValue(i, values[i]);
+  }
+  rids_.push_back(rid);
+}
+
+void TupleBatch::AppendTuple(const Tuple &tuple, const RID &rid) {
+  BUSTUB_ASSERT(!IsFull(), "Batch is full.");
+  for (uint32_t i = 0; i < types_.size(); i++) {
+    AppendValue(i, tuple.GetValue(schema_, i));
+  }
+  rids_.push_back(rid);
+}
+
+Tuple TupleBatch::GetTuple(uint32_t row_idx) const {
+  std::vector<Value> values;
+  values.reserve(types_.size());
+  for (uint32_t i = 0; i < types_.size(); i++) {
+    values.push_back(GetValue(row_idx, i));
+  }
+  return Tuple(values, schema_);
+}
+
+void TupleBatch::Clear() {
+  for (auto &column : integers_) {
+    column.clear();
+  }
+  for (auto &column : values_) {
+    column.clear();
+  }
+  rids_.clear();
+}
+
+void TupleBatch::Truncate(uint32_t row_count) {
+  if (row_count >= GetRowCount()) {
+    return;
+  }
+  for (uint32_t i = 0; i < types_.size(); i++) {
+    if (IsIntegerColumn(i)) {
+      integers_[i].resize(row_count);
+    } else {
+      values_[i].erase(values_[i].begin() + row_count, values_[i].end());
+    }
+  }
+  rids_.resize(row_count);
+}
+
+void TupleBatch::EraseFront(uint32_t row_count) {
+  row_count = std::min(row_count, GetRowCount());
+  for (uint32_t i = 0; i < types_.size(); i++) {
+    if (IsIntegerColumn(i)) {
+      integers_[i].erase(integers_[i].begin(), integers_[i].begin() + row_count);
+    } else {
+      values_[i].erase(values_[i].begin(), values_[i].begin() + row_count);
+    }
+  }
+  rids_.erase(rids_.begin(), rids_.begin() + row_count);
+}
+
+}  // namespace bustub
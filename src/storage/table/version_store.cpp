@@ -0,0 +1,150 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// version_store.cpp
+//
+// Identification: src/storage/table/version_store.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/version_store.h"
+
+namespace bustub {
+
+bool VersionStore::BeginWrite(const RID &rid, Transaction *txn, TablePage *page) {
+  bool snapshot = txn->GetIsolationLevel() == IsolationLevel::SNAPSHOT_ISOLATION;
+  Shard &shard = ShardOf(rid);
+  std::lock_guard<std::mutex> guard(shard.latch_);
+  VersionChain &chain = shard.chains_[rid];
+  if (chain.writer_ == txn->GetTransactionId()) {
+    chain.write_count_++;
+    return true;
+  }
+  if (chain.writer_ != INVALID_TXN_ID || (snapshot && chain.head_ts_ > txn->GetReadTs())) {
+    return false;
+  }
+  Version version{chain.head_ts_, false, Tuple{}};
+  bool is_deleted = false;
+  version.deleted_ = !page->ReadTuple(rid, &version.tuple_, &is_deleted) || is_deleted;
+  chain.undo_.push_back(version);
+  chain.writer_ = txn->GetTransactionId();
+  chain.write_count_ = 1;
+  return true;
+}
+
+void VersionStore::BeginInsert(const RID &rid, Transaction *txn) {
+  Shard &shard = ShardOf(rid);
+  std::lock_guard<std::mutex> guard(shard.latch_);
+  VersionChain &chain = shard.chains_[rid];
+  if (chain.writer_ == txn->GetTransactionId()) {
+    // The transaction freed the slot itself.
+    chain.write_count_++;
+    return;
+  }
+  BUSTUB_ASSERT(chain.writer_ == INVALID_TXN_ID, "An empty slot cannot have an uncommitted writer.");
+  chain.undo_.push_back(Version{chain.head_ts_, true, Tuple{}});
+  chain.writer_ = txn->GetTransactionId();
+  chain.write_count_ = 1;
+}
+
+void VersionStore::AbortWrite(const RID &rid, Transaction *txn) {
+  Shard &shard = ShardOf(rid);
+  std::lock_guard<std::mutex> guard(shard.latch_);
+  auto it = shard.chains_.find(rid);
+  if (it == shard.chains_.end() || it->second.writer_ != txn->GetTransactionId() || --it->second.write_count_ > 0) {
+    return;
+  }
+  VersionChain &chain = it->second;
+  chain.head_ts_ = chain.undo_.back().ts_;
+  chain.undo_.pop_back();
+  chain.writer_ = INVALID_TXN_ID;
+  // A chain that was made for this write has nothing to tell anymore.
+  if (chain.undo_.empty() && chain.head_ts_ == 0) {
+    shard.chains_.erase(it);
+  }
+}
+
+void VersionStore::CommitWrite(const RID &rid, Transaction *txn, timestamp_t commit_ts) {
+  Shard &shard = ShardOf(rid);
+  std::lock_guard<std::mutex> guard(shard.latch_);
+  auto it = shard.chains_.find(rid);
+  if (it == shard.chains_.end() || it->second.writer_ != txn->GetTransactionId()) {
+    return;
+  }
+  it->second.writer_ = INVALID_TXN_ID;
+  it->second.write_count_ = 0;
+  it->second.head_ts_ = commit_ts;
+}
+
+bool VersionStore::ReadVersion(const RID &rid, Transaction *txn, TablePage *page, Tuple *tuple) {
+  Shard &shard = ShardOf(rid);
+  std::lock_guard<std::mutex> guard(shard.latch_);
+  auto it = shard.chains_.find(rid);
+  if (it == shard.chains_.end() || it->second.writer_ == txn->GetTransactionId() ||
+      (it->second.writer_ == INVALID_TXN_ID && it->second.head_ts_ <= txn->GetReadTs())) {
+    bool is_deleted = false;
+    return page->ReadTuple(rid, tuple, &is_deleted) && !is_deleted;
+  }
+  const auto &undo = it->second.undo_;
+  for (auto version = undo.rbegin(); version != undo.rend(); ++version) {
+    if (version->ts_ <= txn->GetReadTs()) {
+      if (version->deleted_) {
+        return false;
+      }
+      *tuple = version->tuple_;
+      return true;
+    }
+  }
+  return false;
+}
+
+size_t VersionStore::GarbageCollect(timestamp_t watermark) {
+  {
+    std::lock_guard<std::mutex> guard(gc_latch_);
+    if (watermark <= gc_watermark_) {
+      return 0;
+    }
+    gc_watermark_ = watermark;
+  }
+  size_t dropped = 0;
+  for (auto &shard : shards_) {
+    std::lock_guard<std::mutex> guard(shard.latch_);
+    for (auto it = shard.chains_.begin(); it != shard.chains_.end();) {
+      VersionChain &chain = it->second;
+      if (chain.writer_ == INVALID_TXN_ID && chain.head_ts_ <= watermark) {
+        // Every snapshot reads the page.
+        dropped += chain.undo_.size();
+        it = shard.chains_.erase(it);
+        continue;
+      }
+      // Keep the newest version that the oldest snapshot reads, and everything newer.
+      auto &undo = chain.undo_;
+      size_t keep = undo.size();
+      while (keep > 0 && undo[keep - 1].ts_ > watermark) {
+        keep--;
+      }
+      if (keep > 1) {
+        undo.erase(undo.begin(), undo.begin() + (keep - 1));
+        dropped += keep - 1;
+      }
+      ++it;
+    }
+  }
+  return dropped;
+}
+
+size_t VersionStore::GetVersionCount() {
+  size_t count = 0;
+  for (auto &shard : shards_) {
+    std::lock_guard<std::mutex> guard(shard.latch_);
+    for (const auto &chain : shard.chains_) {
+      count += chain.second.undo_.size();
+    }
+  }
+  return count;
+}
+
+}  // namespace bustub
@@ -0,0 +1,73 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// thread_pool_test.cpp
+//
+// Identification: test/common/thread_pool_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/thread_pool.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(ThreadPoolTest, RunTest) {
+  ThreadPool pool;
+  std::vector<int> results(16, 0);
+  for (int round = 0; round < 10; round++) {
+    pool.Run(results.size(), [&](size_t i) { results[i] += static_cast<int>(i); });
+  }
+  for (size_t i = 0; i < results.size(); i++) {
+    EXPECT_EQ(10 * static_cast<int>(i), results[i]);
+  }
+  // Every task but the first of a round runs on a worker.
+  EXPECT_GE(pool.GetThreadCount(), 1);
+
+  std::atomic<int> finished{0};
+  EXPECT_THROW(pool.Run(8,
+                        [&](size_t i) {
+                          if (i == 5) {
+                            throw std::runtime_error("task failed");
+                          }
+                          finished++;
+                        }),
+               std::runtime_error);
+  EXPECT_EQ(7, finished);
+}
+
+// NOLINTNEXTLINE
+TEST(ThreadPoolTest, BlockingTasksTest) {
+  // Every task waits for all the others to start, which only finishes if no task waits for a worker.
+  ThreadPool pool;
+  const int num_tasks = 12;
+  std::atomic<int> started{0};
+  pool.Run(num_tasks, [&](size_t i) {
+    started++;
+    while (started < num_tasks) {
+      std::this_thread::yield();
+    }
+  });
+  EXPECT_EQ(num_tasks, started);
+
+  std::atomic<int> submitted{0};
+  {
+    ThreadPool short_lived_pool;
+    for (int i = 0; i < num_tasks; i++) {
+      short_lived_pool.Submit([&] { submitted++; });
+    }
+  }
+  // Destroying the pool runs the queued tasks first.
+  EXPECT_EQ(num_tasks, submitted);
+}
+
+}  // namespace bustub
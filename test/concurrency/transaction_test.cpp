@@ -3,10 +3,14 @@
  */
 
 #include <atomic>
+#include <chrono>  // NOLINT
 #include <cstdio>
+#include <iostream>
 #include <memory>
 #include <random>
+#include <set>
 #include <string>
+#include <thread>  // NOLINT
 #include <utility>
 #include <vector>
 
@@ -153,6 +157,76 @@ void CheckTxnLockSize(Transaction *txn, size_t shared_size, size_t exclusive_siz
   EXPECT_EQ(txn->GetExclusiveLockSet()->size(), exclusive_size);
 }
 
+// NOLINTNEXTLINE
+TEST(TransactionManagerTest, RegistryTest) {
+  LockManager lock_manager;
+  TransactionManager txn_mgr(&lock_manager);
+  constexpr size_t num_threads = 4;
+  constexpr size_t txns_per_thread = 1000;
+  std::vector<std::vector<txn_id_t>> txn_ids(num_threads);
+  std::vector<std::thread> threads;
+  for (size_t thread_idx = 0; thread_idx < num_threads; thread_idx++) {
+    threads.emplace_back([&, thread_idx] {
+      for (size_t i = 0; i < txns_per_thread; i++) {
+        Transaction *txn = txn_mgr.Begin();
+        EXPECT_EQ(txn, txn_mgr.GetTransaction(txn->GetTransactionId()));
+        txn_ids[thread_idx].push_back(txn->GetTransactionId());
+        if (i % 2 == 0) {
+          txn_mgr.Commit(txn);
+        } else {
+          txn_mgr.Abort(txn);
+        }
+        delete txn;
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  std::set<txn_id_t> distinct;
+  for (const auto &ids : txn_ids) {
+    distinct.insert(ids.begin(), ids.end());
+  }
+  EXPECT_EQ(num_threads * txns_per_thread, distinct.size());
+
+  // Only running transactions are registered.
+  std::vector<Transaction *> running;
+  txn_mgr.GetRunningTransactions(&running);
+  EXPECT_TRUE(running.empty());
+  Transaction *txn = txn_mgr.Begin();
+  txn_mgr.GetRunningTransactions(&running);
+  EXPECT_EQ(std::vector<Transaction *>{txn}, running);
+  txn_mgr.Commit(txn);
+  delete txn;
+}
+
+// NOLINTNEXTLINE
+TEST(TransactionManagerTest, DISABLED_BeginCommitBenchmark) {
+  // Empty transactions begin and commit on every thread; no latch is shared by all of them.
+  LockManager lock_manager;
+  TransactionManager txn_mgr(&lock_manager);
+  constexpr size_t txns_per_thread = 200000;
+  for (size_t num_threads : {1, 2, 4, 8}) {
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t thread_idx = 0; thread_idx < num_threads; thread_idx++) {
+      threads.emplace_back([&] {
+        for (size_t i = 0; i < txns_per_thread; i++) {
+          Transaction *txn = txn_mgr.Begin();
+          txn_mgr.Commit(txn);
+          delete txn;
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << num_threads << " threads: " << num_threads * txns_per_thread / elapsed / 1e6 << " M txns/s"
+              << std::endl;
+  }
+}
+
 // NOLINTNEXTLINE
 TEST_F(TransactionTest, DISABLED_SimpleInsertRollbackTest) {
   // txn1: INSERT INTO empty_table2 VALUES (200, 20), (201, 21), (202, 22)
@@ -0,0 +1,106 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bounded_queue_test.cpp
+//
+// Identification: test/container/bounded_queue_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <memory>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "container/bounded_queue.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(BoundedQueueTest, SampleTest) {
+  BoundedQueue<std::unique_ptr<int>> queue(5);
+  EXPECT_EQ(8, queue.GetCapacity());
+
+  std::unique_ptr<int> item;
+  EXPECT_FALSE(queue.TryPop(&item));
+  // The queue wraps around its ring several times.
+  for (int lap = 0; lap < 3; lap++) {
+    for (int i = 0; i < 8; i++) {
+      item = std::make_unique<int>(lap * 8 + i);
+      EXPECT_TRUE(queue.TryPush(&item));
+      EXPECT_EQ(nullptr, item);
+    }
+    item = std::make_unique<int>(-1);
+    EXPECT_FALSE(queue.TryPush(&item));
+    EXPECT_NE(nullptr, item);
+    for (int i = 0; i < 8; i++) {
+      EXPECT_TRUE(queue.TryPop(&item));
+      EXPECT_EQ(lap * 8 + i, *item);
+    }
+    EXPECT_FALSE(queue.TryPop(&item));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BoundedQueueTest, ConcurrentTest) {
+  // Several producers and consumers share a small queue; every item must be popped exactly once, and the items of
+  // each producer in the order in which they were pushed.
+  const int num_producers = 4;
+  const int num_consumers = 3;
+  const int items_per_producer = 20000;
+  BoundedQueue<int64_t> queue(16);
+  std::atomic<int> finished_producers{0};
+  std::vector<std::vector<int64_t>> popped(num_consumers);
+  std::vector<std::thread> threads;
+  for (int p = 0; p < num_producers; p++) {
+    threads.emplace_back([&, p] {
+      for (int i = 0; i < items_per_producer; i++) {
+        int64_t item = static_cast<int64_t>(p) * items_per_producer + i;
+        while (!queue.TryPush(&item)) {
+          std::this_thread::yield();
+        }
+      }
+      finished_producers++;
+    });
+  }
+  for (int c = 0; c < num_consumers; c++) {
+    threads.emplace_back([&, c] {
+      int64_t item;
+      while (true) {
+        if (queue.TryPop(&item)) {
+          popped[c].push_back(item);
+        } else if (finished_producers == num_producers) {
+          if (!queue.TryPop(&item)) {
+            break;
+          }
+          popped[c].push_back(item);
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  std::vector<bool> seen(num_producers * items_per_producer, false);
+  for (const auto &items : popped) {
+    std::vector<int64_t> last(num_producers, -1);
+    for (int64_t item : items) {
+      EXPECT_FALSE(seen[item]);
+      seen[item] = true;
+      EXPECT_LT(last[item / items_per_producer], item);
+      last[item / items_per_producer] = item;
+    }
+  }
+  for (bool item_seen : seen) {
+    EXPECT_TRUE(item_seen);
+  }
+}
+
+}  // namespace bustub
@@ -10,9 +10,17 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
 #include <cstdio>
+#include <map>
 #include <memory>
+#include <random>
 #include <string>
+#include <tuple>
+#include <thread>  // NOLINT
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -24,16 +32,30 @@
 #include "catalog/table_generator.h"
 #include "concurrency/transaction_manager.h"
 #include "execution/execution_engine.h"
+#include "execution/aggregation_hash_table.h"
 #include "execution/executor_context.h"
 #include "execution/executors/aggregation_executor.h"
+#include "execution/executors/exchange_executor.h"
+#include "execution/executors/index_scan_executor.h"
 #include "execution/executors/insert_executor.h"
+#include "execution/executors/limit_executor.h"
 #include "execution/executors/nested_loop_join_executor.h"
+#include "execution/executors/seq_scan_executor.h"
+#include "execution/executors/sort_executor.h"
+#include "execution/executors/top_n_executor.h"
 #include "execution/expressions/aggregate_value_expression.h"
 #include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/compiled_predicate.h"
 #include "execution/expressions/comparison_expression.h"
 #include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
+#include "execution/morsel_dispenser.h"
+#include "execution/plans/exchange_plan.h"
 #include "execution/plans/index_scan_plan.h"
+#include "execution/plans/nested_index_join_plan.h"
 #include "execution/plans/seq_scan_plan.h"
+#include "execution/plans/sort_plan.h"
+#include "execution/sort_key_encoder.h"
 #include "gtest/gtest.h"
 #include "storage/b_plus_tree_test_util.h"  // NOLINT
 #include "storage/table/tuple.h"
@@ -105,6 +127,12 @@ class ExecutorTest : public ::testing::Test {
     return allocated_exprs_.back().get();
   }
 
+  const AbstractExpression *MakeLogicExpression(const AbstractExpression *lhs, const AbstractExpression *rhs,
+                                                LogicType logic_type) {
+    allocated_exprs_.emplace_back(std::make_unique<LogicExpression>(lhs, rhs, logic_type));
+    return allocated_exprs_.back().get();
+  }
+
   const AbstractExpression *MakeAggregateValueExpression(bool is_group_by_term, uint32_t term_idx) {
     allocated_exprs_.emplace_back(
         std::make_unique<AggregateValueExpression>(is_group_by_term, term_idx, TypeId::INTEGER));
@@ -170,7 +198,7 @@ TEST_F(ExecutorTest, DISABLED_SimpleSeqScanTest) {
 }
 
 // NOLINTNEXTLINE
-TEST_F(ExecutorTest, DISABLED_SimpleIndexScanTest) {
+TEST_F(ExecutorTest, SimpleIndexScanTest) {
   // SELECT colA, colB FROM test_1 WHERE colA < 500
 
   // Construct query plan
@@ -206,7 +234,135 @@ TEST_F(ExecutorTest, DISABLED_SimpleIndexScanTest) {
 }
 
 // NOLINTNEXTLINE
-TEST_F(ExecutorTest, DISABLED_SimpleRawInsertTest) {
+TEST_F(ExecutorTest, IndexScanRangeTest) {
+  // SELECT colA, colB FROM test_1 WHERE <predicate> with an index on colA, checked against a sequential scan. test_1
+  // is stored in colA order, so the qualifying RIDs are fetched in key order.
+  TableMetadata *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  Schema &schema = table_info->schema_;
+  Schema *key_schema = ParseCreateStatement("a integer");
+  auto index_info = GetExecutorContext()->GetCatalog()->CreateIndex<GenericKey<4>, RID, GenericComparator<4>>(
+      GetTxn(), "index1", "test_1", schema, *key_schema, {0}, 4);
+  auto *colA = MakeColumnValueExpression(schema, 0, "colA");
+  auto *colB = MakeColumnValueExpression(schema, 0, "colB");
+  auto *out_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+  auto compare = [&](const AbstractExpression *column, ComparisonType comp_type, int32_t constant) {
+    return MakeComparisonExpression(column, MakeConstantValueExpression(ValueFactory::GetIntegerValue(constant)),
+                                    comp_type);
+  };
+  auto both = [&](const AbstractExpression *lhs, const AbstractExpression *rhs) {
+    return MakeLogicExpression(lhs, rhs, LogicType::And);
+  };
+  std::vector<std::pair<const AbstractExpression *, size_t>> predicates{
+      {both(compare(colA, ComparisonType::GreaterThanOrEqual, 100), compare(colA, ComparisonType::LessThan, 200)), 100},
+      {compare(colA, ComparisonType::Equal, 42), 1},
+      {compare(colA, ComparisonType::GreaterThan, 995), 4},
+      {both(MakeComparisonExpression(MakeConstantValueExpression(ValueFactory::GetIntegerValue(500)), colA,
+                                     ComparisonType::GreaterThan),
+            compare(colA, ComparisonType::GreaterThan, 490)),
+       9},
+      {both(compare(colA, ComparisonType::LessThanOrEqual, 10), compare(colA, ComparisonType::GreaterThan, 20)), 0},
+      {both(compare(colA, ComparisonType::LessThan, 300), compare(colB, ComparisonType::Equal, 3)), 0},
+      {MakeLogicExpression(compare(colA, ComparisonType::LessThan, 10), compare(colA, ComparisonType::GreaterThan, 990),
+                           LogicType::Or),
+       19},
+      {nullptr, TEST1_SIZE}};
+
+  for (const auto &[predicate, count] : predicates) {
+    IndexScanPlanNode index_plan{out_schema, predicate, index_info->index_oid_};
+    IndexScanExecutor executor(GetExecutorContext(), &index_plan);
+    executor.Init();
+    std::vector<std::string> actual;
+    Tuple tuple;
+    RID rid;
+    int32_t last = -1;
+    while (executor.Next(&tuple, &rid)) {
+      int32_t key = tuple.GetValue(out_schema, 0).GetAs<int32_t>();
+      ASSERT_LT(last, key);
+      last = key;
+      actual.push_back(tuple.ToString(out_schema));
+    }
+    ASSERT_FALSE(executor.IsFetchingInRidOrder());
+
+    SeqScanPlanNode scan_plan{out_schema, predicate, table_info->oid_};
+    std::vector<Tuple> scanned;
+    GetExecutionEngine()->Execute(&scan_plan, &scanned, GetTxn(), GetExecutorContext());
+    std::vector<std::string> expected;
+    for (const auto &scanned_tuple : scanned) {
+      expected.push_back(scanned_tuple.ToString(out_schema));
+    }
+    if (predicate != nullptr && count > 0 && count < TEST1_SIZE / 2) {
+      ASSERT_EQ(actual.size(), count);
+    }
+    ASSERT_EQ(actual, expected);
+  }
+  delete key_schema;
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, IndexScanRidOrderTest) {
+  // SELECT k, v FROM perm WHERE k >= 500 AND k < 1500 with an index on k, where the table is not stored in k order.
+  // Half of the table qualifies, so the tuples are fetched in RID order; a point lookup stays in key order.
+  Schema schema({Column("k", TypeId::INTEGER), Column("v", TypeId::INTEGER)});
+  TableMetadata *table_info = GetCatalog()->CreateTable(GetTxn(), "perm", schema);
+  const int32_t num_rows = 2000;
+  for (int32_t i = 0; i < num_rows; i++) {
+    Tuple tuple({ValueFactory::GetIntegerValue(i * 7919 % num_rows), ValueFactory::GetIntegerValue(i)}, &schema);
+    RID rid;
+    ASSERT_TRUE(table_info->table_->InsertTuple(tuple, &rid, GetTxn()));
+  }
+  Schema *key_schema = ParseCreateStatement("a integer");
+  auto index_info = GetCatalog()->CreateIndex<GenericKey<4>, RID, GenericComparator<4>>(
+      GetTxn(), "perm_k", "perm", schema, *key_schema, {0}, 4);
+  auto *k = MakeColumnValueExpression(schema, 0, "k");
+  auto *v = MakeColumnValueExpression(schema, 0, "v");
+  auto *out_schema = MakeOutputSchema({{"k", k}, {"v", v}});
+
+  auto *range = MakeLogicExpression(
+      MakeComparisonExpression(k, MakeConstantValueExpression(ValueFactory::GetIntegerValue(500)),
+                               ComparisonType::GreaterThanOrEqual),
+      MakeComparisonExpression(k, MakeConstantValueExpression(ValueFactory::GetIntegerValue(1500)),
+                               ComparisonType::LessThan),
+      LogicType::And);
+  IndexScanPlanNode range_plan{out_schema, range, index_info->index_oid_};
+  IndexScanExecutor range_executor(GetExecutorContext(), &range_plan);
+  range_executor.Init();
+  ASSERT_TRUE(range_executor.IsFetchingInRidOrder());
+  std::vector<bool> seen(num_rows, false);
+  TupleBatch batch(out_schema);
+  RID last_rid;
+  size_t rows = 0;
+  while (range_executor.NextBatch(&batch)) {
+    for (uint32_t row_idx = 0; row_idx < batch.GetRowCount(); row_idx++) {
+      int32_t key = batch.GetValue(row_idx, 0).GetAs<int32_t>();
+      ASSERT_GE(key, 500);
+      ASSERT_LT(key, 1500);
+      ASSERT_FALSE(seen[key]);
+      seen[key] = true;
+      ASSERT_EQ(batch.GetValue(row_idx, 1).GetAs<int32_t>() * 7919 % num_rows, key);
+      if (rows++ > 0) {
+        ASSERT_LT(last_rid.Get(), batch.GetRid(row_idx).Get());
+      }
+      last_rid = batch.GetRid(row_idx);
+    }
+  }
+  ASSERT_EQ(rows, 1000);
+
+  auto *point = MakeComparisonExpression(k, MakeConstantValueExpression(ValueFactory::GetIntegerValue(1234)),
+                                         ComparisonType::Equal);
+  IndexScanPlanNode point_plan{out_schema, point, index_info->index_oid_};
+  IndexScanExecutor point_executor(GetExecutorContext(), &point_plan);
+  point_executor.Init();
+  ASSERT_FALSE(point_executor.IsFetchingInRidOrder());
+  Tuple tuple;
+  RID rid;
+  ASSERT_TRUE(point_executor.Next(&tuple, &rid));
+  ASSERT_EQ(tuple.GetValue(out_schema, 0).GetAs<int32_t>(), 1234);
+  ASSERT_FALSE(point_executor.Next(&tuple, &rid));
+  delete key_schema;
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, SimpleRawInsertTest) {
   // INSERT INTO empty_table2 VALUES (100, 10), (101, 11), (102, 12)
   // Create Values to insert
   std::vector<Value> val1{ValueFactory::GetIntegerValue(100), ValueFactory::GetIntegerValue(10)};
@@ -251,7 +407,7 @@ TEST_F(ExecutorTest, DISABLED_SimpleRawInsertTest) {
 }
 
 // NOLINTNEXTLINE
-TEST_F(ExecutorTest, DISABLED_SimpleSelectInsertTest) {
+TEST_F(ExecutorTest, SimpleSelectInsertTest) {
   // INSERT INTO empty_table2 SELECT colA, colB FROM test_1 WHERE colA < 500
   std::unique_ptr<AbstractPlanNode> scan_plan1;
   const Schema *out_schema1;
@@ -303,7 +459,7 @@ TEST_F(ExecutorTest, DISABLED_SimpleSelectInsertTest) {
 }
 
 // NOLINTNEXTLINE
-TEST_F(ExecutorTest, DISABLED_SimpleRawInsertWithIndexTest) {
+TEST_F(ExecutorTest, SimpleRawInsertWithIndexTest) {
   // INSERT INTO empty_table2 VALUES (100, 10), (101, 11), (102, 12)
   // Create Values to insert
   std::vector<Value> val1{ValueFactory::GetIntegerValue(100), ValueFactory::GetIntegerValue(10)};
@@ -372,6 +528,102 @@ TEST_F(ExecutorTest, DISABLED_SimpleRawInsertWithIndexTest) {
   delete key_schema;
 }
 
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, BatchInsertTest) {
+  // INSERT INTO empty_table2 SELECT colA, colB FROM test_1 ORDER BY colA DESC with an index on colA. The rows are
+  // appended in the order of the child, every page but the last is filled up, and the index covers every row.
+  auto table_info = GetExecutorContext()->GetCatalog()->GetTable("empty_table2");
+  Schema *key_schema = ParseCreateStatement("a integer");
+  auto index_info = GetExecutorContext()->GetCatalog()->CreateIndex<GenericKey<4>, RID, GenericComparator<4>>(
+      GetTxn(), "index1", "empty_table2", table_info->schema_, *key_schema, {0}, 4);
+  auto test_1 = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto *colA = MakeColumnValueExpression(test_1->schema_, 0, "colA");
+  auto *colB = MakeColumnValueExpression(test_1->schema_, 0, "colB");
+  const Schema *scan_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+  SeqScanPlanNode scan_plan{scan_schema, nullptr, test_1->oid_};
+  SortPlanNode sort_plan{
+      scan_schema, &scan_plan, {{OrderByType::Descending, MakeColumnValueExpression(*scan_schema, 0, "colA")}}};
+  InsertPlanNode insert_plan{&sort_plan, table_info->oid_};
+  GetExecutionEngine()->Execute(&insert_plan, nullptr, GetTxn(), GetExecutorContext());
+
+  auto &schema = table_info->schema_;
+  const Schema *out_schema = MakeOutputSchema(
+      {{"colA", MakeColumnValueExpression(schema, 0, "colA")}, {"colB", MakeColumnValueExpression(schema, 0, "colB")}});
+  SeqScanPlanNode check_plan{out_schema, nullptr, table_info->oid_};
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(&check_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), TEST1_SIZE);
+  for (size_t i = 0; i < result_set.size(); i++) {
+    ASSERT_EQ(result_set[i].GetValue(out_schema, 0).GetAs<int32_t>(), static_cast<int32_t>(TEST1_SIZE - 1 - i));
+  }
+
+  std::vector<page_id_t> page_ids;
+  table_info->table_->GetPageIds(&page_ids);
+  ASSERT_GT(page_ids.size(), 1);
+  TupleBatch page_batch(&schema, TEST1_SIZE);
+  table_info->table_->ScanPage(page_ids[0], &page_batch, GetTxn());
+  uint32_t page_capacity = page_batch.GetRowCount();
+  ASSERT_EQ(page_ids.size(), (TEST1_SIZE + page_capacity - 1) / page_capacity);
+
+  std::vector<RID> rids;
+  index_info->index_->ScanRange(nullptr, nullptr, &rids, GetTxn());
+  ASSERT_EQ(rids.size(), TEST1_SIZE);
+  for (size_t i = 0; i < rids.size(); i++) {
+    Tuple indexed_tuple;
+    ASSERT_TRUE(table_info->table_->GetTuple(rids[i], &indexed_tuple, GetTxn()));
+    ASSERT_EQ(indexed_tuple.GetValue(&schema, 0).GetAs<int32_t>(), static_cast<int32_t>(i));
+  }
+  ASSERT_EQ(GetTxn()->GetIndexWriteSet()->size(), TEST1_SIZE);
+  delete key_schema;
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, BatchInsertAbortTest) {
+  // An aborted INSERT INTO empty_table2 VALUES ... leaves neither rows nor index entries behind.
+  auto table_info = GetExecutorContext()->GetCatalog()->GetTable("empty_table2");
+  Schema *key_schema = ParseCreateStatement("a integer");
+  auto index_info = GetExecutorContext()->GetCatalog()->CreateIndex<GenericKey<4>, RID, GenericComparator<4>>(
+      GetTxn(), "index1", "empty_table2", table_info->schema_, *key_schema, {0}, 4);
+  std::vector<std::vector<Value>> raw_vals;
+  for (int32_t i = 0; i < 100; i++) {
+    raw_vals.push_back({ValueFactory::GetIntegerValue(i), ValueFactory::GetIntegerValue(i % 10)});
+  }
+  InsertPlanNode insert_plan{std::move(raw_vals), table_info->oid_};
+
+  Transaction *txn = GetTxnManager()->Begin();
+  ExecutorContext exec_ctx(txn, GetCatalog(), GetBPM(), GetTxnManager(), GetLockManager());
+  GetExecutionEngine()->Execute(&insert_plan, nullptr, txn, &exec_ctx);
+  std::vector<RID> rids;
+  index_info->index_->ScanRange(nullptr, nullptr, &rids, txn);
+  ASSERT_EQ(rids.size(), 100);
+  GetTxnManager()->Abort(txn);
+  delete txn;
+
+  rids.clear();
+  index_info->index_->ScanRange(nullptr, nullptr, &rids, GetTxn());
+  ASSERT_TRUE(rids.empty());
+  auto &schema = table_info->schema_;
+  const Schema *out_schema = MakeOutputSchema({{"colA", MakeColumnValueExpression(schema, 0, "colA")}});
+  SeqScanPlanNode scan_plan{out_schema, nullptr, table_info->oid_};
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(&scan_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_TRUE(result_set.empty());
+
+  // An insert that fails reports it to the query.
+  enable_logging = true;
+  txn = GetTxnManager()->Begin();
+  ExecutorContext failing_ctx(txn, GetCatalog(), GetBPM(), GetTxnManager(), GetLockManager());
+  txn->Wound();
+  EXPECT_THROW(GetExecutionEngine()->Execute(&insert_plan, nullptr, txn, &failing_ctx), TransactionAbortException);
+  GetTxnManager()->Abort(txn);
+  enable_logging = false;
+  delete txn;
+  rids.clear();
+  index_info->index_->ScanRange(nullptr, nullptr, &rids, GetTxn());
+  ASSERT_TRUE(rids.empty());
+  delete key_schema;
+}
+
 // NOLINTNEXTLINE
 TEST_F(ExecutorTest, DISABLED_SimpleDeleteTest) {
   // SELECT colA FROM test_1 WHERE colA == 50
@@ -472,6 +724,1461 @@ TEST_F(ExecutorTest, SimpleNestedLoopJoinTest) {
   }
 }
 
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, SimpleNestedIndexJoinTest) {
+  // SELECT test_1.colA, test_1.colB, test_3.col1, test_3.col2 FROM test_1 JOIN test_3 ON test_1.colA = test_3.col1
+  // with an index on test_3.col1
+  std::unique_ptr<AbstractPlanNode> scan_plan;
+  const Schema *outer_schema;
+  {
+    auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+    auto &schema = table_info->schema_;
+    auto colA = MakeColumnValueExpression(schema, 0, "colA");
+    auto colB = MakeColumnValueExpression(schema, 0, "colB");
+    outer_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+    scan_plan = std::make_unique<SeqScanPlanNode>(outer_schema, nullptr, table_info->oid_);
+  }
+  TableMetadata *inner_info = GetExecutorContext()->GetCatalog()->GetTable("test_3");
+  Schema *key_schema = ParseCreateStatement("a integer");
+  GetExecutorContext()->GetCatalog()->CreateIndex<GenericKey<4>, RID, GenericComparator<4>>(
+      GetTxn(), "index1", "test_3", inner_info->schema_, *key_schema, {0}, 4);
+  const Schema *inner_schema;
+  {
+    auto col1 = MakeColumnValueExpression(inner_info->schema_, 0, "col1");
+    auto col2 = MakeColumnValueExpression(inner_info->schema_, 0, "col2");
+    inner_schema = MakeOutputSchema({{"col1", col1}, {"col2", col2}});
+  }
+  std::unique_ptr<NestedIndexJoinPlanNode> join_plan;
+  const Schema *out_final;
+  {
+    auto colA = MakeColumnValueExpression(*outer_schema, 0, "colA");
+    auto colB = MakeColumnValueExpression(*outer_schema, 0, "colB");
+    auto col1 = MakeColumnValueExpression(*inner_schema, 1, "col1");
+    auto col2 = MakeColumnValueExpression(*inner_schema, 1, "col2");
+    auto predicate = MakeComparisonExpression(colA, col1, ComparisonType::Equal);
+    out_final = MakeOutputSchema({{"colA", colA}, {"colB", colB}, {"col1", col1}, {"col2", col2}});
+    join_plan = std::make_unique<NestedIndexJoinPlanNode>(
+        out_final, std::vector<const AbstractPlanNode *>{scan_plan.get()}, predicate, inner_info->oid_, "index1",
+        outer_schema, inner_schema);
+  }
+
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(join_plan.get(), &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), 100);
+  for (const auto &tuple : result_set) {
+    auto colA = tuple.GetValue(out_final, out_final->GetColIdx("colA")).GetAs<int32_t>();
+    ASSERT_EQ(colA, tuple.GetValue(out_final, out_final->GetColIdx("col1")).GetAs<int32_t>());
+    ASSERT_LT(tuple.GetValue(out_final, out_final->GetColIdx("colB")).GetAs<int32_t>(), 10);
+    ASSERT_GE(tuple.GetValue(out_final, out_final->GetColIdx("col2")).GetAs<int32_t>(), 10);
+    ASSERT_LT(tuple.GetValue(out_final, out_final->GetColIdx("col2")).GetAs<int32_t>(), 20);
+  }
+  delete key_schema;
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, NestedIndexJoinKeyTest) {
+  // SELECT test_1.colB, test_1.colA, test_3.col2, test_3.col1 FROM test_1 JOIN test_3 ON test_3.col1 = test_1.colA
+  // with an index on test_3.col1; the outer join column is not at the position of the index key column.
+  std::unique_ptr<AbstractPlanNode> scan_plan;
+  const Schema *outer_schema;
+  {
+    auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+    auto &schema = table_info->schema_;
+    auto colA = MakeColumnValueExpression(schema, 0, "colA");
+    auto colB = MakeColumnValueExpression(schema, 0, "colB");
+    outer_schema = MakeOutputSchema({{"colB", colB}, {"colA", colA}});
+    scan_plan = std::make_unique<SeqScanPlanNode>(outer_schema, nullptr, table_info->oid_);
+  }
+  TableMetadata *inner_info = GetExecutorContext()->GetCatalog()->GetTable("test_3");
+  Schema *key_schema = ParseCreateStatement("a integer");
+  GetExecutorContext()->GetCatalog()->CreateIndex<GenericKey<4>, RID, GenericComparator<4>>(
+      GetTxn(), "index1", "test_3", inner_info->schema_, *key_schema, {0}, 4);
+  const Schema *inner_schema;
+  {
+    auto col1 = MakeColumnValueExpression(inner_info->schema_, 0, "col1");
+    auto col2 = MakeColumnValueExpression(inner_info->schema_, 0, "col2");
+    inner_schema = MakeOutputSchema({{"col2", col2}, {"col1", col1}});
+  }
+  std::unique_ptr<NestedIndexJoinPlanNode> join_plan;
+  const Schema *out_final;
+  {
+    auto colA = MakeColumnValueExpression(*outer_schema, 0, "colA");
+    auto colB = MakeColumnValueExpression(*outer_schema, 0, "colB");
+    auto col1 = MakeColumnValueExpression(*inner_schema, 1, "col1");
+    auto col2 = MakeColumnValueExpression(*inner_schema, 1, "col2");
+    auto predicate = MakeComparisonExpression(col1, colA, ComparisonType::Equal);
+    out_final = MakeOutputSchema({{"colB", colB}, {"colA", colA}, {"col2", col2}, {"col1", col1}});
+    join_plan = std::make_unique<NestedIndexJoinPlanNode>(
+        out_final, std::vector<const AbstractPlanNode *>{scan_plan.get()}, predicate, inner_info->oid_, "index1",
+        outer_schema, inner_schema);
+  }
+
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(join_plan.get(), &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), 100);
+  for (const auto &tuple : result_set) {
+    auto colA = tuple.GetValue(out_final, out_final->GetColIdx("colA")).GetAs<int32_t>();
+    ASSERT_EQ(colA, tuple.GetValue(out_final, out_final->GetColIdx("col1")).GetAs<int32_t>());
+    ASSERT_LT(tuple.GetValue(out_final, out_final->GetColIdx("colB")).GetAs<int32_t>(), 10);
+    ASSERT_GE(tuple.GetValue(out_final, out_final->GetColIdx("col2")).GetAs<int32_t>(), 10);
+    ASSERT_LT(tuple.GetValue(out_final, out_final->GetColIdx("col2")).GetAs<int32_t>(), 20);
+  }
+  delete key_schema;
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, BatchExecutionTest) {
+  // SELECT colA, colB FROM test_1 WHERE colA < 500 LIMIT 100 OFFSET 450, executed both ways
+  TableMetadata *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  Schema &schema = table_info->schema_;
+  auto *colA = MakeColumnValueExpression(schema, 0, "colA");
+  auto *colB = MakeColumnValueExpression(schema, 0, "colB");
+  auto *const500 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(500));
+  auto *predicate = MakeComparisonExpression(colA, const500, ComparisonType::LessThan);
+  auto *out_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+  SeqScanPlanNode scan_plan{out_schema, predicate, table_info->oid_};
+
+  std::vector<Tuple> tuples;
+  GetExecutionEngine()->Execute(&scan_plan, &tuples, GetTxn(), GetExecutorContext());
+  std::vector<TupleBatch> batches;
+  GetExecutionEngine()->ExecuteBatch(&scan_plan, &batches, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(tuples.size(), 500);
+  size_t row = 0;
+  for (const auto &batch : batches) {
+    ASSERT_LE(batch.GetRowCount(), TupleBatch::DEFAULT_BATCH_SIZE);
+    for (uint32_t i = 0; i < batch.GetRowCount(); i++, row++) {
+      ASSERT_EQ(batch.GetValue(i, 0).GetAs<int32_t>(), tuples[row].GetValue(out_schema, 0).GetAs<int32_t>());
+      ASSERT_EQ(batch.GetValue(i, 1).GetAs<int32_t>(), tuples[row].GetValue(out_schema, 1).GetAs<int32_t>());
+    }
+  }
+  ASSERT_EQ(row, tuples.size());
+
+  LimitPlanNode limit_plan{out_schema, &scan_plan, 100, 450};
+  batches.clear();
+  GetExecutionEngine()->ExecuteBatch(&limit_plan, &batches, GetTxn(), GetExecutorContext());
+  row = 450;
+  for (const auto &batch : batches) {
+    for (uint32_t i = 0; i < batch.GetRowCount(); i++, row++) {
+      ASSERT_EQ(batch.GetValue(i, 0).GetAs<int32_t>(), tuples[row].GetValue(out_schema, 0).GetAs<int32_t>());
+    }
+  }
+  ASSERT_EQ(row, 500);
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, BatchPredicateSelectionTest) {
+  // Every comparison between colB and a constant must select the same rows in batch and tuple-at-a-time mode.
+  TableMetadata *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  Schema &schema = table_info->schema_;
+  TupleBatch batch(&schema);
+  std::vector<Tuple> tuples;
+  for (auto it = table_info->table_->Begin(GetTxn()); it != table_info->table_->End() && !batch.IsFull(); ++it) {
+    batch.AppendTuple(*it, it->GetRid());
+    tuples.push_back(*it);
+  }
+  auto *colB = MakeColumnValueExpression(schema, 0, "colB");
+  auto *const5 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(5));
+  for (auto comp_type : {ComparisonType::Equal, ComparisonType::NotEqual, ComparisonType::LessThan,
+                         ComparisonType::LessThanOrEqual, ComparisonType::GreaterThan,
+                         ComparisonType::GreaterThanOrEqual}) {
+    for (auto *predicate : {MakeComparisonExpression(colB, const5, comp_type),
+                            MakeComparisonExpression(const5, colB, comp_type)}) {
+      for (uint32_t step : {1, 3}) {
+        std::vector<uint32_t> selection;
+        std::vector<uint32_t> expected;
+        for (uint32_t i = 0; i < batch.GetRowCount(); i += step) {
+          selection.push_back(i);
+          if (predicate->Evaluate(&tuples[i], &schema).GetAs<bool>()) {
+            expected.push_back(i);
+          }
+        }
+        predicate->EvaluateSelection(&batch, &selection);
+        ASSERT_EQ(selection, expected);
+      }
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, CompiledPredicateTest) {
+  // Compiled comparisons must agree with the interpreted expression tree.
+  TableMetadata *table1 = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  TableMetadata *table2 = GetExecutorContext()->GetCatalog()->GetTable("test_2");
+  auto *colA = MakeColumnValueExpression(table1->schema_, 0, "colA");
+  auto *colB = MakeColumnValueExpression(table1->schema_, 0, "colB");
+  auto *col1 = MakeColumnValueExpression(table2->schema_, 1, "col1");
+  auto *const5 = MakeConstantValueExpression(ValueFactory::GetIntegerValue(5));
+  ASSERT_EQ(CompiledPredicate::Compile(MakeComparisonExpression(const5, const5, ComparisonType::Equal),
+                                       &table1->schema_),
+            nullptr);
+
+  std::vector<Tuple> tuples1;
+  for (auto it = table1->table_->Begin(GetTxn()); it != table1->table_->End(); ++it) {
+    tuples1.push_back(*it);
+  }
+  std::vector<Tuple> tuples2;
+  for (auto it = table2->table_->Begin(GetTxn()); it != table2->table_->End(); ++it) {
+    tuples2.push_back(*it);
+  }
+  for (auto comp_type : {ComparisonType::Equal, ComparisonType::NotEqual, ComparisonType::LessThan,
+                         ComparisonType::LessThanOrEqual, ComparisonType::GreaterThan,
+                         ComparisonType::GreaterThanOrEqual}) {
+    for (auto *predicate : {MakeComparisonExpression(colB, const5, comp_type),
+                            MakeComparisonExpression(const5, colB, comp_type),
+                            MakeComparisonExpression(colA, colB, comp_type)}) {
+      auto compiled = CompiledPredicate::Compile(predicate, &table1->schema_);
+      ASSERT_NE(compiled, nullptr);
+      for (const auto &tuple : tuples1) {
+        ASSERT_EQ(compiled->Evaluate(&tuple), predicate->Evaluate(&tuple, &table1->schema_).GetAs<bool>());
+      }
+    }
+    // A join predicate between an INTEGER and a SMALLINT column.
+    auto *join_predicate = MakeComparisonExpression(colB, col1, comp_type);
+    auto compiled = CompiledPredicate::Compile(join_predicate, &table1->schema_, &table2->schema_);
+    ASSERT_NE(compiled, nullptr);
+    for (size_t i = 0; i < 20; i++) {
+      for (const auto &right : tuples2) {
+        ASSERT_EQ(compiled->EvaluateJoin(&tuples1[i], &right),
+                  join_predicate->EvaluateJoin(&tuples1[i], &table1->schema_, &right, &table2->schema_).GetAs<bool>());
+      }
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, DISABLED_FilterSelectivityBenchmark) {
+  // SELECT colA, colB FROM test_1 WHERE colA < k for a range of selectivities
+  TableMetadata *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  Schema &schema = table_info->schema_;
+  auto *colA = MakeColumnValueExpression(schema, 0, "colA");
+  auto *colB = MakeColumnValueExpression(schema, 0, "colB");
+  auto *out_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+  const int iterations = 200;
+  for (int32_t percent : {1, 10, 50, 90, 100}) {
+    auto *bound = MakeConstantValueExpression(ValueFactory::GetIntegerValue(TEST1_SIZE * percent / 100));
+    SeqScanPlanNode plan{out_schema, MakeComparisonExpression(colA, bound, ComparisonType::LessThan), table_info->oid_};
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+      GetExecutionEngine()->Execute(&plan, nullptr, GetTxn(), GetExecutorContext());
+    }
+    auto tuple_time = std::chrono::steady_clock::now() - start;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+      GetExecutionEngine()->ExecuteBatch(&plan, nullptr, GetTxn(), GetExecutorContext());
+    }
+    auto batch_time = std::chrono::steady_clock::now() - start;
+    auto rows = static_cast<int64_t>(iterations) * TEST1_SIZE;
+    std::cout << "selectivity " << percent << "%: tuple-at-a-time "
+              << std::chrono::duration_cast<std::chrono::nanoseconds>(tuple_time).count() / rows << " ns/row, batch "
+              << std::chrono::duration_cast<std::chrono::nanoseconds>(batch_time).count() / rows << " ns/row"
+              << std::endl;
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, DISABLED_BatchExecutionBenchmark) {
+  // SELECT colB, COUNT(colA), SUM(colC), MIN(colD), MAX(colD) FROM test_1 WHERE colA < 900 GROUP BY colB
+  std::unique_ptr<AbstractPlanNode> scan_plan;
+  const Schema *scan_schema;
+  {
+    auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+    auto &schema = table_info->schema_;
+    auto colA = MakeColumnValueExpression(schema, 0, "colA");
+    auto colB = MakeColumnValueExpression(schema, 0, "colB");
+    auto colC = MakeColumnValueExpression(schema, 0, "colC");
+    auto colD = MakeColumnValueExpression(schema, 0, "colD");
+    auto predicate = MakeComparisonExpression(colA, MakeConstantValueExpression(ValueFactory::GetIntegerValue(900)),
+                                              ComparisonType::LessThan);
+    scan_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}, {"colC", colC}, {"colD", colD}});
+    scan_plan = std::make_unique<SeqScanPlanNode>(scan_schema, predicate, table_info->oid_);
+  }
+  std::unique_ptr<AbstractPlanNode> agg_plan;
+  {
+    const AbstractExpression *colA = MakeColumnValueExpression(*scan_schema, 0, "colA");
+    const AbstractExpression *colB = MakeColumnValueExpression(*scan_schema, 0, "colB");
+    const AbstractExpression *colC = MakeColumnValueExpression(*scan_schema, 0, "colC");
+    const AbstractExpression *colD = MakeColumnValueExpression(*scan_schema, 0, "colD");
+    const Schema *agg_schema = MakeOutputSchema({{"colB", MakeAggregateValueExpression(true, 0)},
+                                                 {"countA", MakeAggregateValueExpression(false, 0)},
+                                                 {"sumC", MakeAggregateValueExpression(false, 1)},
+                                                 {"minD", MakeAggregateValueExpression(false, 2)},
+                                                 {"maxD", MakeAggregateValueExpression(false, 3)}});
+    agg_plan = std::make_unique<AggregationPlanNode>(
+        agg_schema, scan_plan.get(), nullptr, std::vector<const AbstractExpression *>{colB},
+        std::vector<const AbstractExpression *>{colA, colC, colD, colD},
+        std::vector<AggregationType>{AggregationType::CountAggregate, AggregationType::SumAggregate,
+                                     AggregationType::MinAggregate, AggregationType::MaxAggregate});
+  }
+
+  const int iterations = 200;
+  for (const auto *plan : {scan_plan.get(), agg_plan.get()}) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+      std::vector<Tuple> result_set;
+      GetExecutionEngine()->Execute(plan, &result_set, GetTxn(), GetExecutorContext());
+    }
+    auto tuple_time = std::chrono::steady_clock::now() - start;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+      std::vector<TupleBatch> result_set;
+      GetExecutionEngine()->ExecuteBatch(plan, &result_set, GetTxn(), GetExecutorContext());
+    }
+    auto batch_time = std::chrono::steady_clock::now() - start;
+    std::cout << (plan == scan_plan.get() ? "scan" : "aggregation") << ": tuple-at-a-time "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(tuple_time).count() << " ms, batch "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(batch_time).count() << " ms" << std::endl;
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, GroupByAggregationTest) {
+  // SELECT colB, COUNT(colA), SUM(colC), MIN(colD), MAX(colD) FROM test_1 GROUP BY colB
+  auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  std::unique_ptr<AbstractPlanNode> scan_plan;
+  const Schema *scan_schema;
+  {
+    auto &schema = table_info->schema_;
+    auto colA = MakeColumnValueExpression(schema, 0, "colA");
+    auto colB = MakeColumnValueExpression(schema, 0, "colB");
+    auto colC = MakeColumnValueExpression(schema, 0, "colC");
+    auto colD = MakeColumnValueExpression(schema, 0, "colD");
+    scan_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}, {"colC", colC}, {"colD", colD}});
+    scan_plan = std::make_unique<SeqScanPlanNode>(scan_schema, nullptr, table_info->oid_);
+  }
+  std::unique_ptr<AbstractPlanNode> agg_plan;
+  const Schema *agg_schema;
+  {
+    const AbstractExpression *colA = MakeColumnValueExpression(*scan_schema, 0, "colA");
+    const AbstractExpression *colB = MakeColumnValueExpression(*scan_schema, 0, "colB");
+    const AbstractExpression *colC = MakeColumnValueExpression(*scan_schema, 0, "colC");
+    const AbstractExpression *colD = MakeColumnValueExpression(*scan_schema, 0, "colD");
+    agg_schema = MakeOutputSchema({{"colB", MakeAggregateValueExpression(true, 0)},
+                                   {"countA", MakeAggregateValueExpression(false, 0)},
+                                   {"sumC", MakeAggregateValueExpression(false, 1)},
+                                   {"minD", MakeAggregateValueExpression(false, 2)},
+                                   {"maxD", MakeAggregateValueExpression(false, 3)}});
+    agg_plan = std::make_unique<AggregationPlanNode>(
+        agg_schema, scan_plan.get(), nullptr, std::vector<const AbstractExpression *>{colB},
+        std::vector<const AbstractExpression *>{colA, colC, colD, colD},
+        std::vector<AggregationType>{AggregationType::CountAggregate, AggregationType::SumAggregate,
+                                     AggregationType::MinAggregate, AggregationType::MaxAggregate});
+  }
+
+  // The expected groups, computed straight from the table: colB -> {count, sum, min, max}.
+  std::map<int32_t, std::vector<int32_t>> expected;
+  const Schema &schema = table_info->schema_;
+  for (auto it = table_info->table_->Begin(GetTxn()); it != table_info->table_->End(); ++it) {
+    auto colB = it->GetValue(&schema, schema.GetColIdx("colB")).GetAs<int32_t>();
+    auto colC = it->GetValue(&schema, schema.GetColIdx("colC")).GetAs<int32_t>();
+    auto colD = it->GetValue(&schema, schema.GetColIdx("colD")).GetAs<int32_t>();
+    auto group = expected.emplace(colB, std::vector<int32_t>{0, 0, colD, colD}).first;
+    group->second[0]++;
+    group->second[1] += colC;
+    group->second[2] = std::min(group->second[2], colD);
+    group->second[3] = std::max(group->second[3], colD);
+  }
+
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(agg_plan.get(), &result_set, GetTxn(), GetExecutorContext());
+  std::vector<TupleBatch> batches;
+  GetExecutionEngine()->ExecuteBatch(agg_plan.get(), &batches, GetTxn(), GetExecutorContext());
+  for (const auto &batch : batches) {
+    for (uint32_t i = 0; i < batch.GetRowCount(); i++) {
+      result_set.push_back(batch.GetTuple(i));
+    }
+  }
+  ASSERT_EQ(result_set.size(), 2 * expected.size());
+  for (const auto &tuple : result_set) {
+    auto colB = tuple.GetValue(agg_schema, agg_schema->GetColIdx("colB")).GetAs<int32_t>();
+    ASSERT_EQ(expected.count(colB), 1);
+    const auto &group = expected[colB];
+    ASSERT_EQ(tuple.GetValue(agg_schema, agg_schema->GetColIdx("countA")).GetAs<int32_t>(), group[0]);
+    ASSERT_EQ(tuple.GetValue(agg_schema, agg_schema->GetColIdx("sumC")).GetAs<int32_t>(), group[1]);
+    ASSERT_EQ(tuple.GetValue(agg_schema, agg_schema->GetColIdx("minD")).GetAs<int32_t>(), group[2]);
+    ASSERT_EQ(tuple.GetValue(agg_schema, agg_schema->GetColIdx("maxD")).GetAs<int32_t>(), group[3]);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, AggregationHashTableTest) {
+  // SELECT name, k, COUNT(v), SUM(v), MIN(v), MAX(v) GROUP BY name, k over enough groups to grow the directory,
+  // with NULL group-by values and NULL aggregate inputs.
+  Schema schema({Column("name", TypeId::VARCHAR, 16), Column("k", TypeId::INTEGER), Column("v", TypeId::BIGINT)});
+  auto *name = MakeColumnValueExpression(schema, 0, "name");
+  auto *k = MakeColumnValueExpression(schema, 0, "k");
+  auto *v = MakeColumnValueExpression(schema, 0, "v");
+  AggregationHashTable aht({name, k}, {v, v, v, v},
+                           {AggregationType::CountAggregate, AggregationType::SumAggregate,
+                            AggregationType::MinAggregate, AggregationType::MaxAggregate});
+
+  const int32_t num_rows = 40000;
+  const int32_t num_keys = 5000;
+  // The expected groups: (name, k) -> {count, sum, min, max, non-NULL count}.
+  std::map<std::pair<std::string, int32_t>, std::vector<int64_t>> expected;
+  TupleBatch batch(&schema);
+  for (int32_t i = 0; i < num_rows; i++) {
+    int32_t key = (i * 7919) % num_keys;
+    std::string name_str = key % 3 == 0 ? "" : "name" + std::to_string(key % 7);
+    std::vector<Value> values{key % 3 == 0 ? ValueFactory::GetNullValueByType(TypeId::VARCHAR)
+                                           : ValueFactory::GetVarcharValue(name_str),
+                              key % 11 == 0 ? ValueFactory::GetNullValueByType(TypeId::INTEGER)
+                                            : ValueFactory::GetIntegerValue(key),
+                              i % 5 == 0 ? ValueFactory::GetNullValueByType(TypeId::BIGINT)
+                                         : ValueFactory::GetBigIntValue(i - num_rows / 2)};
+    // Half of the rows go through the tuple path and half through the batch path.
+    if (i % 2 == 0) {
+      Tuple tuple(values, &schema);
+      aht.Insert(&tuple, &schema);
+    } else {
+      batch.AppendRow(values, RID());
+      if (batch.IsFull()) {
+        aht.InsertBatch(&batch);
+        batch.Clear();
+      }
+    }
+    auto group = expected.emplace(std::make_pair(name_str, key % 11 == 0 ? -1 : key),
+                                  std::vector<int64_t>{0, 0, INT64_MAX, INT64_MIN, 0})
+                     .first;
+    group->second[0]++;
+    if (i % 5 != 0) {
+      int64_t val = i - num_rows / 2;
+      group->second[1] += val;
+      group->second[2] = std::min(group->second[2], val);
+      group->second[3] = std::max(group->second[3], val);
+      group->second[4]++;
+    }
+  }
+  aht.InsertBatch(&batch);
+
+  ASSERT_EQ(aht.GetGroupCount(), expected.size());
+  std::vector<Value> group_bys;
+  std::vector<Value> aggregates;
+  for (size_t i = 0; i < aht.GetGroupCount(); i++) {
+    aht.GetGroup(i, &group_bys, &aggregates);
+    ASSERT_EQ(group_bys.size(), 2);
+    ASSERT_EQ(aggregates.size(), 4);
+    std::string name_str = group_bys[0].IsNull() ? "" : group_bys[0].ToString();
+    int32_t key = group_bys[1].IsNull() ? -1 : group_bys[1].GetAs<int32_t>();
+    auto it = expected.find(std::make_pair(name_str, key));
+    ASSERT_NE(it, expected.end());
+    const auto &group = it->second;
+    ASSERT_EQ(aggregates[0].GetAs<int32_t>(), group[0]);
+    if (group[4] == 0) {
+      ASSERT_TRUE(aggregates[1].IsNull());
+      ASSERT_TRUE(aggregates[2].IsNull());
+      ASSERT_TRUE(aggregates[3].IsNull());
+    } else {
+      ASSERT_EQ(aggregates[1].GetAs<int64_t>(), group[1]);
+      ASSERT_EQ(aggregates[2].GetAs<int64_t>(), group[2]);
+      ASSERT_EQ(aggregates[3].GetAs<int64_t>(), group[3]);
+    }
+    expected.erase(it);
+  }
+  ASSERT_TRUE(expected.empty());
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, DISABLED_AggregationHashTableBenchmark) {
+  // SELECT k, COUNT(v), SUM(v) GROUP BY k over a high-cardinality INTEGER key, comparing the typed table against a
+  // std::unordered_map from Value keys to Value accumulators.
+  Schema schema({Column("k", TypeId::INTEGER), Column("v", TypeId::INTEGER)});
+  auto *k = MakeColumnValueExpression(schema, 0, "k");
+  auto *v = MakeColumnValueExpression(schema, 0, "v");
+  const int32_t num_rows = 1 << 20;
+  for (int32_t num_keys : {1000, 100000, 500000}) {
+    std::vector<TupleBatch> batches;
+    for (int32_t i = 0; i < num_rows; i++) {
+      if (batches.empty() || batches.back().IsFull()) {
+        batches.emplace_back(&schema);
+      }
+      batches.back().AppendRow(
+          {ValueFactory::GetIntegerValue(static_cast<int32_t>((static_cast<int64_t>(i) * 7919) % num_keys)),
+           ValueFactory::GetIntegerValue(i)},
+          RID());
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::unordered_map<AggregateKey, AggregateValue> baseline;
+    for (const auto &batch : batches) {
+      for (uint32_t i = 0; i < batch.GetRowCount(); i++) {
+        AggregateKey key{{batch.GetValue(i, 0)}};
+        Value val = batch.GetValue(i, 1);
+        auto it = baseline.find(key);
+        if (it == baseline.end()) {
+          baseline.emplace(key, AggregateValue{{ValueFactory::GetIntegerValue(1), val}});
+        } else {
+          it->second.aggregates_[0] = it->second.aggregates_[0].Add(ValueFactory::GetIntegerValue(1));
+          it->second.aggregates_[1] = it->second.aggregates_[1].Add(val);
+        }
+      }
+    }
+    auto baseline_time = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    AggregationHashTable aht({k}, {v, v}, {AggregationType::CountAggregate, AggregationType::SumAggregate});
+    for (const auto &batch : batches) {
+      aht.InsertBatch(&batch);
+    }
+    auto typed_time = std::chrono::steady_clock::now() - start;
+    ASSERT_EQ(aht.GetGroupCount(), baseline.size());
+    std::cout << num_keys << " groups: unordered_map "
+              << std::chrono::duration_cast<std::chrono::nanoseconds>(baseline_time).count() / num_rows
+              << " ns/row, typed table "
+              << std::chrono::duration_cast<std::chrono::nanoseconds>(typed_time).count() / num_rows << " ns/row"
+              << std::endl;
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, ParallelAggregationTest) {
+  // SELECT key, COUNT(colA), SUM(colC), MIN(colD), MAX(colD) FROM test_1 WHERE colA > 100 GROUP BY key, for a low
+  // (colB) and a high (colC) cardinality key; parallel plans must produce the groups of the serial plan.
+  auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto &schema = table_info->schema_;
+  auto *predicate = MakeComparisonExpression(MakeColumnValueExpression(schema, 0, "colA"),
+                                             MakeConstantValueExpression(ValueFactory::GetIntegerValue(100)),
+                                             ComparisonType::GreaterThan);
+  const Schema *scan_schema = MakeOutputSchema({{"colA", MakeColumnValueExpression(schema, 0, "colA")},
+                                                {"colB", MakeColumnValueExpression(schema, 0, "colB")},
+                                                {"colC", MakeColumnValueExpression(schema, 0, "colC")},
+                                                {"colD", MakeColumnValueExpression(schema, 0, "colD")}});
+  SeqScanPlanNode scan_plan{scan_schema, predicate, table_info->oid_};
+  const AbstractExpression *colA = MakeColumnValueExpression(*scan_schema, 0, "colA");
+  const AbstractExpression *colC = MakeColumnValueExpression(*scan_schema, 0, "colC");
+  const AbstractExpression *colD = MakeColumnValueExpression(*scan_schema, 0, "colD");
+  const Schema *agg_schema = MakeOutputSchema({{"key", MakeAggregateValueExpression(true, 0)},
+                                               {"countA", MakeAggregateValueExpression(false, 0)},
+                                               {"sumC", MakeAggregateValueExpression(false, 1)},
+                                               {"minD", MakeAggregateValueExpression(false, 2)},
+                                               {"maxD", MakeAggregateValueExpression(false, 3)}});
+
+  for (const auto *key : {"colB", "colC"}) {
+    std::vector<std::string> expected;
+    for (uint32_t parallelism : {1, 2, 4, 16}) {
+      AggregationPlanNode agg_plan(agg_schema, &scan_plan, nullptr,
+                                   std::vector<const AbstractExpression *>{MakeColumnValueExpression(*scan_schema, 0, key)},
+                                   std::vector<const AbstractExpression *>{colA, colC, colD, colD},
+                                   std::vector<AggregationType>{AggregationType::CountAggregate,
+                                                                AggregationType::SumAggregate,
+                                                                AggregationType::MinAggregate,
+                                                                AggregationType::MaxAggregate},
+                                   parallelism);
+      std::vector<Tuple> result_set;
+      GetExecutionEngine()->Execute(&agg_plan, &result_set, GetTxn(), GetExecutorContext());
+      std::vector<std::string> groups;
+      for (const auto &tuple : result_set) {
+        groups.push_back(tuple.ToString(agg_schema));
+      }
+      std::sort(groups.begin(), groups.end());
+      if (parallelism == 1) {
+        expected = std::move(groups);
+        ASSERT_GT(expected.size(), 1);
+      } else {
+        ASSERT_EQ(groups, expected);
+      }
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, AggregationHashTableMergeTest) {
+  // Tables built over disjoint halves of the input and merged must equal one table built over all of it, including
+  // VARCHAR keys whose dictionary ids differ between the tables.
+  Schema schema({Column("name", TypeId::VARCHAR, 16), Column("v", TypeId::INTEGER)});
+  auto *name = MakeColumnValueExpression(schema, 0, "name");
+  auto *v = MakeColumnValueExpression(schema, 0, "v");
+  std::vector<const AbstractExpression *> group_bys{name};
+  std::vector<const AbstractExpression *> agg_exprs{v, v, v, v};
+  std::vector<AggregationType> agg_types{AggregationType::CountAggregate, AggregationType::SumAggregate,
+                                         AggregationType::MinAggregate, AggregationType::MaxAggregate};
+  AggregationHashTable whole(group_bys, agg_exprs, agg_types);
+  AggregationHashTable halves[2] = {{group_bys, agg_exprs, agg_types}, {group_bys, agg_exprs, agg_types}};
+  for (int32_t i = 0; i < 2000; i++) {
+    // The second half sees the names in reverse order, so its dictionary is numbered differently.
+    int32_t name_idx = i < 1000 ? i % 37 : 36 - i % 37;
+    Tuple tuple({name_idx == 0 ? ValueFactory::GetNullValueByType(TypeId::VARCHAR)
+                               : ValueFactory::GetVarcharValue("name" + std::to_string(name_idx)),
+                 i % 3 == 0 ? ValueFactory::GetNullValueByType(TypeId::INTEGER) : ValueFactory::GetIntegerValue(i)},
+                &schema);
+    whole.Insert(&tuple, &schema);
+    halves[i < 1000 ? 0 : 1].Insert(&tuple, &schema);
+  }
+  AggregationHashTable merged(group_bys, agg_exprs, agg_types);
+  for (const auto &half : halves) {
+    for (size_t i = 0; i < half.GetGroupCount(); i++) {
+      merged.MergeGroup(half, i);
+    }
+  }
+
+  auto describe = [](const AggregationHashTable &table, size_t group_idx) {
+    std::vector<Value> group_bys;
+    std::vector<Value> aggregates;
+    table.GetGroup(group_idx, &group_bys, &aggregates);
+    std::string result = group_bys[0].ToString();
+    for (const auto &aggregate : aggregates) {
+      result += "," + aggregate.ToString();
+    }
+    return result;
+  };
+  ASSERT_EQ(merged.GetGroupCount(), whole.GetGroupCount());
+  std::vector<std::string> expected;
+  std::vector<std::string> actual;
+  std::unordered_map<std::string, uint64_t> partition_hashes;
+  for (size_t i = 0; i < whole.GetGroupCount(); i++) {
+    expected.push_back(describe(whole, i));
+    partition_hashes[expected.back().substr(0, expected.back().find(','))] = whole.GetPartitionHash(i);
+  }
+  for (size_t i = 0; i < merged.GetGroupCount(); i++) {
+    actual.push_back(describe(merged, i));
+    ASSERT_EQ(merged.GetPartitionHash(i), partition_hashes[actual.back().substr(0, actual.back().find(','))]);
+  }
+  std::sort(expected.begin(), expected.end());
+  std::sort(actual.begin(), actual.end());
+  ASSERT_EQ(actual, expected);
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, SpillingAggregationTest) {
+  // SELECT key, COUNT(colA), SUM(colC), MIN(colD), MAX(colD) FROM test_1 GROUP BY key HAVING COUNT(colA) > 1 under
+  // memory budgets that spill some, most and (recursively) all of the groups.
+  auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto &schema = table_info->schema_;
+  const Schema *scan_schema = MakeOutputSchema({{"colA", MakeColumnValueExpression(schema, 0, "colA")},
+                                                {"colB", MakeColumnValueExpression(schema, 0, "colB")},
+                                                {"colC", MakeColumnValueExpression(schema, 0, "colC")},
+                                                {"colD", MakeColumnValueExpression(schema, 0, "colD")}});
+  SeqScanPlanNode scan_plan{scan_schema, nullptr, table_info->oid_};
+  const AbstractExpression *colA = MakeColumnValueExpression(*scan_schema, 0, "colA");
+  const AbstractExpression *colC = MakeColumnValueExpression(*scan_schema, 0, "colC");
+  const AbstractExpression *colD = MakeColumnValueExpression(*scan_schema, 0, "colD");
+  const AbstractExpression *countA = MakeAggregateValueExpression(false, 0);
+  const Schema *agg_schema = MakeOutputSchema({{"key", MakeAggregateValueExpression(true, 0)},
+                                               {"countA", countA},
+                                               {"sumC", MakeAggregateValueExpression(false, 1)},
+                                               {"minD", MakeAggregateValueExpression(false, 2)},
+                                               {"maxD", MakeAggregateValueExpression(false, 3)}});
+  const AbstractExpression *having = MakeComparisonExpression(
+      countA, MakeConstantValueExpression(ValueFactory::GetIntegerValue(1)), ComparisonType::GreaterThan);
+
+  for (const auto *key : {"colB", "colC"}) {
+    std::vector<std::string> expected;
+    for (size_t memory_budget : {0, 1 << 16, 4096, 1}) {
+      AggregationPlanNode agg_plan(agg_schema, &scan_plan, having,
+                                   std::vector<const AbstractExpression *>{MakeColumnValueExpression(*scan_schema, 0, key)},
+                                   std::vector<const AbstractExpression *>{colA, colC, colD, colD},
+                                   std::vector<AggregationType>{AggregationType::CountAggregate,
+                                                                AggregationType::SumAggregate,
+                                                                AggregationType::MinAggregate,
+                                                                AggregationType::MaxAggregate},
+                                   1, memory_budget);
+      // Repeat the query to check that the spilled pages are unpinned and released.
+      for (int i = 0; i < 3; i++) {
+        std::vector<Tuple> result_set;
+        GetExecutionEngine()->Execute(&agg_plan, &result_set, GetTxn(), GetExecutorContext());
+        std::vector<std::string> groups;
+        for (const auto &tuple : result_set) {
+          groups.push_back(tuple.ToString(agg_schema));
+        }
+        std::sort(groups.begin(), groups.end());
+        if (memory_budget == 0 && i == 0) {
+          expected = std::move(groups);
+          ASSERT_FALSE(expected.empty());
+        } else {
+          ASSERT_EQ(groups, expected);
+        }
+      }
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, AggregationSumOverflowTest) {
+  // SELECT SUM(v) over INTEGER and BIGINT inputs whose sums leave the range of the type.
+  for (auto type : {TypeId::INTEGER, TypeId::BIGINT}) {
+    Schema schema({Column("v", type)});
+    auto *v = MakeColumnValueExpression(schema, 0, "v");
+    AggregationHashTable aht({}, {v}, {AggregationType::SumAggregate});
+    Value max = type == TypeId::INTEGER ? ValueFactory::GetIntegerValue(BUSTUB_INT32_MAX)
+                                        : ValueFactory::GetBigIntValue(BUSTUB_INT64_MAX);
+    Value one = type == TypeId::INTEGER ? ValueFactory::GetIntegerValue(1) : ValueFactory::GetBigIntValue(1);
+    Tuple max_tuple({max}, &schema);
+    Tuple one_tuple({one}, &schema);
+    aht.Insert(&max_tuple, &schema);
+
+    std::vector<Value> group_bys;
+    std::vector<Value> aggregates;
+    aht.GetGroup(0, &group_bys, &aggregates);
+    ASSERT_EQ(aggregates[0].CompareEquals(max), CmpBool::CmpTrue);
+
+    // The sum no longer fits once it passes the maximum, whether the int64 slot wraps or not.
+    EXPECT_THROW(
+        {
+          aht.Insert(&one_tuple, &schema);
+          aht.GetGroup(0, &group_bys, &aggregates);
+        },
+        Exception);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, FrozenAggregationHashTableTest) {
+  // A table freezes as soon as it exceeds its budget. A frozen table aggregates the rows of its groups and reports the
+  // rows of other groups, without adding strings to its dictionary.
+  Schema schema({Column("name", TypeId::VARCHAR, 16), Column("v", TypeId::INTEGER)});
+  auto *name = MakeColumnValueExpression(schema, 0, "name");
+  auto *v = MakeColumnValueExpression(schema, 0, "v");
+  AggregationHashTable aht({name}, {v}, {AggregationType::SumAggregate}, 1);
+  ASSERT_FALSE(aht.IsFrozen());
+  TupleBatch batch(&schema);
+  batch.AppendRow({ValueFactory::GetVarcharValue("a"), ValueFactory::GetIntegerValue(1)}, RID());
+  batch.AppendRow({ValueFactory::GetVarcharValue("c"), ValueFactory::GetIntegerValue(1)}, RID());
+  std::vector<uint32_t> misses;
+  aht.InsertBatch(&batch, &misses);
+  ASSERT_TRUE(aht.IsFrozen());
+  ASSERT_EQ(misses, std::vector<uint32_t>{1});
+  size_t memory_usage = aht.GetMemoryUsage();
+
+  batch.Clear();
+  batch.AppendRow({ValueFactory::GetVarcharValue("b"), ValueFactory::GetIntegerValue(2)}, RID());
+  batch.AppendRow({ValueFactory::GetVarcharValue("a"), ValueFactory::GetIntegerValue(3)}, RID());
+  batch.AppendRow({ValueFactory::GetNullValueByType(TypeId::VARCHAR), ValueFactory::GetIntegerValue(4)}, RID());
+  misses.clear();
+  aht.InsertBatch(&batch, &misses);
+  ASSERT_EQ(misses, (std::vector<uint32_t>{0, 2}));
+  ASSERT_EQ(aht.GetGroupCount(), 1);
+  ASSERT_EQ(aht.GetMemoryUsage(), memory_usage);
+  std::vector<Value> group_bys;
+  std::vector<Value> aggregates;
+  aht.GetGroup(0, &group_bys, &aggregates);
+  ASSERT_EQ(group_bys[0].ToString(), "a");
+  ASSERT_EQ(aggregates[0].GetAs<int32_t>(), 4);
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, DISABLED_ParallelAggregationBenchmark) {
+  // SELECT k, COUNT(v), SUM(v), MIN(v), MAX(v) FROM bench GROUP BY k with a growing number of threads. The table
+  // fits in the buffer pool of the test, so the scan does not serialize on disk reads.
+  Schema schema({Column("k", TypeId::INTEGER), Column("v", TypeId::INTEGER)});
+  TableMetadata *table_info = GetCatalog()->CreateTable(GetTxn(), "bench", schema);
+  const int32_t num_rows = 20000;
+  for (int32_t i = 0; i < num_rows; i++) {
+    Tuple tuple({ValueFactory::GetIntegerValue(i % 5000), ValueFactory::GetIntegerValue(i)}, &schema);
+    RID rid;
+    ASSERT_TRUE(table_info->table_->InsertTuple(tuple, &rid, GetTxn()));
+  }
+  const Schema *scan_schema = MakeOutputSchema(
+      {{"k", MakeColumnValueExpression(schema, 0, "k")}, {"v", MakeColumnValueExpression(schema, 0, "v")}});
+  SeqScanPlanNode scan_plan{scan_schema, nullptr, table_info->oid_};
+  const AbstractExpression *k = MakeColumnValueExpression(*scan_schema, 0, "k");
+  const AbstractExpression *v = MakeColumnValueExpression(*scan_schema, 0, "v");
+  const Schema *agg_schema = MakeOutputSchema({{"k", MakeAggregateValueExpression(true, 0)},
+                                               {"countV", MakeAggregateValueExpression(false, 0)},
+                                               {"sumV", MakeAggregateValueExpression(false, 1)},
+                                               {"minV", MakeAggregateValueExpression(false, 2)},
+                                               {"maxV", MakeAggregateValueExpression(false, 3)}});
+  const int iterations = 20;
+  for (uint32_t parallelism : {1, 2, 4, 8, 16}) {
+    AggregationPlanNode agg_plan(agg_schema, &scan_plan, nullptr, std::vector<const AbstractExpression *>{k},
+                                 std::vector<const AbstractExpression *>{v, v, v, v},
+                                 std::vector<AggregationType>{AggregationType::CountAggregate,
+                                                              AggregationType::SumAggregate,
+                                                              AggregationType::MinAggregate,
+                                                              AggregationType::MaxAggregate},
+                                 parallelism);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+      std::vector<Tuple> result_set;
+      GetExecutionEngine()->Execute(&agg_plan, &result_set, GetTxn(), GetExecutorContext());
+      ASSERT_EQ(result_set.size(), 5000);
+    }
+    auto time = std::chrono::steady_clock::now() - start;
+    std::cout << parallelism << " threads: "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(time).count() / iterations << " ms/query"
+              << std::endl;
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, ParallelSeqScanTest) {
+  // SELECT colA, colB FROM test_1 WHERE colB < 5 with workers sharing a morsel dispenser; together they must return
+  // the tuples of a serial scan exactly once.
+  TableMetadata *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  Schema &schema = table_info->schema_;
+  auto *colA = MakeColumnValueExpression(schema, 0, "colA");
+  auto *colB = MakeColumnValueExpression(schema, 0, "colB");
+  auto *predicate = MakeComparisonExpression(colB, MakeConstantValueExpression(ValueFactory::GetIntegerValue(5)),
+                                             ComparisonType::LessThan);
+  auto *out_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+  SeqScanPlanNode plan{out_schema, predicate, table_info->oid_};
+
+  std::vector<Tuple> serial;
+  GetExecutionEngine()->Execute(&plan, &serial, GetTxn(), GetExecutorContext());
+  std::vector<std::string> expected;
+  for (const auto &tuple : serial) {
+    expected.push_back(tuple.ToString(out_schema));
+  }
+  std::sort(expected.begin(), expected.end());
+  ASSERT_FALSE(expected.empty());
+
+  for (size_t num_workers : {1, 3, 8}) {
+    MorselDispenser dispenser(table_info->table_.get(), num_workers);
+    std::vector<std::unique_ptr<SeqScanExecutor>> workers;
+    for (size_t i = 0; i < num_workers; i++) {
+      workers.emplace_back(std::make_unique<SeqScanExecutor>(GetExecutorContext(), &plan, &dispenser));
+    }
+    std::vector<std::vector<std::string>> outputs(num_workers);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < num_workers; i++) {
+      threads.emplace_back([&, i] {
+        workers[i]->Init();
+        // Odd workers are pulled a tuple at a time, even workers a batch at a time.
+        if (i % 2 == 1) {
+          Tuple tuple;
+          RID rid;
+          while (workers[i]->Next(&tuple, &rid)) {
+            outputs[i].push_back(tuple.ToString(out_schema));
+          }
+        } else {
+          TupleBatch batch(out_schema);
+          while (workers[i]->NextBatch(&batch)) {
+            for (uint32_t row_idx = 0; row_idx < batch.GetRowCount(); row_idx++) {
+              outputs[i].push_back(batch.GetTuple(row_idx).ToString(out_schema));
+            }
+          }
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    std::vector<std::string> actual;
+    for (const auto &output : outputs) {
+      actual.insert(actual.end(), output.begin(), output.end());
+    }
+    std::sort(actual.begin(), actual.end());
+    ASSERT_EQ(actual, expected);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, ParallelSeqScanAbortTest) {
+  // A worker whose transaction cannot lock the rows of its morsel fails the whole scan instead of running out of rows.
+  TableMetadata *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  Schema &schema = table_info->schema_;
+  auto *out_schema = MakeOutputSchema({{"colA", MakeColumnValueExpression(schema, 0, "colA")}});
+  SeqScanPlanNode plan{out_schema, nullptr, table_info->oid_};
+
+  enable_logging = true;
+  Transaction *txn = GetTxnManager()->Begin();
+  ExecutorContext exec_ctx(txn, GetCatalog(), GetBPM(), GetTxnManager(), GetLockManager());
+  txn->Wound();
+  constexpr size_t num_workers = 3;
+  MorselDispenser dispenser(table_info->table_.get(), num_workers);
+  std::vector<std::unique_ptr<SeqScanExecutor>> workers;
+  for (size_t i = 0; i < num_workers; i++) {
+    workers.emplace_back(std::make_unique<SeqScanExecutor>(&exec_ctx, &plan, &dispenser));
+  }
+  ThreadPool pool;
+  EXPECT_THROW(pool.Run(num_workers,
+                        [&](size_t w) {
+                          workers[w]->Init();
+                          TupleBatch batch(out_schema);
+                          while (workers[w]->NextBatch(&batch)) {
+                          }
+                        }),
+               TransactionAbortException);
+  EXPECT_EQ(TransactionState::ABORTED, txn->GetState());
+  GetTxnManager()->Abort(txn);
+  enable_logging = false;
+  delete txn;
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, DISABLED_ParallelSeqScanBenchmark) {
+  // SELECT k, v FROM bench WHERE v < 10000 with a growing number of scan workers.
+  Schema schema({Column("k", TypeId::INTEGER), Column("v", TypeId::INTEGER)});
+  TableMetadata *table_info = GetCatalog()->CreateTable(GetTxn(), "bench", schema);
+  const int32_t num_rows = 20000;
+  for (int32_t i = 0; i < num_rows; i++) {
+    Tuple tuple({ValueFactory::GetIntegerValue(i % 5000), ValueFactory::GetIntegerValue(i)}, &schema);
+    RID rid;
+    ASSERT_TRUE(table_info->table_->InsertTuple(tuple, &rid, GetTxn()));
+  }
+  auto *k = MakeColumnValueExpression(schema, 0, "k");
+  auto *v = MakeColumnValueExpression(schema, 0, "v");
+  auto *predicate = MakeComparisonExpression(v, MakeConstantValueExpression(ValueFactory::GetIntegerValue(10000)),
+                                             ComparisonType::LessThan);
+  SeqScanPlanNode plan{MakeOutputSchema({{"k", k}, {"v", v}}), predicate, table_info->oid_};
+  const int iterations = 50;
+  for (size_t num_workers : {1, 2, 4, 8, 16}) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+      MorselDispenser dispenser(table_info->table_.get(), num_workers);
+      std::vector<std::unique_ptr<SeqScanExecutor>> workers;
+      for (size_t w = 0; w < num_workers; w++) {
+        workers.emplace_back(std::make_unique<SeqScanExecutor>(GetExecutorContext(), &plan, &dispenser));
+      }
+      std::atomic<size_t> rows{0};
+      std::vector<std::thread> threads;
+      for (size_t w = 0; w < num_workers; w++) {
+        threads.emplace_back([&, w] {
+          TupleBatch batch(plan.OutputSchema());
+          workers[w]->Init();
+          while (workers[w]->NextBatch(&batch)) {
+            rows += batch.GetRowCount();
+          }
+        });
+      }
+      for (auto &thread : threads) {
+        thread.join();
+      }
+      ASSERT_EQ(rows, num_rows / 2);
+    }
+    auto time = std::chrono::steady_clock::now() - start;
+    std::cout << num_workers << " workers: "
+              << std::chrono::duration_cast<std::chrono::nanoseconds>(time).count() / iterations / num_rows
+              << " ns/row" << std::endl;
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, GatherExchangeTest) {
+  // SELECT colA, colB FROM test_1 WHERE colB < 5 through a gather exchange over copies of the scan; the gathered rows
+  // must be the rows of a serial scan, whether they are pulled a tuple or a batch at a time.
+  TableMetadata *table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  Schema &schema = table_info->schema_;
+  auto *colA = MakeColumnValueExpression(schema, 0, "colA");
+  auto *colB = MakeColumnValueExpression(schema, 0, "colB");
+  auto *predicate = MakeComparisonExpression(colB, MakeConstantValueExpression(ValueFactory::GetIntegerValue(5)),
+                                             ComparisonType::LessThan);
+  auto *out_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+  SeqScanPlanNode scan_plan{out_schema, predicate, table_info->oid_};
+
+  std::vector<Tuple> serial;
+  GetExecutionEngine()->Execute(&scan_plan, &serial, GetTxn(), GetExecutorContext());
+  std::vector<std::string> expected;
+  for (const auto &tuple : serial) {
+    expected.push_back(tuple.ToString(out_schema));
+  }
+  std::sort(expected.begin(), expected.end());
+  ASSERT_FALSE(expected.empty());
+
+  for (uint32_t parallelism : {1, 3, 8}) {
+    ExchangePlanNode gather_plan{out_schema, &scan_plan, ExchangeType::Gather, parallelism};
+    std::vector<Tuple> result_set;
+    GetExecutionEngine()->Execute(&gather_plan, &result_set, GetTxn(), GetExecutorContext());
+    std::vector<std::string> actual;
+    for (const auto &tuple : result_set) {
+      actual.push_back(tuple.ToString(out_schema));
+    }
+    std::sort(actual.begin(), actual.end());
+    ASSERT_EQ(actual, expected);
+
+    std::vector<TupleBatch> batches;
+    GetExecutionEngine()->ExecuteBatch(&gather_plan, &batches, GetTxn(), GetExecutorContext());
+    actual.clear();
+    for (const auto &batch : batches) {
+      for (uint32_t row_idx = 0; row_idx < batch.GetRowCount(); row_idx++) {
+        actual.push_back(batch.GetTuple(row_idx).ToString(out_schema));
+      }
+    }
+    std::sort(actual.begin(), actual.end());
+    ASSERT_EQ(actual, expected);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, GatherExchangeJoinTest) {
+  // SELECT test_1.colA, test_1.colB, test_2.col1, test_2.col3 FROM test_1 JOIN test_2 ON test_1.colA = test_2.col1,
+  // once with the join below a gather exchange, whose copies split test_1 but each read all of test_2, and once with
+  // a gather exchange as the inner side, which is rewound for every outer tuple.
+  auto table1 = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto *out_schema1 = MakeOutputSchema({{"colA", MakeColumnValueExpression(table1->schema_, 0, "colA")},
+                                        {"colB", MakeColumnValueExpression(table1->schema_, 0, "colB")}});
+  auto *outer_predicate = MakeComparisonExpression(MakeColumnValueExpression(table1->schema_, 0, "colA"),
+                                                   MakeConstantValueExpression(ValueFactory::GetIntegerValue(60)),
+                                                   ComparisonType::LessThan);
+  SeqScanPlanNode scan_plan1{out_schema1, outer_predicate, table1->oid_};
+  auto table2 = GetExecutorContext()->GetCatalog()->GetTable("test_2");
+  auto *out_schema2 = MakeOutputSchema({{"col1", MakeColumnValueExpression(table2->schema_, 0, "col1")},
+                                        {"col3", MakeColumnValueExpression(table2->schema_, 0, "col3")}});
+  SeqScanPlanNode scan_plan2{out_schema2, nullptr, table2->oid_};
+  auto *colA = MakeColumnValueExpression(*out_schema1, 0, "colA");
+  auto *colB = MakeColumnValueExpression(*out_schema1, 0, "colB");
+  auto *col1 = MakeColumnValueExpression(*out_schema2, 1, "col1");
+  auto *col3 = MakeColumnValueExpression(*out_schema2, 1, "col3");
+  auto *predicate = MakeComparisonExpression(colA, col1, ComparisonType::Equal);
+  auto *out_final = MakeOutputSchema({{"colA", colA}, {"colB", colB}, {"col1", col1}, {"col3", col3}});
+
+  auto execute = [&](const AbstractPlanNode *plan) {
+    std::vector<Tuple> result_set;
+    GetExecutionEngine()->Execute(plan, &result_set, GetTxn(), GetExecutorContext());
+    std::vector<std::string> rows;
+    for (const auto &tuple : result_set) {
+      rows.push_back(tuple.ToString(out_final));
+    }
+    std::sort(rows.begin(), rows.end());
+    return rows;
+  };
+
+  NestedLoopJoinPlanNode join_plan{out_final, {&scan_plan1, &scan_plan2}, predicate};
+  std::vector<std::string> expected = execute(&join_plan);
+  ASSERT_EQ(expected.size(), 60);
+
+  ExchangePlanNode gather_join_plan{out_final, &join_plan, ExchangeType::Gather, 4};
+  ASSERT_EQ(execute(&gather_join_plan), expected);
+
+  ExchangePlanNode gather_inner_plan{out_schema2, &scan_plan2, ExchangeType::Gather, 2};
+  NestedLoopJoinPlanNode inner_gather_join_plan{out_final, {&scan_plan1, &gather_inner_plan}, predicate};
+  ASSERT_EQ(execute(&inner_gather_join_plan), expected);
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, RepartitionExchangeTest) {
+  // SELECT colB, COUNT(colA), SUM(colC) FROM test_1 GROUP BY colB as
+  //   Gather <- Aggregation <- Repartition(colB) <- SeqScan
+  // where every copy of the aggregation sees every row of its groups, so the gathered groups are the serial groups.
+  // A repartition exchange without a gather exchange above it has a single consumer.
+  auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto &schema = table_info->schema_;
+  const Schema *scan_schema = MakeOutputSchema({{"colA", MakeColumnValueExpression(schema, 0, "colA")},
+                                                {"colB", MakeColumnValueExpression(schema, 0, "colB")},
+                                                {"colC", MakeColumnValueExpression(schema, 0, "colC")}});
+  SeqScanPlanNode scan_plan{scan_schema, nullptr, table_info->oid_};
+  const AbstractExpression *colA = MakeColumnValueExpression(*scan_schema, 0, "colA");
+  const AbstractExpression *colB = MakeColumnValueExpression(*scan_schema, 0, "colB");
+  const AbstractExpression *colC = MakeColumnValueExpression(*scan_schema, 0, "colC");
+  const Schema *agg_schema = MakeOutputSchema({{"colB", MakeAggregateValueExpression(true, 0)},
+                                               {"countA", MakeAggregateValueExpression(false, 0)},
+                                               {"sumC", MakeAggregateValueExpression(false, 1)}});
+  auto make_agg_plan = [&](const AbstractPlanNode *child) {
+    return std::make_unique<AggregationPlanNode>(
+        agg_schema, child, nullptr, std::vector<const AbstractExpression *>{colB},
+        std::vector<const AbstractExpression *>{colA, colC},
+        std::vector<AggregationType>{AggregationType::CountAggregate, AggregationType::SumAggregate});
+  };
+  auto execute = [&](const AbstractPlanNode *plan) {
+    std::vector<Tuple> result_set;
+    GetExecutionEngine()->Execute(plan, &result_set, GetTxn(), GetExecutorContext());
+    std::vector<std::string> groups;
+    for (const auto &tuple : result_set) {
+      groups.push_back(tuple.ToString(agg_schema));
+    }
+    std::sort(groups.begin(), groups.end());
+    return groups;
+  };
+
+  auto serial_plan = make_agg_plan(&scan_plan);
+  std::vector<std::string> expected = execute(serial_plan.get());
+  ASSERT_GT(expected.size(), 1);
+
+  for (uint32_t consumers : {1, 2, 5}) {
+    for (uint32_t producers : {1, 3}) {
+      ExchangePlanNode repartition_plan{scan_schema, &scan_plan, ExchangeType::Repartition, producers, {colB}};
+      auto agg_plan = make_agg_plan(&repartition_plan);
+      ExchangePlanNode gather_plan{agg_schema, agg_plan.get(), ExchangeType::Gather, consumers};
+      ASSERT_EQ(execute(&gather_plan), expected);
+      ASSERT_EQ(execute(agg_plan.get()), expected);
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, SortKeyEncoderTest) {
+  // Normalized keys must compare like the values they encode, with NULL first in ascending and last in descending
+  // order, and keys with different prefixes must compare like their prefixes.
+  std::vector<std::vector<Value>> columns{
+      {ValueFactory::GetVarcharValue(""), ValueFactory::GetVarcharValue("a"), ValueFactory::GetVarcharValue("ab"),
+       ValueFactory::GetVarcharValue("abcdefghij"), ValueFactory::GetVarcharValue("abcdefghik"),
+       ValueFactory::GetVarcharValue("B"), ValueFactory::GetVarcharValue("b"),
+       ValueFactory::GetNullValueByType(TypeId::VARCHAR)},
+      {ValueFactory::GetIntegerValue(BUSTUB_INT32_MIN + 1), ValueFactory::GetIntegerValue(-256),
+       ValueFactory::GetIntegerValue(-1), ValueFactory::GetIntegerValue(0), ValueFactory::GetIntegerValue(255),
+       ValueFactory::GetIntegerValue(BUSTUB_INT32_MAX), ValueFactory::GetNullValueByType(TypeId::INTEGER)},
+      {ValueFactory::GetDecimalValue(-1e300), ValueFactory::GetDecimalValue(-2.5), ValueFactory::GetDecimalValue(-0.0),
+       ValueFactory::GetDecimalValue(0.0), ValueFactory::GetDecimalValue(1e-300), ValueFactory::GetDecimalValue(3),
+       ValueFactory::GetNullValueByType(TypeId::DECIMAL)},
+      {ValueFactory::GetTinyIntValue(-3), ValueFactory::GetTinyIntValue(0), ValueFactory::GetTinyIntValue(100),
+       ValueFactory::GetNullValueByType(TypeId::TINYINT)},
+      {ValueFactory::GetBooleanValue(false), ValueFactory::GetBooleanValue(true),
+       ValueFactory::GetNullValueByType(TypeId::BOOLEAN)}};
+  for (const auto &values : columns) {
+    Schema schema({values[0].GetTypeId() == TypeId::VARCHAR ? Column("c", TypeId::VARCHAR, 16)
+                                                             : Column("c", values[0].GetTypeId())});
+    auto *c = MakeColumnValueExpression(schema, 0, "c");
+    for (auto order_by_type : {OrderByType::Ascending, OrderByType::Descending}) {
+      SortKeyEncoder encoder({{order_by_type, c}});
+      std::vector<std::string> keys;
+      for (const auto &value : values) {
+        Tuple tuple({value}, &schema);
+        keys.emplace_back();
+        encoder.EncodeTuple(&tuple, &schema, &keys.back());
+      }
+      for (size_t i = 0; i < values.size(); i++) {
+        for (size_t j = 0; j < values.size(); j++) {
+          int expected;
+          if (values[i].IsNull() || values[j].IsNull()) {
+            expected = static_cast<int>(values[j].IsNull()) - static_cast<int>(values[i].IsNull());
+          } else if (values[i].CompareLessThan(values[j]) == CmpBool::CmpTrue) {
+            expected = -1;
+          } else {
+            expected = values[i].CompareEquals(values[j]) == CmpBool::CmpTrue ? 0 : 1;
+          }
+          if (order_by_type == OrderByType::Descending) {
+            expected = -expected;
+          }
+          int actual = SortKeyEncoder::Compare(keys[i].data(), keys[i].size(), keys[j].data(), keys[j].size());
+          ASSERT_EQ(expected, (actual > 0) - (actual < 0)) << values[i].ToString() << " vs " << values[j].ToString();
+          uint64_t prefix_i = SortKeyEncoder::Prefix(keys[i].data(), keys[i].size());
+          uint64_t prefix_j = SortKeyEncoder::Prefix(keys[j].data(), keys[j].size());
+          if (prefix_i != prefix_j) {
+            ASSERT_EQ(expected, prefix_i < prefix_j ? -1 : 1);
+          }
+        }
+      }
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, SortTest) {
+  // SELECT colA, colB, colC FROM test_1 ORDER BY colB, in memory and with budgets that spill a run per ~150 rows
+  // and a run per row, which takes several merge passes. The sort is stable, so rows with equal colB stay in scan
+  // order.
+  auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto &schema = table_info->schema_;
+  const Schema *scan_schema = MakeOutputSchema({{"colA", MakeColumnValueExpression(schema, 0, "colA")},
+                                                {"colB", MakeColumnValueExpression(schema, 0, "colB")},
+                                                {"colC", MakeColumnValueExpression(schema, 0, "colC")}});
+  SeqScanPlanNode scan_plan{scan_schema, nullptr, table_info->oid_};
+  std::vector<Tuple> scanned;
+  std::vector<RID> rids;
+  auto scan = ExecutorFactory::CreateExecutor(GetExecutorContext(), &scan_plan);
+  scan->Init();
+  Tuple tuple;
+  RID rid;
+  while (scan->Next(&tuple, &rid)) {
+    scanned.push_back(tuple);
+    rids.push_back(rid);
+  }
+  ASSERT_EQ(scanned.size(), TEST1_SIZE);
+  std::vector<Tuple> expected_tuples = scanned;
+  std::stable_sort(expected_tuples.begin(), expected_tuples.end(), [&](const Tuple &a, const Tuple &b) {
+    return a.GetValue(scan_schema, 1).GetAs<int32_t>() < b.GetValue(scan_schema, 1).GetAs<int32_t>();
+  });
+  std::vector<std::string> expected;
+  for (const auto &tuple : expected_tuples) {
+    expected.push_back(tuple.ToString(scan_schema));
+  }
+
+  for (size_t memory_budget : {0, 8192, 1}) {
+    SortPlanNode sort_plan{
+        scan_schema, &scan_plan, {{OrderByType::Ascending, MakeColumnValueExpression(*scan_schema, 0, "colB")}},
+        memory_budget};
+    SortExecutor executor(GetExecutorContext(), &sort_plan,
+                          ExecutorFactory::CreateExecutor(GetExecutorContext(), &scan_plan));
+    // Rewinding sorts again.
+    for (int round = 0; round < 2; round++) {
+      executor.Init();
+      std::vector<std::string> actual;
+      while (executor.Next(&tuple, &rid)) {
+        ASSERT_EQ(rid, rids[tuple.GetValue(scan_schema, 0).GetAs<int32_t>()]);
+        actual.push_back(tuple.ToString(scan_schema));
+      }
+      ASSERT_EQ(actual, expected);
+    }
+    if (memory_budget == 0) {
+      ASSERT_EQ(executor.GetRunCount(), 0);
+    } else if (memory_budget == 1) {
+      ASSERT_GT(executor.GetRunCount(), TEST1_SIZE + 1000 / SortExecutor::MAX_MERGE_FAN_IN);
+    } else {
+      ASSERT_GT(executor.GetRunCount(), 1);
+      ASSERT_LE(executor.GetRunCount(), SortExecutor::MAX_MERGE_FAN_IN);
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, SortPlanTest) {
+  // SELECT col1, col2, col3 FROM test_2 ORDER BY col2 DESC, col3, col1 through the execution engine, where col2 is
+  // nullable; NULLs come last in descending order.
+  auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_2");
+  auto &schema = table_info->schema_;
+  const Schema *scan_schema = MakeOutputSchema({{"col1", MakeColumnValueExpression(schema, 0, "col1")},
+                                                {"col2", MakeColumnValueExpression(schema, 0, "col2")},
+                                                {"col3", MakeColumnValueExpression(schema, 0, "col3")}});
+  SeqScanPlanNode scan_plan{scan_schema, nullptr, table_info->oid_};
+  auto *col1 = MakeColumnValueExpression(*scan_schema, 0, "col1");
+  auto *col2 = MakeColumnValueExpression(*scan_schema, 0, "col2");
+  auto *col3 = MakeColumnValueExpression(*scan_schema, 0, "col3");
+
+  std::vector<Tuple> scanned;
+  GetExecutionEngine()->Execute(&scan_plan, &scanned, GetTxn(), GetExecutorContext());
+  auto key = [&](const Tuple &tuple) {
+    Value col2_value = tuple.GetValue(scan_schema, 1);
+    int64_t col2_key = col2_value.IsNull() ? BUSTUB_INT64_MIN : col2_value.GetAs<int32_t>();
+    return std::make_tuple(-col2_key, tuple.GetValue(scan_schema, 2).GetAs<int64_t>(),
+                           tuple.GetValue(scan_schema, 0).GetAs<int16_t>());
+  };
+  std::sort(scanned.begin(), scanned.end(), [&](const Tuple &a, const Tuple &b) { return key(a) < key(b); });
+  std::vector<std::string> expected;
+  for (const auto &tuple : scanned) {
+    expected.push_back(tuple.ToString(scan_schema));
+  }
+
+  for (size_t memory_budget : {0, 512}) {
+    std::vector<OrderBy> order_bys{
+        {OrderByType::Descending, col2}, {OrderByType::Ascending, col3}, {OrderByType::Ascending, col1}};
+    SortPlanNode sort_plan{scan_schema, &scan_plan, std::move(order_bys), memory_budget};
+    std::vector<Tuple> result_set;
+    GetExecutionEngine()->Execute(&sort_plan, &result_set, GetTxn(), GetExecutorContext());
+    std::vector<std::string> actual;
+    for (const auto &tuple : result_set) {
+      actual.push_back(tuple.ToString(scan_schema));
+    }
+    ASSERT_EQ(actual, expected);
+  }
+}
+
+/** Produces num_rows rows of (random BIGINT, row number), mostly for benchmarks. */
+class RandomRowsExecutor : public AbstractExecutor {
+ public:
+  RandomRowsExecutor(ExecutorContext *exec_ctx, const Schema *schema, size_t num_rows)
+      : AbstractExecutor(exec_ctx), schema_(schema), num_rows_(num_rows) {}
+
+  void Init() override {
+    produced_ = 0;
+    generator_.seed(15445);
+  }
+
+  bool Next(Tuple *tuple, RID *rid) override {
+    if (produced_ == num_rows_) {
+      return false;
+    }
+    std::vector<Value> values{ValueFactory::GetBigIntValue(static_cast<int64_t>(generator_() >> 1)),
+                              ValueFactory::GetIntegerValue(static_cast<int32_t>(produced_++))};
+    *tuple = Tuple(values, schema_);
+    *rid = RID();
+    return true;
+  }
+
+  bool NextBatch(TupleBatch *batch) override {
+    batch->Clear();
+    std::vector<Value> values(2, ValueFactory::GetIntegerValue(0));
+    while (!batch->IsFull() && produced_ < num_rows_) {
+      values[0] = ValueFactory::GetBigIntValue(static_cast<int64_t>(generator_() >> 1));
+      values[1] = ValueFactory::GetIntegerValue(static_cast<int32_t>(produced_++));
+      batch->AppendRow(values, RID());
+    }
+    return !batch->IsEmpty();
+  }
+
+  const Schema *GetOutputSchema() override { return schema_; }
+
+  /** @return the number of rows produced since the last Init() */
+  size_t GetProducedCount() const { return produced_; }
+
+ private:
+  const Schema *schema_;
+  size_t num_rows_;
+  size_t produced_{0};
+  std::mt19937_64 generator_;
+};
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, DISABLED_SortBenchmark) {
+  // SELECT k, v FROM <random rows> ORDER BY k, in memory and spilling 16 MB runs.
+  Schema schema({Column("k", TypeId::BIGINT), Column("v", TypeId::INTEGER)});
+  auto *k = MakeColumnValueExpression(schema, 0, "k");
+  const size_t num_rows = 1000000;
+  for (size_t memory_budget : {0, 16 << 20}) {
+    SortPlanNode sort_plan{&schema, nullptr, {{OrderByType::Ascending, k}}, memory_budget};
+    SortExecutor executor(GetExecutorContext(), &sort_plan,
+                          std::make_unique<RandomRowsExecutor>(GetExecutorContext(), &schema, num_rows));
+    auto start = std::chrono::steady_clock::now();
+    executor.Init();
+    Tuple tuple;
+    RID rid;
+    size_t rows = 0;
+    int64_t last = BUSTUB_INT64_MIN;
+    while (executor.Next(&tuple, &rid)) {
+      int64_t key = tuple.GetValue(&schema, 0).GetAs<int64_t>();
+      ASSERT_LE(last, key);
+      last = key;
+      rows++;
+    }
+    ASSERT_EQ(rows, num_rows);
+    auto time = std::chrono::steady_clock::now() - start;
+    std::cout << "budget " << memory_budget << ": " << executor.GetRunCount() << " runs, "
+              << std::chrono::duration_cast<std::chrono::nanoseconds>(time).count() / num_rows << " ns/row"
+              << std::endl;
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, TopNTest) {
+  // SELECT colA, colB FROM test_1 ORDER BY colB LIMIT n OFFSET m, which the factory runs as a top-N. colB has few
+  // distinct values, so most of the cut falls between rows with equal keys, which keep their scan order.
+  auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  auto &schema = table_info->schema_;
+  const Schema *scan_schema = MakeOutputSchema({{"colA", MakeColumnValueExpression(schema, 0, "colA")},
+                                                {"colB", MakeColumnValueExpression(schema, 0, "colB")}});
+  SeqScanPlanNode scan_plan{scan_schema, nullptr, table_info->oid_};
+  SortPlanNode sort_plan{
+      scan_schema, &scan_plan, {{OrderByType::Ascending, MakeColumnValueExpression(*scan_schema, 0, "colB")}}};
+  std::vector<Tuple> sorted;
+  GetExecutionEngine()->Execute(&sort_plan, &sorted, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(sorted.size(), TEST1_SIZE);
+
+  for (auto [limit, offset] : std::vector<std::pair<size_t, size_t>>{
+           {10, 0}, {10, 25}, {1, 999}, {100, 990}, {5, 2000}, {0, 5}, {TEST1_SIZE, 0}}) {
+    LimitPlanNode limit_plan{scan_schema, &sort_plan, limit, offset};
+    auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &limit_plan);
+    ASSERT_NE(dynamic_cast<TopNExecutor *>(executor.get()), nullptr);
+    std::vector<std::string> expected;
+    for (size_t i = offset; i < std::min<size_t>(offset + limit, sorted.size()); i++) {
+      expected.push_back(sorted[i].ToString(scan_schema));
+    }
+    // Rewinding reads the input again.
+    for (int round = 0; round < 2; round++) {
+      executor->Init();
+      std::vector<std::string> actual;
+      Tuple tuple;
+      RID rid;
+      while (executor->Next(&tuple, &rid)) {
+        actual.push_back(tuple.ToString(scan_schema));
+      }
+      ASSERT_EQ(actual, expected) << "LIMIT " << limit << " OFFSET " << offset;
+    }
+  }
+
+  // A cut that is too large for memory is left to the sort, which can spill.
+  LimitPlanNode large_plan{scan_schema, &sort_plan, TopNExecutor::MAX_HEAP_SIZE, 1};
+  ASSERT_NE(dynamic_cast<LimitExecutor *>(ExecutorFactory::CreateExecutor(GetExecutorContext(), &large_plan).get()),
+            nullptr);
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, LimitStopsEarlyTest) {
+  // LIMIT 10 OFFSET 5 pulls no more rows from its child than it needs: 15 rows when pulled a row at a time, and a
+  // single batch when pulled a batch at a time.
+  Schema schema({Column("k", TypeId::BIGINT), Column("v", TypeId::INTEGER)});
+  LimitPlanNode limit_plan{&schema, nullptr, 10, 5};
+  auto child = std::make_unique<RandomRowsExecutor>(GetExecutorContext(), &schema, 100000);
+  RandomRowsExecutor *rows = child.get();
+  LimitExecutor executor(GetExecutorContext(), &limit_plan, std::move(child));
+
+  executor.Init();
+  Tuple tuple;
+  RID rid;
+  std::vector<int32_t> row_numbers;
+  while (executor.Next(&tuple, &rid)) {
+    row_numbers.push_back(tuple.GetValue(&schema, 1).GetAs<int32_t>());
+  }
+  ASSERT_EQ(row_numbers, std::vector<int32_t>({5, 6, 7, 8, 9, 10, 11, 12, 13, 14}));
+  ASSERT_EQ(rows->GetProducedCount(), 15);
+
+  executor.Init();
+  TupleBatch batch(&schema);
+  row_numbers.clear();
+  while (executor.NextBatch(&batch)) {
+    for (uint32_t row_idx = 0; row_idx < batch.GetRowCount(); row_idx++) {
+      row_numbers.push_back(batch.GetValue(row_idx, 1).GetAs<int32_t>());
+    }
+  }
+  ASSERT_EQ(row_numbers, std::vector<int32_t>({5, 6, 7, 8, 9, 10, 11, 12, 13, 14}));
+  ASSERT_EQ(rows->GetProducedCount(), TupleBatch::DEFAULT_BATCH_SIZE);
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, DISABLED_TopNBenchmark) {
+  // SELECT k, v FROM <random rows> ORDER BY k LIMIT 100, as a top-N and as a limit over a full sort.
+  Schema schema({Column("k", TypeId::BIGINT), Column("v", TypeId::INTEGER)});
+  auto *k = MakeColumnValueExpression(schema, 0, "k");
+  const size_t num_rows = 1000000;
+  SortPlanNode sort_plan{&schema, nullptr, {{OrderByType::Ascending, k}}};
+  LimitPlanNode limit_plan{&schema, &sort_plan, 100, 0};
+  for (bool top_n : {true, false}) {
+    std::unique_ptr<AbstractExecutor> executor;
+    auto child = std::make_unique<RandomRowsExecutor>(GetExecutorContext(), &schema, num_rows);
+    if (top_n) {
+      executor = std::make_unique<TopNExecutor>(GetExecutorContext(), &limit_plan, &sort_plan, std::move(child));
+    } else {
+      executor = std::make_unique<LimitExecutor>(
+          GetExecutorContext(), &limit_plan,
+          std::make_unique<SortExecutor>(GetExecutorContext(), &sort_plan, std::move(child)));
+    }
+    auto start = std::chrono::steady_clock::now();
+    executor->Init();
+    Tuple tuple;
+    RID rid;
+    size_t rows = 0;
+    while (executor->Next(&tuple, &rid)) {
+      rows++;
+    }
+    ASSERT_EQ(rows, 100);
+    auto time = std::chrono::steady_clock::now() - start;
+    std::cout << (top_n ? "top-N: " : "limit over sort: ")
+              << std::chrono::duration_cast<std::chrono::nanoseconds>(time).count() / num_rows << " ns/row"
+              << std::endl;
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, DISABLED_InsertBenchmark) {
+  // INSERT INTO bench SELECT k, v FROM <random rows>: 10M rows through the batched insert with one transaction per
+  // 1M rows, 1M rows with an index on the random k, and 50K rows through the per-row TableHeap::InsertTuple(), which
+  // scans the page list from its start for every row.
+  Schema schema({Column("k", TypeId::BIGINT), Column("v", TypeId::INTEGER)});
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  auto load = [&](const std::string &table_name, size_t num_rows, size_t chunk_rows, bool indexed) {
+    TableMetadata *table_info = GetCatalog()->CreateTable(GetTxn(), table_name, schema);
+    if (indexed) {
+      GetCatalog()->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(GetTxn(), table_name + "_k", table_name,
+                                                                          schema, *key_schema, {0}, 8);
+    }
+    InsertPlanNode insert_plan{nullptr, table_info->oid_};
+    auto start = std::chrono::steady_clock::now();
+    for (size_t loaded = 0; loaded < num_rows; loaded += chunk_rows) {
+      Transaction *txn = GetTxnManager()->Begin();
+      ExecutorContext exec_ctx(txn, GetCatalog(), GetBPM(), GetTxnManager(), GetLockManager());
+      InsertExecutor executor(&exec_ctx, &insert_plan,
+                              std::make_unique<RandomRowsExecutor>(&exec_ctx, &schema, chunk_rows));
+      executor.Init();
+      Tuple tuple;
+      RID rid;
+      executor.Next(&tuple, &rid);
+      GetTxnManager()->Commit(txn);
+      delete txn;
+    }
+    auto time = std::chrono::steady_clock::now() - start;
+    std::cout << table_name << ": " << num_rows << " rows, "
+              << std::chrono::duration_cast<std::chrono::nanoseconds>(time).count() / num_rows << " ns/row"
+              << std::endl;
+  };
+  load("bench", 10000000, 1000000, false);
+  load("bench_indexed", 1000000, 1000000, true);
+  delete key_schema;
+
+  const size_t per_row_rows = 50000;
+  TableMetadata *table_info = GetCatalog()->CreateTable(GetTxn(), "bench_per_row", schema);
+  RandomRowsExecutor rows(GetExecutorContext(), &schema, per_row_rows);
+  rows.Init();
+  Tuple tuple;
+  RID rid;
+  auto start = std::chrono::steady_clock::now();
+  while (rows.Next(&tuple, &rid)) {
+    Transaction *txn = GetTxnManager()->Begin();
+    ASSERT_TRUE(table_info->table_->InsertTuple(tuple, &rid, txn));
+    GetTxnManager()->Commit(txn);
+    delete txn;
+  }
+  auto time = std::chrono::steady_clock::now() - start;
+  std::cout << "bench_per_row: " << per_row_rows << " rows, "
+            << std::chrono::duration_cast<std::chrono::nanoseconds>(time).count() / per_row_rows << " ns/row"
+            << std::endl;
+}
+
 // NOLINTNEXTLINE
 TEST_F(ExecutorTest, DISABLED_SimpleAggregationTest) {
   // SELECT COUNT(colA), SUM(colA), min(colA), max(colA) from test_1;
@@ -0,0 +1,351 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// log_manager_test.cpp
+//
+// Identification: test/recovery/log_manager_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <future>  // NOLINT
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "concurrency/transaction_manager.h"
+#include "gtest/gtest.h"
+#include "recovery/log_manager.h"
+#include "storage/table/table_heap.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+class LogManagerTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    ::testing::Test::SetUp();
+    disk_manager_ = std::make_unique<DiskManager>("log_manager_test.db");
+    log_manager_ = std::make_unique<LogManager>(disk_manager_.get());
+    bpm_ = std::make_unique<BufferPoolManager>(100, disk_manager_.get(), log_manager_.get());
+    lock_manager_ = std::make_unique<LockManager>();
+    txn_mgr_ = std::make_unique<TransactionManager>(lock_manager_.get(), log_manager_.get());
+    schema_ = std::make_unique<Schema>(std::vector<Column>{Column("a", TypeId::INTEGER)});
+    // The table is created before logging is enabled, so that it logs no NEWPAGE record.
+    Transaction txn(0);
+    table_ = std::make_unique<TableHeap>(bpm_.get(), lock_manager_.get(), log_manager_.get(), &txn);
+  }
+
+  void TearDown() override {
+    log_manager_->StopFlushThread();
+    table_.reset();
+    disk_manager_->ShutDown();
+    remove("log_manager_test.db");
+    remove("log_manager_test.log");
+    ::testing::Test::TearDown();
+  }
+
+  /** Runs a transaction that inserts one row and commits. */
+  void InsertAndCommit(int32_t a) {
+    Transaction *txn = txn_mgr_->Begin();
+    RID rid;
+    EXPECT_TRUE(table_->InsertTuple(Tuple({ValueFactory::GetIntegerValue(a)}, schema_.get()), &rid, txn));
+    txn_mgr_->Commit(txn);
+    EXPECT_GE(log_manager_->GetPersistentLSN(), txn->GetPrevLSN());
+    delete txn;
+  }
+
+  /** @return the LSNs and types of the log records in the log file, in the order of the file */
+  std::vector<std::pair<lsn_t, LogRecordType>> ReadLogHeaders() {
+    std::vector<std::pair<lsn_t, LogRecordType>> headers;
+    std::vector<char> buffer(LOG_BUFFER_SIZE);
+    int offset = 0;
+    while (disk_manager_->ReadLog(buffer.data(), LOG_BUFFER_SIZE, offset)) {
+      int pos = 0;
+      while (pos + 20 <= LOG_BUFFER_SIZE) {
+        int32_t size = *reinterpret_cast<int32_t *>(buffer.data() + pos);
+        if (size == 0 || pos + size > LOG_BUFFER_SIZE) {
+          break;
+        }
+        headers.emplace_back(*reinterpret_cast<lsn_t *>(buffer.data() + pos + 4),
+                             *reinterpret_cast<LogRecordType *>(buffer.data() + pos + 16));
+        pos += size;
+      }
+      if (pos == 0) {
+        break;
+      }
+      offset += pos;
+      std::fill(buffer.begin(), buffer.end(), 0);
+    }
+    return headers;
+  }
+
+  /** @return the number of log records of the given type in the log file */
+  int CountLogRecords(LogRecordType log_record_type) {
+    auto headers = ReadLogHeaders();
+    return std::count_if(headers.begin(), headers.end(), [&](const auto &header) {
+      return header.second == log_record_type;
+    });
+  }
+
+  std::unique_ptr<DiskManager> disk_manager_;
+  std::unique_ptr<LogManager> log_manager_;
+  std::unique_ptr<BufferPoolManager> bpm_;
+  std::unique_ptr<LockManager> lock_manager_;
+  std::unique_ptr<TransactionManager> txn_mgr_;
+  std::unique_ptr<Schema> schema_;
+  std::unique_ptr<TableHeap> table_;
+};
+
+// NOLINTNEXTLINE
+TEST_F(LogManagerTest, AppendTest) {
+  // Without a flush thread, a commit writes the log itself.
+  enable_logging = true;
+  for (int32_t i = 0; i < 10; i++) {
+    InsertAndCommit(i);
+  }
+  enable_logging = false;
+  EXPECT_EQ(30, log_manager_->GetNextLSN());
+  EXPECT_EQ(29, log_manager_->GetPersistentLSN());
+  EXPECT_EQ(10, disk_manager_->GetNumFlushes());
+  EXPECT_EQ(10, CountLogRecords(LogRecordType::BEGIN));
+  EXPECT_EQ(10, CountLogRecords(LogRecordType::INSERT));
+  EXPECT_EQ(10, CountLogRecords(LogRecordType::COMMIT));
+}
+
+// NOLINTNEXTLINE
+TEST_F(LogManagerTest, GroupCommitTest) {
+  log_manager_->RunFlushThread();
+  ASSERT_TRUE(enable_logging);
+
+  constexpr int num_txns = 8;
+  std::vector<Transaction *> txns;
+  for (int32_t i = 0; i < num_txns; i++) {
+    txns.push_back(txn_mgr_->Begin());
+    RID rid;
+    EXPECT_TRUE(table_->InsertTuple(Tuple({ValueFactory::GetIntegerValue(i)}, schema_.get()), &rid, txns.back()));
+  }
+  int flushes_before = disk_manager_->GetNumFlushes();
+  lsn_t first_commit_lsn = log_manager_->GetNextLSN();
+
+  // Hold up the write for the first commit, so that the other transactions commit while it is in progress.
+  std::promise<void> write_done;
+  std::future<void> write_future = write_done.get_future();
+  disk_manager_->SetFlushLogFuture(&write_future);
+  std::vector<std::thread> threads;
+  threads.emplace_back([&] { txn_mgr_->Commit(txns[0]); });
+  while (!disk_manager_->GetFlushState()) {
+    std::this_thread::yield();
+  }
+  for (int i = 1; i < num_txns; i++) {
+    threads.emplace_back([&, i] { txn_mgr_->Commit(txns[i]); });
+  }
+  while (log_manager_->GetNextLSN() < first_commit_lsn + num_txns) {
+    std::this_thread::yield();
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  write_done.set_value();
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // The first write and one write for all the transactions that waited meanwhile.
+  EXPECT_EQ(flushes_before + 2, disk_manager_->GetNumFlushes());
+  EXPECT_EQ(first_commit_lsn + num_txns - 1, log_manager_->GetPersistentLSN());
+  for (auto txn : txns) {
+    EXPECT_GE(log_manager_->GetPersistentLSN(), txn->GetPrevLSN());
+    delete txn;
+  }
+  log_manager_->StopFlushThread();
+  EXPECT_FALSE(enable_logging);
+  EXPECT_EQ(num_txns, CountLogRecords(LogRecordType::COMMIT));
+}
+
+// NOLINTNEXTLINE
+TEST_F(LogManagerTest, WriteAheadTest) {
+  // A page is written only after the log records that changed it, even if no transaction has committed yet.
+  auto saved_log_timeout = log_timeout;
+  log_timeout = std::chrono::seconds(15);
+  log_manager_->RunFlushThread();
+  Transaction *txn = txn_mgr_->Begin();
+  RID rid;
+  ASSERT_TRUE(table_->InsertTuple(Tuple({ValueFactory::GetIntegerValue(0)}, schema_.get()), &rid, txn));
+  Page *page = bpm_->FetchPage(rid.GetPageId());
+  lsn_t page_lsn = page->GetLSN();
+  bpm_->UnpinPage(rid.GetPageId(), false);
+  EXPECT_EQ(txn->GetPrevLSN(), page_lsn);
+  EXPECT_LT(log_manager_->GetPersistentLSN(), page_lsn);
+
+  EXPECT_TRUE(bpm_->FlushPage(rid.GetPageId()));
+  EXPECT_GE(log_manager_->GetPersistentLSN(), page_lsn);
+  txn_mgr_->Commit(txn);
+  delete txn;
+  log_manager_->StopFlushThread();
+  log_timeout = saved_log_timeout;
+}
+
+// NOLINTNEXTLINE
+TEST_F(LogManagerTest, WriteAheadLatchTest) {
+  // A page that waits for its log records to be written does not hold up the other users of the buffer pool.
+  auto saved_log_timeout = log_timeout;
+  log_timeout = std::chrono::seconds(15);
+  log_manager_->RunFlushThread();
+  Transaction *txn = txn_mgr_->Begin();
+  RID rid;
+  ASSERT_TRUE(table_->InsertTuple(Tuple({ValueFactory::GetIntegerValue(0)}, schema_.get()), &rid, txn));
+
+  std::promise<void> write_done;
+  std::future<void> write_future = write_done.get_future();
+  disk_manager_->SetFlushLogFuture(&write_future);
+  std::thread flusher([&] { EXPECT_TRUE(bpm_->FlushPage(rid.GetPageId())); });
+  while (!disk_manager_->GetFlushState()) {
+    std::this_thread::yield();
+  }
+  page_id_t page_id;
+  ASSERT_NE(nullptr, bpm_->NewPage(&page_id));
+  EXPECT_TRUE(bpm_->UnpinPage(page_id, false));
+  ASSERT_NE(nullptr, bpm_->FetchPage(rid.GetPageId()));
+  EXPECT_TRUE(bpm_->UnpinPage(rid.GetPageId(), false));
+  write_done.set_value();
+  flusher.join();
+  EXPECT_GE(log_manager_->GetPersistentLSN(), txn->GetPrevLSN());
+
+  txn_mgr_->Commit(txn);
+  delete txn;
+  log_manager_->StopFlushThread();
+  log_timeout = saved_log_timeout;
+}
+
+// NOLINTNEXTLINE
+TEST_F(LogManagerTest, ConcurrentAppendTest) {
+  // Concurrent appenders fill several buffers; the records must reach the log file in the order of their LSNs.
+  log_manager_->RunFlushThread();
+  Tuple tuple({ValueFactory::GetIntegerValue(0)}, schema_.get());
+  constexpr int num_threads = 8;
+  constexpr int records = 2000;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; i++) {
+    threads.emplace_back([&, i] {
+      for (int j = 0; j < records; j++) {
+        LogRecord log_record(i, INVALID_LSN, LogRecordType::INSERT, RID(j, 0), tuple);
+        lsn_t lsn = log_manager_->AppendLogRecord(&log_record);
+        EXPECT_EQ(lsn, log_record.GetLSN());
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  log_manager_->StopFlushThread();
+  EXPECT_EQ(num_threads * records - 1, log_manager_->GetPersistentLSN());
+  EXPECT_LT(1, disk_manager_->GetNumFlushes());
+
+  auto headers = ReadLogHeaders();
+  ASSERT_EQ(static_cast<size_t>(num_threads * records), headers.size());
+  for (size_t i = 0; i < headers.size(); i++) {
+    EXPECT_EQ(static_cast<lsn_t>(i), headers[i].first);
+    EXPECT_EQ(LogRecordType::INSERT, headers[i].second);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(LogManagerTest, DISABLED_GroupCommitBenchmark) {
+  // 64 clients commit one insert after the other, with one synced log write per commit and with group commit.
+  constexpr int num_threads = 64;
+  log_manager_->RunFlushThread();
+  for (bool group_commit : {false, true}) {
+    log_manager_->SetGroupCommit(group_commit);
+    int flushes_before = disk_manager_->GetNumFlushes();
+    std::atomic<bool> stop{false};
+    std::atomic<size_t> commits{0};
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (int32_t i = 0; i < num_threads; i++) {
+      threads.emplace_back([&, i] {
+        while (!stop) {
+          InsertAndCommit(i);
+          commits++;
+        }
+      });
+    }
+    std::this_thread::sleep_for(std::chrono::seconds(2));
+    stop = true;
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << (group_commit ? "group commit: " : "per-transaction flush: ") << commits / elapsed
+              << " commits/s, " << static_cast<double>(commits) / (disk_manager_->GetNumFlushes() - flushes_before)
+              << " commits/flush" << std::endl;
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(LogManagerTest, DISABLED_LoggingOverheadBenchmark) {
+  // One transaction inserts rows into a fresh table and then updates them, without and with write-ahead logging.
+  // Note that enable_logging also turns on the row locks of the table heap.
+  constexpr int32_t rows = 20000;
+  for (bool logging : {false, true}) {
+    if (logging) {
+      log_manager_->RunFlushThread();
+    }
+    int flushes_before = disk_manager_->GetNumFlushes();
+    Transaction *txn = txn_mgr_->Begin();
+    TableHeap table(bpm_.get(), lock_manager_.get(), log_manager_.get(), txn);
+    std::vector<RID> rids(rows);
+    auto start = std::chrono::steady_clock::now();
+    for (int32_t i = 0; i < rows; i++) {
+      table.InsertTuple(Tuple({ValueFactory::GetIntegerValue(i)}, schema_.get()), &rids[i], txn);
+    }
+    auto inserted = std::chrono::steady_clock::now();
+    for (int32_t i = 0; i < rows; i++) {
+      table.UpdateTuple(Tuple({ValueFactory::GetIntegerValue(-i)}, schema_.get()), rids[i], txn);
+    }
+    auto updated = std::chrono::steady_clock::now();
+    txn_mgr_->Commit(txn);
+    delete txn;
+    std::cout << (logging ? "with logging: " : "without logging: ")
+              << rows / std::chrono::duration<double>(inserted - start).count() << " inserts/s, "
+              << rows / std::chrono::duration<double>(updated - inserted).count() << " updates/s, "
+              << disk_manager_->GetNumFlushes() - flushes_before << " log writes" << std::endl;
+    log_manager_->StopFlushThread();
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(LogManagerTest, DISABLED_AppendBenchmark) {
+  // Writer threads append INSERT records of 100 byte tuples as fast as they can.
+  Tuple tuple({ValueFactory::GetVarcharValue(std::string(96, 'x'))},
+              std::make_unique<Schema>(std::vector<Column>{Column("b", TypeId::VARCHAR, 96)}).get());
+  constexpr int records = 400000;
+  log_manager_->RunFlushThread();
+  for (int num_threads : {1, 2, 4, 8}) {
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_threads; i++) {
+      threads.emplace_back([&, i] {
+        for (int j = 0; j < records / num_threads; j++) {
+          LogRecord log_record(i, INVALID_LSN, LogRecordType::INSERT, RID(j, 0), tuple);
+          log_manager_->AppendLogRecord(&log_record);
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << num_threads << " writers: " << records / elapsed << " appends/s" << std::endl;
+  }
+}
+
+}  // namespace bustub
@@ -10,6 +10,11 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <unistd.h>
+
+#include <chrono>  // NOLINT
+#include <fstream>
+#include <iostream>
 #include <string>
 #include <vector>
 
@@ -23,11 +28,12 @@
 #include "storage/table/table_heap.h"
 #include "storage/table/table_iterator.h"
 #include "storage/table/tuple.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 
 // NOLINTNEXTLINE
-TEST(RecoveryTest, DISABLED_RedoTest) {
+TEST(RecoveryTest, RedoTest) {
   remove("test.db");
   remove("test.log");
 
@@ -122,7 +128,7 @@ TEST(RecoveryTest, DISABLED_RedoTest) {
 }
 
 // NOLINTNEXTLINE
-TEST(RecoveryTest, DISABLED_UndoTest) {
+TEST(RecoveryTest, UndoTest) {
   remove("test.db");
   remove("test.log");
   BustubInstance *bustub_instance = new BustubInstance("test.db");
@@ -206,7 +212,7 @@ TEST(RecoveryTest, DISABLED_UndoTest) {
 }
 
 // NOLINTNEXTLINE
-TEST(RecoveryTest, DISABLED_CheckpointTest) {
+TEST(RecoveryTest, CheckpointTest) {
   remove("test.db");
   remove("test.log");
   BustubInstance *bustub_instance = new BustubInstance("test.db");
@@ -314,4 +320,217 @@ TEST(RecoveryTest, DISABLED_CheckpointTest) {
   remove("test.db");
   remove("test.log");
 }
+// NOLINTNEXTLINE
+TEST(RecoveryTest, CheckpointRedoTest) {
+  remove("test.db");
+  remove("test.log");
+  BustubInstance *bustub_instance = new BustubInstance("test.db");
+  bustub_instance->log_manager_->RunFlushThread();
+
+  Column col1{"a", TypeId::VARCHAR, 20};
+  Column col2{"b", TypeId::SMALLINT};
+  std::vector<Column> cols{col1, col2};
+  Schema schema{cols};
+  const Tuple tuple = ConstructTuple(&schema);
+
+  Transaction *txn = bustub_instance->transaction_manager_->Begin();
+  auto *test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                                   bustub_instance->log_manager_, txn);
+  page_id_t first_page_id = test_table->GetFirstPageId();
+  RID rid;
+  ASSERT_TRUE(test_table->InsertTuple(tuple, &rid, txn));
+  bustub_instance->transaction_manager_->Commit(txn);
+  delete txn;
+
+  LOG_INFO("Checkpoint writes the first insert");
+  bustub_instance->checkpoint_manager_->BeginCheckpoint();
+  bustub_instance->checkpoint_manager_->EndCheckpoint();
+
+  LOG_INFO("Second insert commits after the checkpoint");
+  txn = bustub_instance->transaction_manager_->Begin();
+  RID rid1;
+  ASSERT_TRUE(test_table->InsertTuple(tuple, &rid1, txn));
+  bustub_instance->transaction_manager_->Commit(txn);
+  delete txn;
+
+  LOG_INFO("Third insert is logged and never commits");
+  Transaction *loser = bustub_instance->transaction_manager_->Begin();
+  RID rid2;
+  ASSERT_TRUE(test_table->InsertTuple(tuple, &rid2, loser));
+  bustub_instance->log_manager_->Flush(loser->GetPrevLSN());
+  delete loser;
+  delete test_table;
+
+  LOG_INFO("System crash, with only the first insert in the table page on disk");
+  delete bustub_instance;
+
+  // The second recovery finds the loser aborted by the first one, and must not roll it back again.
+  for (int restart = 0; restart < 2; restart++) {
+    bustub_instance = new BustubInstance("test.db");
+    LogRecovery log_recovery(bustub_instance->disk_manager_, bustub_instance->buffer_pool_manager_,
+                             bustub_instance->log_manager_);
+    log_recovery.Redo();
+    log_recovery.Undo();
+    EXPECT_LT(0, bustub_instance->log_manager_->GetNextLSN());
+
+    txn = bustub_instance->transaction_manager_->Begin();
+    test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                               bustub_instance->log_manager_, first_page_id);
+    Tuple old_tuple;
+    EXPECT_TRUE(test_table->GetTuple(rid, &old_tuple, txn));
+    EXPECT_TRUE(test_table->GetTuple(rid1, &old_tuple, txn));
+    EXPECT_FALSE(test_table->GetTuple(rid2, &old_tuple, txn));
+    bustub_instance->transaction_manager_->Commit(txn);
+    delete txn;
+    delete test_table;
+    delete bustub_instance;
+  }
+  remove("test.db");
+  remove("test.log");
+}
+
+// NOLINTNEXTLINE
+TEST(RecoveryTest, RepeatedUndoTest) {
+  remove("test.db");
+  remove("test.log");
+  BustubInstance *bustub_instance = new BustubInstance("test.db");
+  bustub_instance->log_manager_->RunFlushThread();
+
+  Column col1{"a", TypeId::VARCHAR, 20};
+  Column col2{"b", TypeId::SMALLINT};
+  std::vector<Column> cols{col1, col2};
+  Schema schema{cols};
+  const Tuple tuple = ConstructTuple(&schema);
+
+  Transaction *txn = bustub_instance->transaction_manager_->Begin();
+  auto *test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                                   bustub_instance->log_manager_, txn);
+  page_id_t first_page_id = test_table->GetFirstPageId();
+  RID rid;
+  ASSERT_TRUE(test_table->InsertTuple(tuple, &rid, txn));
+  bustub_instance->transaction_manager_->Commit(txn);
+  delete txn;
+
+  LOG_INFO("The loser deletes the row for good and never commits");
+  Transaction *loser = bustub_instance->transaction_manager_->Begin();
+  ASSERT_TRUE(test_table->MarkDelete(rid, loser));
+  test_table->ApplyDelete(rid, loser);
+  bustub_instance->log_manager_->Flush(loser->GetPrevLSN());
+  delete loser;
+  delete test_table;
+  delete bustub_instance;
+
+  for (int restart = 0; restart < 2; restart++) {
+    bustub_instance = new BustubInstance("test.db");
+    LogRecovery log_recovery(bustub_instance->disk_manager_, bustub_instance->buffer_pool_manager_,
+                             bustub_instance->log_manager_);
+    log_recovery.Redo();
+    log_recovery.Undo();
+
+    txn = bustub_instance->transaction_manager_->Begin();
+    test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                               bustub_instance->log_manager_, first_page_id);
+    int rows = 0;
+    for (auto it = test_table->Begin(txn); it != test_table->End(); ++it) {
+      rows++;
+    }
+    EXPECT_EQ(1, rows);
+    bustub_instance->transaction_manager_->Commit(txn);
+    delete txn;
+    delete test_table;
+    delete bustub_instance;
+
+    LOG_INFO("System crash with the rollback on disk, before the ABORT record is");
+    std::ifstream log_file("test.log", std::ios::binary | std::ios::ate);
+    auto log_size = static_cast<off_t>(log_file.tellg());
+    log_file.close();
+    LogRecord abort_record(0, INVALID_LSN, LogRecordType::ABORT);
+    ASSERT_EQ(0, truncate("test.log", log_size - abort_record.GetSize()));
+  }
+  remove("test.db");
+  remove("test.log");
+}
+
+// NOLINTNEXTLINE
+TEST(RecoveryTest, DISABLED_RestartBenchmark) {
+  // 1GB of log of committed transactions is followed by a checkpoint and a short tail, which has a transaction that
+  // never commits. Restarting reads all of the log, and redoes and undoes only the tail.
+  remove("test.db");
+  remove("test.log");
+  BustubInstance *bustub_instance = new BustubInstance("test.db");
+  bustub_instance->log_manager_->RunFlushThread();
+  Column col1{"a", TypeId::VARCHAR, 100};
+  std::vector<Column> cols{col1};
+  Schema schema{cols};
+  const Tuple tuple({ValueFactory::GetVarcharValue(std::string(96, 'x'))}, &schema);
+
+  Transaction *txn = bustub_instance->transaction_manager_->Begin();
+  auto *test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                                   bustub_instance->log_manager_, txn);
+  page_id_t first_page_id = test_table->GetFirstPageId();
+  bustub_instance->transaction_manager_->Commit(txn);
+  delete txn;
+
+  constexpr int64_t log_size = int64_t{1} << 30;
+  constexpr int records_per_txn = 100;
+  int64_t logged = 0;
+  for (txn_id_t txn_id = 1000000; logged < log_size; txn_id++) {
+    LogRecord begin(txn_id, INVALID_LSN, LogRecordType::BEGIN);
+    lsn_t lsn = bustub_instance->log_manager_->AppendLogRecord(&begin);
+    for (int i = 0; i < records_per_txn; i++) {
+      LogRecord insert(txn_id, lsn, LogRecordType::INSERT, RID(first_page_id, i), tuple);
+      lsn = bustub_instance->log_manager_->AppendLogRecord(&insert);
+      logged += insert.GetSize();
+    }
+    LogRecord commit(txn_id, lsn, LogRecordType::COMMIT);
+    bustub_instance->log_manager_->AppendLogRecord(&commit);
+  }
+  bustub_instance->checkpoint_manager_->BeginCheckpoint();
+  bustub_instance->checkpoint_manager_->EndCheckpoint();
+
+  constexpr int tail_rows = 1000;
+  txn = bustub_instance->transaction_manager_->Begin();
+  RID rid;
+  for (int i = 0; i < tail_rows; i++) {
+    test_table->InsertTuple(tuple, &rid, txn);
+  }
+  bustub_instance->transaction_manager_->Commit(txn);
+  delete txn;
+  Transaction *loser = bustub_instance->transaction_manager_->Begin();
+  for (int i = 0; i < tail_rows; i++) {
+    test_table->InsertTuple(tuple, &rid, loser);
+  }
+  bustub_instance->log_manager_->Flush(loser->GetPrevLSN());
+  delete loser;
+  delete test_table;
+  delete bustub_instance;
+
+  bustub_instance = new BustubInstance("test.db");
+  auto start = std::chrono::steady_clock::now();
+  LogRecovery log_recovery(bustub_instance->disk_manager_, bustub_instance->buffer_pool_manager_,
+                           bustub_instance->log_manager_);
+  log_recovery.Redo();
+  auto redone = std::chrono::steady_clock::now();
+  log_recovery.Undo();
+  auto undone = std::chrono::steady_clock::now();
+  std::cout << "restart with " << (bustub_instance->log_manager_->GetNextLSN()) << " log records: analysis and redo "
+            << std::chrono::duration<double>(redone - start).count() << " s, undo "
+            << std::chrono::duration<double>(undone - redone).count() << " s" << std::endl;
+
+  txn = bustub_instance->transaction_manager_->Begin();
+  test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                             bustub_instance->log_manager_, first_page_id);
+  int rows = 0;
+  for (auto it = test_table->Begin(txn); it != test_table->End(); ++it) {
+    rows++;
+  }
+  EXPECT_EQ(tail_rows, rows);
+  bustub_instance->transaction_manager_->Commit(txn);
+  delete txn;
+  delete test_table;
+  delete bustub_instance;
+  remove("test.db");
+  remove("test.log");
+}
+
 }  // namespace bustub
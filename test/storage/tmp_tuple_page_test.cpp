@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <string>
 #include <vector>
 
 #include "gtest/gtest.h"
@@ -19,7 +20,7 @@
 namespace bustub {
 
 // NOLINTNEXTLINE
-TEST(TmpTuplePageTest, DISABLED_BasicTest) {
+TEST(TmpTuplePageTest, BasicTest) {
   // There are many ways to do this assignment, and this is only one of them.
   // If you don't like the TmpTuplePage idea, please feel free to delete this test case entirely.
   // You will get full credit as long as you are correctly using a linear probe hash table.
@@ -46,6 +47,45 @@ TEST(TmpTuplePageTest, DISABLED_BasicTest) {
   ASSERT_EQ(*reinterpret_cast<uint32_t *>(data + sizeof(page_id_t) + sizeof(lsn_t)), PAGE_SIZE - 8);
   ASSERT_EQ(*reinterpret_cast<uint32_t *>(data + PAGE_SIZE - 8), 4);
   ASSERT_EQ(*reinterpret_cast<uint32_t *>(data + PAGE_SIZE - 4), 123);
+  ASSERT_EQ(tmp_tuple, TmpTuple(page_id, PAGE_SIZE - 8));
+}
+
+// NOLINTNEXTLINE
+TEST(TmpTuplePageTest, FillAndIterateTest) {
+  TmpTuplePage page{};
+  page_id_t page_id = 15445;
+  page.Init(page_id, PAGE_SIZE);
+
+  std::vector<Column> columns;
+  columns.emplace_back("A", TypeId::INTEGER);
+  columns.emplace_back("B", TypeId::VARCHAR, 32);
+  Schema schema(columns);
+
+  // Fill the page until it refuses a tuple.
+  std::vector<TmpTuple> tmp_tuples;
+  for (int32_t i = 0;; i++) {
+    Tuple tuple({ValueFactory::GetIntegerValue(i), ValueFactory::GetVarcharValue(std::string(i % 20, 'x'))}, &schema);
+    TmpTuple tmp_tuple(INVALID_PAGE_ID, 0);
+    if (!page.Insert(tuple, &tmp_tuple)) {
+      break;
+    }
+    ASSERT_EQ(tmp_tuple.GetPageId(), page_id);
+    tmp_tuples.push_back(tmp_tuple);
+  }
+  ASSERT_GT(tmp_tuples.size(), 100);
+
+  // Iteration visits the tuples from the most recently inserted one.
+  TmpTuple cur(INVALID_PAGE_ID, 0);
+  auto expected = static_cast<int32_t>(tmp_tuples.size());
+  for (bool found = page.GetFirstTmpTuple(&cur); found; found = page.GetNextTmpTuple(cur, &cur)) {
+    expected--;
+    ASSERT_EQ(cur, tmp_tuples[expected]);
+    Tuple tuple;
+    page.Get(cur, &tuple);
+    ASSERT_EQ(tuple.GetValue(&schema, 0).GetAs<int32_t>(), expected);
+    ASSERT_EQ(tuple.GetValue(&schema, 1).ToString(), std::string(expected % 20, 'x'));
+  }
+  ASSERT_EQ(expected, 0);
 }
 
 }  // namespace bustub
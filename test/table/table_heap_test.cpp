@@ -0,0 +1,588 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_heap_test.cpp
+//
+// Identification: test/table/table_heap_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "concurrency/transaction.h"
+#include "concurrency/transaction_manager.h"
+#include "gtest/gtest.h"
+#include "storage/table/free_space_directory.h"
+#include "storage/table/table_heap.h"
+#include "storage/table/tuple.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+class TableHeapTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    ::testing::Test::SetUp();
+    disk_manager_ = std::make_unique<DiskManager>("table_heap_test.db");
+    bpm_ = std::make_unique<BufferPoolManager>(100, disk_manager_.get());
+    lock_manager_ = std::make_unique<LockManager>();
+    log_manager_ = std::make_unique<LogManager>(disk_manager_.get());
+    txn_ = std::make_unique<Transaction>(0);
+    schema_ = std::make_unique<Schema>(
+        std::vector<Column>{Column("a", TypeId::INTEGER), Column("b", TypeId::VARCHAR, 64)});
+  }
+
+  void TearDown() override {
+    txn_.reset();
+    disk_manager_->ShutDown();
+    remove("table_heap_test.db");
+    remove("table_heap_test.log");
+    ::testing::Test::TearDown();
+  }
+
+  /** @return a tuple of the test schema with a 40 byte string */
+  Tuple MakeTuple(int32_t a) {
+    return Tuple({ValueFactory::GetIntegerValue(a), ValueFactory::GetVarcharValue(std::string(40, 'x'))},
+                 schema_.get());
+  }
+
+  /** @return the number of tuples in a table */
+  size_t CountTuples(TableHeap *table) {
+    size_t count = 0;
+    for (auto it = table->Begin(txn_.get()); it != table->End(); ++it) {
+      count++;
+    }
+    return count;
+  }
+
+  /**
+   * @return the column a of the rows that a transaction sees, sorted; the rows are read through an iterator, and
+   * checked against ScanPage()
+   */
+  std::vector<int32_t> ReadColumn(TableHeap *table, Transaction *txn) {
+    std::vector<int32_t> values;
+    for (auto it = table->Begin(txn); it != table->End(); ++it) {
+      values.push_back(it->GetValue(schema_.get(), 0).GetAs<int32_t>());
+    }
+    std::vector<int32_t> scanned;
+    std::vector<page_id_t> page_ids;
+    table->GetPageIds(&page_ids);
+    TupleBatch batch(schema_.get());
+    for (page_id_t page_id : page_ids) {
+      batch.Clear();
+      table->ScanPage(page_id, &batch, txn);
+      for (uint32_t row_idx = 0; row_idx < batch.GetRowCount(); row_idx++) {
+        scanned.push_back(batch.GetTuple(row_idx).GetValue(schema_.get(), 0).GetAs<int32_t>());
+      }
+    }
+    std::sort(values.begin(), values.end());
+    std::sort(scanned.begin(), scanned.end());
+    EXPECT_EQ(values, scanned);
+    return values;
+  }
+
+ protected:
+  std::unique_ptr<DiskManager> disk_manager_;
+  std::unique_ptr<BufferPoolManager> bpm_;
+  std::unique_ptr<LockManager> lock_manager_;
+  std::unique_ptr<LogManager> log_manager_;
+  std::unique_ptr<Transaction> txn_;
+  std::unique_ptr<Schema> schema_;
+};
+
+// NOLINTNEXTLINE
+TEST(FreeSpaceDirectoryTest, FindTest) {
+  FreeSpaceDirectory directory;
+  EXPECT_EQ(INVALID_PAGE_ID, directory.Find(100, 0));
+
+  directory.Update(1, 1000);
+  directory.Update(2, 3000);
+  directory.Update(3, 8);
+  // Page 3 has too little space to be kept.
+  EXPECT_EQ(2U, directory.GetPageCount());
+  EXPECT_EQ(INVALID_PAGE_ID, directory.Find(3500, 0));
+  EXPECT_EQ(2, directory.Find(2000, 0));
+  EXPECT_EQ(2, directory.Find(2000, 1));
+
+  // Both pages certainly have room for 500 bytes, and different hints pick different pages.
+  std::set<page_id_t> picked{directory.Find(500, 0), directory.Find(500, 1)};
+  EXPECT_EQ((std::set<page_id_t>{1, 2}), picked);
+  // Three inserters want three pages.
+  EXPECT_EQ(INVALID_PAGE_ID, directory.Find(500, 0, 3));
+
+  // Page 1 moves down and out of the directory.
+  directory.Update(1, 500);
+  EXPECT_EQ(2, directory.Find(500, 0));
+  directory.Update(2, 0);
+  // Page 1 is in the bucket just below the first certain one, and its exact free space decides.
+  EXPECT_EQ(1, directory.Find(500, 0));
+  EXPECT_EQ(INVALID_PAGE_ID, directory.Find(501, 0));
+  directory.Update(1, 0);
+  EXPECT_EQ(0U, directory.GetPageCount());
+  EXPECT_EQ(INVALID_PAGE_ID, directory.Find(1, 0));
+}
+
+// NOLINTNEXTLINE
+TEST_F(TableHeapTest, ReuseFreedSpaceTest) {
+  TableHeap table(bpm_.get(), lock_manager_.get(), log_manager_.get(), txn_.get());
+  constexpr int32_t rows = 500;
+  std::vector<RID> rids(rows);
+  for (int32_t i = 0; i < rows; i++) {
+    ASSERT_TRUE(table.InsertTuple(MakeTuple(i), &rids[i], txn_.get()));
+  }
+  std::vector<page_id_t> page_ids;
+  table.GetPageIds(&page_ids);
+  ASSERT_GT(page_ids.size(), 2U);
+  // A single inserter fills one page after the other.
+  for (int32_t i = 1; i < rows; i++) {
+    ASSERT_LE(rids[i - 1].GetPageId(), rids[i].GetPageId());
+  }
+
+  // Free the first page; new tuples fill it up again before a page is added.
+  size_t freed = 0;
+  for (const auto &rid : rids) {
+    if (rid.GetPageId() == page_ids[0]) {
+      ASSERT_TRUE(table.MarkDelete(rid, txn_.get()));
+      table.ApplyDelete(rid, txn_.get());
+      freed++;
+    }
+  }
+  ASSERT_GT(freed, 0U);
+  size_t reused = 0;
+  for (size_t i = 0; i < freed; i++) {
+    RID rid;
+    ASSERT_TRUE(table.InsertTuple(MakeTuple(rows + i), &rid, txn_.get()));
+    reused += rid.GetPageId() == page_ids[0] ? 1 : 0;
+  }
+  EXPECT_GT(reused, 0U);
+
+  std::vector<page_id_t> new_page_ids;
+  table.GetPageIds(&new_page_ids);
+  EXPECT_EQ(page_ids, new_page_ids);
+  EXPECT_EQ(static_cast<size_t>(rows), CountTuples(&table));
+}
+
+// NOLINTNEXTLINE
+TEST_F(TableHeapTest, ReopenTest) {
+  page_id_t first_page_id;
+  std::vector<RID> rids(300);
+  {
+    TableHeap table(bpm_.get(), lock_manager_.get(), log_manager_.get(), txn_.get());
+    first_page_id = table.GetFirstPageId();
+    for (size_t i = 0; i < rids.size(); i++) {
+      ASSERT_TRUE(table.InsertTuple(MakeTuple(i), &rids[i], txn_.get()));
+    }
+    for (size_t i = 0; i < 5; i++) {
+      ASSERT_TRUE(table.MarkDelete(rids[i], txn_.get()));
+      table.ApplyDelete(rids[i], txn_.get());
+    }
+  }
+
+  // An opened table finds the holes in its first page before it chains a new page after its last page.
+  TableHeap table(bpm_.get(), lock_manager_.get(), log_manager_.get(), first_page_id);
+  std::vector<page_id_t> page_ids;
+  table.GetPageIds(&page_ids);
+  size_t page_count = page_ids.size();
+  std::set<int64_t> new_rids;
+  RID rid;
+  while (page_ids.size() == page_count) {
+    ASSERT_TRUE(table.InsertTuple(MakeTuple(0), &rid, txn_.get()));
+    new_rids.insert(rid.Get());
+    table.GetPageIds(&page_ids);
+  }
+  EXPECT_EQ(1U, new_rids.count(rids[0].Get()));
+  EXPECT_EQ(page_ids.back(), rid.GetPageId());
+  EXPECT_EQ(rids.size() - 5 + new_rids.size(), CountTuples(&table));
+}
+
+// NOLINTNEXTLINE
+TEST_F(TableHeapTest, ConcurrentInsertTest) {
+  TableHeap table(bpm_.get(), lock_manager_.get(), log_manager_.get(), txn_.get());
+  constexpr size_t num_threads = 4;
+  constexpr int32_t rows_per_thread = 1000;
+  std::vector<std::vector<RID>> rids(num_threads);
+  std::vector<std::thread> threads;
+  for (size_t thread_idx = 0; thread_idx < num_threads; thread_idx++) {
+    threads.emplace_back([&, thread_idx] {
+      Transaction txn(static_cast<txn_id_t>(thread_idx + 1));
+      for (int32_t i = 0; i < rows_per_thread; i++) {
+        RID rid;
+        ASSERT_TRUE(table.InsertTuple(MakeTuple(i), &rid, &txn));
+        rids[thread_idx].push_back(rid);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  std::vector<page_id_t> page_ids;
+  table.GetPageIds(&page_ids);
+  std::set<page_id_t> pages(page_ids.begin(), page_ids.end());
+  std::set<int64_t> distinct;
+  for (const auto &thread_rids : rids) {
+    for (const auto &rid : thread_rids) {
+      EXPECT_EQ(1U, pages.count(rid.GetPageId()));
+      distinct.insert(rid.Get());
+    }
+  }
+  EXPECT_EQ(num_threads * rows_per_thread, distinct.size());
+  EXPECT_EQ(num_threads * rows_per_thread, CountTuples(&table));
+}
+
+// NOLINTNEXTLINE
+TEST_F(TableHeapTest, ScanPageLockWaitTest) {
+  enable_logging = true;
+  TransactionManager txn_mgr(lock_manager_.get());
+  TableHeap table(bpm_.get(), lock_manager_.get(), log_manager_.get(), txn_.get());
+  std::vector<RID> rids(3);
+  Transaction *loader = txn_mgr.Begin();
+  for (int32_t i = 0; i < 3; i++) {
+    ASSERT_TRUE(table.InsertTuple(MakeTuple(i), &rids[i], loader));
+  }
+  txn_mgr.Commit(loader);
+
+  // The scan waits for the writer's lock without holding the page, which the writer latches to roll back.
+  Transaction *writer = txn_mgr.Begin();
+  ASSERT_TRUE(table.UpdateTuple(MakeTuple(10), rids[1], writer));
+  Transaction *reader = txn_mgr.Begin();
+  TupleBatch batch(schema_.get());
+  std::atomic<bool> scanned{false};
+  std::thread scan([&] { scanned = table.ScanPage(rids[0].GetPageId(), &batch, reader); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_FALSE(scanned);
+  txn_mgr.Abort(writer);
+  scan.join();
+  ASSERT_TRUE(scanned);
+  ASSERT_EQ(3U, batch.GetRowCount());
+  for (uint32_t row_idx = 0; row_idx < 3; row_idx++) {
+    EXPECT_EQ(row_idx, batch.GetTuple(row_idx).GetValue(schema_.get(), 0).GetAs<int32_t>());
+  }
+  txn_mgr.Commit(reader);
+
+  // A transaction that cannot lock reports it.
+  Transaction *aborted = txn_mgr.Begin();
+  aborted->SetState(TransactionState::ABORTED);
+  batch.Clear();
+  EXPECT_FALSE(table.ScanPage(rids[0].GetPageId(), &batch, aborted));
+  EXPECT_EQ(0U, batch.GetRowCount());
+  txn_mgr.Abort(aborted);
+  enable_logging = false;
+
+  for (auto txn : {loader, writer, reader, aborted}) {
+    delete txn;
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(TableHeapTest, WoundedWriterTest) {
+  enable_logging = true;
+  LockManager lock_mgr{DeadlockMode::WOUND_WAIT};
+  TransactionManager txn_mgr(&lock_mgr);
+  TableHeap table(bpm_.get(), &lock_mgr, log_manager_.get(), txn_.get());
+  std::vector<RID> rids(2);
+  Transaction *loader = txn_mgr.Begin();
+  for (int32_t i = 0; i < 2; i++) {
+    ASSERT_TRUE(table.InsertTuple(MakeTuple(i), &rids[i], loader));
+  }
+  txn_mgr.Commit(loader);
+
+  // An older transaction wounds a younger writer in its way. The writer runs on until its next write, which fails, and
+  // it cannot commit; its write is rolled back and the older transaction gets the row.
+  Transaction *older = txn_mgr.Begin();
+  Transaction *younger = txn_mgr.Begin();
+  ASSERT_TRUE(table.UpdateTuple(MakeTuple(10), rids[0], younger));
+  std::atomic<bool> updated{false};
+  std::thread wounder([&] { updated = table.UpdateTuple(MakeTuple(20), rids[0], older); });
+  while (!younger->IsWounded()) {
+    std::this_thread::yield();
+  }
+  EXPECT_EQ(TransactionState::GROWING, younger->GetState());
+  EXPECT_FALSE(table.UpdateTuple(MakeTuple(11), rids[1], younger));
+  EXPECT_EQ(TransactionState::ABORTED, younger->GetState());
+  EXPECT_THROW(txn_mgr.Commit(younger), TransactionAbortException);
+  wounder.join();
+  ASSERT_TRUE(updated);
+  txn_mgr.Commit(older);
+
+  // A wounded transaction that holds the lock of a row it writes again notices the wound too.
+  Transaction *holder = txn_mgr.Begin();
+  Transaction *first = txn_mgr.Begin();
+  ASSERT_TRUE(table.UpdateTuple(MakeTuple(30), rids[1], first));
+  ASSERT_TRUE(table.UpdateTuple(MakeTuple(40), rids[0], holder));
+  first->Wound();
+  EXPECT_FALSE(table.UpdateTuple(MakeTuple(31), rids[1], first));
+  EXPECT_THROW(txn_mgr.Commit(first), TransactionAbortException);
+  txn_mgr.Commit(holder);
+  enable_logging = false;
+
+  Transaction *reader = txn_mgr.Begin();
+  EXPECT_EQ((std::vector<int32_t>{1, 40}), ReadColumn(&table, reader));
+  txn_mgr.Commit(reader);
+
+  for (auto txn : {loader, older, younger, holder, first, reader}) {
+    delete txn;
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(TableHeapTest, SnapshotReadTest) {
+  TransactionManager txn_mgr(lock_manager_.get());
+  TableHeap table(bpm_.get(), lock_manager_.get(), log_manager_.get(), txn_.get());
+  std::vector<RID> rids(10);
+  Transaction *loader = txn_mgr.Begin();
+  for (int32_t i = 0; i < 10; i++) {
+    ASSERT_TRUE(table.InsertTuple(MakeTuple(i), &rids[i], loader));
+  }
+  txn_mgr.Commit(loader);
+  // No snapshot reads the versions of the loader's rows, so its commit collected them.
+  EXPECT_EQ(0U, table.GetVersionStore()->GetVersionCount());
+
+  Transaction *reader = txn_mgr.Begin(nullptr, IsolationLevel::SNAPSHOT_ISOLATION);
+  Transaction *writer = txn_mgr.Begin(nullptr, IsolationLevel::SNAPSHOT_ISOLATION);
+  ASSERT_TRUE(table.UpdateTuple(MakeTuple(100), rids[0], writer));
+  ASSERT_TRUE(table.UpdateTuple(MakeTuple(101), rids[0], writer));
+  ASSERT_TRUE(table.MarkDelete(rids[1], writer));
+  RID new_rid;
+  ASSERT_TRUE(table.InsertTuple(MakeTuple(200), &new_rid, writer));
+
+  const std::vector<int32_t> before{0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+  const std::vector<int32_t> after{2, 3, 4, 5, 6, 7, 8, 9, 101, 200};
+  EXPECT_EQ(before, ReadColumn(&table, reader));
+  EXPECT_EQ(after, ReadColumn(&table, writer));
+  Tuple tuple;
+  EXPECT_TRUE(table.GetTuple(rids[1], &tuple, reader));
+  EXPECT_EQ(1, tuple.GetValue(schema_.get(), 0).GetAs<int32_t>());
+  EXPECT_FALSE(table.GetTuple(rids[1], &tuple, writer));
+  EXPECT_FALSE(table.GetTuple(new_rid, &tuple, reader));
+  txn_mgr.Commit(writer);
+
+  // The committed delete freed its slot, but the older snapshot still reads the row.
+  EXPECT_EQ(before, ReadColumn(&table, reader));
+  Transaction *late_reader = txn_mgr.Begin(nullptr, IsolationLevel::SNAPSHOT_ISOLATION);
+  EXPECT_EQ(after, ReadColumn(&table, late_reader));
+  EXPECT_EQ(3U, table.GetVersionStore()->GetVersionCount());
+
+  // Once the older snapshots are gone, the next commit collects the versions they read.
+  txn_mgr.Commit(reader);
+  txn_mgr.Commit(late_reader);
+  Transaction *cleaner = txn_mgr.Begin(nullptr, IsolationLevel::SNAPSHOT_ISOLATION);
+  ASSERT_TRUE(table.UpdateTuple(MakeTuple(2), rids[2], cleaner));
+  txn_mgr.Commit(cleaner);
+  EXPECT_EQ(0U, table.GetVersionStore()->GetVersionCount());
+  EXPECT_EQ(after, ReadColumn(&table, txn_.get()));
+
+  for (auto txn : {loader, reader, writer, late_reader, cleaner}) {
+    delete txn;
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(TableHeapTest, SnapshotWriteConflictTest) {
+  TransactionManager txn_mgr(lock_manager_.get());
+  TableHeap table(bpm_.get(), lock_manager_.get(), log_manager_.get(), txn_.get());
+  std::vector<RID> rids(2);
+  Transaction *loader = txn_mgr.Begin();
+  for (int32_t i = 0; i < 2; i++) {
+    ASSERT_TRUE(table.InsertTuple(MakeTuple(i), &rids[i], loader));
+  }
+  txn_mgr.Commit(loader);
+
+  // The first updater wins over a concurrent one.
+  Transaction *first = txn_mgr.Begin(nullptr, IsolationLevel::SNAPSHOT_ISOLATION);
+  Transaction *second = txn_mgr.Begin(nullptr, IsolationLevel::SNAPSHOT_ISOLATION);
+  ASSERT_TRUE(table.UpdateTuple(MakeTuple(10), rids[0], first));
+  EXPECT_FALSE(table.UpdateTuple(MakeTuple(20), rids[0], second));
+  EXPECT_EQ(TransactionState::ABORTED, second->GetState());
+  txn_mgr.Abort(second);
+
+  // A transaction whose snapshot is older than the first updater's commit loses too, after it wrote another row.
+  Transaction *stale = txn_mgr.Begin(nullptr, IsolationLevel::SNAPSHOT_ISOLATION);
+  txn_mgr.Commit(first);
+  ASSERT_TRUE(table.UpdateTuple(MakeTuple(11), rids[1], stale));
+  EXPECT_FALSE(table.MarkDelete(rids[0], stale));
+  EXPECT_EQ(TransactionState::ABORTED, stale->GetState());
+  txn_mgr.Abort(stale);
+
+  Transaction *fresh = txn_mgr.Begin(nullptr, IsolationLevel::SNAPSHOT_ISOLATION);
+  EXPECT_EQ((std::vector<int32_t>{1, 10}), ReadColumn(&table, fresh));
+  EXPECT_TRUE(table.MarkDelete(rids[0], fresh));
+  txn_mgr.Commit(fresh);
+  EXPECT_EQ((std::vector<int32_t>{1}), ReadColumn(&table, txn_.get()));
+
+  for (auto txn : {loader, first, second, stale, fresh}) {
+    delete txn;
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(TableHeapTest, SnapshotAbortTest) {
+  TransactionManager txn_mgr(lock_manager_.get());
+  TableHeap table(bpm_.get(), lock_manager_.get(), log_manager_.get(), txn_.get());
+  std::vector<RID> rids(3);
+  Transaction *loader = txn_mgr.Begin();
+  for (int32_t i = 0; i < 3; i++) {
+    ASSERT_TRUE(table.InsertTuple(MakeTuple(i), &rids[i], loader));
+  }
+  txn_mgr.Commit(loader);
+
+  Transaction *reader = txn_mgr.Begin(nullptr, IsolationLevel::SNAPSHOT_ISOLATION);
+  Transaction *writer = txn_mgr.Begin(nullptr, IsolationLevel::SNAPSHOT_ISOLATION);
+  ASSERT_TRUE(table.UpdateTuple(MakeTuple(10), rids[0], writer));
+  ASSERT_TRUE(table.UpdateTuple(MakeTuple(20), rids[0], writer));
+  ASSERT_TRUE(table.MarkDelete(rids[1], writer));
+  RID new_rid;
+  ASSERT_TRUE(table.InsertTuple(MakeTuple(30), &new_rid, writer));
+  EXPECT_EQ(3U, table.GetVersionStore()->GetVersionCount());
+  txn_mgr.Abort(writer);
+
+  // The rollback restores the pages and drops the versions that the writer made.
+  const std::vector<int32_t> original{0, 1, 2};
+  EXPECT_EQ(original, ReadColumn(&table, reader));
+  EXPECT_EQ(original, ReadColumn(&table, txn_.get()));
+  EXPECT_EQ(0U, table.GetVersionStore()->GetVersionCount());
+  Transaction *next = txn_mgr.Begin(nullptr, IsolationLevel::SNAPSHOT_ISOLATION);
+  EXPECT_EQ(original, ReadColumn(&table, next));
+  ASSERT_TRUE(table.UpdateTuple(MakeTuple(40), rids[0], next));
+  txn_mgr.Commit(next);
+  txn_mgr.Commit(reader);
+
+  for (auto txn : {loader, reader, writer, next}) {
+    delete txn;
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(TableHeapTest, SnapshotLockingWriterTest) {
+  TransactionManager txn_mgr(lock_manager_.get());
+  TableHeap table(bpm_.get(), lock_manager_.get(), log_manager_.get(), txn_.get());
+  std::vector<RID> rids(2);
+  Transaction *loader = txn_mgr.Begin();
+  for (int32_t i = 0; i < 2; i++) {
+    ASSERT_TRUE(table.InsertTuple(MakeTuple(i), &rids[i], loader));
+  }
+  txn_mgr.Commit(loader);
+
+  // A snapshot does not see the uncommitted writes of a REPEATABLE_READ writer, nor them rolled back.
+  const std::vector<int32_t> original{0, 1};
+  Transaction *reader = txn_mgr.Begin(nullptr, IsolationLevel::SNAPSHOT_ISOLATION);
+  Transaction *dirty = txn_mgr.Begin(nullptr, IsolationLevel::REPEATABLE_READ);
+  ASSERT_TRUE(table.UpdateTuple(MakeTuple(10), rids[0], dirty));
+  ASSERT_TRUE(table.MarkDelete(rids[1], dirty));
+  RID new_rid;
+  ASSERT_TRUE(table.InsertTuple(MakeTuple(30), &new_rid, dirty));
+  EXPECT_EQ(original, ReadColumn(&table, reader));
+  Tuple tuple;
+  EXPECT_FALSE(table.GetTuple(new_rid, &tuple, reader));
+  txn_mgr.Abort(dirty);
+  EXPECT_EQ(original, ReadColumn(&table, reader));
+
+  // A REPEATABLE_READ update committed after the snapshot wins over the snapshot's own update of the row.
+  Transaction *locking = txn_mgr.Begin(nullptr, IsolationLevel::REPEATABLE_READ);
+  ASSERT_TRUE(table.UpdateTuple(MakeTuple(20), rids[0], locking));
+  txn_mgr.Commit(locking);
+  EXPECT_EQ(original, ReadColumn(&table, reader));
+  EXPECT_FALSE(table.UpdateTuple(MakeTuple(40), rids[0], reader));
+  EXPECT_EQ(TransactionState::ABORTED, reader->GetState());
+  txn_mgr.Abort(reader);
+
+  Transaction *fresh = txn_mgr.Begin(nullptr, IsolationLevel::SNAPSHOT_ISOLATION);
+  EXPECT_EQ((std::vector<int32_t>{1, 20}), ReadColumn(&table, fresh));
+  txn_mgr.Commit(fresh);
+
+  for (auto txn : {loader, reader, dirty, locking, fresh}) {
+    delete txn;
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(TableHeapTest, DISABLED_SnapshotReadBenchmark) {
+  // A writer keeps updating rows one at a time, holding each exclusive lock for a millisecond. Readers that lock
+  // wait for it on every scan; snapshot readers do not.
+  enable_logging = true;
+  TransactionManager txn_mgr(lock_manager_.get());
+  TableHeap table(bpm_.get(), lock_manager_.get(), log_manager_.get(), txn_.get());
+  constexpr int32_t rows = 500;
+  std::vector<RID> rids(rows);
+  Transaction *loader = txn_mgr.Begin();
+  for (int32_t i = 0; i < rows; i++) {
+    table.InsertTuple(MakeTuple(i), &rids[i], loader);
+  }
+  txn_mgr.Commit(loader);
+  delete loader;
+
+  for (auto isolation_level : {IsolationLevel::REPEATABLE_READ, IsolationLevel::SNAPSHOT_ISOLATION}) {
+    std::atomic<bool> stop{false};
+    std::thread writer([&] {
+      for (int32_t i = 0; !stop; i++) {
+        Transaction *txn = txn_mgr.Begin(nullptr, IsolationLevel::SNAPSHOT_ISOLATION);
+        bool updated = table.UpdateTuple(MakeTuple(i), rids[i % rows], txn);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        if (updated) {
+          txn_mgr.Commit(txn);
+        } else {
+          txn_mgr.Abort(txn);
+        }
+        delete txn;
+      }
+    });
+    size_t scans = 0;
+    double max_latency = 0;
+    auto start = std::chrono::steady_clock::now();
+    while (std::chrono::steady_clock::now() - start < std::chrono::seconds(2)) {
+      auto scan_start = std::chrono::steady_clock::now();
+      Transaction *txn = txn_mgr.Begin(nullptr, isolation_level);
+      size_t count = 0;
+      for (auto it = table.Begin(txn); it != table.End(); ++it) {
+        count++;
+      }
+      EXPECT_EQ(static_cast<size_t>(rows), count);
+      txn_mgr.Commit(txn);
+      delete txn;
+      scans++;
+      auto latency = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - scan_start).count();
+      max_latency = std::max(max_latency, latency);
+    }
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    stop = true;
+    writer.join();
+    std::cout << (isolation_level == IsolationLevel::SNAPSHOT_ISOLATION ? "snapshot" : "locking") << " reads: "
+              << elapsed / scans << " ms/scan, max " << max_latency << " ms, "
+              << table.GetVersionStore()->GetVersionCount() << " versions kept" << std::endl;
+  }
+  enable_logging = false;
+}
+
+// NOLINTNEXTLINE
+TEST_F(TableHeapTest, DISABLED_InsertBenchmark) {
+  // Inserts one row at a time into a growing table; the cost per row should not grow with the table.
+  TableHeap table(bpm_.get(), lock_manager_.get(), log_manager_.get(), txn_.get());
+  constexpr int32_t rounds = 10;
+  constexpr int32_t rows_per_round = 100000;
+  Tuple tuple = MakeTuple(0);
+  RID rid;
+  for (int32_t round = 0; round < rounds; round++) {
+    auto start = std::chrono::steady_clock::now();
+    for (int32_t i = 0; i < rows_per_round; i++) {
+      table.InsertTuple(tuple, &rid, txn_.get());
+    }
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "rows " << (round + 1) * rows_per_round << ": " << elapsed / rows_per_round << " ns/row"
+              << std::endl;
+  }
+}
+
+}  // namespace bustub
@@ -21,8 +21,31 @@
 #include "logging/common.h"
 #include "storage/table/table_heap.h"
 #include "storage/table/tuple.h"
+#include "type/value_factory.h"
 
 namespace bustub {
+// NOLINTNEXTLINE
+TEST(TupleTest, NullVarcharTest) {
+  Column col1{"a", TypeId::VARCHAR, 20};
+  Column col2{"b", TypeId::INTEGER};
+  Column col3{"c", TypeId::VARCHAR, 16};
+  Schema schema{{col1, col2, col3}};
+
+  Tuple tuple({ValueFactory::GetNullValueByType(TypeId::VARCHAR), ValueFactory::GetIntegerValue(7),
+               ValueFactory::GetVarcharValue("bustub")},
+              &schema);
+  // Each varchar takes its length field, and only the non-NULL one has data.
+  EXPECT_EQ(schema.GetLength() + 2 * sizeof(uint32_t) + 7, tuple.GetLength());
+  EXPECT_TRUE(tuple.GetValue(&schema, 0).IsNull());
+  EXPECT_EQ(7, tuple.GetValue(&schema, 1).GetAs<int32_t>());
+  EXPECT_EQ("bustub", tuple.GetValue(&schema, 2).ToString());
+
+  // The copy round-trips the same way.
+  Tuple copy = tuple;
+  EXPECT_TRUE(copy.GetValue(&schema, 0).IsNull());
+  EXPECT_EQ("bustub", copy.GetValue(&schema, 2).ToString());
+}
+
 // NOLINTNEXTLINE
 TEST(TupleTest, DISABLED_TableHeapTest) {
   // test1: parse create sql statement